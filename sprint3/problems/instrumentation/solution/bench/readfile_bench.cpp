@@ -0,0 +1,88 @@
+/*
+ * Parsing throughput of getGraphFromFileThreads against the number of threads.
+ *
+ * Build from the solution directory:
+ *   g++ -O2 -pthread -o readfile_bench bench/readfile_bench.cpp readfile.cpp graph.cpp binarytree.cpp config.cpp
+ * Run:
+ *   ./readfile_bench <eventsfile> [max_threads] [runs]
+ */
+#include <sys/stat.h>
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+#include "../readfile.h"
+#include "../config.h"
+
+void printUsage()
+{
+	fprintf(stderr, "readfile_bench <eventsfile> [max_threads] [runs]\n");
+}
+
+/* graphs and edges in the list, to check that every thread count gives the same result */
+void countGraph (GraphList g, long * graphs, long * edges)
+{
+	*graphs = 0;
+	*edges = 0;
+	for (GraphListNode * node = g; node != NULL; node = node->next)
+	{
+		(*graphs)++;
+		for (Edge * edge = node->graph->edges; edge != NULL; edge = edge->next)
+			(*edges)++;
+	}
+}
+
+int main (int argc, char ** argv)
+{
+	if (argc < 2 || argc > 4)
+	{
+		printUsage();
+		exit(0);
+	}
+
+	char * file = argv[1];
+	unsigned max_threads = (argc > 2) ? atoi(argv[2]) : std::max (1u, std::thread::hardware_concurrency ());
+	int runs = (argc > 3) ? atoi(argv[3]) : 3;
+
+	struct stat st;
+	if (stat (file, &st) != 0)
+	{
+		perror(file);
+		exit(0);
+	}
+	const double megabytes = st.st_size / (1024.0 * 1024.0);
+
+	char config_file[] = "pathalizer.conf";
+	Config * config = ReadConfig (config_file);
+
+	printf("%zu bytes, %d runs per thread count, best run reported\n", (size_t) st.st_size, runs);
+	printf("%8s %12s %10s %8s %10s %10s\n", "threads", "time, ms", "MB/s", "speedup", "graphs", "edges");
+
+	double single_thread_time = 0;
+	for (unsigned n_threads = 1; n_threads <= max_threads; n_threads *= 2)
+	{
+		double best = 0;
+		long graphs = 0;
+		long edges = 0;
+		for (int run = 0; run < runs; run++)
+		{
+			// Graphs are never freed by the parser, so every run leaks its result
+			NodeHashTbl * nodehash = new NodeHashTbl (255);
+
+			auto start = std::chrono::steady_clock::now();
+			GraphList g = getGraphFromFileThreads (file, nodehash, config, n_threads);
+			double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+			best = (run == 0) ? elapsed : std::min (best, elapsed);
+			countGraph (g, &graphs, &edges);
+		}
+		if (n_threads == 1)
+			single_thread_time = best;
+
+		printf("%8u %12.2f %10.1f %8.2f %10ld %10ld\n",
+				n_threads, best * 1000, megabytes / best, single_thread_time / best, graphs, edges);
+	}
+
+	return 0;
+}
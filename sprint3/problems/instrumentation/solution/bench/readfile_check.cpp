@@ -0,0 +1,109 @@
+/*
+ * Regression check for getGraphFromFileThreads: every thread count must give
+ * the same graphs as a single-threaded read. Runs on generated logs with
+ * blank and malformed lines inside sessions and on any files given.
+ *
+ * Build from the solution directory:
+ *   g++ -O2 -pthread -o readfile_check bench/readfile_check.cpp readfile.cpp graph.cpp binarytree.cpp config.cpp
+ * Run:
+ *   ./readfile_check [eventsfile...]
+ */
+#include <unistd.h>
+
+#include <string>
+
+#include "../readfile.h"
+#include "../config.h"
+
+const unsigned MAX_THREADS = 16;
+
+/* the graph list as text: one line per graph, the start node and then every edge */
+std::string dumpGraph (GraphList g)
+{
+	std::string result;
+	for (GraphListNode * node = g; node != NULL; node = node->next)
+	{
+		result.append (node->graph->start->name);
+		for (Edge * edge = node->graph->edges; edge != NULL; edge = edge->next)
+			result.append (" ").append (edge->from->name).append (">").append (edge->to->name);
+		result.append ("\n");
+	}
+	return result;
+}
+
+std::string parse (char * file, Config * config, unsigned n_threads)
+{
+	NodeHashTbl * nodehash = new NodeHashTbl (255);
+	return dumpGraph (getGraphFromFileThreads (file, nodehash, config, n_threads));
+}
+
+/* returns the number of thread counts that differ from the single-threaded read */
+int check (const char * title, char * file, Config * config)
+{
+	const std::string expected = parse (file, config, 1);
+	int failures = 0;
+	for (unsigned n_threads = 2; n_threads <= MAX_THREADS; n_threads++)
+	{
+		if (parse (file, config, n_threads) != expected)
+		{
+			fprintf(stderr, "%s: %u threads differ from a single-threaded read\n", title, n_threads);
+			failures++;
+		}
+	}
+	printf("%s: %s\n", title, failures ? "FAILED" : "ok");
+	return failures;
+}
+
+int checkLog (const char * title, const std::string & content, Config * config)
+{
+	char file[] = "/tmp/readfile_check_XXXXXX";
+	int fd = mkstemp (file);
+	if (fd < 0 || write (fd, content.data (), content.size ()) != (ssize_t) content.size ())
+	{
+		perror(file);
+		exit(1);
+	}
+	close (fd);
+
+	int failures = check (title, file, config);
+	unlink (file);
+	return failures;
+}
+
+std::string event (const char * session, int timestamp, const char * name)
+{
+	return std::string (session) + "\t" + std::to_string (timestamp) + "\t" + name + "\n";
+}
+
+int main (int argc, char ** argv)
+{
+	Config config;
+	config.min_edgewidth = -1;
+	config.max_edgecount = 60;
+
+	int failures = 0;
+	for (config.ignore_refresh = 0; config.ignore_refresh <= 1; config.ignore_refresh++)
+	{
+		// A session interrupted by blank lines must not be split between chunks
+		std::string blank = event ("1.1.1.1", 1, "/a") + event ("1.1.1.1", 2, "/b");
+		blank += std::string (200, '\n');
+		blank += event ("1.1.1.1", 3, "/c") + event ("1.1.1.1", 4, "/c") + event ("2.2.2.2", 5, "/a");
+		failures += checkLog ("blank lines inside a session", blank, &config);
+
+		// The same with malformed lines and CRLF line ends
+		std::string malformed;
+		for (int i = 0; i < 50; i++)
+		{
+			const std::string session = "10.0.0." + std::to_string (i / 10);
+			malformed += event (session.c_str (), i, ("/page" + std::to_string (i % 3) + "/").c_str ());
+			malformed += (i % 4 == 0) ? "garbage line\n" : "\t\r\n";
+		}
+		malformed += "10.0.0.9\t99\t/last";
+		failures += checkLog ("malformed lines inside sessions", malformed, &config);
+	}
+
+	for (int i = 1; i < argc; i++)
+		failures += check (argv[i], argv[i], &config);
+
+	return failures ? 1 : 0;
+}
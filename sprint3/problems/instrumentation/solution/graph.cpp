@@ -91,10 +91,12 @@ Node * newNode (char * name)
 void FixName (char * name)
 {
 	// Node names may not end with '\' or '/'
-	while ((name[strlen(name)-1] == '\\')
-		|| (name[strlen(name)-1] == '/'))
+	size_t length = strlen(name);
+	while ((length > 0)
+		&& ((name[length-1] == '\\')
+		|| (name[length-1] == '/')))
 	{
-		name[strlen(name)-1] = '\0';
+		name[--length] = '\0';
 	}
 }
 
@@ -181,6 +183,18 @@ void addEdge (Graph * g, Node * from, Node * to)
 	current_edge->next = newEdge(from, to);
 }
 
+Edge * appendEdge (Graph * g, Edge * last, Node * from, Node * to)
+{
+	Edge * edge = newEdge(from, to);
+
+	if (last == NULL)
+		g->edges = edge;
+	else
+		last->next = edge;
+
+	return edge;
+}
+
 AnnotatedEdge * newAnnotatedEdge (Edge * e, AnnotatedEdge * next = NULL)
 {
 	AnnotatedEdge * retval = (AnnotatedEdge *) malloc (sizeof(AnnotatedEdge));
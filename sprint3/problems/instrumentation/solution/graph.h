@@ -108,6 +108,13 @@ GraphListNode * newGraphListNode (GraphListNode * next, Node * start);
 
 void addEdge (Graph * graph, Node * from, Node * to);
 
+/*
+ * Same as addEdge, but appends after last (the current tail of the graph's
+ * edge list, NULL for an empty graph) instead of walking the list.
+ * Returns the new tail.
+ */
+Edge * appendEdge (Graph * graph, Edge * last, Node * from, Node * to);
+
 /*
  * adds an edge to an annotated graph, at the same time
  * converting it to an annotated edge and counting the number
@@ -1,65 +1,304 @@
 #include "readfile.h"
 
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
 #undef DEBUG
 
-GraphList getGraphFromFile (char * file, NodeHashTbl * nodehash, Config * config)
+namespace
+{
+
+// Chunks smaller than this are not worth a thread of their own
+const size_t MIN_CHUNK_SIZE = 1 << 20;
+
+/*
+ * A part of the log parsed by one thread. Node names are interned per chunk,
+ * so the threads share nothing but the (read-only) mapped file. Only the
+ * global node table is filled serially; the chunk's graphs are then built
+ * by its thread again.
+ */
+struct Chunk
+{
+	const char * begin;
+	const char * end;
+	bool ignore_refresh;
+
+	std::vector<std::string_view> names;   // distinct names in the order of first occurrence
+	std::vector<int> events;               // index into names for every kept event
+	std::vector<size_t> sessions;          // index into events where every session starts
+
+	std::vector<Node *> nodes;             // global node for every name
+	GraphListNode * head = NULL;           // graph of the last session of the chunk
+	GraphListNode * tail = NULL;           // graph of the first session, its next is NULL
+};
+
+struct Line
+{
+	std::string_view session;
+	std::string_view name;
+};
+
+const char * FindLineEnd (const char * p, const char * end)
+{
+	const char * eol = (const char *) memchr (p, '\n', end - p);
+	return eol ? eol : end;
+}
+
+/*
+ * Splits "session \t timestamp \t name" into tokens. The name ends at the first
+ * whitespace, as it did with sscanf("%s"). Returns false for malformed lines.
+ */
+bool ScanLine (const char * p, const char * eol, Line & line)
+{
+	const char * tab = (const char *) memchr (p, '\t', eol - p);
+	if (tab == NULL || tab == p)
+		return false;
+	line.session = std::string_view (p, tab - p);
+
+	p = tab + 1;
+	tab = (const char *) memchr (p, '\t', eol - p);
+	if (tab == NULL)
+		return false;
+
+	p = tab + 1;
+	const char * name_end = p;
+	while (name_end < eol && *name_end != ' ' && *name_end != '\t' && *name_end != '\r')
+		name_end++;
+	if (name_end == p)
+		return false;
+
+	// Same as FixName: node names may not end with '\' or '/'
+	while (name_end > p && (name_end[-1] == '\\' || name_end[-1] == '/'))
+		name_end--;
+	line.name = std::string_view (p, name_end - p);
+	return true;
+}
+
+std::string_view GetSession (const char * p, const char * end)
+{
+	Line line;
+	return ScanLine (p, FindLineEnd (p, end), line) ? line.session : std::string_view ();
+}
+
+/*
+ * Moves pos forward to the start of a line that begins a new session,
+ * so that no session is split between two chunks.
+ */
+const char * FindSessionStart (const char * data, const char * pos, const char * end)
+{
+	if (pos == data || pos == end)
+		return pos;
+	if (pos[-1] != '\n')
+		pos = std::min (FindLineEnd (pos, end) + 1, end);
+	if (pos == end)
+		return pos;
+
+	/*
+	 * The parser skips blank and malformed lines without ending the session,
+	 * so the session to continue is the one of the last valid line before pos,
+	 * and such lines after pos do not end it either.
+	 */
+	std::string_view session;
+	for (const char * line = pos; line > data && session.empty (); )
+	{
+		line--;
+		while (line > data && line[-1] != '\n')
+			line--;
+		session = GetSession (line, end);
+	}
+	if (session.empty ())
+		return pos;
+
+	while (pos < end)
+	{
+		const std::string_view next = GetSession (pos, end);
+		if (!next.empty () && next != session)
+			break;
+		pos = std::min (FindLineEnd (pos, end) + 1, end);
+	}
+	return pos;
+}
+
+void ParseChunk (Chunk * chunk)
+{
+	std::unordered_map<std::string_view, int> ids;
+	std::string_view current_session;
+	int last_id = -1;
+	bool has_session = false;
+
+	for (const char * p = chunk->begin; p < chunk->end; )
+	{
+		const char * eol = FindLineEnd (p, chunk->end);
+		Line line;
+		if (!ScanLine (p, eol, line))
+		{
+			p = eol + 1;
+			continue;
+		}
+		p = eol + 1;
+
+		auto [it, inserted] = ids.emplace (line.name, (int) chunk->names.size ());
+		if (inserted)
+			chunk->names.push_back (line.name);
+		const int id = it->second;
+
+		if (!has_session || line.session != current_session)
+		{
+			has_session = true;
+			current_session = line.session;
+			chunk->sessions.push_back (chunk->events.size ());
+			chunk->events.push_back (id);
+		}
+		else if (!chunk->ignore_refresh || id != last_id)
+		{
+			chunk->events.push_back (id);
+		}
+		last_id = id;
+	}
+}
+
+/*
+ * Builds the graphs of the chunk's sessions. Graphs are prepended,
+ * so the list runs from the last session of the chunk to the first.
+ */
+void BuildChunkGraphs (Chunk * chunk)
+{
+	for (size_t s = 0; s < chunk->sessions.size (); s++)
+	{
+		const size_t first = chunk->sessions[s];
+		const size_t last = (s + 1 < chunk->sessions.size ()) ? chunk->sessions[s + 1] : chunk->events.size ();
+
+		// TODO maybe check for graphs without edges?
+		chunk->head = newGraphListNode (chunk->head, chunk->nodes[chunk->events[first]]);
+		if (chunk->tail == NULL)
+			chunk->tail = chunk->head;
+		Edge * last_edge = NULL;
+		for (size_t e = first + 1; e < last; e++)
+		{
+			last_edge = appendEdge (chunk->head->graph, last_edge,
+					chunk->nodes[chunk->events[e - 1]], chunk->nodes[chunk->events[e]]);
+		}
+	}
+}
+
+template <typename Func>
+void ForEachChunk (std::vector<Chunk> & chunks, Func func)
+{
+	std::vector<std::thread> threads;
+	for (size_t i = 1; i < chunks.size (); i++)
+		threads.emplace_back (func, &chunks[i]);
+	func (&chunks[0]);
+	for (auto & thread : threads)
+		thread.join ();
+}
+
+} // namespace
+
+GraphList getGraphFromFileThreads (char * file, NodeHashTbl * nodehash, Config * config, unsigned n_threads)
 {
-	FILE * in;
 	GraphListNode * current_graphlistnode = NULL;
 
-	in = fopen (file, "r");
+	int fd = open (file, O_RDONLY);
+	struct stat st;
 
-	if (in == NULL)
+	if (fd < 0 || fstat (fd, &st) != 0)
 	{
-		char * error = "Error opening file with events ('";
+		const char * error = "Error opening file with events ('";
 		char * errmsg = (char *) malloc (strlen(error) + strlen(file) + 2 + 1);
 		sprintf(errmsg, "%s%s')", error, file);
 		perror(errmsg);
 		exit(0);
 	};
 
-	char buffer[BUFSIZE];
-	char session[BUFSIZE];
-	int timestamp;
-	char name[BUFSIZE];
+	const size_t size = st.st_size;
+	if (size == 0)
+	{
+		close (fd);
+		return NULL;
+	}
+
+	void * mapped = mmap (NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close (fd);
+	if (mapped == MAP_FAILED)
+	{
+		perror ("Error mapping file with events");
+		exit(0);
+	}
+	madvise (mapped, size, MADV_SEQUENTIAL);
+
+	const char * data = (const char *) mapped;
+	const char * end = data + size;
 
-	char * current_session = (char *) malloc (1); // so we can free it
-	Node * last_node = NULL;
-	Node * current_node = NULL;
+	if (n_threads == 0)
+	{
+		n_threads = std::max (1u, std::thread::hardware_concurrency ());
+		n_threads = (unsigned) std::max<size_t> (1, std::min<size_t> (n_threads, size / MIN_CHUNK_SIZE));
+	}
 
 #ifdef DEBUG
-	fprintf(stderr, "Ignoring refreshes: %d", config->ignore_refresh);
+	fprintf(stderr, "Ignoring refreshes: %d, threads: %u", config->ignore_refresh, n_threads);
 #endif
 
-	// while (fscanf(in, "%s\t%d\t%s\n", &session, &timestamp, &name) > 0)
-	while (fgets (buffer, BUFSIZE, in))
+	std::vector<Chunk> chunks (n_threads);
+	const char * chunk_begin = data;
+	for (unsigned i = 0; i < n_threads; i++)
 	{
-		if (!sscanf(buffer, "%s\t%d\t%s\n", &session, &timestamp, &name))
-			break;
+		const char * chunk_end = (i + 1 == n_threads)
+			? end
+			: FindSessionStart (data, std::max (chunk_begin, data + size / n_threads * (i + 1)), end);
+		chunks[i].begin = chunk_begin;
+		chunks[i].end = chunk_end;
+		chunks[i].ignore_refresh = config->ignore_refresh;
+		chunk_begin = chunk_end;
+	}
 
-		last_node = current_node;
+	ForEachChunk (chunks, ParseChunk);
 
-#ifdef DEBUG
-		fprintf(stderr, "Session %s, node %s\n", session, name);
-#endif
-		current_node = getNode(name, nodehash);
-
-		if (strcmp(session, current_session) != 0)
-		{
-			free (current_session);
-			current_session = strdup(session);
-			// TODO maybe check for graphs without edges?
-			current_graphlistnode = newGraphListNode(current_graphlistnode, current_node);
-		}
-		else
+	/*
+	 * The node table is shared, so names are interned serially and in file
+	 * order: nodes are created in the order of their first occurrence,
+	 * same as a sequential read.
+	 */
+	std::string name;
+	for (Chunk & chunk : chunks)
+	{
+		chunk.nodes.reserve (chunk.names.size ());
+		for (std::string_view chunk_name : chunk.names)
 		{
-			if ((!config->ignore_refresh) // if false, just add the edge
-					|| (strcmp(last_node->name, current_node->name) != 0))
-			{
-				addEdge(current_graphlistnode->graph, last_node, current_node);
-			}
+			name.assign (chunk_name);
+			chunk.nodes.push_back (getNode (name.data (), nodehash));
 		}
 	}
 
+	// Graphs only reference the nodes, so every chunk builds its own list
+	ForEachChunk (chunks, BuildChunkGraphs);
+
+	/*
+	 * Splice the lists in file order. Graphs are prepended, same as a sequential
+	 * read: the first graph of a chunk is followed by the last graph of the previous one.
+	 */
+	for (Chunk & chunk : chunks)
+	{
+		if (chunk.head == NULL)
+			continue;
+		chunk.tail->next = current_graphlistnode;
+		current_graphlistnode = chunk.head;
+	}
+
+	munmap (mapped, size);
 	return current_graphlistnode;
 }
+
+GraphList getGraphFromFile (char * file, NodeHashTbl * nodehash, Config * config)
+{
+	return getGraphFromFileThreads (file, nodehash, config, 0);
+}
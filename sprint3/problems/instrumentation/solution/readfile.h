@@ -8,3 +8,10 @@
 #define BUFSIZE 255
 
 GraphList getGraphFromFile (char * file, NodeHashTbl * nodelist, Config * config);
+
+/*
+ * Memory-maps the events file, splits it into n_threads chunks at session
+ * boundaries and parses the chunks in parallel. The result is the same as
+ * for a sequential read. n_threads == 0 uses one thread per core.
+ */
+GraphList getGraphFromFileThreads (char * file, NodeHashTbl * nodelist, Config * config, unsigned n_threads);
@@ -0,0 +1,39 @@
+# Сравнение двух прогонов game_server_bench в формате JSON (--benchmark_out_format=json).
+# Для каждого бенчмарка выводит процессорное время в обоих прогонах и изменение в процентах.
+#
+# Использование: python3 compare_bench.py results/<старый>.json results/<новый>.json [--threshold 5]
+import argparse
+import json
+
+
+def load(path):
+    with open(path) as file:
+        data = json.load(file)
+    # При --benchmark_repetitions сравниваются средние значения
+    runs = {}
+    for run in data['benchmarks']:
+        if run.get('run_type') == 'aggregate' and run.get('aggregate_name') != 'mean':
+            continue
+        runs[run['run_name']] = (run['cpu_time'], run['time_unit'])
+    return data['context'].get('commit', path), runs
+
+
+parser = argparse.ArgumentParser()
+parser.add_argument('baseline', type=str)
+parser.add_argument('contender', type=str)
+parser.add_argument('--threshold', type=float, default=5.0, help='mark changes above this percent')
+args = parser.parse_args()
+
+old_name, old_runs = load(args.baseline)
+new_name, new_runs = load(args.contender)
+
+width = max((len(name) for name in new_runs), default=10)
+print(f'{"benchmark":<{width}} {old_name:>14} {new_name:>14} {"change":>9}')
+for name, (new_time, unit) in new_runs.items():
+    if name not in old_runs:
+        print(f'{name:<{width}} {"-":>14} {new_time:>11.1f} {unit:<2}')
+        continue
+    old_time, _ = old_runs[name]
+    change = (new_time - old_time) / old_time * 100.0
+    mark = ' *' if abs(change) >= args.threshold else ''
+    print(f'{name:<{width}} {old_time:>11.1f} {unit:<2} {new_time:>11.1f} {unit:<2} {change:>+8.1f}%{mark}')
@@ -0,0 +1,350 @@
+#include <benchmark/benchmark.h>
+
+#include "../src/app/app.h"
+#include "../src/app/memory_records.h"
+#include "../src/utils/collision_batch.h"
+#include "../src/utils/collision_detector.h"
+#include "../src/utils/json_loader.h"
+#include "../src/utils/json_writer.h"
+#include "../src/utils/loot_generator.h"
+#include "../src/utils/state_serialization.h"
+
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace std::literals;
+
+namespace {
+
+// Размер поля для поиска коллизий и шаг сетки дорог карты
+constexpr double FIELD_SIZE = 1000.0;
+constexpr model::Coord ROAD_STEP = 20;
+// Путь собаки за тик: 100 мс на скорости 3
+constexpr double GATHERER_STEP = 0.3;
+constexpr auto TICK = model::TimeType{100};
+
+const model::Map::Id MAP_ID{"bench"s};
+
+///  ---  Исходные данные  ---  ///
+
+std::vector<collision_detector::Item> MakeItems(size_t count, std::mt19937& random) {
+    std::uniform_real_distribution<double> coord(0.0, FIELD_SIZE);
+    std::vector<collision_detector::Item> items;
+    items.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        items.push_back({static_cast<unsigned>(i), {coord(random), coord(random)}, 0.0});
+    }
+    return items;
+}
+
+// Собиратели двигаются вдоль одной из осей, как собаки по дорогам
+std::vector<collision_detector::Gatherer> MakeGatherers(size_t count, std::mt19937& random) {
+    std::uniform_real_distribution<double> coord(0.0, FIELD_SIZE);
+    std::vector<collision_detector::Gatherer> gatherers;
+    gatherers.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        const geom::Point2D start{coord(random), coord(random)};
+        const geom::Point2D end = i % 2 ? geom::Point2D{start.x + GATHERER_STEP, start.y}
+                                        : geom::Point2D{start.x, start.y + GATHERER_STEP};
+        gatherers.push_back({start, end, 0.6});
+    }
+    return gatherers;
+}
+
+// Карта - сетка из roads горизонтальных и roads вертикальных дорог с офисами на диагонали
+model::Game MakeGame(size_t roads) {
+    model::Game game(loot_gen::LootGeneratorInfo{1.0, 0.5}, 3.0, 3, 60.0);
+    model::Map map(MAP_ID, "Bench"s);
+    const auto length = static_cast<model::Coord>(std::max<size_t>(roads - 1, 1) * ROAD_STEP);
+    for (size_t i = 0; i < roads; ++i) {
+        const auto offset = static_cast<model::Coord>(i * ROAD_STEP);
+        map.AddRoad(model::Road(model::Road::HORIZONTAL, {0, offset}, length));
+        map.AddRoad(model::Road(model::Road::VERTICAL, {offset, 0}, length));
+        map.AddOffice(model::Office(model::Office::Id{"office"s + std::to_string(i)}, {offset, offset}, {0, 0}));
+    }
+    map.SetDogSpeed(3.0);
+    map.SetNLootTypes(3);
+    map.SetBagCapacity(3);
+    game.AddMap(map);
+    return game;
+}
+
+model::Direction Reverse(model::Direction direction) {
+    switch (direction) {
+        case model::Direction::NORTH:
+            return model::Direction::SOUTH;
+        case model::Direction::SOUTH:
+            return model::Direction::NORTH;
+        case model::Direction::WEST:
+            return model::Direction::EAST;
+        case model::Direction::EAST:
+            return model::Direction::WEST;
+    }
+    return direction;
+}
+
+// Собаки расставлены по дорогам сетки и ходят вдоль них
+void AddDogs(model::GameSession& session, size_t count, size_t roads, std::mt19937& random) {
+    const auto length = static_cast<double>(std::max<size_t>(roads - 1, 1) * ROAD_STEP);
+    std::uniform_real_distribution<double> along(0.0, length);
+    std::uniform_int_distribution<size_t> road(0, roads - 1);
+    const auto speed = session.GetMap().GetDogSpeed().value();
+    for (size_t i = 0; i < count; ++i) {
+        const double offset = static_cast<double>(road(random) * ROAD_STEP);
+        auto* dog = i % 2 ? session.AddDog({along(random), offset}, model::Dog::Name{"dog"s + std::to_string(i)})
+                          : session.AddDog({offset, along(random)}, model::Dog::Name{"dog"s + std::to_string(i)});
+        dog->SetSpeed(speed, i % 2 ? model::Direction::EAST : model::Direction::SOUTH);
+    }
+}
+
+// Трофеи лежат на случайных дорогах сетки
+void AddItems(model::GameSession& session, size_t count, size_t roads, std::mt19937& random) {
+    const auto length = static_cast<double>(std::max<size_t>(roads - 1, 1) * ROAD_STEP);
+    std::uniform_real_distribution<double> along(0.0, length);
+    std::uniform_int_distribution<size_t> road(0, roads - 1);
+    model::Item::Type type = 0;
+    for (size_t i = 0; i < count; ++i) {
+        const double offset = static_cast<double>(road(random) * ROAD_STEP);
+        session.AddItem(i % 2 ? model::Position{along(random), offset} : model::Position{offset, along(random)}, type);
+    }
+}
+
+// Игра с приложением и подключёнными игроками
+struct World {
+    explicit World(size_t roads)
+        : game{MakeGame(roads)}
+        , app{game, records} {
+    }
+
+    std::vector<std::string> Join(size_t players) {
+        std::vector<std::string> tokens;
+        tokens.reserve(players);
+        for (size_t i = 0; i < players; ++i) {
+            tokens.push_back(app.JoinGame("dog"s + std::to_string(i), *MAP_ID).GetTokenAsString());
+        }
+        return tokens;
+    }
+
+    model::Game game;
+    app::MemoryPlayerRepository records;
+    app::Application app;
+};
+
+///  ---  Поиск коллизий  ---  ///
+
+void BM_FindGatherEvents(benchmark::State& state) {
+    std::mt19937 random{42};
+    const auto items = MakeItems(state.range(0), random);
+    const auto gatherers = MakeGatherers(state.range(1), random);
+    const collision_detector::SpanItemGathererProvider provider{items, gatherers};
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(collision_detector::FindGatherEvents(provider));
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0) * state.range(1));
+}
+BENCHMARK(BM_FindGatherEvents)->ArgNames({"items", "gatherers"})->ArgsProduct({{10, 100, 1000}, {10, 100, 1000}});
+
+// Пакетная проверка предметов, которой пользуется тик сессии. isa - см. collision_detector::BatchIsa
+void BM_FindGatherEventsBatch(benchmark::State& state) {
+    const auto isa = static_cast<collision_detector::BatchIsa>(state.range(2));
+    if (!collision_detector::IsBatchIsaSupported(isa)) {
+        state.SkipWithError("Instruction set is not supported");
+        return;
+    }
+    std::mt19937 random{42};
+    collision_detector::ItemsLayout items;
+    for (const auto& item : MakeItems(state.range(0), random)) {
+        items.Add(item);
+    }
+    const auto gatherers = MakeGatherers(state.range(1), random);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(collision_detector::FindGatherEvents(items, gatherers, isa));
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0) * state.range(1));
+}
+BENCHMARK(BM_FindGatherEventsBatch)
+    ->ArgNames({"items", "gatherers", "isa"})
+    ->ArgsProduct({{10, 100, 1000}, {10, 100, 1000}, {0, 1, 2}});
+
+void BM_FindOfficeSaveEvents(benchmark::State& state) {
+    std::mt19937 random{42};
+    std::uniform_real_distribution<double> coord(0.0, FIELD_SIZE);
+    collision_detector::RectIndex offices;
+    for (int64_t i = 0; i < state.range(0); ++i) {
+        const geom::Point2D position{coord(random), coord(random)};
+        offices.Add(collision_detector::Rect(position, position, 0.5), static_cast<size_t>(i));
+    }
+    const auto gatherers = MakeGatherers(state.range(1), random);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(collision_detector::FindOfficeSaveEvents(offices, gatherers));
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(1));
+}
+BENCHMARK(BM_FindOfficeSaveEvents)->ArgNames({"offices", "gatherers"})->ArgsProduct({{4, 64, 1024}, {10, 100, 1000}});
+
+///  ---  Модель  ---  ///
+
+// Перемещение собак по дорогам без остальных этапов тика
+void BM_MoveDog(benchmark::State& state) {
+    const auto dogs = static_cast<size_t>(state.range(0));
+    const auto roads = static_cast<size_t>(state.range(1));
+    auto game = MakeGame(roads);
+    auto* session = game.CreateSession(MAP_ID);
+    std::mt19937 random{42};
+    AddDogs(*session, dogs, roads, random);
+    const auto speed = session->GetMap().GetDogSpeed().value();
+
+    for (auto _ : state) {
+        for (const auto& dog : session->GetDogs()) {
+            dog->SetPosition(session->MoveDog(*dog, TICK));
+            // Собака, упёршаяся в конец дороги, разворачивается
+            if (!dog->IsActive()) {
+                dog->SetSpeed(speed, Reverse(dog->GetDirection()));
+            }
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * dogs);
+}
+BENCHMARK(BM_MoveDog)->ArgNames({"dogs", "roads"})->ArgsProduct({{10, 100, 1000}, {2, 16, 64}});
+
+// Полный тик сессии. Время этапов из TickProfile выводится счётчиками (нс на тик):
+// move - перемещение собак (GameSession::MoveDog), gather, office и loot.
+// Собранные трофеи после каждого тика докладываются, чтобы на карте их оставалось не меньше items
+void BM_SessionTick(benchmark::State& state) {
+    const auto dogs = static_cast<size_t>(state.range(0));
+    const auto roads = static_cast<size_t>(state.range(1));
+    const auto items = static_cast<size_t>(state.range(2));
+    auto game = MakeGame(roads);
+    auto* session = game.CreateSession(MAP_ID);
+    std::mt19937 random{42};
+    std::srand(42);
+    AddDogs(*session, dogs, roads, random);
+    AddItems(*session, items, roads, random);
+    const auto speed = session->GetMap().GetDogSpeed().value();
+
+    model::TickProfile profile;
+    for (auto _ : state) {
+        session->Tick(TICK, &profile);
+        // Собаки, упёршиеся в конец дороги, разворачиваются - иначе сессия быстро замрёт
+        for (const auto& dog : session->GetDogs()) {
+            if (!dog->IsActive()) {
+                dog->SetSpeed(speed, Reverse(dog->GetDirection()));
+            }
+        }
+        if (session->GetItems().size() < items) {
+            AddItems(*session, items - session->GetItems().size(), roads, random);
+        }
+    }
+
+    const auto per_tick = [&state](model::TickProfile::Duration duration) {
+        return benchmark::Counter(static_cast<double>(std::chrono::nanoseconds(duration).count()),
+                                  benchmark::Counter::kAvgIterations);
+    };
+    state.counters["move_ns"] = per_tick(profile.move);
+    state.counters["gather_ns"] = per_tick(profile.gather);
+    state.counters["office_ns"] = per_tick(profile.office);
+    state.counters["loot_ns"] = per_tick(profile.loot);
+    state.counters["items"] = static_cast<double>(session->GetItems().size());
+    state.SetItemsProcessed(state.iterations() * dogs);
+}
+BENCHMARK(BM_SessionTick)
+    ->ArgNames({"dogs", "roads", "items"})
+    ->ArgsProduct({{10, 100, 1000}, {2, 16, 64}, {10, 1000}});
+
+void BM_LootGenerator(benchmark::State& state) {
+    std::mt19937 random{42};
+    std::uniform_real_distribution<double> probability;
+    loot_gen::LootGenerator generator{1s, 0.5, [&] {
+        return probability(random);
+    }};
+    const auto looters = static_cast<unsigned>(state.range(0));
+    unsigned loot = 0;
+    for (auto _ : state) {
+        loot += generator.Generate(TICK, loot % (looters + 1), looters);
+        benchmark::DoNotOptimize(loot);
+    }
+}
+BENCHMARK(BM_LootGenerator)->ArgName("looters")->Arg(10)->Arg(1000);
+
+///  ---  Сериализация и поиск игрока  ---  ///
+
+// Ответ на /api/v1/game/state: собаки с полными рюкзаками и столько же трофеев
+void BM_StateJson(benchmark::State& state) {
+    const auto players = static_cast<size_t>(state.range(0));
+    auto game = MakeGame(16);
+    auto* session = game.CreateSession(MAP_ID);
+    std::mt19937 random{42};
+    AddDogs(*session, players, 16, random);
+
+    app::GetStateResult result;
+    for (size_t i = 0; i < players; ++i) {
+        auto& dog = *session->GetDogs()[i];
+        for (unsigned type = 0; type < 3; ++type) {
+            dog.TakeItem(model::Item{model::Item::Id(i * 3 + type), static_cast<int>(type), dog.GetPosition()});
+        }
+        result.players_.emplace_back(app::Player::Id{static_cast<int>(i)}, dog);
+        result.items_.emplace_back(model::Item::Id(players * 3 + i), 1, dog.GetPosition());
+    }
+
+    std::string body;
+    for (auto _ : state) {
+        body.clear();
+        json_writer::Serialize(result, body);
+        benchmark::DoNotOptimize(body.data());
+    }
+    state.SetBytesProcessed(state.iterations() * body.size());
+}
+BENCHMARK(BM_StateJson)->ArgName("players")->Arg(1)->Arg(100)->Arg(10000);
+
+// Снимок состояния в поток и восстановление из него в новую игру (как при горячем перезапуске)
+void BM_StateSerializerRoundTrip(benchmark::State& state) {
+    World world{16};
+    world.Join(state.range(0));
+
+    size_t snapshot_size = 0;
+    for (auto _ : state) {
+        state.PauseTiming();
+        auto restored = std::make_unique<World>(16);
+        std::stringstream snapshot;
+        state.ResumeTiming();
+
+        serialization::StateSerializer{world.game, world.app}.Serialize(snapshot);
+        serialization::StateSerializer{restored->game, restored->app}.Deserialize(snapshot);
+
+        state.PauseTiming();
+        snapshot_size = snapshot.str().size();
+        restored.reset();
+        state.ResumeTiming();
+    }
+    state.counters["snapshot_bytes"] = static_cast<double>(snapshot_size);
+}
+BENCHMARK(BM_StateSerializerRoundTrip)->ArgName("players")->Arg(10)->Arg(1000)->Unit(benchmark::kMicrosecond);
+
+// Поиск игрока по токену - с него начинается каждый запрос игрока к API
+void BM_FindPlayerByToken(benchmark::State& state) {
+    const auto players = static_cast<size_t>(state.range(0));
+    auto game = MakeGame(2);
+    auto* session = game.CreateSession(MAP_ID);
+    app::Players all_players;
+    app::PlayerTokens player_tokens;
+    std::vector<app::Token> tokens;
+    tokens.reserve(players);
+    for (size_t i = 0; i < players; ++i) {
+        auto* dog = session->AddDog({0.0, 0.0}, model::Dog::Name{"dog"s + std::to_string(i)});
+        tokens.push_back(player_tokens.AddPlayer(all_players.Add(dog, *session)));
+    }
+
+    size_t i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(player_tokens.FindPlayerByToken(tokens[i]));
+        i = i + 1 == players ? 0 : i + 1;
+    }
+}
+BENCHMARK(BM_FindPlayerByToken)->ArgName("players")->Arg(10)->Arg(1000)->Arg(100000);
+
+}  // namespace
+
+BENCHMARK_MAIN();
@@ -0,0 +1,20 @@
+#!/bin/bash
+# Микробенчмарки модели и утилит (game_server_bench) с сохранением результата в JSON.
+# Файл называется по текущему коммиту, чтобы прогоны разных версий можно было сравнить:
+#   python3 compare_bench.py results/<старый>.json results/<новый>.json
+#
+# Использование: ./run_bench.sh <путь-к-game_server_bench> [опции Google Benchmark]
+# Например, только тик сессии с тремя повторами:
+#   ./run_bench.sh ../build/bin/game_server_bench --benchmark_filter=SessionTick --benchmark_repetitions=3
+
+set -e
+
+bench=${1:-../build/bin/game_server_bench}
+shift || true
+here=$(cd "$(dirname "$0")" && pwd)
+commit=$(git -C "$here" rev-parse --short HEAD 2>/dev/null || echo unknown)
+
+mkdir -p "$here/results"
+"$bench" --benchmark_out="$here/results/$commit.json" --benchmark_out_format=json \
+    --benchmark_context=commit="$commit" "$@"
+echo "results: $here/results/$commit.json"
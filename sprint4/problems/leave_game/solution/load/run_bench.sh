@@ -0,0 +1,53 @@
+#!/bin/bash
+# Сравнение режимов работы сервера под нагрузкой на статику и /api/v1/maps:
+#   shared   - один io_context на все потоки (режим по умолчанию)
+#   per-core - io_context и acceptor (SO_REUSEPORT) на каждое ядро (--thread-per-core)
+#
+# Использование: GAME_DB_URL=... ./run_bench.sh <путь-к-game_server>
+# Нагрузку подаёт yandex-tank (docker), результаты складываются в results/<режим>
+
+set -e
+
+server=${1:-../build/bin/game_server}
+here=$(cd "$(dirname "$0")" && pwd)
+root="$here/.."
+
+if [ -z "$GAME_DB_URL" ]; then
+    echo "GAME_DB_URL is not set"
+    exit 1
+fi
+
+run_mode() {
+    local mode=$1
+    shift
+    echo "=== Mode: $mode ==="
+
+    "$server" --config-file "$root/data/config.json" --www-root "$root/static" "$@" > "$here/server_$mode.log" 2>&1 &
+    local server_pid=$!
+    # Ждём, пока сервер начнёт принимать соединения
+    until grep -q "server started" "$here/server_$mode.log"; do sleep 0.1; done
+
+    rm -rf "$here/logs"
+    docker run --rm -v "$here":/var/loadtest --net host yandex/yandex-tank -c load.yaml ammo.txt > /dev/null
+
+    kill -INT $server_pid
+    wait $server_pid || true
+
+    rm -rf "$here/results/$mode"
+    mkdir -p "$here/results/$mode"
+    cp -r "$here"/logs/* "$here/results/$mode/"
+
+    # phout: 3-е поле - время ответа в мкс, 12-е - HTTP-код
+    local phout=$(find "$here/results/$mode" -name 'phout*.log' | head -n 1)
+    sort -t$'\t' -k3,3n "$phout" | awk -F'\t' -v mode="$mode" '
+        { t[NR] = $3; if ($12 != 200) errors++ }
+        END {
+            printf "%s: requests=%d errors=%d p50=%dus p95=%dus p99=%dus\n", mode, NR, errors,
+                t[int(NR*0.50)], t[int(NR*0.95)], t[int(NR*0.99)]
+        }' | tee -a "$here/results/summary.txt"
+}
+
+mkdir -p "$here/results"
+rm -f "$here/results/summary.txt"
+run_mode shared
+run_mode per-core --thread-per-core
@@ -0,0 +1,26 @@
+#!/bin/bash
+# Игровой сценарий под нагрузкой: game_load против локального game_server без PostgreSQL
+# (рекорды в памяти, --memory-records).
+#
+# Использование: ./run_game_load.sh <путь-к-game_server> <путь-к-game_load> [опции game_load]
+# Например, открытый цикл на 5000 rps с уходом игроков на покой:
+#   ./run_game_load.sh ../build/bin/game_server ../build/bin/game_load -u 500 --rps 5000 --idle-retire
+# Сводка пишется в results/game_load.csv и results/game_load.json
+
+set -e
+
+server=${1:-../build/bin/game_server}
+load=${2:-../build/bin/game_load}
+shift 2 || true
+here=$(cd "$(dirname "$0")" && pwd)
+root="$here/.."
+
+"$server" --config-file "$root/data/config.json" --www-root "$root/static" \
+    --tick-period 50 --memory-records > "$here/server_game_load.log" 2>&1 &
+server_pid=$!
+trap 'kill -INT $server_pid 2>/dev/null || true' EXIT
+# Ждём, пока сервер начнёт принимать соединения
+until grep -q "server started" "$here/server_game_load.log"; do sleep 0.1; done
+
+mkdir -p "$here/results"
+"$load" --map map1 town map3 --csv "$here/results/game_load.csv" --json "$here/results/game_load.json" "$@"
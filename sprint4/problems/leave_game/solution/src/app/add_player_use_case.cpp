@@ -11,13 +11,26 @@ AddPlayerUseCase::AddPlayerUseCase(model::Game& game, PlayerTokens& player_token
     , players_{&players} {
 }
 
+model::GameSession* AddPlayerUseCase::FindPlayerSession(const serialization::PlayerRepr& player) const {
+    if ( auto session_id = player.GetSessionId() ) {
+        return game_->FindSessionById(*session_id);
+    }
+    // Старое сохранение: на карте была единственная сессия
+    for ( auto session : game_->GetSessions() ) {
+        if ( session->GetMap().GetId() == player.GetSession() ) {
+            return session;
+        }
+    }
+    return nullptr;
+}
+
 AddPlayerResult AddPlayerUseCase::AddPlayer(const serialization::PlayerRepr& player, const Token& token) {
     auto map = game_->FindMap(player.GetSession());
     if ( !map ) {
         throw AddPlayerError{AddPlayerErrorReason::InvalidMap};
     }
     
-    if ( auto session = game_->FindSession(map->GetId()) ) {
+    if ( auto session = FindPlayerSession(player) ) {
         try {
             // Связываем игрока с собакой на карте
             auto dog = session->FindDog(player.GetDog());
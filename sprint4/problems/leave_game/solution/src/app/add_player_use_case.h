@@ -46,6 +46,8 @@ public:
     AddPlayerResult AddPlayer(const serialization::PlayerRepr& player, const Token& token);
 
 private:
+    model::GameSession* FindPlayerSession(const serialization::PlayerRepr& player) const;
+
     PlayerTokens* player_tokens_;
     Players* players_;
     model::Game* game_;
@@ -3,7 +3,9 @@
 
 #include <boost/archive/binary_oarchive.hpp>
 #include <boost/archive/binary_iarchive.hpp>
+#include <cstdlib>
 #include <fstream>
+#include <stdexcept>
 
 namespace app {
 
@@ -16,27 +18,64 @@ const model::Map& Application::FindMap(std::string map_id) {
 }
 
 JoinGameResult Application::JoinGame(std::string user_name, std::string map_id) {
-    return join_game_.JoinGame(model::Map::Id{map_id}, Player::Name{user_name});
+    auto res = join_game_.JoinGame(model::Map::Id{map_id}, Player::Name{user_name});
+    if (recorder_) {
+        recorder_->Join(user_name, map_id, Token{res.GetTokenAsString()});
+    }
+    if (wal_) {
+        wal_->Append(wal::JoinRecord{std::move(user_name), std::move(map_id), res.GetTokenAsString()});
+    }
+    return res;
 }
 
 ListPlayersResult Application::GetPlayers(std::string_view token) {
+    if (recorder_) {
+        recorder_->Players(app::Token(std::string(token)));
+    }
     return list_players_.GetPlayers(app::Token(std::string(token)));
 }
 
-GetStateResult Application::GetState(std::string_view token) {
-    return game_state_.GetState(app::Token(std::string(token)));
+GetStateResult Application::GetState(std::string_view token, std::optional<AreaOfInterest> area) {
+    if (recorder_) {
+        recorder_->State(app::Token(std::string(token)), area);
+    }
+    return game_state_.GetState(app::Token(std::string(token)), area);
 }
 
 PlayerActionResult Application::ExecutePlayerAction(std::string_view token, PlayerAction action) {
-    return player_action_.ExecutePlayerAction(app::Token(std::string(token)), action);
+    auto res = player_action_.ExecutePlayerAction(app::Token(std::string(token)), action);
+    if (recorder_) {
+        recorder_->Action(app::Token(std::string(token)), action.GetMoveAsString());
+    }
+    if (wal_) {
+        wal_->Append(wal::ActionRecord{std::string(token), action.GetMoveAsString()});
+    }
+    return res;
 }
 
 TickResult Application::ExecuteTick(Tick tick) {
+    if (wal_ || recorder_) {
+        // Типы новых трофеев выбираются через std::rand. Начальное значение попадает в журнал,
+        // чтобы при восстановлении появились те же трофеи
+        const std::uint32_t seed = seed_device_();
+        std::srand(seed);
+        if (wal_) {
+            wal_->Append(wal::TickRecord{tick.GetTimeDelta().count(), seed});
+        }
+        if (recorder_) {
+            recorder_->Tick(tick.GetTimeDelta(), seed);
+        }
+    }
+
     // Выполняем один шаг по времени
-    auto tick_res = tick_.ExecuteTick(tick);
+    auto tick_res = tick_.ExecuteTick(tick, tick_profile_);
 
     // Удаляем неактивных игроков с сохранением их достижений в БД
+    const auto retirement_start = tick_profile_ ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point{};
     SaveRetirementPlayers();
+    if (tick_profile_) {
+        tick_profile_->retirement += std::chrono::steady_clock::now() - retirement_start;
+    }
     
     // Уведомляем подписчиков сигнала tick
     tick_signal_(tick.GetTimeDelta());
@@ -55,6 +94,13 @@ RecordsResult Application::GetRecords(size_t start, size_t limit) {
 void Application::SaveRetirementPlayers() {
     // Проверяем игроков на бездействие
     for (auto player : players_.GetPlayers()) {
+        // Пока ни одна собака сессии не могла бездействовать дольше порога, таймеры можно не синхронизировать
+        auto session = player->GetSession();
+        if (session->GetMaxSleepTime() < retirement_time_) {
+            continue;
+        }
+        session->SyncDogTimers();
+
         auto sleep_time = player->GetSleepTime();
         if (sleep_time >= retirement_time_) {
             // Сохраняем рекорд
@@ -62,14 +108,57 @@ void Application::SaveRetirementPlayers() {
             auto play_time = player->GetPlayTime();
             auto score = player->GetDog().GetScore();
             db_use_cases_.AddPlayer({name, score, play_time});
-            // Удаляем игрока
-            players_.RemovePlayer(player->GetId());
-            // Удаляем токен авторизации
-            tokens_.RemovePlayer(player.get());
+            if (wal_) {
+                wal_->Append(wal::LeaveRecord{*tokens_.FindTokenByPlayer(player.get())});
+            }
+            RemovePlayer(*player);
         }
     }
 
 }
 
+void Application::RemovePlayer(Player& player) {
+    // Удаляем токен авторизации
+    tokens_.RemovePlayer(&player);
+    // Удаляем игрока
+    players_.RemovePlayer(player.GetId());
+}
+
+wal::Lsn Application::ReplayWriteAheadLog(const std::filesystem::path& path, wal::Lsn after_lsn) {
+    wal::Lsn last_lsn = after_lsn;
+    wal::ReadLog(path, [this, &last_lsn](wal::Lsn lsn, const wal::Record& record) {
+        // Записи, попавшие в снимок, пропускаются
+        if (lsn <= last_lsn) {
+            return;
+        }
+        try {
+            ReplayRecord(record);
+        } catch (const std::exception&) {
+            throw;
+        } catch (...) {
+            // Сценарии использования сообщают об ошибках не исключениями std::exception
+            throw std::runtime_error("Write-ahead log record "s + std::to_string(lsn) + " does not match game state"s);
+        }
+        last_lsn = lsn;
+    });
+    return last_lsn;
+}
+
+void Application::ReplayRecord(const wal::Record& record) {
+    if (const auto join = std::get_if<wal::JoinRecord>(&record)) {
+        join_game_.JoinGame(model::Map::Id{join->map_id}, Player::Name{join->name}, Token{join->token});
+    } else if (const auto action = std::get_if<wal::ActionRecord>(&record)) {
+        player_action_.ExecutePlayerAction(Token{action->token}, PlayerAction{action->move});
+    } else if (const auto tick = std::get_if<wal::TickRecord>(&record)) {
+        // Уход игроков на покой повторяется по записям LeaveRecord, а подписчики тиков не уведомляются
+        std::srand(tick->seed);
+        tick_.ExecuteTick(Tick{model::TimeType{tick->dt}});
+    } else if (const auto leave = std::get_if<wal::LeaveRecord>(&record)) {
+        if (auto player = tokens_.FindPlayerByToken(Token{leave->token})) {
+            RemovePlayer(*player);
+        }
+    }
+}
+
 
 }  // namespace app
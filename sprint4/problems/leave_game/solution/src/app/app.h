@@ -12,11 +12,13 @@
 #include "records_use_case.h"
 #include "use_cases_impl.h"
 
-#include "postgres/postgres.h"
+#include "write_ahead_log.h"
+#include "input_recording.h"
 
 #include <boost/signals2.hpp>
 #include <chrono>
 #include <filesystem>
+#include <random>
 
 namespace app {
 
@@ -28,7 +30,8 @@ class Application {
 public:
     using TickSignal = sig::signal<void(milliseconds delta)>;
 
-    Application(model::Game& game, std::string db_url)
+    // Рекорды ушедших на покой игроков сохраняются в records: в игре это БД, в симуляции - память
+    Application(model::Game& game, PlayerRepository& records)
         : join_game_{game, tokens_, players_}
         , list_players_{tokens_, players_}
         , game_state_{tokens_, players_}
@@ -37,8 +40,7 @@ public:
         , list_maps_{game}
         , get_map_{game}
         , add_player_{game, tokens_, players_}
-        , db_{ pqxx::connection{db_url} }
-        , db_use_cases_{db_.GetPlayers()}
+        , db_use_cases_{records}
         , records_use_case_{db_use_cases_}
         , retirement_time_{game.GetDogRetirementTime()}
         {
@@ -53,7 +55,7 @@ public:
     // Для игрока с заданным токеном получает список играющих с ним игроков
     ListPlayersResult GetPlayers(std::string_view token);
     // Получает игровое состояние для игрока с заданным токеном
-    GetStateResult GetState(std::string_view token);
+    GetStateResult GetState(std::string_view token, std::optional<AreaOfInterest> area = std::nullopt);
     // Выполняет действие для игрока с заданным токеном
     PlayerActionResult ExecutePlayerAction(std::string_view token, PlayerAction action);
     // Выполняет один шаг по времени в игре
@@ -71,6 +73,11 @@ public:
         return tokens_;
     }
 
+    // Id новых игроков будут не меньше next_id
+    void ReservePlayerIds(int next_id) noexcept {
+        players_.ReserveIds(next_id);
+    }
+
     // Добавляем обработчик сигнала tick и возвращаем объект connection для управления,
     // при помощи которого можно отписаться от сигнала
     [[nodiscard]] sig::connection DoOnTick(const TickSignal::slot_type& handler) {
@@ -80,13 +87,43 @@ public:
     // Выдаёт список рекордов
     RecordsResult GetRecords(size_t start, size_t limit);
 
+    // Подключает журнал упреждающей записи: подключения игроков, их действия, тики и уходы на покой
+    // записываются в него, чтобы восстановить игру после сбоя по последнему снимку состояния
+    void SetWriteAheadLog(wal::LogWriter* log) noexcept {
+        wal_ = log;
+    }
+    // Подключённый журнал или nullptr
+    wal::LogWriter* GetWriteAheadLog() const noexcept {
+        return wal_;
+    }
+    // Повторяет записи журнала с номерами больше after_lsn. Результаты ушедших на покой игроков
+    // уже сохранены в БД, поэтому повторно не записываются. Возвращает номер последней записи
+    wal::Lsn ReplayWriteAheadLog(const std::filesystem::path& path, wal::Lsn after_lsn);
+
+    // Подключает запись вызовов сценариев использования с начальными значениями std::rand для тиков.
+    // Запись воспроизводится утилитой game_replay
+    void SetRecorder(recording::Recorder* recorder) noexcept {
+        recorder_ = recorder;
+    }
+
+    // Включает замер этапов тика (симуляция без HTTP). nullptr - замер выключен
+    void SetTickProfile(model::TickProfile* profile) noexcept {
+        tick_profile_ = profile;
+    }
+
+    // Статистика тиков игровых сессий. Может вызываться из любого потока
+    TickStats GetTickStats() const noexcept {
+        return tick_.GetStats();
+    }
+
 private:
     void SaveRetirementPlayers();
+    void RemovePlayer(Player& player);
+    void ReplayRecord(const wal::Record& record);
 
 private:
     Players players_;
     PlayerTokens tokens_;
-    postgres::Database db_;
     UseCasesImpl db_use_cases_;
     double retirement_time_;
 
@@ -101,6 +138,12 @@ private:
 
     TickSignal tick_signal_;
     RecordsUseCase records_use_case_;
+
+    wal::LogWriter* wal_ = nullptr;
+    recording::Recorder* recorder_ = nullptr;
+    model::TickProfile* tick_profile_ = nullptr;
+    // Начальные значения std::rand для тиков, записываемых в журнал и запись вызовов
+    std::random_device seed_device_;
 };
 
 }  // namespace app
@@ -1,7 +1,9 @@
 #pragma once
 
 #include <boost/serialization/vector.hpp>
+#include <boost/serialization/version.hpp>
 #include <cstddef>
+#include <optional>
 #include <vector>
 
 #include "players.h"
@@ -37,6 +39,8 @@ public:
     : id_{player.GetId()}
     , name_{player.GetName()}
     , session_{player.GetSession()->GetMap().GetId()}
+    , session_id_{player.GetSession()->GetId()}
+    , has_session_id_{true}
     , dog_{player.GetDog().GetId()} {
     }
 
@@ -46,6 +50,10 @@ public:
         ar & *name_;
         ar & *session_;
         ar & *dog_;
+        if (version > 0) {
+            ar & *session_id_;
+            has_session_id_ = true;
+        }
     }
 
     const app::Player::Id& GetId() const {
@@ -60,6 +68,11 @@ public:
         return session_;
     }
 
+    // В сохранениях версии 0 идентификатора сессии нет: сессия определялась картой
+    std::optional<model::GameSession::Id> GetSessionId() const {
+        return has_session_id_ ? std::optional{session_id_} : std::nullopt;
+    }
+
     const model::Dog::Id& GetDog() const {
         return dog_;
     }
@@ -67,7 +80,9 @@ public:
 private:
     app::Player::Id id_ = app::Player::Id{0};
     app::Player::Name name_ = app::Player::Name{""};
-    model::Map::Id session_ = model::Map::Id{""};   // В данный момент игровая сессия соответсвует одной карте
+    model::Map::Id session_ = model::Map::Id{""};   // Карта, на которой находится сессия игрока
+    model::GameSession::Id session_id_ = model::GameSession::Id{0};
+    bool has_session_id_ = false;
     model::Dog::Id dog_ = model::Dog::Id{0};
 };
 
@@ -144,3 +159,6 @@ private:
 };
 
 }  // namespace serialization
+
+// Версия 1: игрок сохраняет идентификатор своей сессии
+BOOST_CLASS_VERSION(::serialization::PlayerRepr, 1)
@@ -0,0 +1,410 @@
+#include "input_recording.h"
+
+#include "app.h"
+#include "state_serialization.h"
+
+#include <cstring>
+#include <iterator>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <type_traits>
+
+namespace recording {
+
+using namespace std::literals;
+
+namespace {
+
+enum class CallType : std::uint8_t {
+    Snapshot = 1,
+    Join = 2,
+    Action = 3,
+    Tick = 4,
+    State = 5,
+    Players = 6,
+    End = 7
+};
+
+void PutVarint(std::string& out, std::uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<char>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<char>(value));
+}
+
+template <typename T>
+void PutFixed(std::string& out, T value) {
+    char bytes[sizeof(T)];
+    std::memcpy(bytes, &value, sizeof(T));
+    out.append(bytes, sizeof(T));
+}
+
+void PutString(std::string& out, std::string_view str) {
+    PutVarint(out, str.size());
+    out.append(str);
+}
+
+// Последовательное чтение кадра с проверкой границ
+class FrameReader {
+public:
+    explicit FrameReader(std::string_view data) noexcept
+        : data_(data) {
+    }
+
+    bool GetVarint(std::uint64_t& value) noexcept {
+        value = 0;
+        for (unsigned shift = 0; shift < 64 && !data_.empty(); shift += 7) {
+            const auto byte = static_cast<std::uint8_t>(data_.front());
+            data_.remove_prefix(1);
+            value |= std::uint64_t{byte & 0x7fu} << shift;
+            if ((byte & 0x80) == 0) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    template <typename T>
+    bool GetFixed(T& value) noexcept {
+        if (data_.size() < sizeof(T)) {
+            return false;
+        }
+        std::memcpy(&value, data_.data(), sizeof(T));
+        data_.remove_prefix(sizeof(T));
+        return true;
+    }
+
+    bool GetString(std::string& str) {
+        std::uint64_t size;
+        return GetVarint(size) && GetBytes(str, size);
+    }
+
+    bool GetBytes(std::string& str, std::uint64_t size) {
+        if (data_.size() < size) {
+            return false;
+        }
+        str.assign(data_.substr(0, size));
+        data_.remove_prefix(size);
+        return true;
+    }
+
+    bool GetIndex(PlayerIndex& index) noexcept {
+        std::uint64_t value;
+        if (!GetVarint(value) || value > std::numeric_limits<PlayerIndex>::max()) {
+            return false;
+        }
+        index = static_cast<PlayerIndex>(value);
+        return true;
+    }
+
+    bool GetSigned(std::int64_t& value) noexcept {
+        std::uint64_t raw;
+        if (!GetVarint(raw)) {
+            return false;
+        }
+        value = static_cast<std::int64_t>(raw);
+        return true;
+    }
+
+    bool AtEnd() const noexcept {
+        return data_.empty();
+    }
+
+private:
+    std::string_view data_;
+};
+
+struct CallEncoder {
+    std::string& out;
+
+    CallType operator()(const SnapshotCall& call) const {
+        PutString(out, call.state);
+        PutVarint(out, call.time_without_loot);
+        PutVarint(out, call.next_player_id);
+        return CallType::Snapshot;
+    }
+    CallType operator()(const JoinCall& call) const {
+        PutString(out, call.name);
+        PutString(out, call.map_id);
+        return CallType::Join;
+    }
+    CallType operator()(const ActionCall& call) const {
+        PutVarint(out, call.player);
+        PutString(out, call.move);
+        return CallType::Action;
+    }
+    CallType operator()(const TickCall& call) const {
+        PutVarint(out, call.dt);
+        PutFixed(out, call.seed);
+        return CallType::Tick;
+    }
+    CallType operator()(const StateCall& call) const {
+        PutVarint(out, call.player);
+        out.push_back(call.radius ? 1 : 0);
+        if (call.radius) {
+            PutFixed(out, *call.radius);
+        }
+        return CallType::State;
+    }
+    CallType operator()(const PlayersCall& call) const {
+        PutVarint(out, call.player);
+        return CallType::Players;
+    }
+    CallType operator()(const EndCall& call) const {
+        PutFixed(out, call.state_hash);
+        return CallType::End;
+    }
+};
+
+bool DecodeCall(CallType type, FrameReader& reader, Call& call) {
+    switch (type) {
+        case CallType::Snapshot: {
+            SnapshotCall snapshot;
+            if (!reader.GetString(snapshot.state) || !reader.GetSigned(snapshot.time_without_loot)
+                || !reader.GetSigned(snapshot.next_player_id)) {
+                return false;
+            }
+            call = std::move(snapshot);
+            break;
+        }
+        case CallType::Join: {
+            JoinCall join;
+            if (!reader.GetString(join.name) || !reader.GetString(join.map_id)) {
+                return false;
+            }
+            call = std::move(join);
+            break;
+        }
+        case CallType::Action: {
+            ActionCall action;
+            if (!reader.GetIndex(action.player) || !reader.GetString(action.move)) {
+                return false;
+            }
+            call = std::move(action);
+            break;
+        }
+        case CallType::Tick: {
+            TickCall tick;
+            if (!reader.GetSigned(tick.dt) || !reader.GetFixed(tick.seed)) {
+                return false;
+            }
+            call = tick;
+            break;
+        }
+        case CallType::State: {
+            StateCall state;
+            std::uint8_t has_radius;
+            if (!reader.GetIndex(state.player) || !reader.GetFixed(has_radius)) {
+                return false;
+            }
+            if (has_radius) {
+                double radius;
+                if (!reader.GetFixed(radius)) {
+                    return false;
+                }
+                state.radius = radius;
+            }
+            call = state;
+            break;
+        }
+        case CallType::Players: {
+            PlayersCall players;
+            if (!reader.GetIndex(players.player)) {
+                return false;
+            }
+            call = players;
+            break;
+        }
+        case CallType::End: {
+            EndCall end;
+            if (!reader.GetFixed(end.state_hash)) {
+                return false;
+            }
+            call = end;
+            break;
+        }
+        default:
+            return false;
+    }
+    return reader.AtEnd();
+}
+
+// FNV-1a
+class StateHasher {
+public:
+    template <typename T>
+        requires std::is_arithmetic_v<T>
+    void Add(T value) noexcept {
+        AddBytes(&value, sizeof(T));
+    }
+
+    void Add(std::string_view str) noexcept {
+        Add(str.size());
+        AddBytes(str.data(), str.size());
+    }
+
+    std::uint64_t GetHash() const noexcept {
+        return hash_;
+    }
+
+private:
+    void AddBytes(const void* data, size_t size) noexcept {
+        const auto bytes = static_cast<const unsigned char*>(data);
+        for (size_t i = 0; i < size; ++i) {
+            hash_ = (hash_ ^ bytes[i]) * 0x100000001b3ull;
+        }
+    }
+
+    std::uint64_t hash_ = 0xcbf29ce484222325ull;
+};
+
+}  // namespace
+
+Recorder::Recorder(const fs::path& path)
+    : out_{path, std::ios_base::binary | std::ios_base::trunc}
+    , last_time_{std::chrono::steady_clock::now()} {
+    if (!out_) {
+        throw std::runtime_error("Failed to open recording file "s + path.string());
+    }
+}
+
+void Recorder::Snapshot(model::Game& game, app::Application& app) {
+    std::ostringstream state;
+    serialization::StateSerializer{game, app}.Serialize(state);
+    for (const auto& player : app.GetPlayers().GetPlayers()) {
+        token_to_player_[app.GetTokens().FindTokenByPlayer(player.get())] = next_player_++;
+    }
+    Write(SnapshotCall{state.str(), game.GetLootGenerator().GetTimeWithoutLoot().count(),
+                       app.GetPlayers().GetNextId()});
+}
+
+void Recorder::Join(std::string name, std::string map_id, const app::Token& token) {
+    token_to_player_[token] = next_player_++;
+    Write(JoinCall{std::move(name), std::move(map_id)});
+}
+
+void Recorder::Action(const app::Token& token, std::string move) {
+    if (const auto player = FindPlayer(token)) {
+        Write(ActionCall{*player, std::move(move)});
+    }
+}
+
+void Recorder::Tick(std::chrono::milliseconds dt, std::uint32_t seed) {
+    Write(TickCall{dt.count(), seed});
+}
+
+void Recorder::State(const app::Token& token, std::optional<app::AreaOfInterest> area) {
+    if (const auto player = FindPlayer(token)) {
+        Write(StateCall{*player, area ? std::optional{area->radius} : std::nullopt});
+    }
+}
+
+void Recorder::Players(const app::Token& token) {
+    if (const auto player = FindPlayer(token)) {
+        Write(PlayersCall{*player});
+    }
+}
+
+void Recorder::Finish(std::uint64_t state_hash) {
+    Write(EndCall{state_hash});
+    out_.flush();
+}
+
+void Recorder::Write(const Call& call) {
+    const auto now = std::chrono::steady_clock::now();
+    const auto delta = std::chrono::duration_cast<std::chrono::microseconds>(now - last_time_);
+    last_time_ = now;
+
+    // Тело кадра собирается в буфере, чтобы перед ним записать его размер
+    body_.assign(1, '\0');
+    PutVarint(body_, delta.count());
+    body_[0] = static_cast<char>(std::visit(CallEncoder{body_}, call));
+
+    frame_.clear();
+    PutVarint(frame_, body_.size());
+    out_.write(frame_.data(), frame_.size());
+    out_.write(body_.data(), body_.size());
+    ++calls_;
+}
+
+std::optional<PlayerIndex> Recorder::FindPlayer(const app::Token& token) const {
+    if (const auto it = token_to_player_.find(token); it != token_to_player_.end()) {
+        return it->second;
+    }
+    return std::nullopt;
+}
+
+size_t ReadRecording(const fs::path& path,
+                     const std::function<void(std::chrono::microseconds time, const Call& call)>& on_call) {
+    std::ifstream in{path, std::ios_base::binary};
+    if (!in) {
+        throw std::runtime_error("Failed to open recording file "s + path.string());
+    }
+    const std::string data{std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>()};
+
+    size_t calls = 0;
+    std::chrono::microseconds time{0};
+    FrameReader frames{data};
+    Call call;
+    std::uint64_t body_size;
+    std::string body;
+    while (frames.GetVarint(body_size) && frames.GetBytes(body, body_size)) {
+        FrameReader reader{body};
+        std::uint8_t type;
+        std::uint64_t delta;
+        if (!reader.GetFixed(type) || !reader.GetVarint(delta) || !DecodeCall(static_cast<CallType>(type), reader, call)) {
+            throw std::runtime_error("Corrupted recording: call "s + std::to_string(calls + 1));
+        }
+        time += std::chrono::microseconds(delta);
+        on_call(time, call);
+        ++calls;
+    }
+    return calls;
+}
+
+std::uint64_t HashGameState(const model::Game& game, const app::Players& players) {
+    StateHasher hasher;
+    hasher.Add(game.GetSessions().size());
+    for (const auto session : game.GetSessions()) {
+        session->SyncDogTimers();
+        hasher.Add(*session->GetId());
+        hasher.Add(*session->GetMap().GetId());
+        hasher.Add(session->GetDogs().size());
+        for (const auto& dog : session->GetDogs()) {
+            hasher.Add(*dog->GetId());
+            hasher.Add(*dog->GetName());
+            hasher.Add(dog->GetPosition().x);
+            hasher.Add(dog->GetPosition().y);
+            hasher.Add(dog->GetSpeed().ux);
+            hasher.Add(dog->GetSpeed().uy);
+            hasher.Add(static_cast<int>(dog->GetDirection()));
+            hasher.Add(dog->GetScore());
+            hasher.Add(dog->GetPlayTime());
+            hasher.Add(dog->GetSleepTime());
+            hasher.Add(dog->GetBagSize());
+            for (const auto& item : dog->GetBag()) {
+                hasher.Add(*item.id);
+                hasher.Add(item.type);
+            }
+        }
+        hasher.Add(session->GetItems().size());
+        for (const auto& item : session->GetItems()) {
+            hasher.Add(*item->GetId());
+            hasher.Add(item->GetType());
+            hasher.Add(item->GetPosition().x);
+            hasher.Add(item->GetPosition().y);
+        }
+    }
+    hasher.Add(players.GetPlayers().size());
+    for (const auto& player : players.GetPlayers()) {
+        hasher.Add(*player->GetId());
+        hasher.Add(*player->GetName());
+        hasher.Add(*player->GetDog().GetId());
+        hasher.Add(*player->GetSession()->GetId());
+    }
+    return hasher.GetHash();
+}
+
+}  // namespace recording
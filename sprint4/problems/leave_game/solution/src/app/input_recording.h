@@ -0,0 +1,118 @@
+#pragma once
+
+#include "game.h"
+#include "players.h"
+#include "state_use_case.h"
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <variant>
+
+namespace app {
+class Application;
+}  // namespace app
+
+// Запись вызовов сценариев использования для воспроизведения реального трафика без клиентов.
+// Файл записи - последовательность кадров: размер данных, тип, время от предыдущего кадра (мкс), данные.
+// Целые числа хранятся в формате varint, игроки вместо токенов обозначаются номером подключения
+namespace recording {
+
+namespace fs = std::filesystem;
+
+// Номер подключения игрока в записи
+using PlayerIndex = std::uint32_t;
+
+// Состояние игры на момент начала записи, если сервер восстановил его из файла
+struct SnapshotCall {
+    std::string state;
+    // В снимок состояния не входят время без трофеев генератора трофеев и Id следующего игрока
+    std::int64_t time_without_loot;
+    std::int64_t next_player_id;
+};
+
+struct JoinCall {
+    std::string name;
+    std::string map_id;
+};
+
+struct ActionCall {
+    PlayerIndex player;
+    std::string move;
+};
+
+struct TickCall {
+    std::int64_t dt;    // в миллисекундах
+    std::uint32_t seed; // начальное значение std::rand
+};
+
+struct StateCall {
+    PlayerIndex player;
+    std::optional<double> radius;
+};
+
+struct PlayersCall {
+    PlayerIndex player;
+};
+
+// Конец записи: хеш итогового состояния игры
+struct EndCall {
+    std::uint64_t state_hash;
+};
+
+using Call = std::variant<SnapshotCall, JoinCall, ActionCall, TickCall, StateCall, PlayersCall, EndCall>;
+
+// Пишет вызовы в файл. Вызывается из strand API, поэтому не синхронизирован.
+// Вызовы с неизвестными токенами (отклонённые сценариями) не записываются
+class Recorder {
+public:
+    explicit Recorder(const fs::path& path);
+
+    Recorder(const Recorder&) = delete;
+    Recorder& operator=(const Recorder&) = delete;
+
+    // Состояние на момент начала записи. Восстановленные игроки получают первые номера в порядке Players
+    void Snapshot(model::Game& game, app::Application& app);
+    void Join(std::string name, std::string map_id, const app::Token& token);
+    void Action(const app::Token& token, std::string move);
+    void Tick(std::chrono::milliseconds dt, std::uint32_t seed);
+    void State(const app::Token& token, std::optional<app::AreaOfInterest> area);
+    void Players(const app::Token& token);
+    // Завершает запись хешем итогового состояния и сбрасывает буфер на диск
+    void Finish(std::uint64_t state_hash);
+
+    size_t GetCalls() const noexcept {
+        return calls_;
+    }
+
+private:
+    void Write(const Call& call);
+    std::optional<PlayerIndex> FindPlayer(const app::Token& token) const;
+
+    using TokenHasher = util::TaggedHasher<app::Token>;
+
+    std::ofstream out_;
+    std::string body_;
+    std::string frame_;
+    std::chrono::steady_clock::time_point last_time_;
+    std::unordered_map<app::Token, PlayerIndex, TokenHasher> token_to_player_;
+    PlayerIndex next_player_ = 0;
+    size_t calls_ = 0;
+};
+
+// Читает запись и вызывает on_call для каждого вызова по порядку. time - время от начала записи.
+// Возвращает число вызовов. Чтение останавливается на неполном кадре в конце файла
+size_t ReadRecording(const fs::path& path,
+                     const std::function<void(std::chrono::microseconds time, const Call& call)>& on_call);
+
+// Хеш состояния игры: сессии, собаки с рюкзаками, трофеи и игроки. Токены в хеш не входят -
+// при воспроизведении игроки получают новые. Таймеры собак простаивающих сессий синхронизируются
+std::uint64_t HashGameState(const model::Game& game, const app::Players& players);
+
+}  // namespace recording
@@ -17,7 +17,7 @@ JoinGameUseCase::JoinGameUseCase(model::Game& game, PlayerTokens& player_tokens,
 }
 
 // Подключает игрока с указанным именем (пса) к указанной карте
-JoinGameResult JoinGameUseCase::JoinGame(model::Map::Id map_id, Player::Name name) {
+JoinGameResult JoinGameUseCase::JoinGame(model::Map::Id map_id, Player::Name name, std::optional<Token> token) {
     model::Dog::Name name_str(*name);
     if ( !isValidName(name) ) {
         throw JoinGameError{JoinGameErrorReason::InvalidName};
@@ -33,8 +33,11 @@ JoinGameResult JoinGameUseCase::JoinGame(model::Map::Id map_id, Player::Name nam
         try {
             auto dog = session->AddDog(spawn_point, std::move(name_str));
             auto& player = players_->Add(dog, *session);
-            auto token = player_tokens_->AddPlayer(player);
-            return {token, player.GetId()};
+            if ( token ) {
+                player_tokens_->AddPlayer(&player, *token);
+                return {*token, player.GetId()};
+            }
+            return {player_tokens_->AddPlayer(player), player.GetId()};
         }
         catch ( std::invalid_argument err ) {
             throw JoinGameError{JoinGameErrorReason::InvalidName};
@@ -3,6 +3,8 @@
 #include "game.h"
 #include "players.h"
 
+#include <optional>
+
 namespace app {
 
 enum class JoinGameErrorReason {
@@ -41,8 +43,9 @@ private:
 class JoinGameUseCase {
 public:
     JoinGameUseCase(model::Game& game, PlayerTokens& player_tokens, Players& players);
-    // Подключает игрока с указанным именем (пса) к указанной карте
-    JoinGameResult JoinGame(model::Map::Id map_id, Player::Name name);
+    // Подключает игрока с указанным именем (пса) к указанной карте.
+    // Токен задаётся явно при восстановлении игры из журнала
+    JoinGameResult JoinGame(model::Map::Id map_id, Player::Name name, std::optional<Token> token = std::nullopt);
 
 private:
     PlayerTokens* player_tokens_;
@@ -0,0 +1,30 @@
+#include "memory_records.h"
+
+#include <iterator>
+
+namespace app {
+
+void MemoryPlayerRepository::Save(const PlayerRecordInfo& player) {
+    auto id = player.id.ToString();
+    // Как и в БД, повторное сохранение игрока заменяет его рекорд
+    if (const auto it = id_to_record_.find(id); it != id_to_record_.end()) {
+        records_.erase(it->second);
+        id_to_record_.erase(it);
+    }
+    const auto record = records_.insert(Record{player.score, player.play_time, player.name, id}).first;
+    id_to_record_.emplace(std::move(id), record);
+}
+
+std::vector<PlayerStatInfo> MemoryPlayerRepository::GetRecords(size_t start, size_t limit) {
+    std::vector<PlayerStatInfo> result;
+    if (start >= records_.size()) {
+        return result;
+    }
+    auto it = std::next(records_.begin(), start);
+    for (; it != records_.end() && result.size() < limit; ++it) {
+        result.push_back(PlayerStatInfo{it->name, it->score, it->play_time});
+    }
+    return result;
+}
+
+}  // namespace app
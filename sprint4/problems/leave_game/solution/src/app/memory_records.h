@@ -0,0 +1,37 @@
+#pragma once
+
+#include "players.h"
+
+#include <set>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+namespace app {
+
+// Рекорды игроков в памяти процесса - замена PostgreSQL для нагрузочного тестирования
+// (game_server --memory-records). Порядок рекордов тот же, что у запроса к БД:
+// по убыванию очков, затем по времени игры и имени. После остановки сервера рекорды теряются
+class MemoryPlayerRepository : public PlayerRepository {
+public:
+    void Save(const PlayerRecordInfo& player) override;
+    std::vector<PlayerStatInfo> GetRecords(size_t start, size_t limit) override;
+
+private:
+    struct Record {
+        int score;
+        double play_time;
+        std::string name;
+        std::string id;
+
+        bool operator<(const Record& other) const {
+            return std::tie(other.score, play_time, name, id) < std::tie(score, other.play_time, other.name, other.id);
+        }
+    };
+
+    std::set<Record> records_;
+    std::unordered_map<std::string, std::set<Record>::const_iterator> id_to_record_;
+};
+
+}  // namespace app
@@ -1,20 +1,23 @@
 #include "player_use_case.h"
 
 #include <string>
-#include <set>
 #include <stdexcept>
 
 namespace app {
 
 bool PlayerAction::IsDirection() const {
-    // Список допустимых направлений
-    std::set<std::string> valid_directions = {
-        {static_cast<char>(model::Direction::NORTH)}, 
-        {static_cast<char>(model::Direction::SOUTH)}, 
-        {static_cast<char>(model::Direction::EAST)}, 
-        {static_cast<char>(model::Direction::WEST)}
-    };
-    return valid_directions.find(move_) != valid_directions.end();
+    // Направление задаётся одним символом
+    if (move_.size() != 1) {
+        return false;
+    }
+    switch (static_cast<model::Direction>(move_[0])) {
+        case model::Direction::NORTH:
+        case model::Direction::SOUTH:
+        case model::Direction::EAST:
+        case model::Direction::WEST:
+            return true;
+    }
+    return false;
 }
 
 bool PlayerAction::IsStop() const {
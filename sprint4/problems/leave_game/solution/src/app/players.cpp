@@ -2,6 +2,7 @@
 #include "game_session.h"
 
 #include <boost/smart_ptr/make_shared_object.hpp>
+#include <algorithm>
 #include <cstddef>
 #include <memory>
 #include <new>
@@ -30,12 +31,12 @@ Token PlayerTokens::AddPlayer(Player& player) {
 ///  ---  Players  ---  ///
 
 Player& Players::Add(model::Dog* dog, model::GameSession& session) {
-    auto index = players_.size();
-    Player::Id id(index);
+    Player::Id id(next_id_);
 
     try {
         // Добавляем игрока
         players_.emplace_back(std::make_shared<Player>(id, *dog, session));
+        ++next_id_;
         return *players_.back();
     } catch (...) {
         throw std::bad_alloc{};
@@ -43,13 +44,9 @@ Player& Players::Add(model::Dog* dog, model::GameSession& session) {
 }
 
 void Players::Add(std::unique_ptr<Player> player) {
-    auto name = model::Dog::Name(*player->GetName());
-    auto index = *player->GetId(); 
-
-    if ( index >= players_.size() ) {
-        players_.resize(index + 1);
-    }
-    players_[index] =std::move(player);
+    // Id восстановленных игроков могут идти с пропусками, поэтому индекс в списке с ними не связан
+    next_id_ = std::max(next_id_, *player->GetId() + 1);
+    players_.push_back(std::move(player));
 }
 
 Player* Players::FinByDog(const model::Dog& dog, const model::GameSession& session) {
@@ -38,6 +38,8 @@ public:
 
     void SetDogSpeed(model::DynamicDimension speed, std::optional<model::Direction> direction) {
         dog_->SetSpeed(speed, direction);
+        // Следующий тик сессии должен быть полным
+        session_->MarkActive();
     }
 
     model::GameSession* GetSession() const {
@@ -114,6 +116,15 @@ public:
     void AddPlayer(Player* player, Token token) {
         token_to_player[token] = player;
     }
+    // Возвращает токен игрока
+    Token FindTokenByPlayer(const Player* player) const {
+        for (const auto& [token, token_player] : token_to_player) {
+            if (token_player == player) {
+                return token;
+            }
+        }
+        return Token{""};
+    }
     // Удаляет игрока из таблицы
     void RemovePlayer(Player* player) {
         for (auto it = token_to_player.begin(); it != token_to_player.end(); ++it) {
@@ -174,12 +185,23 @@ public:
     // Удаляет игрока с указанным идентификатором
     void RemovePlayer(const Player::Id& player_id);
 
+    // Id следующего игрока. Снимок состояния его не содержит, а для воспроизведения записи вызовов
+    // он должен совпадать: Id ушедших на покой игроков тоже не выдаются повторно
+    int GetNextId() const noexcept {
+        return next_id_;
+    }
+    void ReserveIds(int next_id) noexcept {
+        next_id_ = std::max(next_id_, next_id);
+    }
+
 private:
     // Пришлось перейти на multimap, потому что игроки с одинаковыми именами могут подключаться 
     // к разным картам, то есть находиться в разных сессиях
     using NameToIndex = std::multimap<model::Dog::Name, size_t>;
 
     PlayersContainer players_;
+    // Id следующего игрока. Id ушедших игроков повторно не выдаются
+    int next_id_ = 0;
 };
 
 }  // namespace app
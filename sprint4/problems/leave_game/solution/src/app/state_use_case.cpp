@@ -4,26 +4,50 @@
 
 namespace app {
 
+namespace {
+
+// Проверяет, попадает ли точка в круг области интереса. Сравниваются квадраты расстояний
+bool IsInArea(const model::Position& center, double sq_radius, const model::Position& pos) noexcept {
+    const double dx = pos.x - center.x;
+    const double dy = pos.y - center.y;
+    return dx * dx + dy * dy <= sq_radius;
+}
+
+}  // namespace
+
 // Для игрока с указанным токеном выдаёт список игроков, которые находятся вместе с ним в одной сессии
-GetStateResult GetStateUseCase::GetState(Token token) {
+GetStateResult GetStateUseCase::GetState(Token token, std::optional<AreaOfInterest> area) {
     GetStateResult res;
     // Получаем игрока с заданным токеном
     if ( auto self_player = player_tokens_->FindPlayerByToken(token) ) {
         // Получаем сессию, к которой подключен игрок и список собак в сессии
         auto session = self_player->GetSession();
-        auto dogs = session->GetDogs();
+        const auto& dogs = session->GetDogs();
+        const auto& self_dog = self_player->GetDog();
+
+        // Без области интереса в неё попадает всё
+        const auto center = self_dog.GetPosition();
+        const double sq_radius = area ? area->radius * area->radius : 0.0;
+        const auto is_visible = [&](const model::Position& pos) {
+            return !area || IsInArea(center, sq_radius, pos);
+        };
 
-        // Для каждой собаки находим игрока и складываем в результат
-        for ( auto dog : dogs ) {
-            auto dog_name = dog->GetName();
+        // Для каждой собаки находим игрока и складываем в результат.
+        // Игрок ищется только для видимых собак
+        for ( const auto& dog : dogs ) {
+            if ( dog.get() != &self_dog && !is_visible(dog->GetPosition()) ) {
+                continue;
+            }
             auto player = players_->FinByDog(*dog, *session);
             StatePlayerInfo info{player->GetId(), *dog};
             res.players_.push_back(info);
         }
 
         // Для карты выдаём список лута на ней
-        for ( auto item : session->GetItems() ) {
-            res.items_.push_back(*item);
+        for ( const auto& item : session->GetItems() ) {
+            if ( is_visible(item->GetPosition()) ) {
+                res.items_.push_back(*item);
+            }
         }
     } else {
         throw GetStateError{GetStateErrorReason::InvalidToken};
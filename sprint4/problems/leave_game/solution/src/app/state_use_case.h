@@ -3,6 +3,8 @@
 #include "dog.h"
 #include "players.h"
 
+#include <optional>
+
 namespace app {
 
 enum class GetStateErrorReason {
@@ -44,6 +46,12 @@ public:
 
 };
 
+// Область интереса игрока: в состояние попадают только собаки и предметы,
+// которые находятся не дальше radius от его собаки. Собственная собака попадает всегда
+struct AreaOfInterest {
+    double radius;
+};
+
 class GetStateUseCase {
 public:
     GetStateUseCase(PlayerTokens& player_tokens, Players& players)
@@ -51,7 +59,8 @@ public:
     , players_{&players} {}
 
     // Подключает игрока с указанным именем (пса) к указанной карте
-    GetStateResult GetState(Token token);
+    // Без области интереса выдаётся вся сессия
+    GetStateResult GetState(Token token, std::optional<AreaOfInterest> area = std::nullopt);
 
 private:
     PlayerTokens* player_tokens_;
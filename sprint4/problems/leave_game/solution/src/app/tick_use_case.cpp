@@ -7,12 +7,24 @@ TickUseCase::TickUseCase(model::Game& game)
     }
 
 // Выполняет один шаг по времени в игре
-TickResult TickUseCase::ExecuteTick(Tick tick) {
+TickResult TickUseCase::ExecuteTick(Tick tick, model::TickProfile* profile) {
     auto dt = tick.GetTimeDelta();
-    
+
+    // Сессии, которые покинули все игроки, больше не нужно обсчитывать
+    game_->RemoveEmptySessions();
+
+    // Простаивающие сессии только копят время, полный тик нужен лишь тем, где что-то происходит
+    size_t idle_ticks = 0;
     for ( auto session : game_->GetSessions() ) {
-        session->Tick(dt);
+        if ( session->IsIdle() ) {
+            session->AdvanceIdle(dt);
+            ++idle_ticks;
+        } else {
+            session->Tick(dt, profile);
+        }
     }
+    idle_ticks_.fetch_add(idle_ticks, std::memory_order_relaxed);
+    full_ticks_.fetch_add(game_->GetSessions().size() - idle_ticks, std::memory_order_relaxed);
    
     return TickResult{};
 }
@@ -2,6 +2,8 @@
 
 #include "game.h"
 
+#include <atomic>
+
 namespace app {
 
 class Tick {
@@ -35,14 +37,28 @@ private:
 };
 
 
+// Сколько раз сессии обсчитывались полностью и сколько раз тик пропускался из-за простоя
+struct TickStats {
+    size_t full_ticks = 0;
+    size_t idle_ticks = 0;
+};
+
 class TickUseCase {
 public:
     TickUseCase(model::Game& game_);
-    // Подключает игрока с указанным именем (пса) к указанной карте
-    TickResult ExecuteTick(Tick tick);
+    // Подключает игрока с указанным именем (пса) к указанной карте.
+    // Если передан profile, в нём накапливается время этапов полных тиков сессий
+    TickResult ExecuteTick(Tick tick, model::TickProfile* profile = nullptr);
+
+    // Может вызываться из любого потока
+    TickStats GetStats() const noexcept {
+        return {full_ticks_.load(std::memory_order_relaxed), idle_ticks_.load(std::memory_order_relaxed)};
+    }
 
 private:
     model::Game* game_;
+    std::atomic<size_t> full_ticks_ = 0;
+    std::atomic<size_t> idle_ticks_ = 0;
 };
 
 }  // namespace app
@@ -0,0 +1,46 @@
+#include "admission_control.h"
+
+namespace http_handler {
+
+bool AdmissionControl::TryAdmit(RequestPriority priority) noexcept {
+    if (IsDraining()) {
+        rejected_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    size_t depth = queue_depth_.load(std::memory_order_relaxed);
+    do {
+        if (depth >= config_.max_queue_depth) {
+            rejected_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        if (priority == RequestPriority::NonEssential && IsOverloaded(depth)) {
+            shed_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+    } while (!queue_depth_.compare_exchange_weak(depth, depth + 1, std::memory_order_relaxed));
+
+    admitted_.fetch_add(1, std::memory_order_relaxed);
+    size_t peak = peak_queue_depth_.load(std::memory_order_relaxed);
+    while (depth + 1 > peak && !peak_queue_depth_.compare_exchange_weak(peak, depth + 1, std::memory_order_relaxed)) {
+    }
+    return true;
+}
+
+bool AdmissionControl::IsOverloaded(size_t queue_depth) const noexcept {
+    return queue_depth >= config_.shed_queue_depth
+        || (config_.max_tick_lag.count() > 0
+            && tick_lag_ms_.load(std::memory_order_relaxed) >= config_.max_tick_lag.count());
+}
+
+AdmissionControl::Metrics AdmissionControl::GetMetrics() const noexcept {
+    Metrics metrics;
+    metrics.queue_depth = queue_depth_.load(std::memory_order_relaxed);
+    metrics.peak_queue_depth = peak_queue_depth_.load(std::memory_order_relaxed);
+    metrics.tick_lag = std::chrono::milliseconds(tick_lag_ms_.load(std::memory_order_relaxed));
+    metrics.admitted = admitted_.load(std::memory_order_relaxed);
+    metrics.shed = shed_.load(std::memory_order_relaxed);
+    metrics.rejected = rejected_.load(std::memory_order_relaxed);
+    return metrics;
+}
+
+}  // namespace http_handler
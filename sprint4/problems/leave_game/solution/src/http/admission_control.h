@@ -0,0 +1,106 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+
+namespace http_handler {
+
+// Пороги допуска запросов в strand API
+struct AdmissionConfig {
+    // Предельная длина очереди strand API. Сверх неё отклоняются любые запросы
+    size_t max_queue_depth = 1024;
+    // Длина очереди, начиная с которой отклоняются второстепенные запросы
+    size_t shed_queue_depth = 256;
+    // Отставание игрового тика от периода тикера, при котором отклоняются второстепенные запросы.
+    // 0 - отставание не учитывается
+    std::chrono::milliseconds max_tick_lag{100};
+    // Значение заголовка Retry-After в ответе 503
+    std::chrono::seconds retry_after{1};
+};
+
+// Важность запроса к API при перегрузке
+enum class RequestPriority {
+    // Управление игрой: действия игроков и тик. Отклоняются только при заполненной очереди
+    Essential,
+    // Запросы, без которых игра продолжается: карты, рекорды, список игроков.
+    // Отклоняются первыми
+    NonEssential
+};
+
+// Контроль допуска запросов в strand API.
+// Считает запросы, ожидающие выполнения в strand, и отклоняет новые, если очередь
+// длиннее порогов или игровой цикл не успевает за тикером.
+// Все методы потокобезопасны
+class AdmissionControl {
+public:
+    struct Metrics {
+        size_t queue_depth = 0;
+        size_t peak_queue_depth = 0;
+        std::chrono::milliseconds tick_lag{0};
+        size_t admitted = 0;
+        // Второстепенные запросы, отклонённые из-за перегрузки
+        size_t shed = 0;
+        // Запросы, отклонённые из-за заполненной очереди
+        size_t rejected = 0;
+    };
+
+    explicit AdmissionControl(AdmissionConfig config)
+        : config_(config) {
+    }
+
+    AdmissionControl(const AdmissionControl&) = delete;
+    AdmissionControl& operator=(const AdmissionControl&) = delete;
+
+    // Занимает место в очереди. При отказе запрос не должен попасть в strand
+    bool TryAdmit(RequestPriority priority) noexcept;
+    // Запрос извлечён из очереди и начал выполняться в strand
+    void OnDequeued() noexcept {
+        queue_depth_.fetch_sub(1, std::memory_order_relaxed);
+    }
+    // Сообщает, насколько очередной тик опоздал относительно периода тикера
+    void ReportTickLag(std::chrono::milliseconds lag) noexcept {
+        tick_lag_ms_.store(std::max<long long>(0, lag.count()), std::memory_order_relaxed);
+    }
+    // Горячий перезапуск: новые запросы к API больше не допускаются, а уже стоящие в очереди выполняются
+    void StartDraining() noexcept {
+        draining_.store(true, std::memory_order_release);
+    }
+    // Снимок состояния для нового процесса сделан: запросы, оказавшиеся в очереди после него,
+    // уже не изменят переданное состояние и не выполняются
+    void MarkHandedOff() noexcept {
+        handed_off_.store(true, std::memory_order_release);
+    }
+    // Передача не удалась, процесс продолжает работу
+    void StopDraining() noexcept {
+        handed_off_.store(false, std::memory_order_release);
+        draining_.store(false, std::memory_order_release);
+    }
+    bool IsDraining() const noexcept {
+        return draining_.load(std::memory_order_acquire);
+    }
+    bool IsHandedOff() const noexcept {
+        return handed_off_.load(std::memory_order_acquire);
+    }
+
+    const AdmissionConfig& GetConfig() const noexcept {
+        return config_;
+    }
+    Metrics GetMetrics() const noexcept;
+
+private:
+    bool IsOverloaded(size_t queue_depth) const noexcept;
+
+    const AdmissionConfig config_;
+    std::atomic<size_t> queue_depth_ = 0;
+    std::atomic<size_t> peak_queue_depth_ = 0;
+    std::atomic<long long> tick_lag_ms_ = 0;
+    std::atomic<size_t> admitted_ = 0;
+    std::atomic<size_t> shed_ = 0;
+    std::atomic<size_t> rejected_ = 0;
+    std::atomic<bool> draining_ = false;
+    std::atomic<bool> handed_off_ = false;
+};
+
+}  // namespace http_handler
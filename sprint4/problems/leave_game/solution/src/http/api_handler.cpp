@@ -12,6 +12,9 @@
 #include <boost/json.hpp>
 #include "boost/json/serialize.hpp"
 #include <boost/url.hpp>
+#include <array>
+#include <charconv>
+#include <cmath>
 #include <iostream>
 #include <string_view>
 
@@ -19,6 +22,7 @@
 #include "http_handler_types.h"
 #include "json_fields.h"
 #include "json_loader.h"
+#include "sampling_profiler.h"
 #include "http_handler_defs.h"
 #include "tick_use_case.h"
 
@@ -40,6 +44,78 @@ bool ApiHandler::IsApiRequest(std::string_view target) {
     return clear_url.find(api_strings::MAIN_PATH) == 0;    // Запрос к АПИ, если путь начинается с /api/
 }
 
+ApiRoute ApiHandler::GetApiRoute(std::string_view target) const {
+    // Отбрасываем параметры запроса и завершающие слэши
+    target = target.substr(0, target.find('?'));
+    while (!target.empty() && target.back() == '/') {
+        target.remove_suffix(1);
+    }
+
+    // Сегменты пути без копирования: "/api/v1/game/state" -> ["api", "v1", "game", "state"]
+    constexpr size_t MAX_SEGMENTS = api_strings::LVL4_POS + 1;
+    std::array<std::string_view, MAX_SEGMENTS> segments;
+    size_t count = 0;
+    while (!target.empty()) {
+        target.remove_prefix(1);    // ведущий '/'
+        if (count == MAX_SEGMENTS) {
+            return ApiRoute::Unknown;
+        }
+        const auto end = std::min(target.find('/'), target.size());
+        segments[count++] = target.substr(0, end);
+        target.remove_prefix(end);
+    }
+
+    if (count <= api_strings::TARGET_POS || segments[api_strings::VERSION_POS] != api_strings::VERSION_PATH) {
+        return ApiRoute::Unknown;
+    }
+    const auto target_segment = segments[api_strings::TARGET_POS];
+    if (target_segment == api_strings::MAPS_PATH) {
+        return ApiRoute::Maps;
+    }
+    if (target_segment == api_strings::METRICS_PATH && count == api_strings::LVL3_POS) {
+        return ApiRoute::Metrics;
+    }
+    if (target_segment == api_strings::PROFILE_PATH && count == api_strings::LVL3_POS + 1) {
+        return ApiRoute::Profile;
+    }
+    if (target_segment != api_strings::GAME_PATH) {
+        return ApiRoute::Unknown;
+    }
+    if (count == api_strings::LVL3_POS + 1) {
+        const auto action = segments[api_strings::LVL3_POS];
+        if (action == api_strings::JOIN_PATH) {
+            return ApiRoute::Join;
+        } else if (action == api_strings::PLAYERS_PATH) {
+            return ApiRoute::Players;
+        } else if (action == api_strings::STATE_PATH) {
+            return ApiRoute::State;
+        } else if (action == api_strings::TICK_PATH) {
+            return ApiRoute::Tick;
+        } else if (action == api_strings::RECORDS_PATH) {
+            return ApiRoute::Records;
+        }
+    } else if (count == api_strings::LVL4_POS + 1 && segments[api_strings::LVL3_POS] == api_strings::PLAYER_PATH) {
+        if (segments[api_strings::LVL4_POS] == api_strings::ACTION_PATH) {
+            return ApiRoute::PlayerAction;
+        } else if (segments[api_strings::LVL4_POS] == api_strings::BATCH_PATH) {
+            return ApiRoute::PlayerBatch;
+        }
+    }
+    return ApiRoute::Unknown;
+}
+
+RequestPriority ApiHandler::GetRequestPriority(ApiRoute route) {
+    // Карты, рекорды и список игроков можно запросить позже - игра от этого не остановится
+    switch (route) {
+        case ApiRoute::Maps:
+        case ApiRoute::Records:
+        case ApiRoute::Players:
+            return RequestPriority::NonEssential;
+        default:
+            return RequestPriority::Essential;
+    }
+}
+
 std::string ApiHandler::GetPathFromUri(core::string_view s) const {
     urls::url_view u(s);
     std::string decoded = u.path();
@@ -58,6 +134,7 @@ std::vector<std::string> ApiHandler::GetSegmentsFromPath(core::string_view s) co
 }
 
 StringResponse ApiHandler::HandleApiRequest(const StringRequest& req) {
+    profiler::ZoneScope zone{"ApiHandler::HandleApiRequest"};
     // Определяем цель запроса
     std::string req_target(req.target());
 
@@ -132,6 +209,8 @@ StringResponse ApiHandler::GetGameResponse(const StringRequest& req, const std::
         return GetStateResponse(req, segments);
     } else if ( isPlayerActionRequest(segments) ) {
         return GetPlayerActionResponse(req, segments);
+    } else if ( isPlayerBatchRequest(segments) ) {
+        return GetPlayerBatchResponse(req, segments);
     } else if ( isTickRequest(segments) ) {
         return GetTickResponse(req, segments);
     } else if ( isRecordsRequest(segments) ) {
@@ -194,7 +273,7 @@ StringResponse ApiHandler::GetPlayersResponse(const StringRequest& req, const st
     return response;
 }
 
-std::string_view ApiHandler::GetTokenFromRequestStr(std::string_view str) {
+std::string_view ApiHandler::GetTokenFromRequestStr(std::string_view str) const {
     if ( auto pos = str.find(TokenParams::START_STR) != str.npos ) {
         return str.substr(pos+TokenParams::START_STR.size()-1);
     }
@@ -203,7 +282,7 @@ std::string_view ApiHandler::GetTokenFromRequestStr(std::string_view str) {
 
 http::status ApiHandler::GetPlayers(std::string_view token, std::string& response_body) {
     app::ListPlayersResult res = app_.GetPlayers(token);
-    response_body = boost::json::serialize(json::value_from(res));
+    json_writer::Serialize(res, response_body);
     return http::status::ok;
 }
 
@@ -223,10 +302,9 @@ StringResponse ApiHandler::GetJoinResponse(const StringRequest& req, const std::
     // Проверям корректность запроса (сразу извлекаем данные???)
     if (req_content_type == ContentType::APP_JSON) {
         // Парсим JSON
-        std::string req_body(req.body());
         JoinParams params;
         try {
-            json_loader::ReadJoinParamsFromString(params, req_body);
+            json_loader::ReadJoinParamsFromString(params, req.body());
             status = JoinGame(params, response_body);
         } catch (std::exception err) {
             response_body = GenerateErrorResponse(json_field::API_CODE_INVALID_ARGUMENT, "Join game request parse error");
@@ -277,10 +355,14 @@ StringResponse ApiHandler::GetStateResponse(const StringRequest& req, const std:
 
     // Полуаем токен авторизации
     auto token = GetTokenFromRequestStr(req[http::field::authorization]);
-    if (utils::validators::IsValidToken(token)) {
+    std::optional<app::AreaOfInterest> area;
+    if (!ParseAreaOfInterest(req.target(), area)) {
+        status = http::status::bad_request;
+        response_body = GenerateErrorResponse(json_field::API_CODE_INVALID_ARGUMENT, "Invalid radius"s);
+    } else if (utils::validators::IsValidToken(token)) {
         // Получаем список игроков в виде response_body для игрока с токеном token
         try {
-            status = GetState(token, response_body);
+            status = GetState(token, response_body, area);
         } catch (app::GetStateError err) {
             if(err.reason_ == app::GetStateErrorReason::InvalidToken) {
                 response_body = GenerateErrorResponse(json_field::API_CODE_UNKNOWN_TOKEN, "Player token has not been found");
@@ -316,12 +398,48 @@ StringResponse ApiHandler::GetStateResponse(const StringRequest& req, const std:
     return response;
 }
 
-http::status ApiHandler::GetState(std::string_view token, std::string& response_body) {
-    app::GetStateResult res = app_.GetState(token);
-    response_body = boost::json::serialize(json::value_from(res));
+http::status ApiHandler::GetState(std::string_view token, std::string& response_body,
+                                  std::optional<app::AreaOfInterest> area) {
+    app::GetStateResult res = app_.GetState(token, area);
+    // Состояние - самый частый и самый большой ответ. Буфер резервируется по размеру предыдущего,
+    // чтобы запись обошлась одним выделением памяти
+    response_body.reserve(state_size_hint_);
+    json_writer::Serialize(res, response_body);
+    state_size_hint_ = response_body.size() + response_body.size() / 8;
     return http::status::ok;
 }
 
+bool ApiHandler::ParseAreaOfInterest(std::string_view target, std::optional<app::AreaOfInterest>& area) {
+    area.reset();
+    const auto query_pos = target.find('?');
+    if (query_pos == target.npos) {
+        return true;
+    }
+
+    // Параметры вида "radius=10.5", разделённые '&'. Прочие параметры пропускаются
+    auto query = target.substr(query_pos + 1);
+    while (!query.empty()) {
+        const auto param = query.substr(0, query.find('&'));
+        query.remove_prefix(std::min(param.size() + 1, query.size()));
+
+        const auto eq_pos = param.find('=');
+        if (param.substr(0, eq_pos) != StateParams::RADIUS) {
+            continue;
+        }
+        if (eq_pos == param.npos) {
+            return false;
+        }
+        const auto value = param.substr(eq_pos + 1);
+        double radius = 0.0;
+        const auto [ptr, ec] = std::from_chars(value.data(), value.data() + value.size(), radius);
+        if (ec != std::errc{} || ptr != value.data() + value.size() || !std::isfinite(radius) || radius < 0.0) {
+            return false;
+        }
+        area = app::AreaOfInterest{radius};
+    }
+    return true;
+}
+
 bool ApiHandler::isPlayerActionRequest(const std::vector<std::string>&  segments) const {
     return segments[api_strings::LVL3_POS] == api_strings::PLAYER_PATH && segments[api_strings::LVL4_POS] == api_strings::ACTION_PATH;
 }
@@ -341,10 +459,9 @@ StringResponse ApiHandler::GetPlayerActionResponse(const StringRequest& req, con
         // Проверям корректность запроса
         if (req_content_type == ContentType::APP_JSON) {
             // Парсим JSON
-            std::string req_body(req.body());
             PlayerActionParams params;
             try {
-                json_loader::ReadPlayerActionParamsFromString(params, req_body);
+                json_loader::ReadPlayerActionParamsFromString(params, req.body());
                 status = ExecutePlayerAction(token, params, response_body);
             } catch (std::exception err) {
                 response_body = GenerateErrorResponse(json_field::API_CODE_INVALID_ARGUMENT, "Player action request parse error");
@@ -385,6 +502,86 @@ http::status ApiHandler::ExecutePlayerAction(std::string_view token, PlayerActio
     return http::status::ok;
 }
 
+bool ApiHandler::isPlayerBatchRequest(const std::vector<std::string>&  segments) const {
+    return segments[api_strings::LVL3_POS] == api_strings::PLAYER_PATH && segments[api_strings::LVL4_POS] == api_strings::BATCH_PATH;
+}
+
+// Пакетный запрос: выполняет несколько действий игрока и сразу возвращает состояние игры.
+// Заменяет серию запросов action + state одним запросом и одним переходом в strand API
+StringResponse ApiHandler::GetPlayerBatchResponse(const StringRequest& req, const std::vector<std::string>& segments) {
+    std::string content_type(ContentType::APP_JSON);
+    std::string response_body;
+    std::string_view allowed_method(AllowedMethods::PLAYER_BATCH);
+
+    http::status status = http::status::ok;
+
+    // Полуаем токен авторизации
+    auto token = GetTokenFromRequestStr(req[http::field::authorization]);
+    if (utils::validators::IsValidToken(token)) {
+        auto req_content_type = req[http::field::content_type];
+        // Проверям корректность запроса
+        if (req_content_type == ContentType::APP_JSON) {
+            // Парсим JSON
+            PlayerBatchParams params;
+            try {
+                json_loader::ReadPlayerBatchParamsFromString(params, req.body());
+                status = ExecutePlayerBatch(token, params, response_body);
+            } catch (std::exception err) {
+                response_body = GenerateErrorResponse(json_field::API_CODE_INVALID_ARGUMENT, "Player batch request parse error");
+                status = http::status::bad_request;
+            } catch (app::PlayerActionError err) {
+                if(err.reason_ == app::PlayerActionErrorReason::InvalidMove) {
+                    response_body = GenerateErrorResponse(json_field::API_CODE_INVALID_ARGUMENT, "Invalid move");
+                    status = http::status::bad_request;
+                } else if (err.reason_ == app::PlayerActionErrorReason::InvalidToken) {
+                    response_body = GenerateErrorResponse(json_field::API_CODE_UNKNOWN_TOKEN, "Player token has not been found");
+                    status = http::status::unauthorized;
+                }
+            } catch (app::GetStateError err) {
+                if(err.reason_ == app::GetStateErrorReason::InvalidToken) {
+                    response_body = GenerateErrorResponse(json_field::API_CODE_UNKNOWN_TOKEN, "Player token has not been found");
+                    status = http::status::unauthorized;
+                }
+            }
+
+            auto req_method = req.method();
+            if (req_method != http::verb::post) {   // Недопустимый метод
+                status = http::status::method_not_allowed;
+                // Сгенерировать JSON с ошибкой
+                response_body = GenerateErrorResponse(json_field::API_CODE_INVALID_METHOD, "Only POST method is expected"s);
+            }
+        } else {
+            response_body = GenerateErrorResponse(json_field::API_CODE_INVALID_ARGUMENT, "Invalid content type");
+            status = http::status::bad_request;
+        }
+    } else {
+        status = http::status::unauthorized;
+        response_body = GenerateErrorResponse(json_field::API_CODE_INVALID_TOKEN, "Authorization header is missing"s);
+    }
+
+    auto response = this->MakeStringResponse(status, response_body, response_body.size(), req.version(), req.keep_alive(), content_type, allowed_method);
+    response.set(http::field::cache_control, HttpFildsValue::NO_CACHE);
+    return response;
+}
+
+http::status ApiHandler::ExecutePlayerBatch(std::string_view token, const PlayerBatchParams& params, std::string& response_body) {
+    // Проверяем все действия заранее, чтобы некорректный пакет не был выполнен частично
+    std::vector<app::PlayerAction> actions;
+    actions.reserve(params.actions.size());
+    for (const auto& action_params : params.actions) {
+        app::PlayerAction action(action_params.direction);
+        if (!action.IsDirection() && !action.IsStop()) {
+            throw app::PlayerActionError{app::PlayerActionErrorReason::InvalidMove};
+        }
+        actions.push_back(std::move(action));
+    }
+
+    for (auto& action : actions) {
+        app_.ExecutePlayerAction(token, std::move(action));
+    }
+    return GetState(token, response_body);
+}
+
 bool ApiHandler::isTickRequest(const std::vector<std::string>&  segments) const {
     return segments[api_strings::LVL3_POS] == api_strings::TICK_PATH;
 }
@@ -401,10 +598,9 @@ StringResponse ApiHandler::GetTickResponse(const StringRequest& req, const std::
     // Проверям корректность запроса
     if (req_content_type == ContentType::APP_JSON) {
         // Парсим JSON
-        std::string req_body(req.body());
         TickParams params;
         try {
-            json_loader::ReadTickParamsFromString(params, req_body);
+            json_loader::ReadTickParamsFromString(params, req.body());
             status = ExecuteTick(params, response_body);
         } catch (std::exception err) {
             response_body = GenerateErrorResponse(json_field::API_CODE_INVALID_ARGUMENT, "Tick request parse error");
@@ -474,7 +670,7 @@ StringResponse ApiHandler::GetRecordsResponse(const StringRequest& req, const st
 
 http::status ApiHandler::GetRecords(size_t start, size_t limit, std::string& response_body) {
     app::RecordsResult res = app_.GetRecords(start, limit);
-    response_body = boost::json::serialize(json::value_from(res));
+    json_writer::Serialize(res, response_body);
     return http::status::ok;
 }
 
@@ -482,12 +678,11 @@ http::status ApiHandler::GetRecords(size_t start, size_t limit, std::string& res
 // Создаёт StringResponse с заданными параметрами
 StringResponse ApiHandler::MakeStringResponse(http::status status, std::string_view body, size_t size, unsigned http_version,
                                   bool keep_alive, std::string_view content_type, std::string_view allowed_method) const {
-    StringResponse response(status, http_version);
+    StringResponse response(status, http_version, body);
     response.set(http::field::content_type, content_type);
     if (status == http::status::method_not_allowed) {
         response.set(http::field::allow, allowed_method);
     }
-    response.body() = body;
     response.content_length(size);
     response.keep_alive(keep_alive);
     return response;
@@ -501,7 +696,7 @@ std::string ApiHandler::GenerateErrorResponse(const std::string& code, const std
 http::status ApiHandler::GetMaps(std::string& response, const std::vector<std::string>& segments) const {
     // В данный момент доступна только версия v1 и только карты
     if (segments.size() == api_strings::LVL3_POS) {   // Запросили только список карт
-        response = serialize(json::value_from( app_.ListMaps() ));
+        json_writer::Serialize(app_.ListMaps(), response);
         return http::status::ok;
     } else {    // Запрос конкретной карты
         return GetMap(response,segments);
@@ -515,7 +710,7 @@ http::status ApiHandler::GetMap(std::string& response, const std::vector<std::st
         auto self_map_id = map.GetId();
         if (*self_map_id == map_id) {   // Нашли карту
             extra_data::ExtendedMap ex_map{map, extra_data_[self_map_id]};
-            response = serialize(json::value_from( ex_map ));
+            json_writer::Serialize(ex_map, response);
             return http::status::ok;
         }
     }
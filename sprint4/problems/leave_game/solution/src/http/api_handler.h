@@ -3,6 +3,7 @@
 #include <string>
 #include <utility>
 
+#include "admission_control.h"
 #include "extra_data.h"
 #include "http_server.h"
 #include "http_handler_types.h"
@@ -33,6 +34,13 @@ public:
     ApiHandler& operator=(const ApiHandler&) = delete;
 
     bool IsApiRequest(std::string_view target);
+    // Маршрут запроса к API. Путь разбирается без выделения памяти,
+    // поэтому подходит для проверок до постановки запроса в strand
+    ApiRoute GetApiRoute(std::string_view target) const;
+    // Важность запроса при перегрузке сервера
+    static RequestPriority GetRequestPriority(ApiRoute route);
+    // Токен авторизации из значения заголовка Authorization
+    std::string_view GetTokenFromRequestStr(std::string_view str) const;
 
     // Обработчик запросов к АПИ - всегда возвращает ответ в виде строки. 
     StringResponse HandleApiRequest(const StringRequest& req);
@@ -42,7 +50,6 @@ private:
     // Вспомогательные функции
     std::vector<std::string> GetSegmentsFromPath(boost::core::string_view s) const;
     std::string GetPathFromUri(boost::core::string_view s) const;
-    std::string_view GetTokenFromRequestStr(std::string_view str);
 
     // Функции обработки запросов к API
     StringResponse GetGameResponse(const StringRequest& req, const std::vector<std::string>& segments);
@@ -51,6 +58,7 @@ private:
     StringResponse GetPlayersResponse(const StringRequest& req, const std::vector<std::string>& segments);
     StringResponse GetStateResponse(const StringRequest& req, const std::vector<std::string>& segments);
     StringResponse GetPlayerActionResponse(const StringRequest& req, const std::vector<std::string>& segments);
+    StringResponse GetPlayerBatchResponse(const StringRequest& req, const std::vector<std::string>& segments);
     StringResponse GetTickResponse(const StringRequest& req, const std::vector<std::string>& segments);
     StringResponse GetRecordsResponse(const StringRequest& req, const std::vector<std::string>& segments);
 
@@ -62,6 +70,7 @@ private:
     bool isPlayersRequest(const std::vector<std::string>&  segments) const;
     bool isStateRequest(const std::vector<std::string>&  segments) const;
     bool isPlayerActionRequest(const std::vector<std::string>&  segments) const;
+    bool isPlayerBatchRequest(const std::vector<std::string>&  segments) const;
     bool isTickRequest(const std::vector<std::string>&  segments) const;
     bool isRecordsRequest(const std::vector<std::string>&  segments) const;
 
@@ -69,8 +78,12 @@ private:
     http::status GetMaps(std::string& response, const std::vector<std::string>& segments) const;
     http::status GetMap(std::string& response, const std::vector<std::string>& segments) const;
     http::status GetPlayers(std::string_view token, std::string& response_body);
-    http::status GetState(std::string_view token, std::string& response_body);
+    http::status GetState(std::string_view token, std::string& response_body,
+                          std::optional<app::AreaOfInterest> area = std::nullopt);
+    // Разбирает область интереса из параметров запроса состояния. false - параметр некорректен
+    static bool ParseAreaOfInterest(std::string_view target, std::optional<app::AreaOfInterest>& area);
     http::status ExecutePlayerAction(std::string_view token, PlayerActionParams params, std::string& response_body);
+    http::status ExecutePlayerBatch(std::string_view token, const PlayerBatchParams& params, std::string& response_body);
     http::status ExecuteTick(TickParams params, std::string& response_body);
     http::status GetRecords(size_t start, size_t limit, std::string& response_body);
 
@@ -83,6 +96,9 @@ private:
 
     Strand api_strand_;
     app::Application& app_;
-    extra_data::MapsLootTypes& extra_data_;};
+    extra_data::MapsLootTypes& extra_data_;
+    // Размер буфера под следующий ответ на запрос состояния
+    size_t state_size_hint_ = 0;
+};
 
 }  // namespace http_handler
@@ -0,0 +1,64 @@
+#include "connection_arena.h"
+
+#include <vector>
+
+namespace http_server {
+
+namespace {
+
+// Свободные блоки арен одного потока. Блок, взятый в одном потоке, может вернуться в пул другого:
+// все блоки одинакового размера
+class ArenaBlockPool {
+public:
+    ArenaBlockPool() {
+        // Место под блоки резервируется заранее, чтобы возврат блока не выделял память
+        blocks_.reserve(ConnectionArena::MAX_POOLED_BLOCKS);
+    }
+
+    ArenaBlockPool(const ArenaBlockPool&) = delete;
+    ArenaBlockPool& operator=(const ArenaBlockPool&) = delete;
+
+    ~ArenaBlockPool() {
+        for (unsigned char* block : blocks_) {
+            ::operator delete(block);
+        }
+    }
+
+    unsigned char* Take() {
+        if (blocks_.empty()) {
+            // operator new выравнивает память по alignof(std::max_align_t)
+            return static_cast<unsigned char*>(::operator new(ConnectionArena::CAPACITY));
+        }
+        unsigned char* block = blocks_.back();
+        blocks_.pop_back();
+        return block;
+    }
+
+    void Return(unsigned char* block) noexcept {
+        if (blocks_.size() < ConnectionArena::MAX_POOLED_BLOCKS) {
+            blocks_.push_back(block);
+        } else {
+            ::operator delete(block);
+        }
+    }
+
+private:
+    std::vector<unsigned char*> blocks_;
+};
+
+ArenaBlockPool& LocalPool() {
+    thread_local ArenaBlockPool pool;
+    return pool;
+}
+
+}  // namespace
+
+unsigned char* ConnectionArena::TakeBlock() {
+    return LocalPool().Take();
+}
+
+void ConnectionArena::ReturnBlock(unsigned char* block) noexcept {
+    LocalPool().Return(block);
+}
+
+}  // namespace http_server
@@ -0,0 +1,170 @@
+#pragma once
+
+#include <boost/beast/http/fields.hpp>
+#include <boost/beast/http/string_body.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <new>
+#include <string>
+#include <type_traits>
+
+namespace http_server {
+
+// Память соединения под заголовки и тело запросов.
+// Выделение - простой сдвиг указателя по блоку арены, освобождение только
+// уменьшает счётчик живых блоков. Когда все блоки освобождены (запросы уничтожены),
+// следующее выделение начинает блок сначала, поэтому запросы keep-alive соединения
+// снова и снова используют тот же блок. Если блока не хватило, память берётся из кучи.
+// Блок арены не встроен в соединение: он берётся из пула потока при первом выделении
+// и возвращается в пул (Release), когда соединение простаивает, поэтому память под запросы
+// занимают только соединения, запросы которых сейчас разбираются или обрабатываются.
+// Выделяет память и меняет блок только исполнитель сессии, разбирающий запросы, а освобождают её
+// и другие потоки: запрос уничтожается в strand API, пока сессия уже читает следующий
+// (конвейерная обработка). Поэтому счётчик живых блоков атомарный, а сдвиг указателя
+// и возврат в начало блока выполняются только при выделении.
+// Ответы в арене не размещаются: они формируются в strand API одновременно с разбором
+// следующего запроса, а сдвиг указателя не синхронизирован
+class ConnectionArena {
+public:
+    ConnectionArena() = default;
+    ConnectionArena(const ConnectionArena&) = delete;
+    ConnectionArena& operator=(const ConnectionArena&) = delete;
+
+    // Запросы соединения уничтожаются раньше его арены, поэтому блок возвращается в пул без проверок
+    ~ConnectionArena() {
+        if (unsigned char* block = block_.load(std::memory_order_relaxed)) {
+            ReturnBlock(block);
+        }
+    }
+
+    void* Allocate(std::size_t size, std::size_t alignment) {
+        // Все блоки освобождены - ими больше никто не пользуется, блок можно начать сначала.
+        // acquire: освободивший блок поток закончил работу с его памятью раньше, чем она будет занята снова
+        if (live_blocks_.load(std::memory_order_acquire) == 0) {
+            used_ = 0;
+        }
+        const std::size_t offset = (used_ + alignment - 1) & ~(alignment - 1);
+        if (alignment <= alignof(std::max_align_t) && offset + size <= CAPACITY) {
+            unsigned char* block = block_.load(std::memory_order_relaxed);
+            if (!block) {
+                block = TakeBlock();
+                block_.store(block, std::memory_order_relaxed);
+            }
+            used_ = offset + size;
+            live_blocks_.fetch_add(1, std::memory_order_relaxed);
+            return block + offset;
+        }
+        return ::operator new(size);
+    }
+
+    // Может вызываться из любого потока
+    void Deallocate(void* pointer) noexcept {
+        if (!Owns(pointer)) {
+            ::operator delete(pointer);
+            return;
+        }
+        live_blocks_.fetch_sub(1, std::memory_order_release);
+    }
+
+    // Возвращает блок в пул потока, если ни одно выделение из него не живо.
+    // Вызывается исполнителем сессии, когда соединение ждёт следующий запрос
+    void Release() noexcept {
+        unsigned char* block = block_.load(std::memory_order_relaxed);
+        if (block && live_blocks_.load(std::memory_order_acquire) == 0) {
+            block_.store(nullptr, std::memory_order_relaxed);
+            used_ = 0;
+            ReturnBlock(block);
+        }
+    }
+
+    // Принадлежит ли блок памяти арене (иначе он выделен в куче).
+    // Блок арены не меняется, пока из него выделена хотя бы одна живая область
+    bool Owns(const void* pointer) const noexcept {
+        const auto* block = block_.load(std::memory_order_relaxed);
+        const auto* p = static_cast<const unsigned char*>(pointer);
+        return block && p >= block && p < block + CAPACITY;
+    }
+
+    // Есть ли у арены блок из пула
+    bool HasBlock() const noexcept {
+        return block_.load(std::memory_order_relaxed) != nullptr;
+    }
+
+    // Сколько байт арены занято с последнего возврата в начало блока.
+    // Читается только в исполнителе сессии
+    std::size_t Used() const noexcept {
+        return used_;
+    }
+
+    // Сколько блоков арены ещё не освобождено
+    std::size_t LiveBlocks() const noexcept {
+        return live_blocks_.load(std::memory_order_acquire);
+    }
+
+    static constexpr std::size_t CAPACITY = 8 * 1024;
+    // Сколько свободных блоков хранит пул одного потока. Лишние блоки возвращаются в кучу
+    static constexpr std::size_t MAX_POOLED_BLOCKS = 64;
+
+private:
+    // Блок из пула текущего потока или новый из кучи
+    static unsigned char* TakeBlock();
+    static void ReturnBlock(unsigned char* block) noexcept;
+
+    std::atomic<unsigned char*> block_ = nullptr;
+    std::size_t used_ = 0;
+    std::atomic<std::size_t> live_blocks_ = 0;
+};
+
+// Аллокатор поверх арены соединения. Созданный по умолчанию (без арены) работает с кучей,
+// поэтому сообщения, сформированные вне соединения, остаются корректными
+template <typename T>
+class ArenaAllocator {
+public:
+    using value_type = T;
+    using propagate_on_container_copy_assignment = std::true_type;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+
+    ArenaAllocator() noexcept = default;
+
+    explicit ArenaAllocator(ConnectionArena& arena) noexcept
+        : arena_(&arena) {
+    }
+
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U>& other) noexcept
+        : arena_(other.arena_) {
+    }
+
+    T* allocate(std::size_t n) const {
+        if (!arena_) {
+            return static_cast<T*>(::operator new(sizeof(T) * n));
+        }
+        return static_cast<T*>(arena_->Allocate(sizeof(T) * n, alignof(T)));
+    }
+
+    void deallocate(T* pointer, std::size_t /*n*/) const noexcept {
+        if (!arena_) {
+            return ::operator delete(pointer);
+        }
+        arena_->Deallocate(pointer);
+    }
+
+    template <typename U>
+    bool operator==(const ArenaAllocator<U>& other) const noexcept {
+        return arena_ == other.arena_;
+    }
+
+private:
+    template <typename>
+    friend class ArenaAllocator;
+
+    ConnectionArena* arena_ = nullptr;
+};
+
+// Заголовки и строковое тело, память под которые выделяется в арене соединения
+using ArenaFields = boost::beast::http::basic_fields<ArenaAllocator<char>>;
+using ArenaStringBody = boost::beast::http::basic_string_body<char, std::char_traits<char>, ArenaAllocator<char>>;
+
+}  // namespace http_server
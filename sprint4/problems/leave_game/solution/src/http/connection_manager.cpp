@@ -0,0 +1,67 @@
+#include "connection_manager.h"
+
+namespace http_server {
+
+namespace {
+// Точность таймаутов бездействия и размер колеса таймеров.
+// Таймаут в 30 секунд укладывается в один оборот колеса
+constexpr std::chrono::milliseconds WHEEL_RESOLUTION{250};
+constexpr size_t WHEEL_SLOTS = 256;
+}  // namespace
+
+ConnectionSlot::~ConnectionSlot() {
+    if (!manager_) {
+        // Слот был перемещён
+        return;
+    }
+    if (timer_) {
+        timer_->Cancel();
+    }
+    SetIdle(false);
+    manager_->open_.fetch_sub(1, std::memory_order_relaxed);
+}
+
+void ConnectionSlot::Arm(TimerWheel::Handler on_timeout) {
+    timer_ = manager_->wheel_->Add(manager_->idle_timeout_,
+        [manager = std::weak_ptr<ConnectionManager>(manager_), on_timeout = std::move(on_timeout)] {
+            if (auto self = manager.lock()) {
+                self->reaped_.fetch_add(1, std::memory_order_relaxed);
+            }
+            on_timeout();
+        });
+}
+
+void ConnectionSlot::SetIdle(bool idle) noexcept {
+    if (idle == idle_) {
+        return;
+    }
+    idle_ = idle;
+    if (idle) {
+        manager_->idle_.fetch_add(1, std::memory_order_relaxed);
+    } else {
+        manager_->idle_.fetch_sub(1, std::memory_order_relaxed);
+    }
+}
+
+ConnectionManager::ConnectionManager(net::io_context& ioc, std::chrono::milliseconds idle_timeout, size_t max_connections)
+    : idle_timeout_(idle_timeout)
+    , max_connections_(max_connections)
+    , wheel_(std::make_shared<TimerWheel>(ioc, WHEEL_RESOLUTION, WHEEL_SLOTS)) {
+}
+
+std::optional<ConnectionSlot> ConnectionManager::TryOpen() {
+    size_t open = open_.load(std::memory_order_relaxed);
+    do {
+        if (max_connections_ != 0 && open >= max_connections_) {
+            return std::nullopt;
+        }
+    } while (!open_.compare_exchange_weak(open, open + 1, std::memory_order_relaxed));
+    return ConnectionSlot(shared_from_this());
+}
+
+ConnectionManager::Stats ConnectionManager::GetStats() const noexcept {
+    return {open_.load(std::memory_order_relaxed), idle_.load(std::memory_order_relaxed),
+            reaped_.load(std::memory_order_relaxed), rejected_.load(std::memory_order_relaxed)};
+}
+
+}  // namespace http_server
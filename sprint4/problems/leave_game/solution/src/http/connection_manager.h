@@ -0,0 +1,92 @@
+#pragma once
+
+#include "timer_wheel.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <optional>
+
+namespace http_server {
+
+class ConnectionManager;
+
+// Место соединения в ConnectionManager. Пока слот жив, соединение учитывается как открытое.
+// Методы слота вызываются только из исполнителя своей сессии
+class ConnectionSlot {
+public:
+    explicit ConnectionSlot(std::shared_ptr<ConnectionManager> manager) noexcept
+        : manager_(std::move(manager)) {
+    }
+
+    ConnectionSlot(ConnectionSlot&& other) noexcept = default;
+    ConnectionSlot& operator=(ConnectionSlot&&) = delete;
+    ConnectionSlot(const ConnectionSlot&) = delete;
+    ConnectionSlot& operator=(const ConnectionSlot&) = delete;
+
+    ~ConnectionSlot();
+
+    // Заводит таймаут бездействия соединения. on_timeout вызывается в потоке колеса таймеров,
+    // если соединение не продлевали дольше таймаута
+    void Arm(TimerWheel::Handler on_timeout);
+    // Продлевает таймаут - вызывается при каждом чтении и записи
+    void Touch() noexcept {
+        if (timer_) {
+            timer_->Touch();
+        }
+    }
+    // Соединение простаивает - ждёт новый запрос и не обрабатывает ни одного
+    void SetIdle(bool idle) noexcept;
+
+private:
+    std::shared_ptr<ConnectionManager> manager_;
+    std::shared_ptr<TimerWheel::Entry> timer_;
+    bool idle_ = false;
+};
+
+// Учёт соединений сервера: ограничение их числа, таймауты бездействия и счётчики.
+// Таймауты всех соединений обслуживаются одним колесом таймеров
+class ConnectionManager : public std::enable_shared_from_this<ConnectionManager> {
+public:
+    struct Stats {
+        size_t open = 0;
+        size_t idle = 0;
+        // Закрыто по таймауту бездействия
+        size_t reaped = 0;
+        // Отклонено из-за превышения лимита
+        size_t rejected = 0;
+    };
+
+    // max_connections == 0 - число соединений не ограничено
+    ConnectionManager(net::io_context& ioc, std::chrono::milliseconds idle_timeout, size_t max_connections);
+
+    // Занимает место под новое соединение. Если лимит исчерпан, возвращает nullopt
+    std::optional<ConnectionSlot> TryOpen();
+    void OnRejected() noexcept {
+        rejected_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    Stats GetStats() const noexcept;
+
+    void Start() {
+        wheel_->Start();
+    }
+    void Stop() {
+        wheel_->Stop();
+    }
+
+private:
+    friend class ConnectionSlot;
+
+    std::chrono::milliseconds idle_timeout_;
+    size_t max_connections_;
+    std::shared_ptr<TimerWheel> wheel_;
+
+    std::atomic<size_t> open_ = 0;
+    std::atomic<size_t> idle_ = 0;
+    std::atomic<size_t> reaped_ = 0;
+    std::atomic<size_t> rejected_ = 0;
+};
+
+}  // namespace http_server
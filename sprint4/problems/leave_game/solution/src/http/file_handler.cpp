@@ -83,12 +83,11 @@ FileRequestResult FileHandler::HandleFileRequest(const StringRequest& req) const
 StringResponse FileHandler::MakeStringResponse(http::status status, std::string_view body, size_t size, unsigned http_version,
                                   bool keep_alive,
                                   std::string_view content_type) const {
-    StringResponse response(status, http_version);
+    StringResponse response(status, http_version, body);
     response.set(http::field::content_type, content_type);
     if (status == http::status::method_not_allowed) {
         response.set(http::field::allow, "GET, HEAD");
     }
-    response.body() = body;
     response.content_length(size);
     response.keep_alive(keep_alive);
     return response;
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <new>
+
+namespace http_server {
+
+// Память под обработчики асинхронных операций одного соединения.
+// Обработчики соединения выполняются строго по очереди, поэтому одновременно
+// живут не больше двух из них (выполняемый и следующий за ним). Для них заведены
+// два слота фиксированного размера, а если слоты заняты или обработчик
+// не помещается, память берётся из кучи
+class HandlerMemory {
+public:
+    HandlerMemory() = default;
+    HandlerMemory(const HandlerMemory&) = delete;
+    HandlerMemory& operator=(const HandlerMemory&) = delete;
+
+    void* Allocate(std::size_t size) {
+        if (size <= SLOT_SIZE) {
+            for (auto& slot : slots_) {
+                if (!slot.in_use.exchange(true, std::memory_order_acquire)) {
+                    return slot.storage;
+                }
+            }
+        }
+        return ::operator new(size);
+    }
+
+    void Deallocate(void* pointer) noexcept {
+        for (auto& slot : slots_) {
+            if (pointer == slot.storage) {
+                slot.in_use.store(false, std::memory_order_release);
+                return;
+            }
+        }
+        ::operator delete(pointer);
+    }
+
+private:
+    static constexpr std::size_t SLOT_SIZE = 1024;
+
+    struct Slot {
+        alignas(std::max_align_t) unsigned char storage[SLOT_SIZE];
+        std::atomic<bool> in_use{false};
+    };
+
+    std::array<Slot, 2> slots_;
+};
+
+// Аллокатор, который связывается с обработчиком (boost::asio::bind_allocator),
+// чтобы asio размещал его в памяти соединения
+template <typename T>
+class HandlerAllocator {
+public:
+    using value_type = T;
+
+    explicit HandlerAllocator(HandlerMemory& memory) noexcept
+        : memory_(&memory) {
+    }
+
+    template <typename U>
+    HandlerAllocator(const HandlerAllocator<U>& other) noexcept
+        : memory_(other.memory_) {
+    }
+
+    T* allocate(std::size_t n) const {
+        return static_cast<T*>(memory_->Allocate(sizeof(T) * n));
+    }
+
+    void deallocate(T* pointer, std::size_t /*n*/) const noexcept {
+        memory_->Deallocate(pointer);
+    }
+
+    template <typename U>
+    bool operator==(const HandlerAllocator<U>& other) const noexcept {
+        return memory_ == other.memory_;
+    }
+
+private:
+    template <typename>
+    friend class HandlerAllocator;
+
+    HandlerMemory* memory_;
+};
+
+}  // namespace http_server
@@ -0,0 +1,252 @@
+#include "hot_restart.h"
+
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <system_error>
+
+namespace hot_restart {
+
+using namespace std::literals;
+
+namespace {
+
+// Заголовок передачи. Слушающие сокеты приходят вместе с ним во вспомогательных данных
+struct Header {
+    std::uint32_t magic;
+    std::uint32_t fd_count;
+    std::uint64_t state_size;
+};
+
+constexpr std::uint32_t MAGIC = 0x52484753;     // "GSHR"
+// Сокетов не больше, чем acceptor в режиме "поток на ядро"
+constexpr size_t MAX_FDS = 256;
+
+[[noreturn]] void ThrowSystemError(std::string_view what) {
+    throw std::system_error(errno, std::generic_category(), std::string(what));
+}
+
+// Закрывает дескриптор при выходе из области видимости
+class FileDescriptor {
+public:
+    explicit FileDescriptor(int fd) noexcept
+        : fd_(fd) {
+    }
+    ~FileDescriptor() {
+        if (fd_ >= 0) {
+            ::close(fd_);
+        }
+    }
+
+    FileDescriptor(const FileDescriptor&) = delete;
+    FileDescriptor& operator=(const FileDescriptor&) = delete;
+
+    int Get() const noexcept {
+        return fd_;
+    }
+
+private:
+    int fd_;
+};
+
+sockaddr_un MakeAddress(const fs::path& path) {
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    const std::string& str = path.native();
+    if (str.size() >= sizeof(addr.sun_path)) {
+        throw std::invalid_argument("Hot restart socket path is too long: "s + str);
+    }
+    std::memcpy(addr.sun_path, str.c_str(), str.size() + 1);
+    return addr;
+}
+
+void SetTimeout(int fd, int option, std::chrono::milliseconds timeout) {
+    timeval tv{};
+    tv.tv_sec = timeout.count() / 1000;
+    tv.tv_usec = (timeout.count() % 1000) * 1000;
+    if (::setsockopt(fd, SOL_SOCKET, option, &tv, sizeof(tv)) != 0) {
+        ThrowSystemError("setsockopt"sv);
+    }
+}
+
+void SendAll(int fd, const char* data, size_t size) {
+    while (size > 0) {
+        const ssize_t sent = ::send(fd, data, size, MSG_NOSIGNAL);
+        if (sent < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            ThrowSystemError("Hot restart send"sv);
+        }
+        data += sent;
+        size -= sent;
+    }
+}
+
+void ReceiveAll(int fd, char* data, size_t size) {
+    while (size > 0) {
+        const ssize_t received = ::recv(fd, data, size, 0);
+        if (received < 0 && errno == EINTR) {
+            continue;
+        }
+        if (received < 0) {
+            ThrowSystemError("Hot restart receive"sv);
+        }
+        if (received == 0) {
+            throw std::runtime_error("Hot restart connection closed by peer"s);
+        }
+        data += received;
+        size -= received;
+    }
+}
+
+}  // namespace
+
+ControlSocket::ControlSocket(const fs::path& path)
+    : path_(path) {
+    const sockaddr_un addr = MakeAddress(path);
+    fd_ = ::socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd_ < 0) {
+        ThrowSystemError("Hot restart socket"sv);
+    }
+    // Файл предыдущего процесса заменяется: тот продолжает слушать удалённый файл и больше не доступен
+    ::unlink(path.c_str());
+    struct stat st{};
+    if (::bind(fd_, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) != 0
+        || ::listen(fd_, 1) != 0
+        || ::stat(path.c_str(), &st) != 0) {
+        const int error = errno;
+        ::close(fd_);
+        errno = error;
+        ThrowSystemError("Hot restart socket "s + path.string());
+    }
+    inode_ = st.st_ino;
+}
+
+ControlSocket::~ControlSocket() {
+    struct stat st{};
+    if (::stat(path_.c_str(), &st) == 0 && st.st_ino == inode_) {
+        ::unlink(path_.c_str());
+    }
+    ::close(fd_);
+}
+
+std::optional<int> ControlSocket::Accept() {
+    const int connection = ::accept4(fd_, nullptr, nullptr, SOCK_CLOEXEC);
+    if (connection < 0) {
+        if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) {
+            return std::nullopt;
+        }
+        ThrowSystemError("Hot restart accept"sv);
+    }
+    return connection;
+}
+
+void SendHandoff(int connection, const std::vector<int>& listen_fds, std::string_view state) {
+    FileDescriptor guard{connection};
+    if (listen_fds.empty() || listen_fds.size() > MAX_FDS) {
+        throw std::invalid_argument("Invalid number of listening sockets for hot restart"s);
+    }
+    // Новый процесс, переставший читать, не должен держать старый вечно
+    SetTimeout(connection, SO_SNDTIMEO, 5s);
+
+    Header header{MAGIC, static_cast<std::uint32_t>(listen_fds.size()), state.size()};
+    iovec iov{&header, sizeof(header)};
+
+    const size_t fds_size = sizeof(int) * listen_fds.size();
+    std::vector<char> control(CMSG_SPACE(fds_size));
+    msghdr msg{};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control.data();
+    msg.msg_controllen = control.size();
+    cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN(fds_size);
+    std::memcpy(CMSG_DATA(cmsg), listen_fds.data(), fds_size);
+
+    ssize_t sent;
+    do {
+        sent = ::sendmsg(connection, &msg, MSG_NOSIGNAL);
+    } while (sent < 0 && errno == EINTR);
+    if (sent < 0) {
+        ThrowSystemError("Hot restart sendmsg"sv);
+    }
+    // Сокеты переданы вместе с первым байтом, остаток заголовка и состояние идут обычным потоком
+    const auto header_bytes = reinterpret_cast<const char*>(&header);
+    SendAll(connection, header_bytes + sent, sizeof(header) - sent);
+    SendAll(connection, state.data(), state.size());
+}
+
+std::optional<Handoff> RequestHandoff(const fs::path& path, std::chrono::milliseconds timeout) {
+    const sockaddr_un addr = MakeAddress(path);
+    FileDescriptor connection{::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0)};
+    if (connection.Get() < 0) {
+        ThrowSystemError("Hot restart socket"sv);
+    }
+    if (::connect(connection.Get(), reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) != 0) {
+        // Работающего процесса нет
+        if (errno == ENOENT || errno == ECONNREFUSED) {
+            return std::nullopt;
+        }
+        ThrowSystemError("Hot restart connect "s + path.string());
+    }
+    SetTimeout(connection.Get(), SO_RCVTIMEO, timeout);
+
+    Header header{};
+    iovec iov{&header, sizeof(header)};
+    std::vector<char> control(CMSG_SPACE(sizeof(int) * MAX_FDS));
+    msghdr msg{};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control.data();
+    msg.msg_controllen = control.size();
+
+    ssize_t received;
+    do {
+        received = ::recvmsg(connection.Get(), &msg, MSG_CMSG_CLOEXEC);
+    } while (received < 0 && errno == EINTR);
+    if (received < 0) {
+        ThrowSystemError("Hot restart recvmsg"sv);
+    }
+    if (received == 0) {
+        throw std::runtime_error("Hot restart connection closed by peer"s);
+    }
+
+    Handoff handoff;
+    for (cmsghdr* cmsg = CMSG_FIRSTHDR(&msg); cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+        if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_RIGHTS) {
+            const size_t count = (cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+            const size_t old_size = handoff.listen_fds.size();
+            handoff.listen_fds.resize(old_size + count);
+            std::memcpy(handoff.listen_fds.data() + old_size, CMSG_DATA(cmsg), count * sizeof(int));
+        }
+    }
+
+    try {
+        if (msg.msg_flags & MSG_CTRUNC) {
+            throw std::runtime_error("Hot restart: listening sockets were truncated"s);
+        }
+        ReceiveAll(connection.Get(), reinterpret_cast<char*>(&header) + received, sizeof(header) - received);
+        if (header.magic != MAGIC || header.fd_count != handoff.listen_fds.size()) {
+            throw std::runtime_error("Hot restart: invalid handoff header"s);
+        }
+        handoff.state.resize(header.state_size);
+        ReceiveAll(connection.Get(), handoff.state.data(), handoff.state.size());
+    } catch (...) {
+        for (int fd : handoff.listen_fds) {
+            ::close(fd);
+        }
+        throw;
+    }
+    return handoff;
+}
+
+}  // namespace hot_restart
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <sys/types.h>
+
+#include <chrono>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Горячий перезапуск сервера без разрыва соединений.
+// Работающий процесс слушает управляющий Unix-сокет. Новый процесс подключается к нему и получает
+// слушающие TCP-сокеты (SCM_RIGHTS) и снимок состояния игры в том же потоке данных.
+// Очередь ожидающих соединений принадлежит сокету, а не процессу, поэтому клиенты, подключившиеся
+// во время передачи, дождутся, пока новый процесс начнёт принимать соединения
+namespace hot_restart {
+
+namespace fs = std::filesystem;
+
+// То, что новый процесс получает от старого
+struct Handoff {
+    std::vector<int> listen_fds;
+    std::string state;
+};
+
+// Управляющий сокет работающего процесса
+class ControlSocket {
+public:
+    // Создаёт сокет по пути path. Файл, оставшийся от предыдущего процесса, заменяется
+    explicit ControlSocket(const fs::path& path);
+    // Удаляет файл сокета, если его не успел заменить новый процесс
+    ~ControlSocket();
+
+    ControlSocket(const ControlSocket&) = delete;
+    ControlSocket& operator=(const ControlSocket&) = delete;
+
+    // Дескриптор для ожидания подключения (готовность к чтению)
+    int GetFd() const noexcept {
+        return fd_;
+    }
+
+    // Принимает подключение нового процесса. nullopt - подключений нет
+    std::optional<int> Accept();
+
+private:
+    fs::path path_;
+    int fd_ = -1;
+    // Номер inode файла сокета: по нему видно, что файл уже принадлежит другому процессу
+    ino_t inode_ = 0;
+};
+
+// Передаёт сокеты и состояние новому процессу и закрывает соединение с ним.
+// Сокеты остаются открытыми и в старом процессе - их надо закрыть после передачи
+void SendHandoff(int connection, const std::vector<int>& listen_fds, std::string_view state);
+
+// Подключается к работающему процессу и принимает от него сокеты и состояние.
+// nullopt - по пути path никто не слушает, сервер запускается обычным образом
+std::optional<Handoff> RequestHandoff(const fs::path& path, std::chrono::milliseconds timeout);
+
+}  // namespace hot_restart
@@ -0,0 +1,204 @@
+#pragma once
+#include "sdk.h"
+
+#include "handler_allocator.h"
+#include "http_server.h"
+
+#include <boost/asio/bind_allocator.hpp>
+#include <boost/asio/co_spawn.hpp>
+#include <boost/asio/detached.hpp>
+#include <boost/asio/dispatch.hpp>
+#include <boost/asio/redirect_error.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/asio/use_awaitable.hpp>
+
+#include <memory>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <variant>
+
+namespace http_server {
+
+// Сессия, обрабатывающая запросы в одной корутине (boost::asio::awaitable) вместо цепочки колбэков.
+// Все объекты, нужные для обработки запроса, живут в сессии и переиспользуются между
+// запросами keep-alive соединения:
+//  - запрос читается в request_ через буфер buffer_, заголовки и тело размещаются в arena_,
+//    которая на время ожидания запроса возвращает свой блок в пул потока;
+//  - ответ обработчика кладётся в response_, откуда и пишется в сокет, без копии в куче;
+//  - обработчики, которые отправляются в strand api и обратно, размещаются в handler_memory_.
+// Поддерживаются ответы со строковым и файловым телом - других сервер не формирует,
+// а также закрытие соединения вместо ответа (CloseConnection)
+template <typename RequestHandler>
+class CoroSession : public std::enable_shared_from_this<CoroSession<RequestHandler>> {
+    // Listener создаёт сокеты на strand, но хранит исполнитель в полиморфной обёртке any_io_executor,
+    // копирование которой при каждой асинхронной операции выделяет память.
+    // Поэтому сессия работает с конкретным типом исполнителя
+    using Executor = net::strand<net::io_context::executor_type>;
+    using Stream = beast::basic_stream<tcp, Executor>;
+    using UseAwaitable = net::use_awaitable_t<Executor>;
+    using HttpRequest = http::request<ArenaStringBody, ArenaFields>;
+    using StringResponse = http::response<http::string_body>;
+    using FileResponse = http::response<http::file_body>;
+
+public:
+    template <typename Handler>
+    CoroSession(tcp::socket&& socket, Handler&& request_handler, ConnectionSlot&& connection)
+        : stream_(MakeStream(std::move(socket)))
+        , connection_(std::move(connection))
+        , response_ready_(stream_.get_executor())
+        , request_handler_(std::forward<Handler>(request_handler)) {
+    }
+
+    CoroSession(const CoroSession&) = delete;
+    CoroSession& operator=(const CoroSession&) = delete;
+
+    void Run() {
+        // По таймауту бездействия закрываем сокет - ожидающая операция корутины завершится с ошибкой
+        connection_.Arm([weak_self = this->weak_from_this()] {
+            if (auto self = weak_self.lock()) {
+                net::dispatch(self->stream_.get_executor(), [self] {
+                    self->stream_.close();
+                });
+            }
+        });
+        // Корутина владеет сессией через self до своего завершения
+        net::co_spawn(stream_.get_executor(), [self = this->shared_from_this()]() {
+            return self->Serve();
+        }, net::detached);
+    }
+
+private:
+    HttpRequest MakeRequest() {
+        return HttpRequest(std::piecewise_construct, std::make_tuple(ArenaAllocator<char>(arena_)),
+                           std::make_tuple(ArenaAllocator<char>(arena_)));
+    }
+
+    static Stream MakeStream(tcp::socket&& socket) {
+        const auto* executor = socket.get_executor().template target<Executor>();
+        if (!executor) {
+            throw std::logic_error("CoroSession requires a socket bound to an io_context strand");
+        }
+        const auto protocol = socket.local_endpoint().protocol();
+        return Stream(net::basic_stream_socket<tcp, Executor>(*executor, protocol, socket.release()));
+    }
+
+    // Функция отправки ответа, которая передаётся обработчику запроса.
+    // Копирование не выделяет память, а связанный с ней аллокатор позволяет
+    // обработчику разместить свои асинхронные операции в памяти сессии
+    class ResponseSender {
+    public:
+        using allocator_type = HandlerAllocator<void>;
+
+        explicit ResponseSender(std::shared_ptr<CoroSession> session) noexcept
+            : session_(std::move(session)) {
+        }
+
+        allocator_type get_allocator() const noexcept {
+            return allocator_type(session_->handler_memory_);
+        }
+
+        // Может быть вызвана из любого потока: ответ передаётся в сессию через её исполнитель
+        template <typename Response>
+        void operator()(Response&& response) const {
+            using ResponseType = std::decay_t<Response>;
+            static_assert(std::is_same_v<ResponseType, StringResponse> || std::is_same_v<ResponseType, FileResponse>
+                              || std::is_same_v<ResponseType, CloseConnection>,
+                          "CoroSession supports only string and file responses");
+
+            auto deliver = [session = session_, response = ResponseType(std::move(response))]() mutable {
+                session->response_.template emplace<ResponseType>(std::move(response));
+                session->response_ready_.cancel();
+            };
+            // Если ответ сформирован прямо в корутине сессии, dispatch выполнит deliver на месте
+            net::dispatch(session_->stream_.get_executor(),
+                          net::bind_allocator(get_allocator(), std::move(deliver)));
+        }
+
+    private:
+        std::shared_ptr<CoroSession> session_;
+    };
+
+    net::awaitable<void, Executor> Serve() {
+        beast::error_code ec;
+        const auto endpoint = stream_.socket().remote_endpoint(ec);
+        if (ec) {
+            ReportError(ec, "remote_endpoint"sv);
+            co_return;
+        }
+
+        for (;;) {
+            // Очищаем запрос и ответ от прежних значений. Когда обработчик уничтожит и свой
+            // экземпляр прежнего запроса, следующий запрос снова разбирается с начала буфера арены.
+            // Строка тела при перемещающем присваивании оставляет себе прежний буфер - освобождаем и его
+            request_ = MakeRequest();
+            request_.body().shrink_to_fit();
+            response_.template emplace<std::monostate>();
+            connection_.Touch();
+            connection_.SetIdle(true);
+            // Пока соединение ждёт запрос, блок арены ему не нужен: отдаём его другим соединениям потока
+            arena_.Release();
+            co_await http::async_read(stream_, buffer_, request_, net::redirect_error(UseAwaitable{}, ec));
+            connection_.SetIdle(false);
+            connection_.Touch();
+            if (ec == http::error::end_of_stream) {
+                break;
+            }
+            if (ec) {
+                ReportError(ec, "read"sv);
+                co_return;
+            }
+
+            request_handler_(std::move(request_), ResponseSender(this->shared_from_this()), tcp::endpoint(endpoint));
+
+            // Ответ мог быть сформирован синхронно. Иначе ждём, пока его доставит ResponseSender.
+            // Таймер используется как событие: ResponseSender отменяет ожидание
+            while (std::holds_alternative<std::monostate>(response_)) {
+                response_ready_.expires_at(net::steady_timer::time_point::max());
+                co_await response_ready_.async_wait(net::redirect_error(UseAwaitable{}, ec));
+            }
+
+            if (std::holds_alternative<CloseConnection>(response_)) {
+                // Ответа на запрос не будет - клиент повторит его на новом соединении
+                break;
+            }
+            bool close = false;
+            if (auto* string_response = std::get_if<StringResponse>(&response_)) {
+                close = string_response->need_eof();
+                co_await http::async_write(stream_, *string_response, net::redirect_error(UseAwaitable{}, ec));
+            } else if (auto* file_response = std::get_if<FileResponse>(&response_)) {
+                close = file_response->need_eof();
+                co_await http::async_write(stream_, *file_response, net::redirect_error(UseAwaitable{}, ec));
+            }
+            if (ec) {
+                ReportError(ec, "write"sv);
+                co_return;
+            }
+            connection_.Touch();
+            if (close) {
+                // Семантика ответа требует закрыть соединение
+                break;
+            }
+        }
+
+        stream_.socket().shutdown(tcp::socket::shutdown_send, ec);
+    }
+
+    // Поток содержит внутри себя сокет. Таймаут бездействия отслеживает колесо таймеров через connection_
+    Stream stream_;
+    ConnectionSlot connection_;
+    // Буфер для обмена сообщениями
+    beast::flat_buffer buffer_;
+    // Память под запрос. Объявлена раньше него, чтобы быть уничтоженной позже
+    ConnectionArena arena_;
+    // Текущий запрос и ответ на него
+    HttpRequest request_;
+    std::variant<std::monostate, StringResponse, FileResponse, CloseConnection> response_;
+    // Сигнал о готовности ответа
+    net::steady_timer response_ready_;
+    // Память под обработчики, передаваемые между исполнителями
+    HandlerMemory handler_memory_;
+    RequestHandler request_handler_;
+};
+
+}  // namespace http_server
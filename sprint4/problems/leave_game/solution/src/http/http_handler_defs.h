@@ -14,6 +14,8 @@ namespace api_strings {
     constexpr static int              TARGET_POS   = 2;
     constexpr static std::string_view MAPS_PATH    = "maps"sv;
     constexpr static std::string_view GAME_PATH    = "game"sv;
+    constexpr static std::string_view METRICS_PATH = "metrics"sv;
+    constexpr static std::string_view PROFILE_PATH = "profile"sv;
     // --- LVL 3 --- // Action
     constexpr static int              LVL3_POS     = 3;
     constexpr static std::string_view JOIN_PATH    = "join"sv;
@@ -22,9 +24,15 @@ namespace api_strings {
     constexpr static std::string_view PLAYER_PATH  = "player"sv;
     constexpr static std::string_view TICK_PATH    = "tick"sv;
     constexpr static std::string_view RECORDS_PATH = "records"sv;
+    // Управление встроенным профилировщиком (/api/v1/profile/...)
+    constexpr static std::string_view PROFILE_START_PATH  = "start"sv;
+    constexpr static std::string_view PROFILE_STOP_PATH   = "stop"sv;
+    constexpr static std::string_view PROFILE_STACKS_PATH = "stacks"sv;
+    constexpr static std::string_view PROFILE_ZONES_PATH  = "zones"sv;
     // --- LVL 4 --- // 
     constexpr static int              LVL4_POS     = 4;
     constexpr static std::string_view ACTION_PATH  = "action"sv;
+    constexpr static std::string_view BATCH_PATH   = "batch"sv;
 }
 
 namespace ContentType {
@@ -53,8 +61,12 @@ namespace AllowedMethods {
     constexpr static std::string_view PLAYERS       = "GET, HEAD"sv;
     constexpr static std::string_view STATE         = "GET, HEAD"sv;
     constexpr static std::string_view PLAYER_ACTION = "POST"sv;
+    constexpr static std::string_view PLAYER_BATCH  = "POST"sv;
     constexpr static std::string_view TICK          = "POST"sv;
     constexpr static std::string_view RECORDS       = "GET, HEAD"sv;
+    constexpr static std::string_view METRICS       = "GET, HEAD"sv;
+    constexpr static std::string_view PROFILE_CONTROL = "POST"sv;
+    constexpr static std::string_view PROFILE_VIEW    = "GET, HEAD"sv;
     // Для единообразия. Для ошибки на самом деле не нужен допустимый метод.
     constexpr static std::string_view ERROR   = "GET, HEAD"sv;
 };
@@ -64,6 +76,18 @@ namespace HttpFildsValue {
     constexpr static std::string_view NO_CACHE = "no-cache"sv;
 };
 
+namespace StateParams {
+    using namespace std::literals;
+    // Радиус области интереса. Без него выдаётся состояние всей сессии
+    constexpr static std::string_view RADIUS = "radius"sv;
+}
+
+namespace ProfileParams {
+    using namespace std::literals;
+    // Частота сэмплирования при запуске профилировщика, раз в секунду
+    constexpr static std::string_view FREQUENCY = "frequency"sv;
+}
+
 namespace TokenParams {
     using namespace std::literals;
     constexpr static std::string_view START_STR = "Bearer "sv;
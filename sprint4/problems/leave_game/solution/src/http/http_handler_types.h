@@ -3,6 +3,10 @@
 #include <boost/json/conversion.hpp>
 #include <boost/beast/http.hpp>
 #include <chrono>
+#include <string>
+#include <vector>
+
+#include "connection_arena.h"
 
 namespace http_handler {
 
@@ -17,17 +21,42 @@ public:
     std::string direction;
 };
 
+// Несколько действий игрока, выполняемых одним запросом
+class PlayerBatchParams {
+public:
+    std::vector<PlayerActionParams> actions;
+};
+
 class TickParams {
 public:
     std::chrono::milliseconds dt;   // в миллисекундах
 };
 
+// Маршруты API, различаемые при контроле нагрузки
+enum class ApiRoute {
+    Maps,
+    Join,
+    Players,
+    State,
+    PlayerAction,
+    PlayerBatch,
+    Tick,
+    Records,
+    Metrics,
+    Profile,
+    Unknown
+};
+constexpr size_t API_ROUTE_COUNT = static_cast<size_t>(ApiRoute::Unknown) + 1;
+
 namespace beast = boost::beast;
 namespace http = beast::http;
 
 // Запрос, тело которого представлено в виде строки
-using StringRequest = http::request<http::string_body>;
-// Ответ, тело которого представлено в виде строки
+using StringRequest = http::request<http_server::ArenaStringBody, http_server::ArenaFields>;
+// Ответ, тело которого представлено в виде строки.
+// Тело ответа - обычная строка, чтобы сериализованный JSON перемещался в него без копирования.
+// Заголовки ответа размещаются в куче, а не в арене соединения: ответ формируется в strand API
+// одновременно с разбором следующего запроса в арене (см. ConnectionArena)
 using StringResponse = http::response<http::string_body>;
 
 // Ответ, тело которого представлено в виде бинарной последовательности
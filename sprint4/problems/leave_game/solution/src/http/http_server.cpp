@@ -1,7 +1,15 @@
 #include "http_server.h"
 
+#include "sampling_profiler.h"
+
 #include <boost/asio/dispatch.hpp>
 #include <iostream>
+#include <tuple>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
 
 namespace http_server {
 
@@ -11,23 +19,40 @@ void ReportError(beast::error_code ec, std::string_view what) {
 
 // 
 void SessionBase::Run() {
+    // Колесо таймеров держит только слабую ссылку: по таймауту закрываем сессию, если она ещё жива
+    connection_.Arm([weak_self = std::weak_ptr<SessionBase>(GetSharedThis())] {
+        if (auto self = weak_self.lock()) {
+            self->OnIdleTimeout();
+        }
+    });
     // Вызываем метод Read, используя executor объекта stream_.
     // Таким образом вся работа со stream_ будет выполняться, используя его executor
     net::dispatch(stream_.get_executor(),
                 beast::bind_front_handler(&SessionBase::Read, GetSharedThis()));
 }
 
-// Явный конструктор, чтобы предотвратить неявное приведение типов при вызове
-SessionBase::SessionBase(tcp::socket&& socket)
-    : stream_(std::move(socket)) {
+SessionBase::SessionBase(tcp::socket&& socket, ConnectionSlot&& connection)
+    : stream_(std::move(socket))
+    , connection_(std::move(connection))
+    , request_(MakeRequest()) {
+}
+
+SessionBase::HttpRequest SessionBase::MakeRequest() {
+    return HttpRequest(std::piecewise_construct, std::make_tuple(ArenaAllocator<char>(arena_)),
+                       std::make_tuple(ArenaAllocator<char>(arena_)));
 }
 
 // Основной метод чтения запроса
 void SessionBase::Read() {
     using namespace std::literals;
-    // Очищаем запрос от прежнего значения (метод Read может быть вызван несколько раз)
-    request_.clear();
-    stream_.expires_after(30s);
+    reading_ = true;
+    // Очищаем запрос от прежнего значения (метод Read может быть вызван несколько раз).
+    // Запрос пересоздаётся целиком, чтобы освободить всю занятую им память арены.
+    // Строка тела при перемещающем присваивании оставляет себе прежний буфер - освобождаем и его
+    request_ = MakeRequest();
+    request_.body().shrink_to_fit();
+    connection_.Touch();
+    UpdateIdle();
     // Считываем request_ из stream_, используя buffer_ для хранения считанных данных
     http::async_read(stream_, buffer_, request_,
                         // По окончании операции будет вызван метод OnRead
@@ -36,39 +61,150 @@ void SessionBase::Read() {
 
 void SessionBase::OnRead(beast::error_code ec, [[maybe_unused]] std::size_t bytes_read) {
     using namespace std::literals;
+    reading_ = false;
+    connection_.Touch();
+    UpdateIdle();
     if (ec == http::error::end_of_stream) {
-        // Нормальная ситуация - клиент закрыл соединение. Мы тоже закрываем
-        return Close();
+        // Нормальная ситуация - клиент закрыл соединение. Мы тоже закрываем,
+        // но только после того, как запишем ответы на уже прочитанные запросы
+        read_closed_ = true;
+        if (!writing_ && pending_writes_.empty()) {
+            Close();
+        }
+        return;
     }
     if (ec) {
+        read_closed_ = true;
         return ReportError(ec, "read"sv);
     }
-    HandleRequest(std::move(request_));
+
+    // Соединение уже решено закрыть (CloseConnection), пока этот запрос читался: ответа на него не будет
+    if (read_closed_) {
+        return;
+    }
+    // Запрос без keep-alive последний: после ответа на него соединение будет закрыто
+    read_closed_ = !request_.keep_alive();
+
+    // Резервируем место под ответ до вызова обработчика - он может ответить сразу
+    const size_t index = first_pending_index_ + pending_writes_.size();
+    pending_writes_.emplace_back();
+    HandleRequest(std::move(request_), index);
+
+    // Читаем следующий запрос, не дожидаясь ответа на этот
+    ReadAhead();
+}
+
+void SessionBase::ReadAhead() {
+    if (!reading_ && !read_closed_ && pending_writes_.size() < MAX_PIPELINED_REQUESTS) {
+        Read();
+    }
 }
 
 // Закрытие соединения потока stream_
 void SessionBase::Close() {
     beast::error_code ec;
-    stream_.socket().shutdown(tcp::socket::shutdown_send);
+    stream_.socket().shutdown(tcp::socket::shutdown_send, ec);
+}
+
+void SessionBase::OnIdleTimeout() {
+    // Вызывается в потоке колеса таймеров, а сокет закрываем в исполнителе сессии
+    net::dispatch(stream_.get_executor(), [self = GetSharedThis()] {
+        self->stream_.close();
+    });
+}
+
+void SessionBase::UpdateIdle() {
+    const bool idle = reading_ && !writing_ && pending_writes_.empty();
+    connection_.SetIdle(idle);
+    if (idle) {
+        // Пока соединение ждёт запрос, блок арены ему не нужен: отдаём его другим соединениям потока
+        arena_.Release();
+    }
+}
+
+void SessionBase::Write(size_t index, CloseConnection) {
+    net::dispatch(stream_.get_executor(), [self = GetSharedThis(), index] {
+        // Следующие запросы не читаются, соединение закрывается, как после ответа с Connection: close
+        self->read_closed_ = true;
+        self->EnqueueWrite(index, [self] {
+            self->OnWrite(true, {}, 0);
+        });
+    });
+}
+
+void SessionBase::EnqueueWrite(size_t index, std::function<void()> write) {
+    pending_writes_[index - first_pending_index_] = std::move(write);
+    WriteNext();
+}
+
+void SessionBase::WriteNext() {
+    // Пишем только первый в очереди ответ - более поздние ждут, даже если уже готовы
+    if (writing_ || pending_writes_.empty() || !pending_writes_.front()) {
+        return;
+    }
+    writing_ = true;
+    UpdateIdle();
+    auto write = std::move(pending_writes_.front());
+    pending_writes_.pop_front();
+    ++first_pending_index_;
+    write();
 }
 
 void SessionBase::OnWrite(bool close, beast::error_code ec, [[maybe_unused]] std::size_t bytes_written) {
+    writing_ = false;
+    connection_.Touch();
     if (ec) {
         return ReportError(ec, "write"sv);
     }
 
-    if (close) {
-        // Семантика ответа требует закрыть соединение
+    if (close || (read_closed_ && pending_writes_.empty())) {
+        // Семантика ответа требует закрыть соединение, либо клиент больше ничего не пришлёт
         return Close();
     }
 
-    // Считываем следующий запрос
-    Read();
+    // Место в конвейере освободилось - можно читать следующий запрос
+    ReadAhead();
+    WriteNext();
+    UpdateIdle();
 }
 
 boost::asio::ip::tcp::endpoint SessionBase::GetEndpoint() {
     return stream_.socket().remote_endpoint();
 }
 
+IoContextPool::IoContextPool(unsigned size) {
+    size = std::max(1u, size);
+    contexts_.reserve(size);
+    for (unsigned i = 0; i < size; ++i) {
+        // Каждый io_context обслуживается одним потоком
+        contexts_.push_back(std::make_unique<net::io_context>(1));
+    }
+}
+
+void IoContextPool::Start() {
+    const unsigned n_cores = std::max(1u, std::thread::hardware_concurrency());
+    threads_.reserve(contexts_.size());
+    for (size_t i = 0; i < contexts_.size(); ++i) {
+        auto& thread = threads_.emplace_back([&ioc = *contexts_[i]] {
+            profiler::RegisterThread();
+            ioc.run();
+        });
+#ifdef __linux__
+        // Закрепляем поток за ядром. Неудача не критична - поток просто останется "плавающим"
+        cpu_set_t cpu_set;
+        CPU_ZERO(&cpu_set);
+        CPU_SET(i % n_cores, &cpu_set);
+        pthread_setaffinity_np(thread.native_handle(), sizeof(cpu_set), &cpu_set);
+#endif
+    }
+}
+
+void IoContextPool::Stop() {
+    for (auto& ioc : contexts_) {
+        ioc->stop();
+    }
+    // jthread дожидается завершения потока в деструкторе
+    threads_.clear();
+}
 
 }  // namespace http_server
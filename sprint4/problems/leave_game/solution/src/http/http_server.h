@@ -1,12 +1,21 @@
 #pragma once
 #include "sdk.h"
+#include "connection_arena.h"
+#include "connection_manager.h"
 
+#include <boost/asio/dispatch.hpp>
 #include <boost/asio/ip/tcp.hpp>
 #include <boost/asio/strand.hpp>
+#include <boost/asio/write.hpp>
 #include <boost/beast/core.hpp>
 #include <boost/beast/http.hpp>
 
+#include <deque>
+#include <functional>
 #include <iostream>
+#include <memory>
+#include <thread>
+#include <vector>
 
 namespace http_server {
 
@@ -21,6 +30,10 @@ using namespace std::literals;
 
 void ReportError(beast::error_code ec, std::string_view what);
 
+// Вместо ответа: соединение закрывается после записи ответов на предыдущие запросы.
+// Клиент не получает ответа на этот запрос и повторяет его на новом соединении
+struct CloseConnection {};
+
 // Базовый класс сессии
 class SessionBase {
 public:
@@ -29,46 +42,88 @@ public:
     boost::asio::ip::tcp::endpoint GetEndpoint();
 
 protected:
-    // Обёртка для http-запроса, где тело запроса представлено строкой
-    using HttpRequest = http::request<http::string_body>;
+    // Обёртка для http-запроса, где тело запроса представлено строкой.
+    // Заголовки и тело размещаются в арене соединения
+    using HttpRequest = http::request<ArenaStringBody, ArenaFields>;
     // Запрещаем копирование и присваивание объектов SessionBase и его наследников
     SessionBase(const SessionBase&) = delete;
     SessionBase& operator=(const SessionBase&) = delete;
     ~SessionBase() = default;
-    // Явный конструктор, чтобы предотвратить неявное приведение типов при вызове
-    explicit SessionBase(tcp::socket&& socket);
-    // Шаблонная функция записи ответа. Body и Fields являются параметрами шаблона http::response
+    // Конструктор сессии на сокете socket, занявшей место connection в ConnectionManager
+    SessionBase(tcp::socket&& socket, ConnectionSlot&& connection);
+    // Шаблонная функция записи ответа на запрос с порядковым номером index.
+    // Body и Fields являются параметрами шаблона http::response
     template <typename Body, typename Fields>
-    void Write(http::response<Body, Fields>&& response) {
+    void Write(size_t index, http::response<Body, Fields>&& response) {
         // Запись выполняется асинхронно, поэтому response перемещаем в область кучи
         auto safe_response = std::make_shared<http::response<Body, Fields>>(std::move(response));
 
         auto self = GetSharedThis();
-        http::async_write(stream_, *safe_response,
-                            [safe_response, self](beast::error_code ec, std::size_t bytes_written) {
-                                self->OnWrite(safe_response->need_eof(), ec, bytes_written);
-                            });
-}
+        // Ответ может быть сформирован в другом потоке (strand API), а очередь ответов
+        // изменяется только в strand сессии
+        net::dispatch(stream_.get_executor(), [self, index, safe_response] {
+            self->EnqueueWrite(index, [self, safe_response] {
+                http::async_write(self->stream_, *safe_response,
+                                    [self, safe_response](beast::error_code ec, std::size_t bytes_written) {
+                                        self->OnWrite(safe_response->need_eof(), ec, bytes_written);
+                                    });
+            });
+        });
+    }
+
+    // Закрывает соединение вместо ответа на запрос с порядковым номером index
+    void Write(size_t index, CloseConnection);
 
 private:
+    // Пустой запрос, память под который выделяется в арене соединения
+    HttpRequest MakeRequest();
     // Основной метод чтения запроса
     void Read();
     void OnRead(beast::error_code ec, [[maybe_unused]] std::size_t bytes_read);
+    // Начинает чтение следующего запроса, если конвейер запросов не заполнен
+    void ReadAhead();
     // Закрытие соединения потока stream_
     void Close();
+    // Соединение не продлевали дольше таймаута бездействия - закрываем сокет,
+    // ожидающие операции завершатся с ошибкой
+    void OnIdleTimeout();
+    // Соединение простаивает, если ждёт новый запрос, а ответов в работе нет
+    void UpdateIdle();
+    // Кладёт готовый ответ на место в очереди и запускает запись, если подошла его очередь
+    void EnqueueWrite(size_t index, std::function<void()> write);
+    void WriteNext();
     void OnWrite(bool close, beast::error_code ec, [[maybe_unused]] std::size_t bytes_written);
-    // Обработку запроса делегируем подклассу
-    virtual void HandleRequest(HttpRequest&& request) = 0;
+    // Обработку запроса делегируем подклассу. index - порядковый номер запроса в соединении,
+    // который нужно передать в Write вместе с ответом
+    virtual void HandleRequest(HttpRequest&& request, size_t index) = 0;
     // Виртуальная функция получения указателя на собсвенный класс
     virtual std::shared_ptr<SessionBase> GetSharedThis() = 0;
 
 private:
-    // tcp_stream содержит внутри себя сокет и добавляет поддержку таймаутов
+    // tcp_stream содержит внутри себя сокет. Собственные таймауты потока не используются:
+    // таймаут бездействия отслеживает общее колесо таймеров через connection_
     beast::tcp_stream stream_;
+    ConnectionSlot connection_;
     // Буфер для обмена сообщениями
     beast::flat_buffer buffer_;
+    // Память под запросы. Объявлена раньше них, чтобы быть уничтоженной позже
+    ConnectionArena arena_;
     // Непосредственно запрос от клиента
     HttpRequest request_;
+
+    // Конвейерная обработка (HTTP/1.1 pipelining): следующий запрос читается, не дожидаясь
+    // ответа на предыдущий, а ответы записываются строго в порядке поступления запросов.
+    // Максимальное число запросов, ожидающих ответа
+    static constexpr size_t MAX_PIPELINED_REQUESTS = 16;
+    // Записи ответов на запросы, ожидающие ответа, в порядке их поступления.
+    // Пустая функция - ответ ещё не сформирован
+    std::deque<std::function<void()>> pending_writes_;
+    // Порядковый номер запроса, ответ на который стоит первым в очереди
+    size_t first_pending_index_ = 0;
+    bool reading_ = false;
+    bool writing_ = false;
+    // Новых запросов больше не будет: клиент закрыл соединение или попросил закрыть его после ответа
+    bool read_closed_ = false;
 };
 
 // Класс, реализующий обработку сессии. Обработчик определяется типом RequestHandler
@@ -78,19 +133,19 @@ class Session : public SessionBase, public std::enable_shared_from_this<Session<
 public:
     // Конструктор, который создаёт сессию на заданном сокете socket с обработчиком request_handler
     template <typename Handler>
-    Session(tcp::socket&& socket, Handler&& request_handler)
-        : SessionBase(std::move(socket))
+    Session(tcp::socket&& socket, Handler&& request_handler, ConnectionSlot&& connection)
+        : SessionBase(std::move(socket), std::move(connection))
         , request_handler_(std::forward<Handler>(request_handler)) {
     }
 
 private:
-    void HandleRequest(HttpRequest&& request) override {
+    void HandleRequest(HttpRequest&& request, size_t index) override {
         auto endpoint = this->GetEndpoint();
         // Захватываем умный указатель на текущий объект Session в лямбде,
         // чтобы продлить время жизни сессии до вызова лямбды.
         // Используется generic-лямбда функция, способная принять response произвольного типа
-        request_handler_(std::move(request), [self = this->shared_from_this()](auto&& response) {
-            self->Write(std::move(response));
+        request_handler_(std::move(request), [self = this->shared_from_this(), index](auto&& response) {
+            self->Write(index, std::move(response));
         },
         std::move(endpoint));
     }
@@ -104,15 +159,72 @@ private:
     RequestHandler request_handler_;
 };
 
-template <typename RequestHandler>
-class Listener : public std::enable_shared_from_this<Listener<RequestHandler>> {
+// Запущенный acceptor. Нужен, чтобы при горячем перезапуске передать слушающий сокет новому процессу
+class ListenerControl {
 public:
+    // Дескриптор слушающего сокета
+    virtual int GetNativeHandle() const noexcept = 0;
+    // Прекращает приём соединений и закрывает сокет. Принятые соединения продолжают обслуживаться
+    virtual void Stop() = 0;
+    // Приостанавливает приём соединений, не закрывая сокет: новые соединения ждут в его очереди
+    virtual void Pause() = 0;
+    // Возобновляет приём соединений после Pause
+    virtual void Resume() = 0;
+
+protected:
+    ~ListenerControl() = default;
+};
+
+using Listeners = std::vector<std::shared_ptr<ListenerControl>>;
+
+// Булева опция сокета уровня SOL_SOCKET для acceptor::set_option.
+// Реализует требования SettableSocketOption из asio, не опираясь на его внутреннее пространство detail
+template <int Name>
+class BooleanSocketOption {
+public:
+    explicit BooleanSocketOption(bool value) noexcept
+        : value_{value ? 1 : 0} {
+    }
+
+    template <typename Protocol>
+    int level(const Protocol&) const noexcept {
+        return SOL_SOCKET;
+    }
+
+    template <typename Protocol>
+    int name(const Protocol&) const noexcept {
+        return Name;
+    }
+
+    template <typename Protocol>
+    const void* data(const Protocol&) const noexcept {
+        return &value_;
+    }
+
+    template <typename Protocol>
+    std::size_t size(const Protocol&) const noexcept {
+        return sizeof(value_);
+    }
+
+private:
+    int value_;
+};
+
+// Тип сессии задаётся параметром SessionType: по умолчанию Session на колбэках,
+// либо CoroSession на корутинах (http_coro_session.h)
+template <typename RequestHandler, template <typename> class SessionType = Session>
+class Listener : public ListenerControl, public std::enable_shared_from_this<Listener<RequestHandler, SessionType>> {
+public:
+    // reuse_port разрешает нескольким acceptor слушать один и тот же порт (SO_REUSEPORT).
+    // Ядро ОС само распределяет входящие соединения между ними
     template <typename Handler>
-    Listener(net::io_context& ioc, const tcp::endpoint& endpoint, Handler&& request_handler)
+    Listener(net::io_context& ioc, const tcp::endpoint& endpoint, Handler&& request_handler,
+             std::shared_ptr<ConnectionManager> connections, bool reuse_port = false)
         : ioc_(ioc)
         // Обработчики асинхронных операций acceptor_ будут вызываться в своём strand
         , acceptor_(net::make_strand(ioc))
-        , request_handler_(std::forward<Handler>(request_handler)) {
+        , request_handler_(std::forward<Handler>(request_handler))
+        , connections_(std::move(connections)) {
         // Открываем acceptor, используя протокол (IPv4 или IPv6), указанный в endpoint
         acceptor_.open(endpoint.protocol());
 
@@ -121,18 +233,64 @@ public:
         // Однако это может помешать повторно открыть сокет в полузакрытом состоянии.
         // Флаг reuse_address разрешает открыть сокет, когда он "наполовину закрыт"
         acceptor_.set_option(net::socket_base::reuse_address(true));
+        if (reuse_port) {
+            acceptor_.set_option(ReusePort(true));
+        }
         // Привязываем acceptor к адресу и порту endpoint
         acceptor_.bind(endpoint);
         // Переводим acceptor в состояние, в котором он способен принимать новые соединения
         // Благодаря этому новые подключения будут помещаться в очередь ожидающих соединений
         acceptor_.listen(net::socket_base::max_listen_connections);
+        native_handle_ = acceptor_.native_handle();
+    }
+
+    // Принимает соединения на уже слушающем сокете, полученном от предыдущего процесса сервера
+    template <typename Handler>
+    Listener(net::io_context& ioc, const tcp::endpoint& endpoint, int native_handle, Handler&& request_handler,
+             std::shared_ptr<ConnectionManager> connections)
+        : ioc_(ioc)
+        , acceptor_(net::make_strand(ioc))
+        , request_handler_(std::forward<Handler>(request_handler))
+        , connections_(std::move(connections))
+        , native_handle_(native_handle) {
+        acceptor_.assign(endpoint.protocol(), native_handle);
     }
 
     void Run() {
         DoAccept();
     }
 
+    int GetNativeHandle() const noexcept override {
+        return native_handle_;
+    }
+
+    void Stop() override {
+        net::dispatch(acceptor_.get_executor(), [self = this->shared_from_this()] {
+            sys::error_code ec;
+            self->acceptor_.close(ec);
+        });
+    }
+
+    void Pause() override {
+        net::dispatch(acceptor_.get_executor(), [self = this->shared_from_this()] {
+            self->is_paused_ = true;
+            sys::error_code ec;
+            self->acceptor_.cancel(ec);
+        });
+    }
+
+    void Resume() override {
+        net::dispatch(acceptor_.get_executor(), [self = this->shared_from_this()] {
+            if (self->is_paused_ && self->acceptor_.is_open()) {
+                self->is_paused_ = false;
+                self->DoAccept();
+            }
+        });
+    }
+
 private:
+    using ReusePort = BooleanSocketOption<SO_REUSEPORT>;
+
     void DoAccept() {
         acceptor_.async_accept(
             // Передаём последовательный исполнитель, в котором будут вызываться обработчики
@@ -153,38 +311,134 @@ private:
     void OnAccept(sys::error_code ec, tcp::socket socket) {
         using namespace std::literals;
 
+        if (ec == net::error::operation_aborted) {
+            return;     // acceptor остановлен или приостановлен
+        }
         if (ec) {
             return ReportError(ec, "accept"sv);
         }
 
-        // Асинхронно обрабатываем сессию
-        AsyncRunSession(std::move(socket));
+        if (auto connection = connections_->TryOpen()) {
+            // Асинхронно обрабатываем сессию
+            AsyncRunSession(std::move(socket), std::move(*connection));
+        } else {
+            RejectConnection(std::move(socket));
+        }
 
-        // Принимаем новое соединение
-        DoAccept();
+        // Принимаем новое соединение. Соединение, принятое до приостановки, ещё обслуживается
+        if (!is_paused_) {
+            DoAccept();
+        }
     }
 
     // Асинхронно обрабатывает сессию
-    void AsyncRunSession(tcp::socket&& socket) {
+    void AsyncRunSession(tcp::socket&& socket, ConnectionSlot&& connection) {
         // Создаём шаред указатель на сессию. Ссесия создаётся через конструктор и по указателю
         // вызывается метод Run()
-        std::make_shared<Session<RequestHandler>>(std::move(socket), request_handler_)->Run();
+        std::make_shared<SessionType<RequestHandler>>(std::move(socket), request_handler_, std::move(connection))->Run();
+    }
+
+    // Лимит соединений исчерпан: вместо молчаливого разрыва отвечаем клиенту 503
+    // и закрываем соединение, не читая запрос
+    void RejectConnection(tcp::socket&& socket) {
+        static constexpr std::string_view REJECT_RESPONSE =
+            "HTTP/1.1 503 Service Unavailable\r\nConnection: close\r\nContent-Length: 0\r\n\r\n"sv;
+
+        connections_->OnRejected();
+        auto safe_socket = std::make_shared<tcp::socket>(std::move(socket));
+        net::async_write(*safe_socket, net::buffer(REJECT_RESPONSE),
+                         [safe_socket](sys::error_code ec, [[maybe_unused]] std::size_t bytes_written) {
+                             safe_socket->shutdown(tcp::socket::shutdown_both, ec);
+                         });
     }
 
 private:
     net::io_context& ioc_;
     tcp::acceptor acceptor_;
     RequestHandler request_handler_;
+    std::shared_ptr<ConnectionManager> connections_;
+    int native_handle_ = -1;
+    // Изменяется и читается в strand acceptor_
+    bool is_paused_ = false;
 };
 
-// Функция запуска сервера
-template <typename RequestHandler>
-void ServeHttp(net::io_context& ioc, const tcp::endpoint& endpoint, RequestHandler&& handler) {
+// Функция запуска сервера. Если переданы слушающие сокеты предыдущего процесса (горячий перезапуск),
+// соединения принимаются на них, иначе открывается новый acceptor
+template <template <typename> class SessionType = Session, typename RequestHandler>
+Listeners ServeHttp(net::io_context& ioc, const tcp::endpoint& endpoint, RequestHandler&& handler,
+                    std::shared_ptr<ConnectionManager> connections, const std::vector<int>& inherited_fds = {}) {
     // При помощи decay_t исключим ссылки из типа RequestHandler,
     // чтобы Listener хранил RequestHandler по значению
-    using MyListener = Listener<std::decay_t<RequestHandler>>;
+    using MyListener = Listener<std::decay_t<RequestHandler>, SessionType>;
+
+    Listeners listeners;
+    if (inherited_fds.empty()) {
+        listeners.push_back(std::make_shared<MyListener>(ioc, endpoint, std::forward<RequestHandler>(handler), std::move(connections)));
+    }
+    for (int fd : inherited_fds) {
+        listeners.push_back(std::make_shared<MyListener>(ioc, endpoint, fd, handler, connections));
+    }
+    for (auto& listener : listeners) {
+        std::static_pointer_cast<MyListener>(listener)->Run();
+    }
+    return listeners;
+}
 
-    std::make_shared<MyListener>(ioc, endpoint, std::forward<RequestHandler>(handler))->Run();
+// Пул io_context для режима "поток на ядро".
+// Каждый io_context обслуживается ровно одним потоком, закреплённым за своим ядром,
+// поэтому соединение от принятия до закрытия обрабатывается на одном ядре
+// и потоки не конкурируют за общую очередь обработчиков
+class IoContextPool {
+public:
+    explicit IoContextPool(unsigned size);
+
+    IoContextPool(const IoContextPool&) = delete;
+    IoContextPool& operator=(const IoContextPool&) = delete;
+
+    ~IoContextPool() {
+        Stop();
+    }
+
+    size_t Size() const noexcept {
+        return contexts_.size();
+    }
+
+    net::io_context& Get(size_t index) {
+        return *contexts_.at(index);
+    }
+
+    // Запускает по потоку на каждый io_context и сразу возвращает управление
+    void Start();
+    // Останавливает все io_context и дожидается завершения потоков
+    void Stop();
+
+private:
+    std::vector<std::unique_ptr<net::io_context>> contexts_;
+    std::vector<std::jthread> threads_;
+};
+
+// Функция запуска сервера в режиме "поток на ядро": на каждый io_context из пула
+// создаётся свой acceptor на одном и том же порту (SO_REUSEPORT).
+// Слушающие сокеты предыдущего процесса распределяются по io_context пула: их число
+// может не совпадать с размером пула, а новые сокеты к ним не добавить, если у них нет SO_REUSEPORT
+template <template <typename> class SessionType = Session, typename RequestHandler>
+Listeners ServeHttpPerCore(IoContextPool& pool, const tcp::endpoint& endpoint, const RequestHandler& handler,
+                           const std::shared_ptr<ConnectionManager>& connections, const std::vector<int>& inherited_fds = {}) {
+    using MyListener = Listener<std::decay_t<RequestHandler>, SessionType>;
+
+    Listeners listeners;
+    if (inherited_fds.empty()) {
+        for (size_t i = 0; i < pool.Size(); ++i) {
+            listeners.push_back(std::make_shared<MyListener>(pool.Get(i), endpoint, handler, connections, true));
+        }
+    }
+    for (size_t i = 0; i < inherited_fds.size(); ++i) {
+        listeners.push_back(std::make_shared<MyListener>(pool.Get(i % pool.Size()), endpoint, inherited_fds[i], handler, connections));
+    }
+    for (auto& listener : listeners) {
+        std::static_pointer_cast<MyListener>(listener)->Run();
+    }
+    return listeners;
 }
 
 }  // namespace http_server
@@ -0,0 +1,184 @@
+#include "rate_limiter.h"
+
+#include "http_handler_defs.h"
+#include "utils.h"
+
+#include <algorithm>
+#include <bit>
+#include <charconv>
+#include <functional>
+
+namespace http_handler {
+
+namespace {
+
+// Соли ключей, чтобы корзины токена и IP-адреса с одинаковым хешем не совпали
+constexpr uint64_t TOKEN_KEY_SALT = 0x9E3779B97F4A7C15ull;
+constexpr uint64_t IP_KEY_SALT = 0xC2B2AE3D27D4EB4Full;
+
+uint64_t MakeKey(uint64_t hash, ApiRoute route, uint64_t salt) noexcept {
+    uint64_t key = (hash ^ salt) * 0xFF51AFD7ED558CCDull + static_cast<uint64_t>(route);
+    key ^= key >> 33;
+    // Ноль обозначает свободную ячейку таблицы
+    return key == 0 ? 1 : key;
+}
+
+uint64_t HashAddress(const boost::asio::ip::address& ip) noexcept {
+    if (ip.is_v4()) {
+        return ip.to_v4().to_uint();
+    }
+    const auto bytes = ip.to_v6().to_bytes();
+    return std::hash<std::string_view>{}(std::string_view(reinterpret_cast<const char*>(bytes.data()), bytes.size()));
+}
+
+std::optional<ApiRoute> RouteFromName(std::string_view name) {
+    if (name == api_strings::MAPS_PATH) {
+        return ApiRoute::Maps;
+    } else if (name == api_strings::JOIN_PATH) {
+        return ApiRoute::Join;
+    } else if (name == api_strings::PLAYERS_PATH) {
+        return ApiRoute::Players;
+    } else if (name == api_strings::STATE_PATH) {
+        return ApiRoute::State;
+    } else if (name == api_strings::ACTION_PATH) {
+        return ApiRoute::PlayerAction;
+    } else if (name == api_strings::BATCH_PATH) {
+        return ApiRoute::PlayerBatch;
+    } else if (name == api_strings::TICK_PATH) {
+        return ApiRoute::Tick;
+    } else if (name == api_strings::RECORDS_PATH) {
+        return ApiRoute::Records;
+    }
+    return std::nullopt;
+}
+
+// Группа счётчиков статистики текущего потока. Потоки получают группы по кругу
+size_t CounterShard(size_t shards) noexcept {
+    static std::atomic<size_t> next_shard = 0;
+    thread_local const size_t shard = next_shard.fetch_add(1, std::memory_order_relaxed);
+    return shard % shards;
+}
+
+bool ParseRate(std::string_view str, uint32_t& rate) {
+    const auto [ptr, ec] = std::from_chars(str.data(), str.data() + str.size(), rate);
+    return ec == std::errc{} && ptr == str.data() + str.size();
+}
+
+}  // namespace
+
+std::optional<std::pair<ApiRoute, RouteBudget>> ParseRouteBudget(std::string_view str) {
+    const auto eq_pos = str.find('=');
+    if (eq_pos == str.npos) {
+        return std::nullopt;
+    }
+    const auto route = RouteFromName(str.substr(0, eq_pos));
+    if (!route) {
+        return std::nullopt;
+    }
+
+    // Бюджет IP-адреса можно не указывать: "state=20"
+    auto rates = str.substr(eq_pos + 1);
+    const auto slash_pos = rates.find('/');
+    RouteBudget budget;
+    if (!ParseRate(rates.substr(0, slash_pos), budget.token_rate)) {
+        return std::nullopt;
+    }
+    if (slash_pos != rates.npos && !ParseRate(rates.substr(slash_pos + 1), budget.ip_rate)) {
+        return std::nullopt;
+    }
+    return std::make_pair(*route, budget);
+}
+
+RateLimiter::RateLimiter(RateLimitConfig config, size_t capacity)
+    : config_(config)
+    , start_(Clock::now())
+    , mask_(std::bit_ceil(std::max<size_t>(capacity, MAX_PROBES)) - 1)
+    , buckets_(std::make_unique<Bucket[]>(mask_ + 1)) {
+}
+
+bool RateLimiter::Allow(ApiRoute route, std::string_view token, const boost::asio::ip::address& ip,
+                        Clock::time_point now) noexcept {
+    const auto& budget = config_[route];
+    if (budget.token_rate == 0 && budget.ip_rate == 0) {
+        return true;
+    }
+
+    // Отсчёт с единицы, чтобы состояние корзины после первого запроса не было нулевым
+    const uint64_t now_ms = std::chrono::duration_cast<std::chrono::milliseconds>(now - start_).count() + 1;
+
+    bool allowed = true;
+    // Запрос с токеном неправильного формата всё равно будет отклонён API - ограничиваем его только по адресу
+    if (budget.token_rate != 0 && utils::validators::IsValidToken(token)) {
+        const uint64_t key = MakeKey(std::hash<std::string_view>{}(token), route, TOKEN_KEY_SALT);
+        allowed = TryConsume(FindBucket(key, now_ms), budget.token_rate, now_ms);
+    }
+    if (allowed && budget.ip_rate != 0) {
+        const uint64_t key = MakeKey(HashAddress(ip), route, IP_KEY_SALT);
+        allowed = TryConsume(FindBucket(key, now_ms), budget.ip_rate, now_ms);
+    }
+
+    auto& counters = counters_[CounterShard(COUNTER_SHARDS)];
+    (allowed ? counters.allowed : counters.rejected).fetch_add(1, std::memory_order_relaxed);
+    return allowed;
+}
+
+RateLimiter::Stats RateLimiter::GetStats() const noexcept {
+    Stats stats;
+    for (const auto& counters : counters_) {
+        stats.allowed += counters.allowed.load(std::memory_order_relaxed);
+        stats.rejected += counters.rejected.load(std::memory_order_relaxed);
+    }
+    return stats;
+}
+
+RateLimiter::Bucket& RateLimiter::FindBucket(uint64_t key, uint64_t now_ms) noexcept {
+    const size_t start = key & mask_;
+    for (size_t probe = 0; probe < MAX_PROBES; ++probe) {
+        auto& bucket = buckets_[(start + probe) & mask_];
+        uint64_t bucket_key = bucket.key.load(std::memory_order_acquire);
+        if (bucket_key == key) {
+            return bucket;
+        }
+        if (bucket_key == 0) {
+            // Занимаем свободную ячейку. Если её перехватили, это могла быть корзина с тем же ключом
+            if (bucket.key.compare_exchange_strong(bucket_key, key, std::memory_order_acq_rel) || bucket_key == key) {
+                return bucket;
+            }
+        }
+    }
+
+    // Свободных ячеек поблизости нет - вытесняем корзину в начальной ячейке.
+    // Новая корзина пуста и пополняется с текущего момента
+    auto& bucket = buckets_[start];
+    bucket.key.store(key, std::memory_order_release);
+    bucket.state.store(now_ms << TOKENS_BITS, std::memory_order_release);
+    return bucket;
+}
+
+bool RateLimiter::TryConsume(Bucket& bucket, uint32_t rate, uint64_t now_ms) noexcept {
+    const uint64_t capacity = std::min<uint64_t>(uint64_t(rate) * REQUEST_COST, TOKENS_MASK);
+
+    uint64_t state = bucket.state.load(std::memory_order_relaxed);
+    for (;;) {
+        const uint64_t last_ms = state >> TOKENS_BITS;
+        uint64_t tokens = state & TOKENS_MASK;
+        if (state == 0) {
+            // Новая корзина
+            tokens = capacity;
+        } else if (now_ms > last_ms) {
+            // За миллисекунду корзина пополняется на rate тысячных долей запроса.
+            // Прошедшее время ограничено, чтобы произведение не переполнилось
+            const uint64_t elapsed = std::min<uint64_t>(now_ms - last_ms, TOKENS_MASK);
+            tokens = std::min(capacity, tokens + elapsed * rate);
+        }
+        if (tokens < REQUEST_COST) {
+            return false;
+        }
+        const uint64_t new_state = (std::max(now_ms, last_ms) << TOKENS_BITS) | (tokens - REQUEST_COST);
+        if (bucket.state.compare_exchange_weak(state, new_state, std::memory_order_relaxed)) {
+            return true;
+        }
+    }
+}
+
+}  // namespace http_handler
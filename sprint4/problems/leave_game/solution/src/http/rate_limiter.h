@@ -0,0 +1,108 @@
+#pragma once
+
+#include "http_handler_types.h"
+
+#include <boost/asio/ip/address.hpp>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string_view>
+
+namespace http_handler {
+
+// Бюджет запросов к одному маршруту API. 0 - без ограничения.
+// Корзина вмещает запросы за одну секунду, поэтому короткий всплеск до rate запросов допустим
+struct RouteBudget {
+    // Запросов в секунду на один токен игрока
+    uint32_t token_rate = 0;
+    // Запросов в секунду на один IP-адрес клиента
+    uint32_t ip_rate = 0;
+};
+
+struct RateLimitConfig {
+    std::array<RouteBudget, API_ROUTE_COUNT> routes{};
+
+    RouteBudget& operator[](ApiRoute route) {
+        return routes[static_cast<size_t>(route)];
+    }
+    const RouteBudget& operator[](ApiRoute route) const {
+        return routes[static_cast<size_t>(route)];
+    }
+};
+
+// Разбирает описание бюджета маршрута вида "state=20/200" (токен/IP).
+// Возвращает nullopt, если маршрут неизвестен или описание некорректно
+std::optional<std::pair<ApiRoute, RouteBudget>> ParseRouteBudget(std::string_view str);
+
+// Ограничитель частоты запросов по алгоритму token bucket.
+// Корзины ключуются парой (маршрут, токен игрока) и парой (маршрут, IP-адрес клиента)
+// и лежат в хеш-таблице фиксированного размера с открытой адресацией.
+// Корзина токена заводится только для токена правильного формата: иначе клиент, меняя
+// произвольный токен, получал бы новую корзину на каждый запрос.
+// Состояние корзины - одно 64-битное слово (время последнего пополнения и запас),
+// которое обновляется через compare_exchange, поэтому блокировок нет.
+// Отказ не пишет в общую память: проверка сводится к хешу ключа и нескольким атомарным чтениям.
+// При переполнении таблицы новая корзина вытесняет старую - ограничение становится
+// приблизительным, но память остаётся постоянной. Вытеснившая корзина начинает пустой
+// и наполняется со временем, поэтому перебором ключей нельзя получить свежий бюджет.
+// Счётчики статистики разнесены по потокам, чтобы запросы разных потоков не писали в одну кэш-линию
+class RateLimiter {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    struct Stats {
+        size_t allowed = 0;
+        size_t rejected = 0;
+    };
+
+    // capacity округляется вверх до степени двойки
+    explicit RateLimiter(RateLimitConfig config, size_t capacity = 1 << 16);
+
+    RateLimiter(const RateLimiter&) = delete;
+    RateLimiter& operator=(const RateLimiter&) = delete;
+
+    // Списывает запрос из корзин токена (если он передан) и IP-адреса.
+    // false - бюджет одной из корзин исчерпан
+    bool Allow(ApiRoute route, std::string_view token, const boost::asio::ip::address& ip,
+               Clock::time_point now = Clock::now()) noexcept;
+
+    Stats GetStats() const noexcept;
+
+private:
+    struct Bucket {
+        std::atomic<uint64_t> key = 0;
+        // Старшие биты - время последнего пополнения в миллисекундах от создания ограничителя,
+        // младшие TOKENS_BITS - запас в тысячных долях запроса. Ноль - полная корзина
+        std::atomic<uint64_t> state = 0;
+    };
+
+    // Счётчики статистики одной группы потоков, каждая в своей кэш-линии
+    struct alignas(64) Counters {
+        std::atomic<size_t> allowed = 0;
+        std::atomic<size_t> rejected = 0;
+    };
+
+    static constexpr unsigned TOKENS_BITS = 24;
+    static constexpr uint64_t TOKENS_MASK = (uint64_t(1) << TOKENS_BITS) - 1;
+    // Один запрос в тысячных долях
+    static constexpr uint64_t REQUEST_COST = 1000;
+    // Сколько соседних ячеек просматривается при поиске корзины
+    static constexpr size_t MAX_PROBES = 8;
+    // На сколько групп разнесены счётчики статистики
+    static constexpr size_t COUNTER_SHARDS = 16;
+
+    Bucket& FindBucket(uint64_t key, uint64_t now_ms) noexcept;
+    static bool TryConsume(Bucket& bucket, uint32_t rate, uint64_t now_ms) noexcept;
+
+    const RateLimitConfig config_;
+    const Clock::time_point start_;
+    size_t mask_;
+    std::unique_ptr<Bucket[]> buckets_;
+    std::array<Counters, COUNTER_SHARDS> counters_;
+};
+
+}  // namespace http_handler
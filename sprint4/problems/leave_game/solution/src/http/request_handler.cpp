@@ -1,26 +1,197 @@
 #include "request_handler.h"
 
+#include "http_handler_defs.h"
+#include "json_fields.h"
+#include "sampling_profiler.h"
+
 #include "boost/beast/http/status.hpp"
 #include <boost/beast/http/file_body.hpp>
 #include <boost/json.hpp>
 #include <boost/url.hpp>
+#include <algorithm>
+#include <charconv>
 #include <string_view>
 
 namespace http_handler {
 
+namespace {
+
+// Частота из параметра frequency строки запроса. Без параметра - частота по умолчанию
+bool ParseProfileFrequency(std::string_view query, unsigned& frequency) {
+    frequency = profiler::DEFAULT_FREQUENCY;
+    while (!query.empty()) {
+        const auto param = query.substr(0, query.find('&'));
+        query.remove_prefix(std::min(param.size() + 1, query.size()));
+
+        const auto eq_pos = param.find('=');
+        if (param.substr(0, eq_pos) != ProfileParams::FREQUENCY) {
+            continue;
+        }
+        if (eq_pos == param.npos) {
+            return false;
+        }
+        const auto value = param.substr(eq_pos + 1);
+        const auto [ptr, ec] = std::from_chars(value.data(), value.data() + value.size(), frequency);
+        if (ec != std::errc{} || ptr != value.data() + value.size()
+            || frequency == 0 || frequency > profiler::MAX_FREQUENCY) {
+            return false;
+        }
+    }
+    return true;
+}
+
+}  // namespace
+
 StringResponse RequestHandler::ReportServerError(unsigned version, bool keep_alive) const {
     auto body = "Internal Server Error"s;
     return MakeStringResponse(http::status::internal_server_error, body, body.size(), version, keep_alive, ContentType::TEXT_PLAIN);
 }
 
+StringResponse RequestHandler::ReportServiceUnavailable(unsigned version, bool keep_alive) const {
+    // Отказ должен стоить как можно меньше, поэтому тела ответов сериализуются один раз
+    static const std::string overloaded_body = boost::json::serialize(boost::json::value_from(
+        ResponseError{json_field::API_CODE_SERVICE_UNAVAILABLE, "Server is overloaded, retry later"s}));
+    static const std::string draining_body = boost::json::serialize(boost::json::value_from(
+        ResponseError{json_field::API_CODE_SERVICE_UNAVAILABLE, "Server is restarting, retry later"s}));
+    // Завершающийся после горячего перезапуска процесс закрывает соединение, чтобы клиент переподключился к новому
+    const bool is_draining = admission_.IsDraining();
+    const auto& body = is_draining ? draining_body : overloaded_body;
+    auto response = MakeStringResponse(http::status::service_unavailable, body, body.size(), version,
+                                       keep_alive && !is_draining, ContentType::APP_JSON);
+    response.set(http::field::retry_after, std::to_string(admission_.GetConfig().retry_after.count()));
+    response.set(http::field::cache_control, HttpFildsValue::NO_CACHE);
+    return response;
+}
+
+StringResponse RequestHandler::ReportTooManyRequests(unsigned version, bool keep_alive) const {
+    // Отказ должен стоить как можно меньше, поэтому тело ответа сериализуется один раз
+    static const std::string body = boost::json::serialize(boost::json::value_from(
+        ResponseError{json_field::API_CODE_TOO_MANY_REQUESTS, "Request rate limit exceeded"s}));
+    auto response = MakeStringResponse(http::status::too_many_requests, body, body.size(), version, keep_alive, ContentType::APP_JSON);
+    response.set(http::field::retry_after, "1"sv);
+    response.set(http::field::cache_control, HttpFildsValue::NO_CACHE);
+    return response;
+}
+
+StringResponse RequestHandler::ReportMetrics(http::verb method, unsigned version, bool keep_alive) const {
+    if (method != http::verb::get && method != http::verb::head) {
+        auto body = boost::json::serialize(boost::json::value_from(
+            ResponseError{json_field::API_CODE_INVALID_METHOD, "Only GET, HEAD method is expected"s}));
+        return MakeStringResponse(http::status::method_not_allowed, body, body.size(), version, keep_alive, ContentType::APP_JSON);
+    }
+
+    const auto& config = admission_.GetConfig();
+    const auto metrics = admission_.GetMetrics();
+    boost::json::object metrics_jobject;
+    metrics_jobject[json_field::METRICS_QUEUE_DEPTH] = metrics.queue_depth;
+    metrics_jobject[json_field::METRICS_PEAK_QUEUE_DEPTH] = metrics.peak_queue_depth;
+    metrics_jobject[json_field::METRICS_MAX_QUEUE_DEPTH] = config.max_queue_depth;
+    metrics_jobject[json_field::METRICS_SHED_QUEUE_DEPTH] = config.shed_queue_depth;
+    metrics_jobject[json_field::METRICS_TICK_LAG] = metrics.tick_lag.count();
+    metrics_jobject[json_field::METRICS_MAX_TICK_LAG] = config.max_tick_lag.count();
+    metrics_jobject[json_field::METRICS_ADMITTED] = metrics.admitted;
+    metrics_jobject[json_field::METRICS_SHED] = metrics.shed;
+    metrics_jobject[json_field::METRICS_REJECTED] = metrics.rejected;
+    metrics_jobject[json_field::METRICS_RATE_LIMITED] = rate_limiter_.GetStats().rejected;
+    const auto tick_stats = app_.GetTickStats();
+    metrics_jobject[json_field::METRICS_FULL_TICKS] = tick_stats.full_ticks;
+    metrics_jobject[json_field::METRICS_IDLE_TICKS] = tick_stats.idle_ticks;
+    // Соединения, закрытые по таймауту бездействия колесом таймеров, и отклонённые сверх лимита
+    const auto connection_stats = connections_.GetStats();
+    boost::json::object connections_jobject;
+    connections_jobject[json_field::CONNECTIONS_OPEN] = connection_stats.open;
+    connections_jobject[json_field::CONNECTIONS_IDLE] = connection_stats.idle;
+    connections_jobject[json_field::CONNECTIONS_REAPED] = connection_stats.reaped;
+    connections_jobject[json_field::CONNECTIONS_REJECTED] = connection_stats.rejected;
+    metrics_jobject[json_field::METRICS_CONNECTIONS] = std::move(connections_jobject);
+
+    auto body = boost::json::serialize(metrics_jobject);
+    const size_t size = body.size();
+    if (method == http::verb::head) {
+        body.clear();
+    }
+    auto response = MakeStringResponse(http::status::ok, body, size, version, keep_alive, ContentType::APP_JSON);
+    response.set(http::field::cache_control, HttpFildsValue::NO_CACHE);
+    return response;
+}
+
+StringResponse RequestHandler::ReportProfile(http::verb method, std::string_view target, unsigned version,
+                                             bool keep_alive) const {
+    // Действие - последний сегмент пути: /api/v1/profile/<действие>
+    const auto query_pos = std::min(target.find('?'), target.size());
+    auto path = target.substr(0, query_pos);
+    while (!path.empty() && path.back() == '/') {
+        path.remove_suffix(1);
+    }
+    const auto action = path.substr(path.rfind('/') + 1);
+    const auto query = target.substr(std::min(query_pos + 1, target.size()));
+
+    const bool is_control = action == api_strings::PROFILE_START_PATH || action == api_strings::PROFILE_STOP_PATH;
+    const bool is_view = action == api_strings::PROFILE_STACKS_PATH || action == api_strings::PROFILE_ZONES_PATH;
+    if (!is_control && !is_view) {
+        auto body = boost::json::serialize(boost::json::value_from(
+            ResponseError{json_field::API_CODE_BAD_REQUEST, "Unknown profiler action"s}));
+        return MakeStringResponse(http::status::bad_request, body, body.size(), version, keep_alive, ContentType::APP_JSON);
+    }
+
+    if (is_view) {
+        if (method != http::verb::get && method != http::verb::head) {
+            auto body = boost::json::serialize(boost::json::value_from(
+                ResponseError{json_field::API_CODE_INVALID_METHOD, "Only GET, HEAD method is expected"s}));
+            return MakeStringResponse(http::status::method_not_allowed, body, body.size(), version, keep_alive,
+                                      ContentType::APP_JSON, AllowedMethods::PROFILE_VIEW);
+        }
+        // Свёрнутые стеки отдаются как есть - их можно сразу передать flamegraph.pl
+        auto body = action == api_strings::PROFILE_STACKS_PATH ? profiler::GetFoldedStacks() : profiler::GetFoldedZones();
+        const size_t size = body.size();
+        if (method == http::verb::head) {
+            body.clear();
+        }
+        auto response = MakeStringResponse(http::status::ok, body, size, version, keep_alive, ContentType::TEXT_PLAIN);
+        response.set(http::field::cache_control, HttpFildsValue::NO_CACHE);
+        return response;
+    }
+
+    if (method != http::verb::post) {
+        auto body = boost::json::serialize(boost::json::value_from(
+            ResponseError{json_field::API_CODE_INVALID_METHOD, "Only POST method is expected"s}));
+        return MakeStringResponse(http::status::method_not_allowed, body, body.size(), version, keep_alive,
+                                  ContentType::APP_JSON, AllowedMethods::PROFILE_CONTROL);
+    }
+    // Повторный запуск или остановка ничего не меняют - в ответе всё равно текущее состояние
+    if (action == api_strings::PROFILE_START_PATH) {
+        unsigned frequency = 0;
+        if (!ParseProfileFrequency(query, frequency)) {
+            auto body = boost::json::serialize(boost::json::value_from(
+                ResponseError{json_field::API_CODE_INVALID_ARGUMENT, "Invalid sampling frequency"s}));
+            return MakeStringResponse(http::status::bad_request, body, body.size(), version, keep_alive, ContentType::APP_JSON);
+        }
+        profiler::Start(frequency);
+    } else {
+        profiler::Stop();
+    }
+
+    const auto stats = profiler::GetStats();
+    boost::json::object profile_jobject;
+    profile_jobject[json_field::PROFILE_RUNNING] = stats.is_running;
+    profile_jobject[json_field::PROFILE_FREQUENCY] = stats.frequency;
+    profile_jobject[json_field::PROFILE_SAMPLES] = stats.samples;
+    profile_jobject[json_field::PROFILE_DROPPED] = stats.dropped;
+
+    auto body = boost::json::serialize(profile_jobject);
+    auto response = MakeStringResponse(http::status::ok, body, body.size(), version, keep_alive, ContentType::APP_JSON);
+    response.set(http::field::cache_control, HttpFildsValue::NO_CACHE);
+    return response;
+}
+
 // Создаёт StringResponse с заданными параметрами
 StringResponse RequestHandler::MakeStringResponse(http::status status, std::string_view body, size_t size, unsigned http_version,
                                   bool keep_alive,
-                                  std::string_view content_type) const {
+                                  std::string_view content_type, std::string_view allowed_method) const {
     StringResponse response(status, http_version);
     response.set(http::field::content_type, content_type);
     if (status == http::status::method_not_allowed) {
-        response.set(http::field::allow, "GET, HEAD");
+        response.set(http::field::allow, allowed_method);
     }
     response.body() = body;
     response.content_length(size);
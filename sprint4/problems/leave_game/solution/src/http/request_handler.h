@@ -1,9 +1,15 @@
 #pragma once
 
+#include "admission_control.h"
 #include "extra_data.h"
 #include "http_server.h"
 #include "api_handler.h"
 #include "file_handler.h"
+#include "http_handler_defs.h"
+#include "rate_limiter.h"
+
+#include <boost/asio/associated_allocator.hpp>
+#include <boost/asio/bind_allocator.hpp>
 
 namespace http_handler {
 
@@ -11,31 +17,78 @@ class RequestHandler : public std::enable_shared_from_this<RequestHandler> {
 public:
     using Strand = net::strand<net::io_context::executor_type>;
 
-    explicit RequestHandler(Strand api_strand, app::Application& app, fs::path path, extra_data::MapsLootTypes& extra_data)
+    explicit RequestHandler(Strand api_strand, app::Application& app, fs::path path, extra_data::MapsLootTypes& extra_data,
+                            AdmissionControl& admission, RateLimiter& rate_limiter,
+                            const http_server::ConnectionManager& connections, bool is_metrics_enabled = false,
+                            bool is_profiler_enabled = false)
         : api_handler_{api_strand, app, extra_data}
-        , file_handler_{path} {
+        , app_{app}
+        , file_handler_{path}
+        , admission_{admission}
+        , rate_limiter_{rate_limiter}
+        , connections_{connections}
+        , is_metrics_enabled_{is_metrics_enabled}
+        , is_profiler_enabled_{is_profiler_enabled} {
     }
 
     RequestHandler(const RequestHandler&) = delete;
     RequestHandler& operator=(const RequestHandler&) = delete;
 
     template <typename Body, typename Allocator, typename Send>
-    void operator()(http::request<Body, http::basic_fields<Allocator>>&& req, Send&& send) {
+    void operator()(http::request<Body, http::basic_fields<Allocator>>&& req, Send&& send,
+                    const boost::asio::ip::tcp::endpoint& endpoint) {
         auto version = req.version();
         auto keep_alive = req.keep_alive();
 
         try {
             // Запрос к АПИ обрабатываем в выделенном Strand, чтобы избежать гонки
             if (api_handler_.IsApiRequest(req.target())) {
+                const auto route = api_handler_.GetApiRoute(req.target());
+                // Метрики читаются из счётчиков и не должны стоять в очереди strand вместе с остальными запросами.
+                // Они раскрывают нагрузку и настройки сервера, поэтому, как и профилировщик, включаются явно
+                if (route == ApiRoute::Metrics && is_metrics_enabled_) {
+                    return send(ReportMetrics(req.method(), version, keep_alive));
+                }
+                // Профилировщик тоже не трогает состояние игры. Сэмплы снимаются и тогда, когда strand перегружен
+                if (route == ApiRoute::Profile && is_profiler_enabled_) {
+                    return send(ReportProfile(req.method(), req.target(), version, keep_alive));
+                }
+                // Частоту запросов ограничиваем по токену игрока и адресу клиента, пока запрос не попал в strand
+                if (!rate_limiter_.Allow(route, api_handler_.GetTokenFromRequestStr(req[http::field::authorization]),
+                                         endpoint.address())) {
+                    return send(ReportTooManyRequests(version, keep_alive));
+                }
+                // Очередь strand ограничена: при перегрузке отвечаем сразу, не ставя запрос в очередь
+                if (!admission_.TryAdmit(ApiHandler::GetRequestPriority(route))) {
+                    // Состояние игры уходит новому процессу: соединение закрывается без ответа,
+                    // и клиент повторяет запрос уже к новому процессу
+                    if (admission_.IsDraining()) {
+                        return send(http_server::CloseConnection{});
+                    }
+                    return send(ReportServiceUnavailable(version, keep_alive));
+                }
                 auto handle = [self = shared_from_this(), send,
                                req = std::forward<decltype(req)>(req), version, keep_alive] {
+                    self->admission_.OnDequeued();
+                    // Пока запрос ждал в очереди, снимок состояния уже передан новому процессу
+                    if (self->admission_.IsHandedOff()) {
+                        return send(http_server::CloseConnection{});
+                    }
                     try {
-                        return send(self->api_handler_.HandleApiRequest(req));
+                        auto response = self->api_handler_.HandleApiRequest(req);
+                        // Запросы, допущенные до начала передачи состояния, выполняются как обычно,
+                        // но следующие клиент отправит уже новому процессу
+                        if (self->admission_.IsDraining()) {
+                            response.keep_alive(false);
+                        }
+                        return send(std::move(response));
                     } catch (...) {
                         send(self->ReportServerError(version, keep_alive));
                     }
                 };
-                return net::dispatch(api_handler_.GetStrand(), handle);
+                // Если у send есть связанный аллокатор (см. CoroSession), обработчик размещается с его помощью
+                return net::dispatch(api_handler_.GetStrand(),
+                                     net::bind_allocator(net::get_associated_allocator(send), std::move(handle)));
             }
             // Не пошли в запрос к АПИ, значит запрос к ФС. Возвращаем результат обработки запроса к файлу
             return std::visit(
@@ -55,12 +108,27 @@ private:
     StringResponse HandleApiRequest(const StringRequest& req) const;
     // Генератор сообщения об ошибке
     StringResponse ReportServerError(unsigned version, bool keep_alive) const;
+    // Ответ 503 с заголовком Retry-After на запрос, отклонённый из-за перегрузки
+    StringResponse ReportServiceUnavailable(unsigned version, bool keep_alive) const;
+    // Ответ 429 на запрос сверх бюджета маршрута
+    StringResponse ReportTooManyRequests(unsigned version, bool keep_alive) const;
+    // Метрики контроля допуска, ограничения частоты запросов, тиков игровых сессий и соединений
+    StringResponse ReportMetrics(http::verb method, unsigned version, bool keep_alive) const;
+    // Запуск и остановка профилировщика, выдача свёрнутых стеков (/api/v1/profile/start|stop|stacks|zones)
+    StringResponse ReportProfile(http::verb method, std::string_view target, unsigned version, bool keep_alive) const;
 
     StringResponse MakeStringResponse(http::status status, std::string_view body, size_t size, unsigned http_version,
-                                      bool keep_alive, std::string_view content_type) const;
+                                      bool keep_alive, std::string_view content_type,
+                                      std::string_view allowed_method = AllowedMethods::METRICS) const;
 
     ApiHandler api_handler_;
+    const app::Application& app_;
     FileHandler file_handler_;
+    AdmissionControl& admission_;
+    RateLimiter& rate_limiter_;
+    const http_server::ConnectionManager& connections_;
+    bool is_metrics_enabled_;
+    bool is_profiler_enabled_;
 };
 
 }  // namespace http_handler
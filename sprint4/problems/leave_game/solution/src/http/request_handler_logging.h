@@ -7,9 +7,12 @@
 #include <boost/json.hpp>
 #include <boost/json/value.hpp>
 #include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/associated_allocator.hpp>
+#include <boost/asio/bind_allocator.hpp>
 
 #include <boost/timer/timer.hpp>
 #include <memory>
+#include <type_traits>
 
 #include "server_params.h"
 #include "logger.h"
@@ -39,24 +42,32 @@ public:
         auto timer = std::make_shared<boost::timer::cpu_timer>();
 
         auto loggingResponse = [send, response_jobject, timer](auto&& response) {
-            timer->stop();
-            boost::timer::cpu_times times = timer->elapsed();
-
-            // Заполняем информацию об ответе. Обработка запроса к этому времени уже произведена
-            (*response_jobject)[json_field::RESPONSE_TIME] = static_cast<unsigned long>(times.wall / 1'000'000);   // наносекунды в миллисекунды
-            (*response_jobject)[json_field::RESPONSE_CODE] = response.result_int();
-            (*response_jobject)[json_field::RESPONSE_CONTENT_TYPE] = response[http::field::content_type];
-
-            // непосредственная отправка ответа
-            send(response);
-
-            BOOST_LOG_TRIVIAL(info) << boost::log::add_value(additional_data, boost::json::value(*response_jobject))
-                                    << server_params::RESPONSE_SENT_MESSAGE;
-
+            if constexpr (std::is_same_v<std::decay_t<decltype(response)>, http_server::CloseConnection>) {
+                // Ответа нет - соединение закрывается
+                send(response);
+            } else {
+                timer->stop();
+                boost::timer::cpu_times times = timer->elapsed();
+
+                // Заполняем информацию об ответе. Обработка запроса к этому времени уже произведена
+                (*response_jobject)[json_field::RESPONSE_TIME] = static_cast<unsigned long>(times.wall / 1'000'000);   // наносекунды в миллисекунды
+                (*response_jobject)[json_field::RESPONSE_CODE] = response.result_int();
+                (*response_jobject)[json_field::RESPONSE_CONTENT_TYPE] = response[http::field::content_type];
+
+                // непосредственная отправка ответа
+                send(response);
+
+                BOOST_LOG_TRIVIAL(info) << boost::log::add_value(additional_data, boost::json::value(*response_jobject))
+                                        << server_params::RESPONSE_SENT_MESSAGE;
+            }
         };
 
         // Непосредственно обработка запроса с использованием лямбды
-        decorated_(std::forward<decltype(req)>(req), std::move(loggingResponse));
+        // Аллокатор send сохраняем и для обёртки, чтобы он был доступен обработчику запроса.
+        // Адрес клиента нужен обработчику для ограничения частоты запросов
+        decorated_(std::forward<decltype(req)>(req),
+                   boost::asio::bind_allocator(boost::asio::get_associated_allocator(send), std::move(loggingResponse)),
+                   endpoint);
     }
 
 private:
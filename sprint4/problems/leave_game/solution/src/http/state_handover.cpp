@@ -0,0 +1,45 @@
+#include "state_handover.h"
+
+#include <sstream>
+#include <utility>
+
+#include "hot_restart.h"
+
+namespace hot_restart {
+
+void StateHandover::Begin() {
+    admission_.MarkHandedOff();
+    handed_off_ = true;
+    wal_ = app_.GetWriteAheadLog();
+    app_.SetWriteAheadLog(nullptr);
+
+    std::ostringstream state;
+    serializer_.Serialize(state, wal_ ? wal_->GetLastLsn() : 0);
+    state_ = std::move(state).str();
+}
+
+void StateHandover::Send(int successor, std::vector<int> listen_fds, Handler handler) {
+    // Поток предыдущей, неудавшейся отправки к этому времени уже завершён
+    thread_ = std::jthread([this, successor, listen_fds = std::move(listen_fds), handler = std::move(handler)] {
+        std::exception_ptr error;
+        try {
+            // Новый процесс начнёт журнал заново, поэтому старый должен дописать его до передачи.
+            // Записи после снимка не добавляются, журнал отключён в Begin
+            if (wal_) {
+                wal_->Flush();
+            }
+            SendHandoff(successor, listen_fds, state_);
+        } catch (...) {
+            error = std::current_exception();
+        }
+        handler(error);
+    });
+}
+
+void StateHandover::Abort() noexcept {
+    app_.SetWriteAheadLog(wal_);
+    handed_off_ = false;
+    admission_.StopDraining();
+}
+
+}  // namespace hot_restart
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <exception>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "admission_control.h"
+#include "app.h"
+#include "state_serialization.h"
+
+// Передача состояния игры новому процессу при горячем перезапуске (см. hot_restart.h)
+namespace hot_restart {
+
+// Работающий процесс передаёт состояние в три этапа. Сначала новые запросы к API перестают допускаться
+// (AdmissionControl::StartDraining), а уже стоящие в очереди strand API выполняются как обычно.
+// Затем в strand, вслед за ними, делается снимок: после него ни один запрос и ни один тик состояние
+// уже не изменят. Дописывание журнала и отправка ждут диска и нового процесса, поэтому выполняются
+// в отдельном потоке и не задерживают strand
+class StateHandover {
+public:
+    // Итог отправки: nullptr - новый процесс получил состояние
+    using Handler = std::function<void(std::exception_ptr error)>;
+
+    StateHandover(app::Application& app, serialization::StateSerializer& serializer,
+                  http_handler::AdmissionControl& admission) noexcept
+        : app_{app}
+        , serializer_{serializer}
+        , admission_{admission} {
+    }
+
+    StateHandover(const StateHandover&) = delete;
+    StateHandover& operator=(const StateHandover&) = delete;
+
+    // Выполняется в strand API после StartDraining. Запросы, оставшиеся в очереди, больше не выполняются,
+    // журнал упреждающей записи отключается, состояние сохраняется в снимок
+    void Begin();
+    // Отправляет снимок и слушающие сокеты новому процессу в отдельном потоке.
+    // Перед отправкой дописывает журнал: новый процесс начнёт его заново.
+    // handler вызывается в том же потоке
+    void Send(int successor, std::vector<int> listen_fds, Handler handler);
+    // Выполняется в strand API, если отправка не удалась: запросы снова допускаются, процесс продолжает работу
+    void Abort() noexcept;
+
+    // Состояние передаётся или уже передано. Читается в strand API, после остановки ioc - в основном потоке
+    bool IsHandedOff() const noexcept {
+        return handed_off_;
+    }
+
+    // Снимок, сделанный Begin
+    const std::string& GetState() const noexcept {
+        return state_;
+    }
+
+private:
+    app::Application& app_;
+    serialization::StateSerializer& serializer_;
+    http_handler::AdmissionControl& admission_;
+    // Журнал, отключённый на время передачи
+    wal::LogWriter* wal_ = nullptr;
+    bool handed_off_ = false;
+    std::string state_;
+    // Поток отправки. Объявлен последним: разрушение объекта дожидается конца отправки,
+    // пока данные, которые она читает, ещё живы
+    std::jthread thread_;
+};
+
+}  // namespace hot_restart
@@ -0,0 +1,89 @@
+#include "timer_wheel.h"
+
+#include <algorithm>
+
+namespace http_server {
+
+TimerWheel::TimerWheel(net::io_context& ioc, std::chrono::milliseconds resolution, size_t slots)
+    : resolution_(std::max(resolution, std::chrono::milliseconds(1)))
+    , strand_(net::make_strand(ioc))
+    , timer_(strand_)
+    , slots_(std::max<size_t>(slots, 1)) {
+}
+
+std::shared_ptr<TimerWheel::Entry> TimerWheel::Add(std::chrono::milliseconds timeout, Handler on_expire) {
+    // Таймаут округляется вверх до целого числа тиков, но не меньше одного
+    const uint64_t timeout_ticks = std::max<uint64_t>(1, (timeout + resolution_ - std::chrono::milliseconds(1)) / resolution_);
+    auto entry = std::make_shared<Entry>(*this, timeout_ticks, std::move(on_expire));
+
+    std::lock_guard lock(mutex_);
+    slots_[entry->deadline_.load(std::memory_order_relaxed) % slots_.size()].push_back(entry);
+    return entry;
+}
+
+void TimerWheel::Start() {
+    net::dispatch(strand_, [self = shared_from_this()] {
+        self->next_tick_time_ = std::chrono::steady_clock::now();
+        self->ScheduleTick();
+    });
+}
+
+void TimerWheel::Stop() {
+    net::dispatch(strand_, [self = shared_from_this()] {
+        self->timer_.cancel();
+    });
+}
+
+void TimerWheel::ScheduleTick() {
+    // Срок следующего тика отсчитывается от предыдущего, а не от текущего момента,
+    // чтобы задержки обработки не накапливались
+    next_tick_time_ += resolution_;
+    timer_.expires_at(next_tick_time_);
+    timer_.async_wait([self = shared_from_this()](boost::system::error_code ec) {
+        if (!ec) {
+            self->OnTick();
+            self->ScheduleTick();
+        }
+    });
+}
+
+void TimerWheel::OnTick() {
+    const uint64_t tick = current_tick_.fetch_add(1, std::memory_order_relaxed) + 1;
+
+    Slot slot;
+    {
+        std::lock_guard lock(mutex_);
+        slot.swap(slots_[tick % slots_.size()]);
+    }
+
+    std::vector<std::shared_ptr<Entry>> expired;
+    Slot postponed;
+    for (auto& entry : slot) {
+        if (entry->cancelled_.load(std::memory_order_relaxed)) {
+            continue;
+        }
+        if (entry->deadline_.load(std::memory_order_relaxed) <= tick) {
+            expired.push_back(std::move(entry));
+        } else {
+            postponed.push_back(std::move(entry));
+        }
+    }
+
+    if (!postponed.empty()) {
+        // Запись, которую продлили, переезжает в слот своего нового срока.
+        // Если до срока больше оборота колеса, она вернётся в текущий слот и дождётся следующего оборота
+        std::lock_guard lock(mutex_);
+        for (auto& entry : postponed) {
+            slots_[entry->deadline_.load(std::memory_order_relaxed) % slots_.size()].push_back(std::move(entry));
+        }
+    }
+
+    // Обработчики вызываются без блокировки: они могут добавлять новые таймеры
+    for (auto& entry : expired) {
+        if (entry->on_expire_) {
+            entry->on_expire_();
+        }
+    }
+}
+
+}  // namespace http_server
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <boost/asio/dispatch.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/asio/strand.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace http_server {
+
+namespace net = boost::asio;
+
+// Хешированное колесо таймеров: один steady_timer на всех вместо таймера на каждое соединение.
+// Время разбито на тики длиной resolution, таймеры лежат в слотах колеса по номеру тика,
+// в котором истекают. За тик обрабатывается только один слот.
+// Продление таймера (Touch) лишь перезаписывает срок в записи и не трогает слоты:
+// запись, срок которой отодвинулся, переносится в нужный слот, когда колесо дойдёт до неё.
+// Поэтому частые продления на каждом запросе почти ничего не стоят
+class TimerWheel : public std::enable_shared_from_this<TimerWheel> {
+public:
+    using Handler = std::function<void()>;
+
+    // Таймер колеса. Продлевать и отменять его можно из любого потока
+    class Entry {
+    public:
+        Entry(const TimerWheel& wheel, uint64_t timeout_ticks, Handler on_expire)
+            : wheel_(wheel)
+            , timeout_ticks_(timeout_ticks)
+            , on_expire_(std::move(on_expire)) {
+            Touch();
+        }
+
+        // Отсчитывает таймаут заново от текущего момента
+        void Touch() noexcept {
+            deadline_.store(wheel_.CurrentTick() + timeout_ticks_, std::memory_order_relaxed);
+        }
+
+        // Отменённая запись удаляется из колеса, когда оно до неё дойдёт
+        void Cancel() noexcept {
+            cancelled_.store(true, std::memory_order_relaxed);
+        }
+
+    private:
+        friend class TimerWheel;
+
+        const TimerWheel& wheel_;
+        const uint64_t timeout_ticks_;
+        std::atomic<uint64_t> deadline_ = 0;
+        std::atomic<bool> cancelled_ = false;
+        Handler on_expire_;
+    };
+
+    TimerWheel(net::io_context& ioc, std::chrono::milliseconds resolution, size_t slots);
+
+    TimerWheel(const TimerWheel&) = delete;
+    TimerWheel& operator=(const TimerWheel&) = delete;
+
+    // Добавляет таймер, который вызовет on_expire через timeout после последнего продления.
+    // on_expire вызывается в потоке io_context колеса
+    std::shared_ptr<Entry> Add(std::chrono::milliseconds timeout, Handler on_expire);
+
+    void Start();
+    void Stop();
+
+    uint64_t CurrentTick() const noexcept {
+        return current_tick_.load(std::memory_order_relaxed);
+    }
+
+private:
+    using Slot = std::vector<std::shared_ptr<Entry>>;
+
+    void ScheduleTick();
+    void OnTick();
+
+    std::chrono::milliseconds resolution_;
+    net::strand<net::io_context::executor_type> strand_;
+    net::steady_timer timer_;
+    std::chrono::steady_clock::time_point next_tick_time_;
+    std::atomic<uint64_t> current_tick_ = 0;
+    // Слоты изменяются и при добавлении таймеров (потоки соединений), и в тике колеса
+    std::mutex mutex_;
+    std::vector<Slot> slots_;
+};
+
+}  // namespace http_server
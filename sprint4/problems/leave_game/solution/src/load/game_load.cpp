@@ -0,0 +1,334 @@
+// Генератор нагрузки на game_server. Виртуальные пользователи в keep-alive соединениях подключаются
+// к игре, двигают собак, запрашивают состояние и список игроков, при --idle-retire ждут ухода на покой.
+// Замкнутый цикл (по умолчанию): каждый пользователь отправляет следующий запрос после ответа.
+// Открытый цикл (--rps): запросы назначаются с постоянной частотой, задержка считается от назначенного
+// времени. Результат - квантили задержек по видам запросов, по желанию в CSV и JSON
+//
+// Сервер для нагрузки без PostgreSQL: game_server --memory-records ...
+
+#include <boost/asio/co_spawn.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/signal_set.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/program_options.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <exception>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "json_writer.h"
+#include "load_client.h"
+
+using namespace std::literals;
+
+namespace {
+
+namespace net = boost::asio;
+
+struct Args {
+    std::string address = "127.0.0.1"s;
+    std::string port = "8080"s;
+    size_t users = 100;
+    unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+    unsigned duration = 30;
+    double rps = 0.0;
+    unsigned think_time = 0;
+    unsigned steps = 200;
+    double state_ratio = 0.5;
+    double players_ratio = 0.05;
+    bool idle_retire = false;
+    unsigned idle_poll = 1000;
+    std::vector<std::string> maps;
+    unsigned tick_period = 0;
+    unsigned timeout = 5000;
+    std::uint32_t seed = 0;
+    std::string csv_file;
+    std::string json_file;
+};
+
+[[nodiscard]] std::optional<Args> ParseCommandLine(int argc, const char* const argv[]) {
+    namespace po = boost::program_options;
+
+    po::options_description desc{"All options"s};
+
+    Args args;
+    desc.add_options()
+        ("help,h", "Show help")
+        ("address,a", po::value(&args.address)->value_name("host"s), "set server address")
+        ("port,p", po::value(&args.port)->value_name("port"s), "set server port")
+        ("users,u", po::value(&args.users)->value_name("count"s), "set number of virtual users (connections)")
+        ("threads", po::value(&args.threads)->value_name("count"s), "set number of generator threads")
+        ("duration,d", po::value(&args.duration)->value_name("seconds"s), "set test duration")
+        // Опция --rps включает открытый цикл: запросы отправляются с заданной частотой независимо от ответов
+        ("rps", po::value(&args.rps)->value_name("requests"s), "open loop: send requests at a constant rate")
+        ("think-time", po::value(&args.think_time)->value_name("milliseconds"s), "closed loop: pause between a response and the next request")
+        ("steps", po::value(&args.steps)->value_name("count"s), "set number of actions and state requests per game")
+        ("state-ratio", po::value(&args.state_ratio)->value_name("fraction"s), "set share of state requests among game steps")
+        ("players-ratio", po::value(&args.players_ratio)->value_name("fraction"s), "set share of player list requests among game steps")
+        ("idle-retire", po::bool_switch(&args.idle_retire), "stop the dog after the game and wait until the server retires it")
+        ("idle-poll", po::value(&args.idle_poll)->value_name("milliseconds"s), "set state polling period while waiting for retirement")
+        ("map,m", po::value(&args.maps)->multitoken()->value_name("id"s), "set maps to join (default map1)")
+        // Для сервера без --tick-period время в игре двигает генератор
+        ("tick-period", po::value(&args.tick_period)->value_name("milliseconds"s), "send /api/v1/game/tick with this period")
+        ("timeout", po::value(&args.timeout)->value_name("milliseconds"s), "set request timeout")
+        ("seed", po::value(&args.seed)->value_name("number"s), "set random seed")
+        ("csv", po::value(&args.csv_file)->value_name("file"s), "write latency percentiles to a CSV file")
+        ("json", po::value(&args.json_file)->value_name("file"s), "write summary to a JSON file");
+
+    po::variables_map vm;
+    po::store(po::parse_command_line(argc, argv, desc), vm);
+    po::notify(vm);
+
+    if (vm.contains("help"s)) {
+        std::cout << desc;
+        return std::nullopt;
+    }
+    if (args.users == 0 || args.threads == 0) {
+        throw std::runtime_error("Number of users and threads must be positive"s);
+    }
+    if (args.state_ratio < 0 || args.players_ratio < 0 || args.state_ratio + args.players_ratio > 1) {
+        throw std::runtime_error("Shares of state and player list requests must be in [0, 1] in total"s);
+    }
+    if (args.maps.empty()) {
+        args.maps.push_back("map1"s);
+    }
+    return args;
+}
+
+constexpr std::array<double, 5> PERCENTILES = {50.0, 90.0, 99.0, 99.9, 100.0};
+
+struct Row {
+    std::string_view name;
+    const load::LatencyHistogram& latency;
+    std::uint64_t errors;
+};
+
+std::vector<Row> MakeRows(const load::Stats& stats, const load::LatencyHistogram& all, std::uint64_t all_errors) {
+    std::vector<Row> rows;
+    for (size_t i = 0; i < load::ENDPOINT_COUNT; ++i) {
+        const auto& endpoint = stats.endpoints[i];
+        if (endpoint.latency.GetCount() > 0) {
+            rows.push_back({load::EndpointToString(static_cast<load::Endpoint>(i)), endpoint.latency, endpoint.errors});
+        }
+    }
+    rows.push_back({"all"sv, all, all_errors});
+    return rows;
+}
+
+double ToMilliseconds(load::LatencyHistogram::Microseconds us) {
+    return us.count() / 1000.0;
+}
+
+void PrintRows(const std::vector<Row>& rows, double seconds) {
+    std::cout << std::left << std::setw(9) << "endpoint" << std::right
+              << std::setw(10) << "requests" << std::setw(8) << "errors" << std::setw(10) << "rps"
+              << std::setw(9) << "mean" << std::setw(9) << "p50" << std::setw(9) << "p90"
+              << std::setw(9) << "p99" << std::setw(9) << "p99.9" << std::setw(9) << "max" << "  (ms)\n";
+    for (const auto& row : rows) {
+        std::cout << std::left << std::setw(9) << row.name << std::right
+                  << std::setw(10) << row.latency.GetCount() << std::setw(8) << row.errors
+                  << std::setw(10) << row.latency.GetCount() / seconds
+                  << std::setw(9) << ToMilliseconds(row.latency.GetMean());
+        for (const auto percentile : PERCENTILES) {
+            std::cout << std::setw(9) << ToMilliseconds(row.latency.GetValueAtPercentile(percentile));
+        }
+        std::cout << '\n';
+    }
+}
+
+void WriteCsv(const std::string& path, const std::vector<Row>& rows, double seconds) {
+    std::ofstream out{path};
+    out << "endpoint,requests,errors,rps,min_us,mean_us,p50_us,p90_us,p99_us,p999_us,max_us\n";
+    for (const auto& row : rows) {
+        out << row.name << ',' << row.latency.GetCount() << ',' << row.errors << ','
+            << row.latency.GetCount() / seconds << ',' << row.latency.GetMin().count() << ','
+            << row.latency.GetMean().count();
+        for (const auto percentile : PERCENTILES) {
+            out << ',' << row.latency.GetValueAtPercentile(percentile).count();
+        }
+        out << '\n';
+    }
+    if (!out) {
+        throw std::runtime_error("Failed to write "s + path);
+    }
+}
+
+void WriteJson(const std::string& path, const Args& args, const load::Stats& stats,
+               const std::vector<Row>& rows, double seconds) {
+    std::string json;
+    json_writer::JsonWriter writer{json};
+    writer.BeginObject()
+        .Key("mode"sv).Value(args.rps > 0 ? "open"sv : "closed"sv)
+        .Key("users"sv).Value(args.users)
+        .Key("targetRps"sv).Value(args.rps)
+        .Key("durationS"sv).Value(seconds)
+        .Key("retirements"sv).Value(stats.retirements)
+        .Key("reconnects"sv).Value(stats.reconnects)
+        .Key("endpoints"sv).BeginObject();
+    for (const auto& row : rows) {
+        writer.Key(row.name).BeginObject()
+            .Key("requests"sv).Value(row.latency.GetCount())
+            .Key("errors"sv).Value(row.errors)
+            .Key("rps"sv).Value(row.latency.GetCount() / seconds)
+            .Key("minUs"sv).Value(row.latency.GetMin().count())
+            .Key("meanUs"sv).Value(row.latency.GetMean().count())
+            .Key("p50Us"sv).Value(row.latency.GetValueAtPercentile(50.0).count())
+            .Key("p90Us"sv).Value(row.latency.GetValueAtPercentile(90.0).count())
+            .Key("p99Us"sv).Value(row.latency.GetValueAtPercentile(99.0).count())
+            .Key("p999Us"sv).Value(row.latency.GetValueAtPercentile(99.9).count())
+            .Key("maxUs"sv).Value(row.latency.GetMax().count())
+            .EndObject();
+    }
+    writer.EndObject().EndObject();
+
+    std::ofstream out{path};
+    out << json << '\n';
+    if (!out) {
+        throw std::runtime_error("Failed to write "s + path);
+    }
+}
+
+}  // namespace
+
+int main(int argc, const char* argv[]) {
+    try {
+        std::optional<Args> args = ParseCommandLine(argc, argv);
+        if (!args) {
+            return EXIT_SUCCESS;
+        }
+
+        load::tcp::endpoint endpoint;
+        {
+            net::io_context ioc;
+            load::tcp::resolver resolver{ioc};
+            endpoint = *resolver.resolve(args->address, args->port).begin();
+        }
+
+        load::ScenarioConfig scenario;
+        scenario.maps = args->maps;
+        scenario.steps = args->steps;
+        scenario.state_ratio = args->state_ratio;
+        scenario.players_ratio = args->players_ratio;
+        scenario.idle_retire = args->idle_retire;
+        scenario.idle_poll = std::chrono::milliseconds{args->idle_poll};
+        scenario.timeout = std::chrono::milliseconds{args->timeout};
+
+        // У каждого потока свой io_context и своя статистика - без синхронизации между потоками
+        const unsigned num_threads = std::min<size_t>(args->threads, args->users);
+        std::deque<net::io_context> contexts;
+        std::vector<load::Stats> stats(num_threads);
+        for (unsigned i = 0; i < num_threads; ++i) {
+            contexts.emplace_back(1);
+        }
+
+        const auto start = load::Clock::now();
+        std::atomic_bool stop = false;
+        std::optional<load::Pacer> pacer;
+        if (args->rps > 0) {
+            pacer.emplace(args->rps, start);
+        } else {
+            pacer.emplace(std::chrono::milliseconds{args->think_time});
+        }
+
+        // Исключения, вышедшие из корутин, - ошибки генератора, а не сервера: они останавливают нагрузку
+        std::mutex failure_mutex;
+        std::exception_ptr failure;
+        const auto on_done = [&](std::exception_ptr ex) {
+            if (ex) {
+                std::lock_guard lock{failure_mutex};
+                failure = failure ? failure : ex;
+                stop = true;
+            }
+        };
+        std::deque<load::VirtualUser> users;
+        for (size_t i = 0; i < args->users; ++i) {
+            auto& ioc = contexts[i % num_threads];
+            auto& user = users.emplace_back(ioc.get_executor(), endpoint, args->address, scenario, *pacer, stop,
+                                            stats[i % num_threads], i, args->seed + static_cast<std::uint32_t>(i));
+            net::co_spawn(ioc, user.Run(), on_done);
+        }
+        std::optional<load::TickDriver> ticks;
+        if (args->tick_period > 0) {
+            ticks.emplace(contexts[0].get_executor(), endpoint, args->address,
+                          std::chrono::milliseconds{args->tick_period}, stop, stats[0]);
+            net::co_spawn(contexts[0], ticks->Run(), on_done);
+        }
+
+        // Генератор останавливается по истечении времени или по сигналу
+        net::steady_timer timer{contexts[0], std::chrono::seconds{args->duration}};
+        net::signal_set signals{contexts[0], SIGINT, SIGTERM};
+        const auto stop_load = [&] {
+            stop = true;
+            timer.cancel();
+            signals.cancel();
+        };
+        timer.async_wait([&](const boost::system::error_code& ec) {
+            if (!ec) {
+                stop_load();
+            }
+        });
+        signals.async_wait([&](const boost::system::error_code& ec, int) {
+            if (!ec) {
+                stop_load();
+            }
+        });
+
+        std::vector<std::jthread> threads;
+        for (unsigned i = 1; i < num_threads; ++i) {
+            threads.emplace_back([&ioc = contexts[i]] {
+                ioc.run();
+            });
+        }
+        contexts[0].run();
+        threads.clear();
+        if (failure) {
+            std::rethrow_exception(failure);
+        }
+        const double seconds = std::chrono::duration<double>(load::Clock::now() - start).count();
+
+        load::Stats total;
+        for (const auto& thread_stats : stats) {
+            total.Merge(thread_stats);
+        }
+        // Тики подаёт генератор, а не пользователи: в общую задержку они не входят
+        load::LatencyHistogram all;
+        std::uint64_t all_errors = 0;
+        for (size_t i = 0; i < load::ENDPOINT_COUNT; ++i) {
+            if (static_cast<load::Endpoint>(i) != load::Endpoint::Tick) {
+                all.Merge(total.endpoints[i].latency);
+                all_errors += total.endpoints[i].errors;
+            }
+        }
+        const auto rows = MakeRows(total, all, all_errors);
+
+        std::cout << std::fixed << std::setprecision(2);
+        if (args->rps > 0) {
+            std::cout << "open loop, target " << args->rps << " rps";
+        } else {
+            std::cout << "closed loop";
+        }
+        std::cout << ", users: " << args->users << ", duration: " << seconds << " s"
+                  << ", retirements: " << total.retirements << ", reconnects: " << total.reconnects << '\n';
+        PrintRows(rows, seconds);
+
+        if (!args->csv_file.empty()) {
+            WriteCsv(args->csv_file, rows, seconds);
+        }
+        if (!args->json_file.empty()) {
+            WriteJson(args->json_file, *args, total, rows, seconds);
+        }
+        return EXIT_SUCCESS;
+    } catch (const std::exception& ex) {
+        std::cerr << ex.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+}
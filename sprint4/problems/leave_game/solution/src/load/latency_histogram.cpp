@@ -0,0 +1,89 @@
+#include "latency_histogram.h"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+namespace load {
+
+namespace {
+
+// Значения меньше 2^LINEAR_BITS хранятся точно
+constexpr unsigned LINEAR_BITS = 8;
+constexpr std::uint64_t LINEAR_COUNT = std::uint64_t{1} << LINEAR_BITS;
+// Корзин на каждый следующий интервал [2^k, 2^(k+1))
+constexpr unsigned SUB_BUCKET_BITS = LINEAR_BITS - 1;
+constexpr std::uint64_t SUB_BUCKET_COUNT = std::uint64_t{1} << SUB_BUCKET_BITS;
+constexpr unsigned MAX_BITS = std::bit_width(LatencyHistogram::MAX_VALUE);
+constexpr size_t BUCKETS = LINEAR_COUNT + (MAX_BITS - LINEAR_BITS) * SUB_BUCKET_COUNT;
+
+}  // namespace
+
+LatencyHistogram::LatencyHistogram()
+    : counts_(BUCKETS) {
+}
+
+void LatencyHistogram::Record(Microseconds value) noexcept {
+    const std::uint64_t us = std::clamp<std::int64_t>(value.count(), 0, MAX_VALUE);
+    ++counts_[GetIndex(us)];
+    ++count_;
+    sum_ += us;
+    min_ = std::min(min_, us);
+    max_ = std::max(max_, us);
+}
+
+void LatencyHistogram::Merge(const LatencyHistogram& other) noexcept {
+    for (size_t i = 0; i < BUCKETS; ++i) {
+        counts_[i] += other.counts_[i];
+    }
+    count_ += other.count_;
+    sum_ += other.sum_;
+    min_ = std::min(min_, other.min_);
+    max_ = std::max(max_, other.max_);
+}
+
+LatencyHistogram::Microseconds LatencyHistogram::GetMin() const noexcept {
+    return Microseconds(count_ ? min_ : 0);
+}
+
+LatencyHistogram::Microseconds LatencyHistogram::GetMean() const noexcept {
+    return Microseconds(count_ ? sum_ / count_ : 0);
+}
+
+LatencyHistogram::Microseconds LatencyHistogram::GetValueAtPercentile(double percentile) const noexcept {
+    if (count_ == 0) {
+        return Microseconds(0);
+    }
+    const double rank = std::clamp(percentile, 0.0, 100.0) / 100.0 * count_;
+    const auto target = std::max<std::uint64_t>(1, static_cast<std::uint64_t>(std::ceil(rank)));
+    std::uint64_t seen = 0;
+    for (size_t i = 0; i < BUCKETS; ++i) {
+        seen += counts_[i];
+        if (seen >= target) {
+            return Microseconds(std::min(GetHighestEquivalentValue(i), max_));
+        }
+    }
+    return Microseconds(max_);
+}
+
+size_t LatencyHistogram::GetIndex(std::uint64_t value) noexcept {
+    if (value < LINEAR_COUNT) {
+        return value;
+    }
+    // value в интервале [2^(bits-1), 2^bits): его старшие LINEAR_BITS битов выбирают корзину
+    const unsigned bits = std::bit_width(value);
+    const unsigned shift = bits - LINEAR_BITS;
+    return LINEAR_COUNT + (bits - LINEAR_BITS - 1) * SUB_BUCKET_COUNT + ((value >> shift) - SUB_BUCKET_COUNT);
+}
+
+std::uint64_t LatencyHistogram::GetHighestEquivalentValue(size_t index) noexcept {
+    if (index < LINEAR_COUNT) {
+        return index;
+    }
+    const auto interval = (index - LINEAR_COUNT) / SUB_BUCKET_COUNT;
+    const auto sub_bucket = (index - LINEAR_COUNT) % SUB_BUCKET_COUNT;
+    const unsigned shift = interval + 1;
+    return ((SUB_BUCKET_COUNT + sub_bucket + 1) << shift) - 1;
+}
+
+}  // namespace load
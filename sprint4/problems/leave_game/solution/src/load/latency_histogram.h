@@ -0,0 +1,50 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+namespace load {
+
+// Гистограмма задержек в духе HdrHistogram: значения до 256 мкс хранятся точно, дальше каждый
+// интервал [2^k, 2^(k+1)) делится на 128 равных корзин - относительная погрешность не больше 1%.
+// Память постоянна и не зависит от числа замеров. Значения больше MAX_VALUE учитываются как MAX_VALUE.
+// Не синхронизирована: у каждого пользователя нагрузки своя гистограмма, они объединяются в конце
+class LatencyHistogram {
+public:
+    using Microseconds = std::chrono::microseconds;
+
+    // Около 19 часов
+    static constexpr std::uint64_t MAX_VALUE = (std::uint64_t{1} << 36) - 1;
+
+    LatencyHistogram();
+
+    void Record(Microseconds value) noexcept;
+    void Merge(const LatencyHistogram& other) noexcept;
+
+    std::uint64_t GetCount() const noexcept {
+        return count_;
+    }
+    // Для пустой гистограммы - нули
+    Microseconds GetMin() const noexcept;
+    Microseconds GetMax() const noexcept {
+        return Microseconds(max_);
+    }
+    Microseconds GetMean() const noexcept;
+    // Значение, не меньше которого percentile процентов замеров (0..100).
+    // Возвращается верхняя граница корзины, но не больше максимального замера
+    Microseconds GetValueAtPercentile(double percentile) const noexcept;
+
+private:
+    static size_t GetIndex(std::uint64_t value) noexcept;
+    static std::uint64_t GetHighestEquivalentValue(size_t index) noexcept;
+
+    std::vector<std::uint64_t> counts_;
+    std::uint64_t count_ = 0;
+    std::uint64_t min_ = MAX_VALUE;
+    std::uint64_t max_ = 0;
+    // Сумма для среднего. 2^64 мкс - больше полумиллиона лет суммарного ожидания
+    std::uint64_t sum_ = 0;
+};
+
+}  // namespace load
@@ -0,0 +1,332 @@
+#include "load_client.h"
+
+#include "json_fields.h"
+#include "json_scanner.h"
+#include "json_writer.h"
+
+#include <boost/asio/steady_timer.hpp>
+#include <boost/asio/use_awaitable.hpp>
+#include <boost/beast/http/read.hpp>
+#include <boost/beast/http/write.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+namespace load {
+
+using namespace std::literals;
+
+namespace {
+
+constexpr std::string_view JOIN_TARGET = "/api/v1/game/join"sv;
+constexpr std::string_view ACTION_TARGET = "/api/v1/game/player/action"sv;
+constexpr std::string_view STATE_TARGET = "/api/v1/game/state"sv;
+constexpr std::string_view PLAYERS_TARGET = "/api/v1/game/players"sv;
+constexpr std::string_view TICK_TARGET = "/api/v1/game/tick"sv;
+
+constexpr std::array<std::string_view, 4> MOVES = {"L"sv, "R"sv, "U"sv, "D"sv};
+
+// Пауза перед повторным подключением после сетевой ошибки
+constexpr auto RECONNECT_DELAY = 100ms;
+// Шаг ожидания: остановка генератора замечается не позже чем через него
+constexpr auto STOP_CHECK_PERIOD = 100ms;
+
+LatencyHistogram::Microseconds GetLatency(Clock::time_point start) {
+    return std::chrono::duration_cast<LatencyHistogram::Microseconds>(Clock::now() - start);
+}
+
+std::string MakeJoinBody(std::string_view name, std::string_view map_id) {
+    std::string body;
+    json_writer::JsonWriter writer(body);
+    writer.BeginObject()
+        .Key(json_field::JOIN_NAME).Value(name)
+        .Key(json_field::JOIN_MAP_ID).Value(map_id)
+        .EndObject();
+    return body;
+}
+
+std::string MakeActionBody(std::string_view move) {
+    std::string body;
+    json_writer::JsonWriter writer(body);
+    writer.BeginObject().Key(json_field::PLAYER_ACTION_MOVE_DIRECTION).Value(move).EndObject();
+    return body;
+}
+
+std::string MakeTickBody(std::chrono::milliseconds dt) {
+    std::string body;
+    json_writer::JsonWriter writer(body);
+    writer.BeginObject().Key(json_field::TICK_DT).Value(dt.count()).EndObject();
+    return body;
+}
+
+}  // namespace
+
+std::string_view EndpointToString(Endpoint endpoint) noexcept {
+    switch (endpoint) {
+        case Endpoint::Join:
+            return "join"sv;
+        case Endpoint::Action:
+            return "action"sv;
+        case Endpoint::State:
+            return "state"sv;
+        case Endpoint::Players:
+            return "players"sv;
+        case Endpoint::Tick:
+            return "tick"sv;
+    }
+    return "unknown"sv;
+}
+
+void Stats::Merge(const Stats& other) noexcept {
+    for (size_t i = 0; i < ENDPOINT_COUNT; ++i) {
+        endpoints[i].latency.Merge(other.endpoints[i].latency);
+        endpoints[i].errors += other.endpoints[i].errors;
+    }
+    retirements += other.retirements;
+    reconnects += other.reconnects;
+}
+
+Pacer::Pacer(std::chrono::milliseconds think_time) noexcept
+    : think_time_{think_time} {
+}
+
+Pacer::Pacer(double requests_per_second, Clock::time_point start) noexcept
+    : is_open_{true}
+    , start_{start}
+    , interval_{std::chrono::duration<double>(1.0 / requests_per_second)} {
+}
+
+Clock::time_point Pacer::Next(Clock::time_point now) noexcept {
+    if (!is_open_) {
+        return now + think_time_;
+    }
+    const auto slot = next_slot_.fetch_add(1, std::memory_order_relaxed);
+    return start_ + std::chrono::duration_cast<Clock::duration>(interval_ * static_cast<double>(slot));
+}
+
+///  ---  Connection  ---  ///
+
+Connection::Connection(net::any_io_executor executor, tcp::endpoint endpoint, std::string host,
+                       std::chrono::milliseconds timeout)
+    : stream_{std::move(executor)}
+    , endpoint_{endpoint}
+    , host_{std::move(host)}
+    , timeout_{timeout} {
+    request_.version(11);
+    request_.keep_alive(true);
+    request_.set(http::field::host, host_);
+}
+
+net::awaitable<void> Connection::Connect() {
+    stream_.expires_after(timeout_);
+    co_await stream_.async_connect(endpoint_, net::use_awaitable);
+    stream_.socket().set_option(tcp::no_delay{true});
+    is_connected_ = true;
+}
+
+net::awaitable<void> Connection::Send(http::verb method, std::string_view target, std::string body,
+                                      std::string_view token) {
+    if (!is_connected_) {
+        co_await Connect();
+    }
+
+    request_.method(method);
+    request_.target(beast::string_view{target.data(), target.size()});
+    if (token.empty()) {
+        request_.erase(http::field::authorization);
+    } else {
+        request_.set(http::field::authorization, "Bearer "s.append(token));
+    }
+    if (body.empty()) {
+        request_.erase(http::field::content_type);
+    } else {
+        request_.set(http::field::content_type, "application/json");
+    }
+    request_.body() = std::move(body);
+    request_.prepare_payload();
+
+    // Ответ разбирается в новый объект: парсер не принимает уже заполненное сообщение
+    response_ = {};
+    try {
+        stream_.expires_after(timeout_);
+        co_await http::async_write(stream_, request_, net::use_awaitable);
+        co_await http::async_read(stream_, buffer_, response_, net::use_awaitable);
+    } catch (...) {
+        Close();
+        throw;
+    }
+    if (!response_.keep_alive()) {
+        Close();
+    }
+}
+
+void Connection::Close() noexcept {
+    beast::error_code ec;
+    stream_.socket().shutdown(tcp::socket::shutdown_both, ec);
+    stream_.close();
+    buffer_.clear();
+    is_connected_ = false;
+}
+
+///  ---  VirtualUser  ---  ///
+
+VirtualUser::VirtualUser(net::any_io_executor executor, tcp::endpoint endpoint, std::string host,
+                         const ScenarioConfig& config, Pacer& pacer, const std::atomic_bool& stop, Stats& stats,
+                         size_t index, std::uint32_t seed)
+    : connection_{std::move(executor), endpoint, std::move(host), config.timeout}
+    , config_{config}
+    , pacer_{pacer}
+    , stop_{stop}
+    , name_{"load"s + std::to_string(index)}
+    , game_{index}
+    , random_{seed}
+    , stats_{stats} {
+}
+
+net::awaitable<void> VirtualUser::Run() {
+    while (!stop_) {
+        bool is_failed = false;
+        try {
+            co_await Play();
+        } catch (const boost::system::system_error&) {
+            // Ошибка уже учтена в статистике запроса. Игра начинается заново в новом соединении
+            is_failed = true;
+        }
+        if (is_failed) {
+            ++stats_.reconnects;
+            co_await WaitUntil(Clock::now() + RECONNECT_DELAY);
+        }
+    }
+}
+
+net::awaitable<void> VirtualUser::Play() {
+    const auto& map_id = config_.maps[game_++ % config_.maps.size()];
+    auto start = pacer_.Next(Clock::now());
+    if (!co_await WaitUntil(start)) {
+        co_return;
+    }
+    token_.clear();
+    if (co_await Request(Endpoint::Join, http::verb::post, JOIN_TARGET, MakeJoinBody(name_, map_id), start)
+        != http::status::ok) {
+        co_return;
+    }
+    if (auto token = ParseJoinToken(connection_.GetResponse().body())) {
+        token_ = std::move(*token);
+    } else {
+        ++stats_[Endpoint::Join].errors;
+        co_return;
+    }
+
+    std::uniform_real_distribution<double> kind;
+    std::uniform_int_distribution<size_t> move(0, MOVES.size() - 1);
+    for (unsigned step = 0; step < config_.steps; ++step) {
+        start = pacer_.Next(Clock::now());
+        if (!co_await WaitUntil(start)) {
+            co_return;
+        }
+        const double k = kind(random_);
+        http::status status;
+        if (k < config_.players_ratio) {
+            status = co_await Request(Endpoint::Players, http::verb::get, PLAYERS_TARGET, {}, start);
+        } else if (k < config_.players_ratio + config_.state_ratio) {
+            status = co_await Request(Endpoint::State, http::verb::get, STATE_TARGET, {}, start);
+        } else {
+            status = co_await Request(Endpoint::Action, http::verb::post, ACTION_TARGET,
+                                      MakeActionBody(MOVES[move(random_)]), start);
+        }
+        if (status == http::status::unauthorized) {
+            // Токен перестал действовать - игрока отправили на покой раньше
+            co_return;
+        }
+    }
+
+    if (!config_.idle_retire) {
+        co_return;
+    }
+    // Собака останавливается, пользователь ждёт ухода на покой, опрашивая состояние
+    co_await Request(Endpoint::Action, http::verb::post, ACTION_TARGET, MakeActionBody(""sv), Clock::now());
+    while (co_await WaitUntil(Clock::now() + config_.idle_poll)) {
+        if (co_await Request(Endpoint::State, http::verb::get, STATE_TARGET, {}, Clock::now(),
+                             http::status::unauthorized) == http::status::unauthorized) {
+            ++stats_.retirements;
+            co_return;
+        }
+    }
+}
+
+net::awaitable<http::status> VirtualUser::Request(Endpoint endpoint, http::verb method, std::string_view target,
+                                                  std::string body, Clock::time_point start,
+                                                  http::status expected) {
+    auto& stats = stats_[endpoint];
+    try {
+        co_await connection_.Send(method, target, std::move(body), token_);
+    } catch (const boost::system::system_error&) {
+        stats.latency.Record(GetLatency(start));
+        ++stats.errors;
+        throw;
+    }
+    stats.latency.Record(GetLatency(start));
+    const auto status = connection_.GetResponse().result();
+    if (status != http::status::ok && status != expected) {
+        ++stats.errors;
+    }
+    co_return status;
+}
+
+net::awaitable<bool> VirtualUser::WaitUntil(Clock::time_point time) {
+    net::steady_timer timer{co_await net::this_coro::executor};
+    while (!stop_ && Clock::now() < time) {
+        timer.expires_at(std::min(time, Clock::now() + STOP_CHECK_PERIOD));
+        co_await timer.async_wait(net::use_awaitable);
+    }
+    co_return !stop_;
+}
+
+///  ---  TickDriver  ---  ///
+
+TickDriver::TickDriver(net::any_io_executor executor, tcp::endpoint endpoint, std::string host,
+                       std::chrono::milliseconds period, const std::atomic_bool& stop, Stats& stats)
+    : connection_{std::move(executor), endpoint, std::move(host), std::max(period, 1000ms)}
+    , period_{period}
+    , stop_{stop}
+    , stats_{stats} {
+}
+
+net::awaitable<void> TickDriver::Run() {
+    net::steady_timer timer{co_await net::this_coro::executor};
+    auto next = Clock::now();
+    auto& stats = stats_[Endpoint::Tick];
+    while (!stop_) {
+        next += period_;
+        timer.expires_at(next);
+        co_await timer.async_wait(net::use_awaitable);
+        const auto start = Clock::now();
+        try {
+            co_await connection_.Send(http::verb::post, TICK_TARGET, MakeTickBody(period_));
+            if (connection_.GetResponse().result() != http::status::ok) {
+                ++stats.errors;
+            }
+        } catch (const boost::system::system_error&) {
+            ++stats.errors;
+            ++stats_.reconnects;
+        }
+        stats.latency.Record(GetLatency(start));
+    }
+}
+
+std::optional<std::string> ParseJoinToken(std::string_view body) {
+    json_scanner::Scanner scanner{body};
+    std::optional<std::string> token;
+    const bool is_valid = scanner.ReadObject([&](std::string_view key) {
+        if (key == json_field::JOIN_TOKEN) {
+            return scanner.ReadString(token.emplace());
+        }
+        return scanner.SkipValue();
+    });
+    if (!is_valid || !scanner.AtEnd()) {
+        return std::nullopt;
+    }
+    return token;
+}
+
+}  // namespace load
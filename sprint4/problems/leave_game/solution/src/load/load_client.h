@@ -0,0 +1,189 @@
+#pragma once
+
+#include "latency_histogram.h"
+
+#include <boost/asio/awaitable.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/beast/core/flat_buffer.hpp>
+#include <boost/beast/core/tcp_stream.hpp>
+#include <boost/beast/http/message.hpp>
+#include <boost/beast/http/string_body.hpp>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Генератор нагрузки на игровой сервер: виртуальные пользователи проходят игровой сценарий
+// через keep-alive соединения, задержки ответов собираются в гистограммы по видам запросов
+namespace load {
+
+namespace net = boost::asio;
+namespace beast = boost::beast;
+namespace http = beast::http;
+using tcp = net::ip::tcp;
+
+using Clock = std::chrono::steady_clock;
+
+enum class Endpoint {
+    Join,
+    Action,
+    State,
+    Players,
+    Tick
+};
+
+constexpr size_t ENDPOINT_COUNT = 5;
+
+std::string_view EndpointToString(Endpoint endpoint) noexcept;
+
+struct EndpointStats {
+    LatencyHistogram latency;
+    // Ответы с неуспешным кодом и сетевые ошибки
+    std::uint64_t errors = 0;
+};
+
+struct Stats {
+    std::array<EndpointStats, ENDPOINT_COUNT> endpoints;
+    // Игроки, ушедшие на покой после бездействия
+    std::uint64_t retirements = 0;
+    std::uint64_t reconnects = 0;
+
+    EndpointStats& operator[](Endpoint endpoint) noexcept {
+        return endpoints[static_cast<size_t>(endpoint)];
+    }
+    const EndpointStats& operator[](Endpoint endpoint) const noexcept {
+        return endpoints[static_cast<size_t>(endpoint)];
+    }
+
+    void Merge(const Stats& other) noexcept;
+};
+
+// Темп запросов, общий для всех пользователей.
+// В замкнутом цикле пользователь отправляет следующий запрос после ответа на предыдущий и паузы think_time.
+// В открытом цикле запросы назначаются с постоянной частотой независимо от ответов сервера
+class Pacer {
+public:
+    // Замкнутый цикл
+    explicit Pacer(std::chrono::milliseconds think_time) noexcept;
+    // Открытый цикл
+    Pacer(double requests_per_second, Clock::time_point start) noexcept;
+
+    Pacer(const Pacer&) = delete;
+    Pacer& operator=(const Pacer&) = delete;
+
+    // Время, на которое назначен следующий запрос. Задержка отсчитывается от него, а не от фактической
+    // отправки: иначе сервер, который не успевает отвечать, сам откладывает запросы и занижает
+    // свои задержки (coordinated omission). Может вызываться из любого потока
+    Clock::time_point Next(Clock::time_point now) noexcept;
+
+private:
+    bool is_open_ = false;
+    Clock::duration think_time_{};
+    Clock::time_point start_;
+    std::chrono::duration<double, Clock::period> interval_{};
+    std::atomic<std::uint64_t> next_slot_{0};
+};
+
+// Keep-alive соединение с сервером. Переподключается, если сервер закрыл соединение
+class Connection {
+public:
+    using Response = http::response<http::string_body>;
+
+    Connection(net::any_io_executor executor, tcp::endpoint endpoint, std::string host,
+               std::chrono::milliseconds timeout);
+
+    // Отправляет запрос и читает ответ. При сетевой ошибке выбрасывает boost::system::system_error
+    net::awaitable<void> Send(http::verb method, std::string_view target,
+                              std::string body = {}, std::string_view token = {});
+    // Ответ на последний запрос
+    const Response& GetResponse() const noexcept {
+        return response_;
+    }
+    void Close() noexcept;
+
+private:
+    net::awaitable<void> Connect();
+
+    beast::tcp_stream stream_;
+    tcp::endpoint endpoint_;
+    std::string host_;
+    std::chrono::milliseconds timeout_;
+    bool is_connected_ = false;
+    http::request<http::string_body> request_;
+    beast::flat_buffer buffer_;
+    Response response_;
+};
+
+struct ScenarioConfig {
+    // Карты, к которым подключаются пользователи (по очереди)
+    std::vector<std::string> maps;
+    // Число действий и запросов состояния за одну игру
+    unsigned steps = 200;
+    // Доля запросов состояния среди шагов игры, остальное - действия
+    double state_ratio = 0.5;
+    // Доля запросов списка игроков среди шагов игры
+    double players_ratio = 0.05;
+    // После шагов игры собака останавливается, а пользователь опрашивает состояние раз в idle_poll,
+    // пока сервер не отправит игрока на покой. Иначе пользователь сразу подключается заново
+    bool idle_retire = false;
+    std::chrono::milliseconds idle_poll{1000};
+    std::chrono::milliseconds timeout{5000};
+};
+
+// Виртуальный пользователь: подключается к игре, двигает собаку и запрашивает состояние,
+// затем бросает игру или ждёт ухода на покой и подключается снова - до остановки генератора.
+// У каждого потока генератора свой io_context: пользователи потока пишут в общую статистику
+// потока stats без синхронизации
+class VirtualUser {
+public:
+    VirtualUser(net::any_io_executor executor, tcp::endpoint endpoint, std::string host,
+                const ScenarioConfig& config, Pacer& pacer, const std::atomic_bool& stop, Stats& stats,
+                size_t index, std::uint32_t seed);
+
+    net::awaitable<void> Run();
+
+private:
+    net::awaitable<void> Play();
+    // Выполняет запрос, назначенный на start, и учитывает его задержку. Возвращает код ответа
+    net::awaitable<http::status> Request(Endpoint endpoint, http::verb method, std::string_view target,
+                                         std::string body, Clock::time_point start,
+                                         http::status expected = http::status::ok);
+    // Ждёт назначенного времени. false - генератор остановлен
+    net::awaitable<bool> WaitUntil(Clock::time_point time);
+
+    Connection connection_;
+    const ScenarioConfig& config_;
+    Pacer& pacer_;
+    const std::atomic_bool& stop_;
+    std::string name_;
+    size_t game_ = 0;
+    std::string token_;
+    std::mt19937 random_;
+    Stats& stats_;
+};
+
+// Подаёт тики POST /api/v1/game/tick раз в period - для сервера, запущенного без --tick-period
+class TickDriver {
+public:
+    TickDriver(net::any_io_executor executor, tcp::endpoint endpoint, std::string host,
+               std::chrono::milliseconds period, const std::atomic_bool& stop, Stats& stats);
+
+    net::awaitable<void> Run();
+
+private:
+    Connection connection_;
+    std::chrono::milliseconds period_;
+    const std::atomic_bool& stop_;
+    Stats& stats_;
+};
+
+// Извлекает токен из ответа на запрос подключения к игре
+std::optional<std::string> ParseJoinToken(std::string_view body);
+
+}  // namespace load
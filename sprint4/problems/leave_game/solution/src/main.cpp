@@ -1,29 +1,46 @@
 #include "sdk.h"
 
 #include <boost/asio/io_context.hpp>
+#include <boost/asio/post.hpp>
+#include <boost/asio/posix/stream_descriptor.hpp>
 #include <boost/asio/signal_set.hpp>
+#include <boost/asio/steady_timer.hpp>
 #include <boost/log/utility/setup/common_attributes.hpp>
 #include <boost/log/utility/setup/console.hpp>  // add_console_log()
 #include <boost/program_options.hpp>
 #include <boost/signals2.hpp>
 
+#include <unistd.h>
+
 #include <cstdlib>
+#include <functional>
 #include <iostream>
 #include <memory>
+#include <optional>
+#include <sstream>
+#include <string>
 #include <thread>
 #include <chrono>
+#include <vector>
 
 #include "server_params.h"
 #include "json_loader.h"
 #include "request_handler.h"
+#include "http_coro_session.h"
 #include "game.h"
 #include "logger.h"
 #include "request_handler_logging.h"
 #include "json_fields.h"
 #include "app.h"
+#include "memory_records.h"
+#include "postgres/postgres.h"
 #include "ticker.h"
+#include "hot_restart.h"
+#include "state_handover.h"
+#include "sampling_profiler.h"
 
 #include "state_serialization.h"
+#include "write_ahead_log.h"
 
 using namespace std::literals;
 using milliseconds = std::chrono::milliseconds;
@@ -38,6 +55,11 @@ namespace logging = boost::log;
 
 namespace {
 
+// Сколько новый процесс ждёт передачи состояния от работающего
+constexpr auto HANDOFF_TIMEOUT = 5s;
+// Период проверки, закрылись ли соединения завершающегося после передачи процесса
+constexpr auto DRAIN_CHECK_PERIOD = 100ms;
+
 struct Args {
     bool is_dt_set = false;
     unsigned long dt;
@@ -48,6 +70,24 @@ struct Args {
     bool is_save_state_period_set = false;
     unsigned long save_state_period;
     bool is_random_spawn;
+    bool is_thread_per_core;
+    bool is_coroutine_sessions;
+    size_t max_connections = 0;
+    unsigned long idle_timeout = 30;
+    http_handler::AdmissionConfig admission;
+    std::vector<std::string> rate_limits;
+    size_t session_capacity = 0;
+    bool is_wal_path_set = false;
+    std::string wal_path;
+    unsigned long wal_sync_period = 50;
+    bool is_record_path_set = false;
+    std::string record_path;
+    bool is_memory_records = false;
+    bool is_metrics_endpoint = false;
+    bool is_profiler_endpoint = false;
+    bool is_hot_restart_socket_set = false;
+    std::string hot_restart_socket;
+    unsigned long drain_timeout = 10;
 };
 
 [[nodiscard]] std::optional<Args> ParseCommandLine(int argc, const char* const argv[]) {
@@ -70,7 +110,47 @@ struct Args {
         // Опция --save-state-period <игровое-время-в-миллисекундах>, сохраняющая свой аргумент в поле args.save_state_period
         ("save-state-period,w", po::value(&args.save_state_period)->value_name("milliseconds"s), "set game state save period")
         // Опция --randomize-spawn-points, сохраняющая свой аргумент в поле args.is_random_spawn
-        ("randomize-spawn-points", po::bool_switch(&args.is_random_spawn),"spawn dogs at random positions");
+        ("randomize-spawn-points", po::bool_switch(&args.is_random_spawn),"spawn dogs at random positions")
+        // Опция --thread-per-core включает режим "поток на ядро" с отдельным acceptor (SO_REUSEPORT) на каждое ядро
+        ("thread-per-core", po::bool_switch(&args.is_thread_per_core), "serve HTTP with an io_context and SO_REUSEPORT acceptor per core")
+        // Опция --coroutine-sessions включает обработку соединений корутинами (CoroSession)
+        ("coroutine-sessions", po::bool_switch(&args.is_coroutine_sessions), "serve HTTP connections with coroutine sessions")
+        // Опция --max-connections ограничивает число одновременных соединений, сверх лимита сервер отвечает 503
+        ("max-connections", po::value(&args.max_connections)->value_name("count"s), "set maximum number of open connections (0 - unlimited)")
+        // Опция --idle-timeout задаёт время, после которого бездействующее соединение закрывается
+        ("idle-timeout", po::value(&args.idle_timeout)->value_name("seconds"s), "set idle connection timeout")
+        // Пороги контроля допуска запросов в strand API (см. AdmissionConfig)
+        ("api-queue-limit", po::value(&args.admission.max_queue_depth)->value_name("requests"s), "set maximum API strand queue depth")
+        ("api-shed-depth", po::value(&args.admission.shed_queue_depth)->value_name("requests"s), "set API queue depth at which non-essential requests are rejected")
+        ("max-tick-lag", po::value<unsigned long>()->value_name("milliseconds"s)->notifier([&args](unsigned long lag) {
+            args.admission.max_tick_lag = std::chrono::milliseconds(lag);
+        }), "set tick lag at which non-essential requests are rejected (0 - ignore tick lag)")
+        ("retry-after", po::value<unsigned long>()->value_name("seconds"s)->notifier([&args](unsigned long seconds) {
+            args.admission.retry_after = std::chrono::seconds(seconds);
+        }), "set Retry-After value for rejected requests")
+        // Опция --rate-limit route=token_rps[/ip_rps] задаёт бюджет запросов маршрута на токен игрока и IP клиента.
+        // Может быть указана несколько раз
+        ("rate-limit", po::value(&args.rate_limits)->composing()->value_name("route=token_rps[/ip_rps]"s),
+            "limit request rate of API route (maps, join, players, state, action, batch, tick, records)")
+        // Опция --session-capacity ограничивает число собак в игровой сессии. Заполненная карта получает новую сессию
+        ("session-capacity", po::value(&args.session_capacity)->value_name("dogs"s), "set maximum number of dogs in a game session (0 - unlimited)")
+        // Опция --wal-file <путь-к-файлу> включает журнал упреждающей записи, который дополняет снимки состояния
+        ("wal-file", po::value(&args.wal_path)->value_name("file"s), "set write-ahead log path (requires --state-file)")
+        // Опция --wal-sync-period задаёт период групповой записи журнала на диск
+        ("wal-sync-period", po::value(&args.wal_sync_period)->value_name("milliseconds"s), "set write-ahead log sync period")
+        // Опция --record-file <путь-к-файлу> включает запись вызовов API для воспроизведения утилитой game_replay
+        ("record-file", po::value(&args.record_path)->value_name("file"s), "record game API calls for game_replay")
+        // Опция --memory-records хранит рекорды в памяти вместо PostgreSQL - для нагрузочного тестирования (game_load)
+        ("memory-records", po::bool_switch(&args.is_memory_records), "keep player records in memory instead of PostgreSQL")
+        // Опция --metrics-endpoint открывает /api/v1/metrics: очередь strand API, отказы, тики и соединения
+        ("metrics-endpoint", po::bool_switch(&args.is_metrics_endpoint), "enable server metrics at /api/v1/metrics")
+        // Опция --profiler-endpoint открывает /api/v1/profile: запуск встроенного профилировщика и свёрнутые стеки
+        ("profiler-endpoint", po::bool_switch(&args.is_profiler_endpoint), "enable sampling profiler control at /api/v1/profile")
+        // Опция --hot-restart-socket <путь> включает горячий перезапуск: сервер, запущенный с тем же путём,
+        // забирает у работающего слушающие сокеты и состояние игры
+        ("hot-restart-socket", po::value(&args.hot_restart_socket)->value_name("path"s), "set hot restart control socket path")
+        // Опция --drain-timeout ограничивает время, за которое процесс, передавший состояние, дожидается закрытия соединений
+        ("drain-timeout", po::value(&args.drain_timeout)->value_name("seconds"s), "set connection drain timeout after hot restart");
 
     // variables_map хранит значения опций после разбора
     po::variables_map vm;
@@ -102,6 +182,21 @@ struct Args {
         args.is_save_state_period_set = true;
     }
 
+    if (vm.contains("record-file"s)) {
+        args.is_record_path_set = true;
+    }
+
+    if (vm.contains("hot-restart-socket"s)) {
+        args.is_hot_restart_socket_set = true;
+    }
+
+    if (vm.contains("wal-file"s)) {
+        if (!args.is_state_path_set) {
+            throw std::runtime_error("Write-ahead log requires state file"s);
+        }
+        args.is_wal_path_set = true;
+    }
+
     // С опциями программы всё в порядке, возвращаем структуру args
     return args;
 }
@@ -131,6 +226,7 @@ int main(int argc, const char* argv[]) {
 
         // Загружаем карту из файла и построить модель игры
         auto [game,extra_data] = json_loader::LoadGame(args->config_file);
+        game.SetSessionCapacity(args->session_capacity);
 
         // Инициализируем io_context
         const unsigned num_threads = std::thread::hardware_concurrency();
@@ -139,56 +235,153 @@ int main(int argc, const char* argv[]) {
         // strand для выполнения запросов к API
         auto api_strand = net::make_strand(ioc);
 
-        // Получаем URL для подключения к базе данных
-        const char* db_url = std::getenv("GAME_DB_URL");
-        if (!db_url) {
-            throw std::runtime_error("DB URL is not specified");
+        // Рекорды игроков хранятся в БД или, для нагрузочного тестирования, в памяти
+        std::optional<postgres::Database> db;
+        app::MemoryPlayerRepository memory_records;
+        if (!args->is_memory_records) {
+            // Получаем URL для подключения к базе данных
+            const char* db_url = std::getenv("GAME_DB_URL");
+            if (!db_url) {
+                throw std::runtime_error("DB URL is not specified");
+            }
+            db.emplace(pqxx::connection{db_url});
         }
+        app::PlayerRepository& records = db ? static_cast<app::PlayerRepository&>(db->GetPlayers()) : memory_records;
 
         // Объект Application содержит сценарии использования
-        app::Application app(game, db_url);
+        app::Application app(game, records);
+
+        // Контроль допуска запросов в strand API
+        http_handler::AdmissionControl admission(args->admission);
+
+        // Ограничитель частоты запросов с бюджетами маршрутов из командной строки
+        http_handler::RateLimitConfig rate_limit_config;
+        for (const auto& rate_limit : args->rate_limits) {
+            auto route_budget = http_handler::ParseRouteBudget(rate_limit);
+            if (!route_budget) {
+                throw std::runtime_error("Invalid rate limit: "s + rate_limit);
+            }
+            rate_limit_config[route_budget->first] = route_budget->second;
+        }
+        http_handler::RateLimiter rate_limiter(rate_limit_config);
 
         // Объект StateSerializer содержит механизмы сериализации/десериализации состояния игры
         serialization::StateSerializer serializer(game, app);
 
+        // Журнал упреждающей записи. Записи, вошедшие в очередной снимок состояния, из него удаляются.
+        // Объявлен раньше передачи состояния, которая дописывает его в своём потоке
+        std::optional<wal::LogWriter> wal_writer;
+
+        // Передача состояния новому процессу при горячем перезапуске. С её начала тики и сохранение
+        // состояния прекращаются
+        hot_restart::StateHandover handover(app, serializer, admission);
+
         if (args->is_dt_set) {
             // Настраиваем вызов метода Application::ExecuteTick каждые args->dt миллисекунд внутри strand
             auto ticker = std::make_shared<utils::Ticker>(api_strand, std::chrono::milliseconds(args->dt),
-                [&app](std::chrono::milliseconds delta) { app.ExecuteTick(delta); }
+                [&app, &admission, &handover, period = std::chrono::milliseconds(args->dt)](std::chrono::milliseconds delta) {
+                    if (handover.IsHandedOff()) {
+                        return;
+                    }
+                    // Тик опаздывает, если strand перегружен или предыдущий тик выполнялся слишком долго
+                    admission.ReportTickLag(delta - period);
+                    app.ExecuteTick(delta);
+                }
             );
             ticker->Start();
         }
 
-        sig::scoped_connection conn;
-        if (args->is_state_path_set) {
-            // Пробуем азгрузить состояние игры из файла
-            if (std::filesystem::exists(args->state_path)) {
-                try {
-                    serializer.Deserialize(args->state_path);
-                } catch (const std::exception& ex) {
-                    std::cerr << ex.what() << std::endl;
-                    return EXIT_FAILURE;
+        const auto save_state = [&serializer, &args, &wal_writer] {
+            serializer.Serialize(args->state_path, wal_writer ? wal_writer->GetLastLsn() : 0);
+            if (wal_writer) {
+                wal_writer->Truncate();
+            }
+        };
+
+        // При горячем перезапуске слушающие сокеты и состояние игры забираются у работающего процесса.
+        // С этого момента он перестаёт выполнять запросы к API, поэтому всё, что может долго
+        // готовиться (конфигурация, подключение к БД), сделано раньше
+        const auto takeover_start = std::chrono::steady_clock::now();
+        std::optional<hot_restart::Handoff> handoff;
+        if (args->is_hot_restart_socket_set) {
+            handoff = hot_restart::RequestHandoff(args->hot_restart_socket, HANDOFF_TIMEOUT);
+        }
+
+        // Пробуем азгрузить состояние игры из файла и повторить действия, записанные в журнал после него.
+        // Переданное предыдущим процессом состояние заменяет файл: оно новее и уже включает журнал
+        try {
+            wal::Lsn last_lsn = 0;
+            if (handoff) {
+                std::istringstream state{handoff->state};
+                last_lsn = serializer.Deserialize(state);
+            } else if (args->is_state_path_set && std::filesystem::exists(args->state_path)) {
+                last_lsn = serializer.Deserialize(args->state_path);
+            }
+            if (args->is_wal_path_set) {
+                if (std::filesystem::exists(args->wal_path)) {
+                    last_lsn = app.ReplayWriteAheadLog(args->wal_path, last_lsn);
                 }
+                // Восстановленное состояние сохраняется снимком, после чего журнал начинается заново
+                serializer.Serialize(args->state_path, last_lsn);
+                wal_writer.emplace(args->wal_path, milliseconds(args->wal_sync_period), last_lsn);
+                app.SetWriteAheadLog(&*wal_writer);
             }
+        } catch (const std::exception& ex) {
+            std::cerr << ex.what() << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        // Запись вызовов начинается с восстановленного состояния
+        std::optional<recording::Recorder> recorder;
+        if (args->is_record_path_set) {
+            recorder.emplace(args->record_path);
+            recorder->Snapshot(game, app);
+            app.SetRecorder(&*recorder);
+        }
 
+        sig::scoped_connection conn;
+        if (args->is_state_path_set) {
             // Если задано сохранение состояния по времени, то настраиваем обработчик
             if (args->is_save_state_period_set) {
                 // Лямбда-функция будет вызываться всякий раз, когда Application будет слать сигнал tick
                 // Функция перестанет вызываться после разрушения conn.
-                conn = app.DoOnTick([total = 0ms, &serializer, &args](milliseconds delta) mutable {
-                    serializer.Serialize(args->state_path);
-                    total += delta;
-                    std::cout << "Tick! Delta: " << delta.count() << "ms, Total: " << total.count() << "ms" << std::endl;
+                // Снимок сохраняется, когда с предыдущего прошло не меньше save-state-period игрового времени
+                conn = app.DoOnTick([since_save = 0ms, period = milliseconds(args->save_state_period), &save_state](milliseconds delta) mutable {
+                    since_save += delta;
+                    if (since_save >= period) {
+                        save_state();
+                        since_save = 0ms;
+                    }
                 });
             }
         }
 
+        // В режиме "поток на ядро" HTTP-соединения обслуживаются отдельным пулом io_context,
+        // а в ioc остаются только api_strand, тикер и обработка сигналов
+        std::optional<http_server::IoContextPool> per_core_pool;
+        if (args->is_thread_per_core) {
+            per_core_pool.emplace(num_threads);
+        }
+
+        // Учёт соединений: лимит, таймауты бездействия на общем колесе таймеров и счётчики.
+        // Один на все acceptor, чтобы лимит был общим и в режиме "поток на ядро"
+        auto connections = std::make_shared<http_server::ConnectionManager>(
+            ioc, std::chrono::seconds(args->idle_timeout), args->max_connections);
+        connections->Start();
+
+        const auto stop_server = [&ioc, &per_core_pool] {
+            if (per_core_pool) {
+                per_core_pool->Stop();
+            }
+            ioc.stop();
+        };
+
         // Добавляем асинхронный обработчик сигналов SIGINT и SIGTERM
         // Подписываемся на сигналы и при их получении завершаем работу сервера
         net::signal_set signals(ioc, SIGINT, SIGTERM);
-        signals.async_wait([&ioc](const sys::error_code& ec, [[maybe_unused]] int signal_number) {
+        signals.async_wait([&stop_server](const sys::error_code& ec, [[maybe_unused]] int signal_number) {
             if (!ec) {
-                ioc.stop();
+                stop_server();
             }
             BOOST_LOG_TRIVIAL(info) << boost::log::add_value(additional_data, boost::json::value({json_field::ERROR_CODE, EXIT_SUCCESS}))
                                     << server_params::EXIT_MESSAGE;
@@ -198,16 +391,126 @@ int main(int argc, const char* argv[]) {
         fs::path base_path{std::string(args->static_path)};
 
         // Создаём обработчик HTTP-запросов и связываем его с моделью игры
-        auto handler = make_shared<http_handler::RequestHandler>(api_strand, app, base_path, extra_data);
+        auto handler = make_shared<http_handler::RequestHandler>(api_strand, app, base_path, extra_data, admission, rate_limiter,
+                                                                 *connections, args->is_metrics_endpoint, args->is_profiler_endpoint);
 
-        // endpoint нужен и известен только внутри логгера, поэтому тут он не нужен
-        http_handler::LoggingRequestHandler logging_handler{ [handler](auto&& req, auto&& send) {
-            (*handler)(std::forward<decltype(req)>(req), std::forward<decltype(send)>(send));
+        // endpoint известен только внутри логгера, он передаёт его дальше для ограничения частоты запросов
+        http_handler::LoggingRequestHandler logging_handler{ [handler](auto&& req, auto&& send, const auto& endpoint) {
+            (*handler)(std::forward<decltype(req)>(req), std::forward<decltype(send)>(send), endpoint);
         } };
 
         const auto address = net::ip::make_address(server_params::ADRESS);
+        // Слушающие сокеты предыдущего процесса. Пустой список - сокеты открываются заново
+        const std::vector<int> inherited_fds = handoff ? handoff->listen_fds : std::vector<int>{};
         // Запустить обработчик HTTP-запросов, делегируя их обработчику запросов
-        http_server::ServeHttp(ioc, {address, server_params::PORT}, logging_handler);
+        http_server::Listeners listeners;
+        if (per_core_pool && args->is_coroutine_sessions) {
+            listeners = http_server::ServeHttpPerCore<http_server::CoroSession>(*per_core_pool, {address, server_params::PORT}, logging_handler, connections, inherited_fds);
+        } else if (per_core_pool) {
+            listeners = http_server::ServeHttpPerCore(*per_core_pool, {address, server_params::PORT}, logging_handler, connections, inherited_fds);
+        } else if (args->is_coroutine_sessions) {
+            listeners = http_server::ServeHttp<http_server::CoroSession>(ioc, {address, server_params::PORT}, logging_handler, connections, inherited_fds);
+        } else {
+            listeners = http_server::ServeHttp(ioc, {address, server_params::PORT}, logging_handler, connections, inherited_fds);
+        }
+        const auto takeover_time = std::chrono::steady_clock::now() - takeover_start;
+
+        // Горячий перезапуск: ждём подключения нового процесса к управляющему сокету.
+        // Сокет создаётся после передачи состояния, поэтому файл предыдущего процесса заменяется только сейчас
+        std::optional<hot_restart::ControlSocket> control_socket;
+        // Копия дескриптора управляющего сокета, за готовностью которого следит ioc
+        net::posix::stream_descriptor control_watch(ioc);
+        net::steady_timer drain_timer(ioc);
+        std::chrono::steady_clock::time_point drain_deadline;
+        std::function<void()> wait_for_successor;
+        std::function<void()> wait_for_drain;
+
+        // Процесс, передавший состояние, дожидается закрытия своих соединений и завершается
+        wait_for_drain = [&] {
+            if (connections->GetStats().open == 0 || std::chrono::steady_clock::now() >= drain_deadline) {
+                return stop_server();
+            }
+            drain_timer.expires_after(DRAIN_CHECK_PERIOD);
+            drain_timer.async_wait([&wait_for_drain](sys::error_code ec) {
+                if (!ec) {
+                    wait_for_drain();
+                }
+            });
+        };
+
+        // Передаёт новому процессу слушающие сокеты и состояние. Новые запросы к API и соединения
+        // перестают приниматься сразу, а снимок делается в api_strand после запросов, уже стоящих
+        // в очереди: они выполняются как обычно. Соединения, пришедшие тем временем, ждут в очереди
+        // слушающих сокетов и достанутся новому процессу. Отправка выполняется в отдельном потоке,
+        // её итог обрабатывается снова в api_strand
+        const auto hand_off = [&](int successor) {
+            const auto start = std::chrono::steady_clock::now();
+            admission.StartDraining();
+            for (const auto& listener : listeners) {
+                listener->Pause();
+            }
+
+            net::post(api_strand, [&, start, successor] {
+                handover.Begin();
+
+                std::vector<int> listen_fds;
+                for (const auto& listener : listeners) {
+                    listen_fds.push_back(listener->GetNativeHandle());
+                }
+                handover.Send(successor, listen_fds, [&, start, socket_count = listen_fds.size()](std::exception_ptr error) {
+                    net::post(api_strand, [&, start, socket_count, error] {
+                        if (error) {
+                            // Новый процесс не получил состояние - продолжаем работу
+                            try {
+                                std::rethrow_exception(error);
+                            } catch (const std::exception& ex) {
+                                BOOST_LOG_TRIVIAL(error) << boost::log::add_value(additional_data, boost::json::value({json_field::ERROR_CODE, EXIT_FAILURE}))
+                                                         << ex.what();
+                            }
+                            handover.Abort();
+                            for (const auto& listener : listeners) {
+                                listener->Resume();
+                            }
+                            return wait_for_successor();
+                        }
+                        // Слушающие сокеты теперь у нового процесса - свои копии закрываем
+                        for (const auto& listener : listeners) {
+                            listener->Stop();
+                        }
+
+                        boost::json::object handoff_jobject;
+                        handoff_jobject[json_field::HOT_RESTART_STATE_SIZE] = handover.GetState().size();
+                        handoff_jobject[json_field::HOT_RESTART_SOCKETS] = socket_count;
+                        handoff_jobject[json_field::HOT_RESTART_TIME_US] =
+                            std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+                        BOOST_LOG_TRIVIAL(info) << boost::log::add_value(additional_data, boost::json::value(handoff_jobject))
+                                                << server_params::HANDOFF_MESSAGE;
+
+                        drain_deadline = std::chrono::steady_clock::now() + std::chrono::seconds(args->drain_timeout);
+                        net::post(ioc, wait_for_drain);
+                    });
+                });
+            });
+        };
+
+        wait_for_successor = [&] {
+            control_watch.async_wait(net::posix::stream_descriptor::wait_read, [&](sys::error_code ec) {
+                if (ec) {
+                    return;
+                }
+                auto successor = control_socket->Accept();
+                if (!successor) {
+                    return wait_for_successor();
+                }
+                hand_off(*successor);
+            });
+        };
+
+        if (args->is_hot_restart_socket_set) {
+            control_socket.emplace(args->hot_restart_socket);
+            control_watch.assign(::dup(control_socket->GetFd()));
+            wait_for_successor();
+        }
 
         // Настраиваем логгер
         boost::log::add_common_attributes(); 
@@ -224,15 +527,52 @@ int main(int argc, const char* argv[]) {
         BOOST_LOG_TRIVIAL(info) << boost::log::add_value(additional_data, boost::json::value(server_params_jobject))
                                 << server_params::START_MESSAGE;
 
+        if (handoff) {
+            // Время от запроса состояния до начала приёма соединений: всё это время запросы к API ждут
+            boost::json::object takeover_jobject;
+            takeover_jobject[json_field::HOT_RESTART_STATE_SIZE] = handoff->state.size();
+            takeover_jobject[json_field::HOT_RESTART_SOCKETS] = handoff->listen_fds.size();
+            takeover_jobject[json_field::HOT_RESTART_TIME_US] =
+                std::chrono::duration_cast<std::chrono::microseconds>(takeover_time).count();
+            BOOST_LOG_TRIVIAL(info) << boost::log::add_value(additional_data, boost::json::value(takeover_jobject))
+                                    << server_params::TAKEOVER_MESSAGE;
+        }
+
         // Запускаем обработку асинхронных операций
-        RunWorkers(std::max(1u, num_threads), [&ioc] {
+        if (per_core_pool) {
+            // Запросы к API всё равно выполняются последовательно в api_strand, поэтому ioc хватает одного потока
+            per_core_pool->Start();
+            profiler::RegisterThread();
             ioc.run();
-        });
+            per_core_pool->Stop();
+        } else {
+            RunWorkers(std::max(1u, num_threads), [&ioc] {
+                // Профилировщик раскручивает стеки только потоков с известными границами стека
+                profiler::RegisterThread();
+                ioc.run();
+            });
+        }
+        // Сбор сэмплов, запущенный через /api/v1/profile/start, завершается до выхода из main
+        profiler::Stop();
+
+        const auto connection_stats = connections->GetStats();
+        boost::json::object connections_jobject;
+        connections_jobject[json_field::CONNECTIONS_OPEN] = connection_stats.open;
+        connections_jobject[json_field::CONNECTIONS_IDLE] = connection_stats.idle;
+        connections_jobject[json_field::CONNECTIONS_REAPED] = connection_stats.reaped;
+        connections_jobject[json_field::CONNECTIONS_REJECTED] = connection_stats.rejected;
+        BOOST_LOG_TRIVIAL(info) << boost::log::add_value(additional_data, boost::json::value(connections_jobject))
+                                << server_params::CONNECTIONS_MESSAGE;
+
+        // Запись завершается хешем итогового состояния: по нему game_replay проверяет воспроизведение
+        if (recorder) {
+            recorder->Finish(recording::HashGameState(game, app.GetPlayers()));
+        }
 
         // В этой точке все асинхронные операции уже завершены и можно 
-        // сохранить состояние сервера в файл
-        if (args->is_state_path_set) {
-            serializer.Serialize(args->state_path);
+        // сохранить состояние сервера в файл. Переданное новому процессу состояние сохраняет он
+        if (args->is_state_path_set && !handover.IsHandedOff()) {
+            save_state();
         }
     } catch (const std::exception& ex) {
         BOOST_LOG_TRIVIAL(error) << boost::log::add_value(additional_data, boost::json::value({json_field::ERROR_CODE, EXIT_FAILURE}))
@@ -0,0 +1,123 @@
+#pragma once
+
+#include "item.h"
+
+#include <algorithm>
+#include <array>
+#include <memory>
+
+namespace model {
+
+// Предмет в рюкзаке. Положение на карте уже не нужно: для очков и состояния игры хватает Id, типа и ценности
+struct BagItem {
+    Item::Id id;
+    Item::Type type;
+    Item::Value value;
+};
+
+// Рюкзак собаки: предметы хранятся по значению прямо в объекте собаки.
+// Вместимость рюкзака задаётся картой и обычно мала, поэтому до INLINE_CAPACITY предметов
+// память не выделяется. Для карт с большей вместимостью место резервируется один раз (Reserve)
+class Bag {
+public:
+    static constexpr size_t INLINE_CAPACITY = 3;
+
+    Bag() = default;
+
+    Bag(const Bag& other) {
+        Reserve(other.size_);
+        std::copy_n(other.GetData(), other.size_, GetData());
+        size_ = other.size_;
+    }
+
+    Bag& operator=(const Bag& other) {
+        if (this != &other) {
+            size_ = 0;
+            Reserve(other.size_);
+            std::copy_n(other.GetData(), other.size_, GetData());
+            size_ = other.size_;
+        }
+        return *this;
+    }
+
+    // Перемещённый рюкзак остаётся пустым и снова использует встроенное хранилище
+    Bag(Bag&& other) noexcept {
+        MoveFrom(other);
+    }
+
+    Bag& operator=(Bag&& other) noexcept {
+        if (this != &other) {
+            MoveFrom(other);
+        }
+        return *this;
+    }
+
+    // Гарантирует место под capacity предметов
+    void Reserve(size_t capacity) {
+        if (capacity <= capacity_) {
+            return;
+        }
+        auto heap = std::make_unique<BagItem[]>(capacity);
+        std::copy_n(GetData(), size_, heap.get());
+        heap_ = std::move(heap);
+        capacity_ = capacity;
+    }
+
+    void Add(const BagItem& item) {
+        if (size_ == capacity_) {
+            Reserve(capacity_ * 2);
+        }
+        GetData()[size_++] = item;
+    }
+
+    void Clear() noexcept {
+        size_ = 0;
+    }
+
+    size_t Size() const noexcept {
+        return size_;
+    }
+
+    bool Empty() const noexcept {
+        return size_ == 0;
+    }
+
+    size_t GetCapacity() const noexcept {
+        return capacity_;
+    }
+
+    const BagItem* begin() const noexcept {
+        return GetData();
+    }
+
+    const BagItem* end() const noexcept {
+        return GetData() + size_;
+    }
+
+private:
+    void MoveFrom(Bag& other) noexcept {
+        heap_ = std::move(other.heap_);
+        if (!heap_) {
+            std::copy_n(other.inline_.data(), other.size_, inline_.data());
+        }
+        size_ = other.size_;
+        capacity_ = other.capacity_;
+        other.size_ = 0;
+        other.capacity_ = INLINE_CAPACITY;
+    }
+
+    BagItem* GetData() noexcept {
+        return heap_ ? heap_.get() : inline_.data();
+    }
+
+    const BagItem* GetData() const noexcept {
+        return heap_ ? heap_.get() : inline_.data();
+    }
+
+    std::array<BagItem, INLINE_CAPACITY> inline_{};
+    std::unique_ptr<BagItem[]> heap_;
+    size_t size_ = 0;
+    size_t capacity_ = INLINE_CAPACITY;
+};
+
+}  // namespace model
@@ -3,9 +3,9 @@
 #include "model_geom.h"
 #include "tagged.h"
 #include "item.h"
+#include "bag.h"
 #include "serializer.h"
 
-#include <memory>
 #include <optional>
 
 namespace model {
@@ -14,7 +14,7 @@ class Dog {
 public:
     using Id = util::Tagged<std::uint32_t, Dog>;
     using Name = util::Tagged<std::string, Dog>;
-    using Bag = std::vector<std::shared_ptr<Item>>;
+    using Bag = model::Bag;
 
     Dog(Id id, Name name, Position position = {0.0, 0.0}, Speed speed = {0.0, 0.0}, Direction direction = Direction::NORTH ) noexcept
         : id_{std::move(id)}
@@ -65,15 +65,21 @@ public:
     }
 
     size_t GetBagSize() const noexcept {
-        return bag_.size();
+        return bag_.Size();
     }
 
-    void TakeItem(std::shared_ptr<Item> item) {
-        bag_.push_back(item);
+    // Резервирует место под вместимость рюкзака на карте, чтобы подбор предметов не выделял память
+    void ReserveBag(size_t capacity) {
+        bag_.Reserve(capacity);
     }
 
-    void ClearBag() {
-        bag_.clear();
+    // Кладёт в рюкзак копию предмета без его положения на карте
+    void TakeItem(const Item& item) {
+        bag_.Add({item.GetId(), item.GetType(), item.GetValue()});
+    }
+
+    void ClearBag() noexcept {
+        bag_.Clear();
     }
 
     int GetScore() const noexcept {
@@ -89,8 +95,8 @@ public:
     }
 
     void SaveBag() {
-        for (auto item : bag_) {
-            score_ += item->GetValue();
+        for (const auto& item : bag_) {
+            score_ += item.value;
         }
         ClearBag();
     }
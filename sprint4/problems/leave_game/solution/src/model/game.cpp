@@ -1,5 +1,7 @@
 #include "game.h"
 
+#include <algorithm>
+
 namespace model {
 using namespace std::literals;
 
@@ -17,31 +19,27 @@ void Game::AddMap(const Map& map) {
     }
 }
 
-GameSession* Game::CreateSession(const Map::Id& map_id) {
+GameSession* Game::CreateSession(const Map::Id& map_id, std::optional<GameSession::Id> id) {
     //  Найдём карту, к которой хотим подключиться
     auto map = FindMap(map_id);
     if( !map ) {
         throw std::invalid_argument("Map with id "s + *map_id + " isn`t exists"s);
     }
 
-    // Карта есть. Пробуем добавить новую сессию
-    const size_t index = sessions_.size();
-    if (auto [it, inserted] = map_id_to_session_index_.emplace(map_id, index); !inserted) {
-        // Сессия есть для карты с таким Id. Заново создавать нельзя!
-        throw std::invalid_argument("Session for map with id "s + *map_id + " already exists"s);
-    } else {
-        // Создаём новую сессию, привязанную к указанной карте
-        GameSession* new_session = new GameSession(*map, &loot_generator_);
-        try {
-            sessions_.emplace_back(new_session);
-        } catch (...) {
-            // Не получилось. Откатываем изменения в map_id_to_map_index_
-            map_id_to_session_index_.erase(it);
-            delete new_session;
-            throw;
-        }
+    GameSession::Id session_id = id.value_or(GameSession::Id{next_session_id_});
+    if ( FindSessionById(session_id) ) {
+        throw std::invalid_argument("Session with id "s + std::to_string(*session_id) + " already exists"s);
     }
-    return sessions_.back();
+    next_session_id_ = std::max(next_session_id_, *session_id + 1);
+
+    // Создаём новую сессию, привязанную к указанной карте
+    auto new_session = std::make_unique<GameSession>(session_id, *map, &loot_generator_);
+    auto& map_sessions = map_id_to_sessions_[map_id];
+    map_sessions.reserve(map_sessions.size() + 1);
+    sessions_.push_back(new_session.get());
+    // После резервирования добавление не бросает исключений
+    map_sessions.push_back(new_session.get());
+    return new_session.release();
 }
 
 const Map* Game::FindMap(const Map::Id& id) const noexcept {
@@ -53,15 +51,53 @@ const Map* Game::FindMap(const Map::Id& id) const noexcept {
 
 // Возвращает указатель на игровую сесссию с возможностью изменения
 GameSession* Game::FindSession(const Map::Id& id) {
-    // В данной реализации одна карта (MapId) соответсвует одной сессии
-    // При необходимости можно будет переделать, чтобы на одной карте было несколько сессий.
-    // Для этого нужно будет добавить критерий "переполнения" сессии и создания новой, например, по количеству 
-    // игроков в текущей найденной сессии
-    if (auto it = map_id_to_session_index_.find(id); it != map_id_to_session_index_.end()) {
-        return sessions_.at(it->second);
-    } else {
-        // Если не нашли сессию для игрока, пробуем создать новую
-        return CreateSession(id);
+    // Популярная карта не должна превращаться в одну большую сессию: стоимость тика и выдачи
+    // состояния растёт быстрее числа собак. Поэтому игрок попадает в наименее загруженную
+    // сессию карты, а когда свободных мест нет, для карты создаётся ещё одна сессия
+    GameSession* least_loaded = nullptr;
+    if (auto it = map_id_to_sessions_.find(id); it != map_id_to_sessions_.end()) {
+        for (auto session : it->second) {
+            if (!least_loaded || session->GetDogs().size() < least_loaded->GetDogs().size()) {
+                least_loaded = session;
+            }
+        }
+    }
+    if (least_loaded && (session_capacity_ == 0 || least_loaded->GetDogs().size() < session_capacity_)) {
+        return least_loaded;
+    }
+    // Если не нашли сессию для игрока, пробуем создать новую
+    return CreateSession(id);
+}
+
+GameSession* Game::FindSessionById(const GameSession::Id& id) noexcept {
+    auto it = std::find_if(sessions_.begin(), sessions_.end(), [&id](const GameSession* session) {
+        return session->GetId() == id;
+    });
+    return it != sessions_.end() ? *it : nullptr;
+}
+
+void Game::RemoveEmptySessions() {
+    std::vector<GameSession*> removed;
+    for (auto& [map_id, map_sessions] : map_id_to_sessions_) {
+        // Последнюю сессию карты оставляем, даже если она пуста
+        for (auto it = map_sessions.begin(); it != map_sessions.end() && map_sessions.size() > 1;) {
+            if ((*it)->GetDogs().empty()) {
+                removed.push_back(*it);
+                it = map_sessions.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+    if (removed.empty()) {
+        return;
+    }
+
+    std::erase_if(sessions_, [&removed](const GameSession* session) {
+        return std::find(removed.begin(), removed.end(), session) != removed.end();
+    });
+    for (auto session : removed) {
+        delete session;
     }
 }
 
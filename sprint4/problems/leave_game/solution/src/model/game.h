@@ -3,6 +3,8 @@
 #include "game_session.h"
 #include "loot_generator.h"
 
+#include <optional>
+
 namespace model {
 
 class Game {
@@ -25,7 +27,8 @@ public:
     }
 
     void AddMap(const Map& map);
-    GameSession* CreateSession(const Map::Id& map_id);
+    // Создаёт на карте новую сессию. Идентификатор задаётся явно при восстановлении сохранённого состояния
+    GameSession* CreateSession(const Map::Id& map_id, std::optional<GameSession::Id> id = std::nullopt);
 
     const Maps& GetMaps() const noexcept {
         return maps_;
@@ -36,7 +39,21 @@ public:
     }
 
     const Map* FindMap(const Map::Id& id) const noexcept;
+    // Выбирает сессию для нового игрока: наименее загруженную из сессий карты, в которых есть места.
+    // Если все сессии карты заполнены, создаёт новую
     GameSession* FindSession(const Map::Id& id);
+    GameSession* FindSessionById(const GameSession::Id& id) noexcept;
+    // Удаляет сессии, в которых не осталось собак. Одна сессия карты сохраняется вместе с лутом на ней
+    void RemoveEmptySessions();
+
+    size_t GetSessionCapacity() const noexcept {
+        return session_capacity_;
+    }
+
+    // Максимальное число собак в сессии. 0 - без ограничения, тогда на карте одна сессия
+    void SetSessionCapacity(size_t capacity) noexcept {
+        session_capacity_ = capacity;
+    }
 
     const DynamicDimension GetDefaultDogSpeed() const noexcept {
         return defuault_dog_speed_;
@@ -50,9 +67,18 @@ public:
         return dog_retirement_time_;
     }
 
+    // Генератор трофеев, общий для всех сессий
+    loot_gen::LootGenerator& GetLootGenerator() noexcept {
+        return loot_generator_;
+    }
+    const loot_gen::LootGenerator& GetLootGenerator() const noexcept {
+        return loot_generator_;
+    }
+
 private:
     using MapIdHasher = util::TaggedHasher<Map::Id>;
     using MapIdToIndex = std::unordered_map<Map::Id, size_t, MapIdHasher>;
+    using MapIdToSessions = std::unordered_map<Map::Id, GameSessions, MapIdHasher>;
 
     DynamicDimension defuault_dog_speed_;
     int default_bag_capacity_;
@@ -62,7 +88,10 @@ private:
     MapIdToIndex map_id_to_map_index_;
 
     GameSessions sessions_;
-    MapIdToIndex map_id_to_session_index_;
+    // Сессии каждой карты
+    MapIdToSessions map_id_to_sessions_;
+    std::uint32_t next_session_id_ = 0;
+    size_t session_capacity_ = 0;
 
     loot_gen::LootGenerator loot_generator_;
 };
@@ -1,27 +1,62 @@
 #include "game_session.h"
 
 #include "collision_detector.h"
+#include "collision_batch.h"
+#include "sampling_profiler.h"
 
+#include <algorithm>
 #include <memory>
 #include <optional>
 #include <set>
 #include <type_traits>
 #include <unordered_set>
-#include <variant>
 
 namespace model {
 using namespace std::string_literals;
 
+namespace {
+
+// Замер этапов тика. Без профиля часы не опрашиваются
+class PhaseTimer {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    explicit PhaseTimer(TickProfile* profile) noexcept
+        : profile_{profile}
+        , start_{profile ? Clock::now() : Clock::time_point{}} {
+    }
+
+    // Относит к этапу phase время, прошедшее с предыдущей отметки
+    void Mark(TickProfile::Duration TickProfile::*phase) noexcept {
+        if (profile_) {
+            const auto now = Clock::now();
+            profile_->*phase += now - start_;
+            start_ = now;
+        }
+    }
+
+private:
+    TickProfile* profile_;
+    Clock::time_point start_;
+};
+
+}  // namespace
+
 Dog* GameSession::AddDog(Position pos, const Dog::Name& name) {
+    // Накопленный простой не должен достаться новой собаке
+    SyncDogTimers();
     const size_t index = dogs_.size();  // Получаем незанятый индекс
-    // Здесь должна быть генерация уникального Id собаки. Пока берём просто индекс.
+    // Id не совпадает с индексом: после ухода собак индексы освобождаются, а Id повторяться не должны
+    const size_t id = next_dog_index_;
     // Пробуем добавить
-    if (auto [it, inserted] = dog_id_to_index_.emplace(next_dog_index_, index); !inserted) {
-        throw std::invalid_argument("Dog with id "s + std::to_string(index) + " already exists"s);
+    if (auto [it, inserted] = dog_id_to_index_.emplace(id, index); !inserted) {
+        throw std::invalid_argument("Dog with id "s + std::to_string(id) + " already exists"s);
     } else {
-        // Создаём на основе индекса и имени экземпляр собаки
+        // Создаём на основе Id и имени экземпляр собаки
         try {
-            dogs_.emplace_back(std::make_shared<Dog>(model::Dog::Id(index), name, pos));
+            auto dog = std::make_shared<Dog>(model::Dog::Id(id), name, pos);
+            dog->ReserveBag(static_cast<size_t>(map_->GetBagCapacity()));
+            dogs_.emplace_back(std::move(dog));
         } catch (...) {
             dog_id_to_index_.erase(it);
             throw;
@@ -32,29 +67,42 @@ Dog* GameSession::AddDog(Position pos, const Dog::Name& name) {
 }
 
 void GameSession::AddDog(const Dog& dog) {
+    SyncDogTimers();
     const size_t id = *dog.GetId();  // Получаем сохранённый индекс
     const size_t index = dogs_.size();  // Получаем незанятый индекс
     // Пробуем добавить
     if (auto [it, inserted] = dog_id_to_index_.emplace(id, index); !inserted) {
         throw std::invalid_argument("Dog with id "s + std::to_string(index) + " already exists"s);
     } else {
-        if ( index >= dogs_.size() ) {
-            dogs_.resize(index + 1);
+        try {
+            auto restored = std::make_shared<Dog>(dog);
+            // Копия рюкзака вмещает только сохранённые предметы - резервируем вместимость карты, как у новой собаки
+            restored->ReserveBag(static_cast<size_t>(map_->GetBagCapacity()));
+            if ( index >= dogs_.size() ) {
+                dogs_.resize(index + 1);
+            }
+            dogs_[index] = std::move(restored);
+        } catch (...) {
+            dog_id_to_index_.erase(it);
+            throw;
         }
-        dogs_[index] = std::make_shared<Dog>(dog);
     }
-    ++next_dog_index_;
+    // Новые собаки получат Id больше сохранённых
+    next_dog_index_ = std::max<size_t>(next_dog_index_, id + 1);
+    max_sleep_time_ = std::max(max_sleep_time_, dog.GetSleepTime());
+    has_active_dogs_ = has_active_dogs_ || dog.IsActive();
 }
 
 void GameSession::AddItem(Position pos, Item::Type& type) {
     const size_t index = items_.size();  // Получаем незанятый индекс
+    const size_t id = next_item_index_;
     // Пробуем добавить
-    if (auto [it, inserted] = item_id_to_index_.emplace(next_item_index_, index); !inserted) {
-        throw std::invalid_argument("Item with id "s + std::to_string(index) + " already exists"s);
+    if (auto [it, inserted] = item_id_to_index_.emplace(id, index); !inserted) {
+        throw std::invalid_argument("Item with id "s + std::to_string(id) + " already exists"s);
     } else {
-        // Создаём на основе индекса и имени экземпляр предмета
+        // Создаём на основе Id и типа экземпляр предмета
         try {
-            items_.emplace_back(std::make_shared<Item>(Item::Id(index), type, pos));
+            items_.emplace_back(std::make_shared<Item>(Item::Id(id), type, pos));
         } catch (...) {
             item_id_to_index_.erase(it);
             throw;
@@ -75,32 +123,36 @@ void GameSession::AddItem(std::shared_ptr<Item> item) {
         }
         items_[index] = item;
     }
-    ++next_item_index_;
+    next_item_index_ = std::max<size_t>(next_item_index_, id + 1);
 }
 
-void GameSession::Tick(TimeType dt) noexcept {
+void GameSession::Tick(TimeType dt, TickProfile* profile) noexcept {
+    profiler::ZoneScope zone{"GameSession::Tick"};
+    PhaseTimer timer{profile};
+
+    // Время простоя от предыдущих тиков переносится на собак до начала движения
+    SyncDogTimers();
+
     // Список предметов для обработки коллизий
-    std::vector<collision_detector::Item> col_items;
+    // Хранится в виде структуры массивов для пакетной обработки, память переиспользуется между тиками
+    auto& col_items = col_items_;
+    col_items.Clear();
+    col_items.Reserve(item_id_to_index_.size());
     for (const auto& [item_id, item_insex] : item_id_to_index_) {
-        col_items.push_back(
+        col_items.Add(
             { *item_id, 
             {items_[item_insex]->GetPosition().x, items_[item_insex]->GetPosition().y},
             items_[item_insex]->GetWidth() }
             );
     }
 
-    // Список офисов для обработки коллизий
-    std::vector<collision_detector::Rect> col_offices;
-    for (auto office : map_->GetOffices()) {
-        collision_detector::Rect rect(  office.GetPosition().x, office.GetPosition().y, 
-                                        office.GetOffset().dx, office.GetOffset().dy);
-        col_offices.push_back(rect);
-    }
-
     // Список сборщиков для обработки коллизий
     std::vector<collision_detector::Gatherer> col_gatherers;
+    col_gatherers.reserve(dogs_.size());
 
     // Перемещаем собак
+    has_active_dogs_ = false;
+    max_sleep_time_ = 0.0;
     for (auto dog : dogs_) {
         // Запоминаем старые координаты для сбора предметов
         auto old_pos = dog->GetPosition();
@@ -110,53 +162,51 @@ void GameSession::Tick(TimeType dt) noexcept {
         dog->SetPosition(pos);
         // Сохраняем "собирателя" 
         col_gatherers.push_back({ {old_pos.x, old_pos.y}, {pos.x, pos.y}, dog->GetWidth() });
+        // Собака, упёршаяся в край дороги, останавливается - после тика сессия может стать простаивающей
+        has_active_dogs_ = has_active_dogs_ || dog->IsActive();
+        max_sleep_time_ = std::max(max_sleep_time_, dog->GetSleepTime());
     }
+    timer.Mark(&TickProfile::move);
 
     // Обрабатываем коллизии собак и предметов
-    collision_detector::VectorItemGathererProvider item_provider(col_items, col_gatherers);
-    auto item_collisions = collision_detector::FindGatherEvents(item_provider);
-    // Обрабатываем коллизии собак и баз(офисов)
-    collision_detector::VectorOfficeSaveProvider office_provider(col_offices, col_gatherers);
-    auto office_collisions = collision_detector::FindOfficeSaveEvents(office_provider);
-
-    std::set<collision_detector::AllIvents> all_events;
-    for (auto item_event : item_collisions) {
-        all_events.insert(item_event);
-    }
-    for (auto office_event : office_collisions) {
-        all_events.insert(office_event);
-    }
+    // Предметы проверяются пакетами с помощью векторных инструкций
+    auto item_collisions = collision_detector::FindGatherEvents(col_items, col_gatherers);
+    timer.Mark(&TickProfile::gather);
+    // Обрабатываем коллизии собак и баз(офисов). Геометрия офисов заранее подготовлена картой
+    auto office_collisions = collision_detector::FindOfficeSaveEvents(map_->GetOfficeIndex(), col_gatherers);
+    timer.Mark(&TickProfile::office);
+
+    // Оба списка событий уже отсортированы по времени, поэтому просто сливаем их
+    collision_detector::EventStream all_events(item_collisions, office_collisions);
 
     std::set<Item::Id> collected_items;
 
-    // События уже отсортированы по времени, потому что оператор сравнения переопределён
-    for (auto event : all_events) {
-        std::visit([this, &col_items, &collected_items](auto&& arg) {
-            using T = std::decay_t<decltype(arg)>;
-            if constexpr (std::is_same_v<T, collision_detector::OfficeSaveEvent>) {
-                // Если встретили событие офиса
-                auto dog = dogs_.at(arg.gatherer_id);
-                // Сдаём предметы (начисляем очки + очищаем рюкзак)
-                dog->SaveBag();
-            } else if constexpr (std::is_same_v<T, collision_detector::GatheringEvent>) {
-                // Если встретили событие сбора
-                auto collected_item_id = Item::Id(col_items[arg.item_id].id);
-                auto item_index = item_id_to_index_[collected_item_id];
-                auto item = items_[item_index];
-                auto dog = dogs_.at(arg.gatherer_id);
-                // Пробуем поднять предмет (лезет в рюкзак и не собрали ранее)
-                if (dog->GetBagSize() < map_->GetBagCapacity() && !collected_items.contains(collected_item_id)) {
-                    // Запоминаем, что предмет собран
-                    collected_items.insert(collected_item_id);
-                    // Убираем предмет в рюкзак (создаётся копия)
-                    dog->TakeItem(item);
-                }
+    all_events.ForEach([this, &col_items, &collected_items](const auto& arg) {
+        using T = std::decay_t<decltype(arg)>;
+        if constexpr (std::is_same_v<T, collision_detector::OfficeSaveEvent>) {
+            // Если встретили событие офиса
+            auto dog = dogs_.at(arg.gatherer_id);
+            // Сдаём предметы (начисляем очки + очищаем рюкзак)
+            dog->SaveBag();
+        } else if constexpr (std::is_same_v<T, collision_detector::GatheringEvent>) {
+            // Если встретили событие сбора
+            auto collected_item_id = Item::Id(col_items.GetId(arg.item_id));
+            auto item_index = item_id_to_index_[collected_item_id];
+            auto item = items_[item_index];
+            auto dog = dogs_.at(arg.gatherer_id);
+            // Пробуем поднять предмет (лезет в рюкзак и не собрали ранее)
+            if (dog->GetBagSize() < map_->GetBagCapacity() && !collected_items.contains(collected_item_id)) {
+                // Запоминаем, что предмет собран
+                collected_items.insert(collected_item_id);
+                // Убираем предмет в рюкзак (создаётся копия)
+                dog->TakeItem(*item);
             }
-        }, event);
-    }
+        }
+    });
 
     // Очищаем список предметов от нулевых указателей
     ClearCollectedItems(collected_items);
+    timer.Mark(&TickProfile::gather);
 
     // Генерируем новые предметы при необходимости
     size_t n_items = item_id_to_index_.size();
@@ -167,6 +217,27 @@ void GameSession::Tick(TimeType dt) noexcept {
         Position pos = map_->GetRandomPointOnMap();
         AddItem(pos, rand_type);
     }
+    timer.Mark(&TickProfile::loot);
+}
+
+void GameSession::AdvanceIdle(TimeType dt) noexcept {
+    pending_idle_time_ += dt;
+    // Трофеев хватает всем, генератор только учитывает прошедшее время
+    loot_generator_->AddTimeWithoutLoot(dt);
+}
+
+void GameSession::SyncDogTimers() noexcept {
+    if (pending_idle_time_ == TimeType::zero()) {
+        return;
+    }
+    // Пока сессия простаивала, все собаки стояли на месте
+    const double idle_time = ToSeconds(pending_idle_time_);
+    for (const auto& dog : dogs_) {
+        dog->AddPlayTime(idle_time);
+        dog->AddSleepTime(idle_time);
+    }
+    max_sleep_time_ += idle_time;
+    pending_idle_time_ = TimeType::zero();
 }
 
  Dog* GameSession::FindDog(const Dog::Id& id) noexcept {
@@ -3,23 +3,43 @@
 #include "map.h"
 #include "dog.h"
 #include "loot_generator.h"
+#include "collision_batch.h"
 
+#include <algorithm>
 #include <atomic>
+#include <chrono>
 #include <set>
 #include <memory>
 
 namespace model {
 
+// Время, затраченное на этапы полных тиков сессий. Накапливается, только если передано в Tick
+struct TickProfile {
+    using Duration = std::chrono::steady_clock::duration;
+
+    Duration move{};        // перемещение собак
+    Duration gather{};      // поиск и обработка событий сбора трофеев
+    Duration office{};      // поиск событий сдачи трофеев на базу
+    Duration loot{};        // генерация новых трофеев
+    Duration retirement{};  // уход игроков на покой (заполняет приложение)
+};
+
 class GameSession {
 public:
+    using Id = util::Tagged<std::uint32_t, GameSession>;
     using Dogs = std::vector<std::shared_ptr<Dog>>;
     using Items = std::vector<std::shared_ptr<Item>>;
 
-    GameSession(const Map& map, loot_gen::LootGenerator* loot_generator) noexcept
-        : map_{&map}
+    GameSession(Id id, const Map& map, loot_gen::LootGenerator* loot_generator) noexcept
+        : id_{id}
+        , map_{&map}
         , loot_generator_{loot_generator} {
     }
 
+    const Id& GetId() const noexcept {
+        return id_;
+    }
+
     Dog* AddDog(Position pos, const Dog::Name& name);
     void AddDog(const Dog& dog);
 
@@ -38,16 +58,52 @@ public:
         return *map_;
     }
 
-    void Tick(TimeType dt) noexcept;
+    void Tick(TimeType dt, TickProfile* profile = nullptr) noexcept;
+    // Положение собаки через dt при движении по дорогам карты. Обновляет таймеры собаки,
+    // но не её положение - его устанавливает Tick
+    Position MoveDog(Dog& dog, TimeType dt) noexcept;
+
+    // Сессия простаивает: ни одна собака не движется, а трофеев не меньше, чем собак.
+    // Тик такой сессии не создаёт событий сбора и не генерирует трофеи - меняются только таймеры собак
+    bool IsIdle() const noexcept {
+        return !has_active_dogs_ && items_.size() >= dogs_.size();
+    }
+    // Тик простаивающей сессии за O(1): время копится в сессии и переносится на собак при синхронизации
+    void AdvanceIdle(TimeType dt) noexcept;
+    // Переносит накопленное время простоя на таймеры собак
+    void SyncDogTimers() noexcept;
+    // Собака сессии начала движение
+    void MarkActive() noexcept {
+        has_active_dogs_ = true;
+    }
+    // Оценка сверху времени бездействия собак сессии (в секундах), не требующая синхронизации
+    double GetMaxSleepTime() const noexcept {
+        return max_sleep_time_ + ToSeconds(pending_idle_time_);
+    }
 
     Dog* FindDog(const Dog::Id& id) noexcept;
     void RemoveDog(const Dog::Id& id);
 
+    // Id следующих собаки и трофея. После ухода собак и сбора трофеев они больше Id оставшихся,
+    // поэтому сохраняются в снимке состояния: восстановленная сессия не должна выдавать их повторно
+    size_t GetNextDogId() const noexcept {
+        return next_dog_index_;
+    }
+    size_t GetNextItemId() const noexcept {
+        return next_item_index_;
+    }
+    void ReserveIds(size_t next_dog_id, size_t next_item_id) noexcept {
+        next_dog_index_ = std::max<size_t>(next_dog_index_, next_dog_id);
+        next_item_index_ = std::max<size_t>(next_item_index_, next_item_id);
+    }
+
 private:
     std::optional<Item::Id> GetItemIdByIndex(size_t index);
     std::optional<Dog::Id> GetDogIdByIndex(size_t index);
     void ClearCollectedItems(const std::set<Item::Id>& collected_items);
-    Position MoveDog(Dog& dog, TimeType dt) noexcept;
+    static double ToSeconds(TimeType dt) noexcept {
+        return dt.count() / 1000.0;
+    }
 
 private:
     using DogIdHasher = util::TaggedHasher<Dog::Id>;
@@ -55,6 +111,7 @@ private:
     using ItemIdHasher = util::TaggedHasher<Item::Id>;
     using ItemIdToIndex = std::unordered_map<Item::Id, size_t, ItemIdHasher>;
 
+    Id id_;
     Dogs dogs_;
     Items items_;
     const Map* map_;
@@ -64,6 +121,16 @@ private:
     std::atomic<size_t> next_item_index_{0};
 
     loot_gen::LootGenerator* loot_generator_;
+
+    // Буфер предметов для обработки коллизий, переиспользуется между тиками
+    collision_detector::ItemsLayout col_items_;
+
+    // Есть ли собаки с ненулевой скоростью (пересчитывается каждым полным тиком)
+    bool has_active_dogs_ = false;
+    // Время простоя, ещё не перенесённое на таймеры собак
+    TimeType pending_idle_time_{0};
+    // Наибольшее время бездействия собак на момент последней синхронизации
+    double max_sleep_time_ = 0.0;
 };
 
 }  // namespace model
@@ -16,6 +16,16 @@ void Map::AddOffice(const Office& office) {
         offices_.pop_back();
         throw;
     }
+    try {
+        // Прямоугольник офиса для обработки коллизий
+        office_index_.Add({static_cast<double>(o.GetPosition().x), static_cast<double>(o.GetPosition().y),
+                           static_cast<double>(o.GetOffset().dx), static_cast<double>(o.GetOffset().dy)},
+                          index);
+    } catch (...) {
+        warehouse_id_to_index_.erase(o.GetId());
+        offices_.pop_back();
+        throw;
+    }
 }
 
 // Получение произвольной точки на дорогах карты
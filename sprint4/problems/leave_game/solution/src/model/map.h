@@ -2,6 +2,7 @@
 
 #include "road.h"
 #include "buildings.h"
+#include "collision_detector.h"
 
 #include <optional>
 
@@ -42,6 +43,12 @@ public:
         return offices_;
     }
 
+    // Геометрия офисов для обработки коллизий. Строится при добавлении офисов,
+    // так как после загрузки карты они не меняются
+    const collision_detector::RectIndex& GetOfficeIndex() const noexcept {
+        return office_index_;
+    }
+
     void AddRoad(const Road& road) {
         roads_.emplace_back(road);
     }
@@ -93,6 +100,7 @@ private:
 
     OfficeIdToIndex warehouse_id_to_index_;
     Offices offices_;
+    collision_detector::RectIndex office_index_;
 };
 
 }  // namespace model
@@ -1,4 +1,7 @@
 #include <boost/serialization/vector.hpp>
+#include <boost/serialization/version.hpp>
+
+#include <optional>
 
 #include "game.h"
 
@@ -23,6 +26,13 @@ void serialize(Archive& ar, model::Speed& speed, [[maybe_unused]] const unsigned
     ar & speed.uy;
 }
 
+template <typename Archive>
+void serialize(Archive& ar, model::BagItem& item, [[maybe_unused]] const unsigned version) {
+    ar & *item.id;
+    ar & item.type;
+    ar & item.value;
+}
+
 }  // namespace model
 
 namespace serialization {
@@ -69,17 +79,19 @@ public:
     , pos_{dog.GetPosition()}
     , speed_{dog.GetSpeed()}
     , direction_{dog.GetDirection()}
-    , score_{dog.GetScore()} {
-        for (const auto& item : dog.GetBag()) {
-            bag_content_.push_back(ItemRepr{*item});
-        }
+    , score_{dog.GetScore()}
+    , play_time_{dog.GetPlayTime()}
+    , sleep_time_{dog.GetSleepTime()} {
+        bag_content_.assign(dog.GetBag().begin(), dog.GetBag().end());
     }
 
     [[nodiscard]] model::Dog Restore() const {
         model::Dog dog{id_, name_, pos_, speed_, direction_};
         dog.AddScore(score_);
+        dog.AddPlayTime(play_time_);
+        dog.AddSleepTime(sleep_time_);
         for (const auto& item : bag_content_) {
-            dog.TakeItem(item.Restore());
+            dog.TakeItem(model::Item{item.id, item.type, {}, item.value});
         }
         return dog;
     }
@@ -93,7 +105,22 @@ public:
         ar & speed_;
         ar & direction_;
         ar & score_;
-        ar & bag_content_;
+        if (version > 1) {
+            ar & bag_content_;
+        } else {
+            // До версии 2 рюкзак хранился как список предметов вместе с их положением на карте
+            std::vector<ItemRepr> bag_items;
+            ar & bag_items;
+            bag_content_.clear();
+            for (const auto& item_repr : bag_items) {
+                const auto item = item_repr.Restore();
+                bag_content_.push_back({item->GetId(), item->GetType(), item->GetValue()});
+            }
+        }
+        if (version > 0) {
+            ar & play_time_;
+            ar & sleep_time_;
+        }
     }
 
 private:
@@ -103,8 +130,10 @@ private:
     size_t bag_capacity_ = 0;
     model::Speed speed_;
     model::Direction direction_ = model::Direction::NORTH;
-    std::vector<ItemRepr> bag_content_;
+    std::vector<model::BagItem> bag_content_;
     int score_ = 0;
+    double play_time_ = 0.0;
+    double sleep_time_ = 0.0;
 };
 
 // GameSessionRepr (GameSessionRepresentation) - сериализованное представление класса GameSession
@@ -120,6 +149,10 @@ public:
             items_.push_back(ItemRepr(*item));
         }
         map_id_ = session.GetMap().GetId();
+        id_ = session.GetId();
+        has_id_ = true;
+        next_dog_id_ = session.GetNextDogId();
+        next_item_id_ = session.GetNextItemId();
     }
 
     // Restore нет, потому что для создания объекта игровой сессии требуется
@@ -128,6 +161,11 @@ public:
         return map_id_;
     }
 
+    // В сохранениях версии 0 идентификатора нет: там на каждой карте была одна сессия
+    std::optional<model::GameSession::Id> GetId() const {
+        return has_id_ ? std::optional{id_} : std::nullopt;
+    }
+
     const std::vector<DogRepr>& GetDogs() const {
         return dogs_;
     }
@@ -136,17 +174,45 @@ public:
         return items_;
     }
 
+    // В сохранениях версий 0 и 1 - нули: следующие Id определяются по сохранённым собакам и трофеям
+    size_t GetNextDogId() const {
+        return next_dog_id_;
+    }
+
+    size_t GetNextItemId() const {
+        return next_item_id_;
+    }
+
     template <typename Archive>
     void serialize(Archive& ar, [[maybe_unused]] const unsigned version) {
         ar & dogs_;
         ar & items_;
         ar & *map_id_;
+        if (version > 0) {
+            ar & *id_;
+            has_id_ = true;
+        }
+        if (version > 1) {
+            ar & next_dog_id_;
+            ar & next_item_id_;
+        }
     }
 
 private:
     std::vector<DogRepr> dogs_;
     std::vector<ItemRepr> items_;
     model::Map::Id map_id_ = model::Map::Id{""};
+    model::GameSession::Id id_ = model::GameSession::Id{0};
+    bool has_id_ = false;
+    size_t next_dog_id_ = 0;
+    size_t next_item_id_ = 0;
 };
 
 }  // namespace serialization
+
+// Версия 1: собака сохраняет время в игре и время бездействия
+// Версия 2: предметы в рюкзаке сохраняются без положения на карте
+BOOST_CLASS_VERSION(::serialization::DogRepr, 2)
+// Версия 1: на карте может быть несколько сессий, сессия сохраняет свой идентификатор
+// Версия 2: сессия сохраняет Id следующих собаки и трофея
+BOOST_CLASS_VERSION(::serialization::GameSessionRepr, 2)
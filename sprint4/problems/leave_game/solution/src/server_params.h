@@ -12,4 +12,7 @@ namespace server_params {
     constexpr static std::string_view EXIT_MESSAGE    = "server exited"sv;
     constexpr static std::string_view REQUEST_RECEIV_MESSAGE = "request received"sv;
     constexpr static std::string_view RESPONSE_SENT_MESSAGE  = "response sent"sv;
+    constexpr static std::string_view CONNECTIONS_MESSAGE    = "connections"sv;
+    constexpr static std::string_view HANDOFF_MESSAGE        = "state handed off"sv;
+    constexpr static std::string_view TAKEOVER_MESSAGE       = "state taken over"sv;
 }
\ No newline at end of file
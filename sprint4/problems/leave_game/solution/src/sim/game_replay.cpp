@@ -0,0 +1,155 @@
+// Воспроизведение записи вызовов API (game_server --record-file) без HTTP и БД.
+// Выполняет вызовы в том же порядке с теми же начальными значениями std::rand, сверяет хеш
+// итогового состояния с записанным и выводит время выполнения по видам вызовов.
+// Код возврата 1 - состояние разошлось с записанным
+
+#include <boost/program_options.hpp>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "app.h"
+#include "input_recording.h"
+#include "json_loader.h"
+#include "replay.h"
+#include "simulation.h"
+
+using namespace std::literals;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct Args {
+    std::string config_file;
+    std::string record_file;
+    size_t session_capacity = 0;
+    bool is_paced = false;
+};
+
+[[nodiscard]] std::optional<Args> ParseCommandLine(int argc, const char* const argv[]) {
+    namespace po = boost::program_options;
+
+    po::options_description desc{"All options"s};
+
+    Args args;
+    desc.add_options()
+        ("help,h", "Show help")
+        ("config-file,c", po::value(&args.config_file)->value_name("file"s), "set config file path")
+        ("record-file,r", po::value(&args.record_file)->value_name("file"s), "set recording file path")
+        // Должна совпадать с настройкой сервера при записи
+        ("session-capacity", po::value(&args.session_capacity)->value_name("dogs"s), "set maximum number of dogs in a game session (0 - unlimited)")
+        ("paced", po::bool_switch(&args.is_paced), "replay calls at recorded times instead of as fast as possible");
+
+    po::variables_map vm;
+    po::store(po::parse_command_line(argc, argv, desc), vm);
+    po::notify(vm);
+
+    if (vm.contains("help"s)) {
+        std::cout << desc;
+        return std::nullopt;
+    }
+    if (!vm.contains("config-file"s)) {
+        throw std::runtime_error("Config file path have not been specified"s);
+    }
+    if (!vm.contains("record-file"s)) {
+        throw std::runtime_error("Recording file path have not been specified"s);
+    }
+    return args;
+}
+
+// Время выполнения вызовов одного вида
+struct CallTimes {
+    std::vector<Clock::duration> times;
+    size_t failed = 0;
+};
+
+double ToMilliseconds(Clock::duration duration) {
+    return std::chrono::duration<double, std::milli>(duration).count();
+}
+
+void PrintCallTimes(std::string_view name, CallTimes& calls) {
+    if (calls.times.empty()) {
+        return;
+    }
+    Clock::duration total{};
+    for (const auto time : calls.times) {
+        total += time;
+    }
+    std::sort(calls.times.begin(), calls.times.end());
+    const auto percentile = [&calls](double p) {
+        return ToMilliseconds(calls.times[static_cast<size_t>(p * (calls.times.size() - 1))]);
+    };
+    std::cout << "  " << std::left << std::setw(10) << name << std::right
+              << std::setw(9) << calls.times.size() << " calls" << std::setw(7) << calls.failed << " failed"
+              << std::setw(12) << ToMilliseconds(total) << " ms total"
+              << std::setw(10) << ToMilliseconds(total) / calls.times.size() << " avg"
+              << std::setw(10) << percentile(0.5) << " p50"
+              << std::setw(10) << percentile(0.99) << " p99"
+              << std::setw(10) << percentile(1.0) << " max\n";
+}
+
+}  // namespace
+
+int main(int argc, const char* argv[]) {
+    try {
+        std::optional<Args> args = ParseCommandLine(argc, argv);
+        if (!args) {
+            return EXIT_SUCCESS;
+        }
+
+        auto [game, extra_data] = json_loader::LoadGame(args->config_file);
+        game.SetSessionCapacity(args->session_capacity);
+
+        sim::RetiredPlayers retired;
+        app::Application app(game, retired);
+        sim::Replayer replayer(game, app);
+
+        // Порядок совпадает с альтернативами recording::Call
+        constexpr std::array<std::string_view, std::variant_size_v<recording::Call>> CALL_NAMES = {
+            "snapshot"sv, "join"sv, "action"sv, "tick"sv, "state"sv, "players"sv, "end"sv};
+        std::array<CallTimes, CALL_NAMES.size()> call_times;
+
+        const auto start = Clock::now();
+        const size_t calls = recording::ReadRecording(args->record_file,
+            [&](std::chrono::microseconds time, const recording::Call& call) {
+                if (args->is_paced) {
+                    std::this_thread::sleep_until(start + time);
+                }
+                const auto result = replayer.Execute(call);
+                auto& times = call_times[call.index()];
+                times.times.push_back(result.time);
+                times.failed += result.failed;
+            });
+        const auto wall_time = Clock::now() - start;
+
+        std::cout << std::fixed << std::setprecision(3);
+        std::cout << "calls: " << calls << ", wall time: " << ToMilliseconds(wall_time) << " ms\n";
+        for (size_t i = 0; i < CALL_NAMES.size(); ++i) {
+            PrintCallTimes(CALL_NAMES[i], call_times[i]);
+        }
+
+        const auto hash = recording::HashGameState(game, app.GetPlayers());
+        std::cout << "state hash: " << std::hex << std::setw(16) << std::setfill('0') << hash;
+        const auto recorded_hash = replayer.GetRecordedHash();
+        if (!recorded_hash) {
+            // Сервер, записавший вызовы, завершился аварийно
+            std::cout << ", recording has no final state hash" << std::endl;
+            return EXIT_SUCCESS;
+        }
+        std::cout << ", recorded: " << std::setw(16) << *recorded_hash
+                  << (hash == *recorded_hash ? " - match"sv : " - MISMATCH"sv) << std::endl;
+        return hash == *recorded_hash ? EXIT_SUCCESS : EXIT_FAILURE;
+    } catch (const std::exception& ex) {
+        std::cerr << ex.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+}
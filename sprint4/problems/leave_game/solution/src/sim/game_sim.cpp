@@ -0,0 +1,208 @@
+// Ускоренная симуляция игры без HTTP и БД для профилирования модели.
+// Загружает конфигурацию, подключает N ботов и выполняет M тиков подряд без пауз,
+// после чего выводит скорость, распределение времени по этапам тика и число выделений памяти
+
+#include <boost/program_options.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "app.h"
+#include "json_loader.h"
+#include "simulation.h"
+
+using namespace std::literals;
+
+namespace {
+
+// Счётчики выделений памяти через глобальный operator new
+std::atomic<size_t> allocations = 0;
+std::atomic<size_t> allocated_bytes = 0;
+
+}  // namespace
+
+void* operator new(std::size_t size) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+    if (void* ptr = std::malloc(size == 0 ? 1 : size)) {
+        return ptr;
+    }
+    throw std::bad_alloc{};
+}
+
+void operator delete(void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept {
+    std::free(ptr);
+}
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct Args {
+    std::string config_file;
+    size_t dogs = 100;
+    size_t ticks = 10000;
+    unsigned long tick_period = 50;
+    std::string policy = "mixed"s;
+    unsigned turn_period = 20;
+    std::uint32_t seed = 0;
+    size_t session_capacity = 0;
+};
+
+[[nodiscard]] std::optional<Args> ParseCommandLine(int argc, const char* const argv[]) {
+    namespace po = boost::program_options;
+
+    po::options_description desc{"All options"s};
+
+    Args args;
+    desc.add_options()
+        ("help,h", "Show help")
+        ("config-file,c", po::value(&args.config_file)->value_name("file"s), "set config file path")
+        ("dogs,n", po::value(&args.dogs)->value_name("count"s), "set number of bot dogs")
+        ("ticks,m", po::value(&args.ticks)->value_name("count"s), "set number of ticks to simulate")
+        ("tick-period,t", po::value(&args.tick_period)->value_name("milliseconds"s), "set game time of one tick")
+        ("policy", po::value(&args.policy)->value_name("random|patrol|idle|mixed"s), "set bot movement policy")
+        ("turn-period", po::value(&args.turn_period)->value_name("ticks"s), "set average number of ticks between bot turns")
+        ("seed", po::value(&args.seed)->value_name("number"s), "set random seed of bots and loot")
+        ("session-capacity", po::value(&args.session_capacity)->value_name("dogs"s), "set maximum number of dogs in a game session (0 - unlimited)");
+
+    po::variables_map vm;
+    po::store(po::parse_command_line(argc, argv, desc), vm);
+    po::notify(vm);
+
+    if (vm.contains("help"s)) {
+        std::cout << desc;
+        return std::nullopt;
+    }
+    if (!vm.contains("config-file"s)) {
+        throw std::runtime_error("Config file path have not been specified"s);
+    }
+    if (args.turn_period == 0) {
+        throw std::runtime_error("Turn period must be positive"s);
+    }
+    return args;
+}
+
+double ToMilliseconds(Clock::duration duration) {
+    return std::chrono::duration<double, std::milli>(duration).count();
+}
+
+void PrintPhase(std::string_view name, Clock::duration phase, Clock::duration total) {
+    std::cout << "  " << std::left << std::setw(12) << name << std::right
+              << std::setw(12) << ToMilliseconds(phase) << " ms"
+              << std::setw(8) << (total.count() ? 100.0 * phase.count() / total.count() : 0.0) << " %\n";
+}
+
+}  // namespace
+
+int main(int argc, const char* argv[]) {
+    try {
+        std::optional<Args> args = ParseCommandLine(argc, argv);
+        if (!args) {
+            return EXIT_SUCCESS;
+        }
+        const auto policy = sim::ParseMovePolicy(args->policy);
+        if (!policy) {
+            throw std::runtime_error("Unknown bot policy: "s + args->policy);
+        }
+
+        auto [game, extra_data] = json_loader::LoadGame(args->config_file);
+        game.SetSessionCapacity(args->session_capacity);
+
+        sim::RetiredPlayers retired;
+        app::Application app(game, retired);
+        model::TickProfile profile;
+        app.SetTickProfile(&profile);
+
+        // Типы трофеев выбираются через std::rand
+        std::srand(args->seed);
+        sim::Bots bots(app, game, {args->dogs, *policy, args->turn_period, args->seed});
+        bots.JoinAll();
+
+        std::vector<Clock::duration> tick_times;
+        tick_times.reserve(args->ticks);
+        Clock::duration actions_time{};
+        size_t tick_allocations = 0;
+        size_t tick_bytes = 0;
+        size_t action_allocations = 0;
+
+        const app::Tick tick{model::TimeType{args->tick_period}};
+        const auto start = Clock::now();
+        for (size_t i = 0; i < args->ticks; ++i) {
+            const size_t before_actions = allocations.load(std::memory_order_relaxed);
+            const auto actions_start = Clock::now();
+            bots.Act(retired);
+            const auto tick_start = Clock::now();
+            actions_time += tick_start - actions_start;
+
+            const size_t before_tick = allocations.load(std::memory_order_relaxed);
+            const size_t before_tick_bytes = allocated_bytes.load(std::memory_order_relaxed);
+            app.ExecuteTick(tick);
+            tick_times.push_back(Clock::now() - tick_start);
+            tick_allocations += allocations.load(std::memory_order_relaxed) - before_tick;
+            tick_bytes += allocated_bytes.load(std::memory_order_relaxed) - before_tick_bytes;
+            action_allocations += before_tick - before_actions;
+        }
+        const auto wall_time = Clock::now() - start;
+
+        Clock::duration ticks_time{};
+        for (const auto time : tick_times) {
+            ticks_time += time;
+        }
+        std::sort(tick_times.begin(), tick_times.end());
+        const auto percentile = [&tick_times](double p) {
+            return tick_times.empty() ? Clock::duration{} : tick_times[static_cast<size_t>(p * (tick_times.size() - 1))];
+        };
+        const double ticks = std::max<size_t>(args->ticks, 1);
+        const auto tick_stats = app.GetTickStats();
+        size_t items = 0;
+        for (const auto session : game.GetSessions()) {
+            items += session->GetItems().size();
+        }
+
+        std::cout << std::fixed << std::setprecision(3);
+        std::cout << "maps: " << game.GetMaps().size() << ", dogs: " << args->dogs
+                  << ", policy: " << sim::MovePolicyToString(*policy)
+                  << ", ticks: " << args->ticks << " x " << args->tick_period << " ms\n";
+        std::cout << "wall time: " << ToMilliseconds(wall_time) << " ms, ticks: " << ToMilliseconds(ticks_time)
+                  << " ms, bot actions: " << ToMilliseconds(actions_time) << " ms\n";
+        std::cout << "ticks/s: " << std::setprecision(1) << args->ticks / std::chrono::duration<double>(ticks_time).count()
+                  << std::setprecision(3) << ", game time speedup: x"
+                  << args->ticks * args->tick_period / std::max(ToMilliseconds(wall_time), 1e-3) << "\n";
+        std::cout << "tick time: avg " << ToMilliseconds(ticks_time) / ticks << " ms, p50 " << ToMilliseconds(percentile(0.5))
+                  << " ms, p99 " << ToMilliseconds(percentile(0.99)) << " ms, max " << ToMilliseconds(percentile(1.0)) << " ms\n";
+
+        std::cout << "tick phases:\n";
+        const auto phases = profile.move + profile.gather + profile.office + profile.loot + profile.retirement;
+        PrintPhase("move"sv, profile.move, ticks_time);
+        PrintPhase("gather"sv, profile.gather, ticks_time);
+        PrintPhase("office"sv, profile.office, ticks_time);
+        PrintPhase("loot"sv, profile.loot, ticks_time);
+        PrintPhase("retirement"sv, profile.retirement, ticks_time);
+        PrintPhase("other"sv, std::max(ticks_time - phases, Clock::duration{}), ticks_time);
+
+        std::cout << std::setprecision(1);
+        std::cout << "allocations: " << tick_allocations / ticks << " per tick (" << tick_bytes / ticks << " bytes), "
+                  << action_allocations / ticks << " per tick in bot actions\n";
+        std::cout << "sessions: " << game.GetSessions().size() << ", full session ticks: " << tick_stats.full_ticks
+                  << ", idle session ticks: " << tick_stats.idle_ticks << "\n";
+        std::cout << "bot actions: " << bots.GetActions() << ", retired: " << retired.GetTotal()
+                  << ", rejoined: " << bots.GetRejoins() << ", lost objects: " << items << std::endl;
+    } catch (const std::exception& ex) {
+        std::cerr << ex.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,81 @@
+#include "replay.h"
+
+#include "state_serialization.h"
+
+#include <sstream>
+#include <stdexcept>
+
+namespace sim {
+
+using namespace std::literals;
+
+Replayer::Result Replayer::Execute(const recording::Call& call) {
+    Result result;
+    const auto start = std::chrono::steady_clock::now();
+    try {
+        std::visit([this](const auto& call) {
+            Apply(call);
+        }, call);
+    } catch (const std::logic_error&) {
+        // Запись не соответствует игре
+        throw;
+    } catch (...) {
+        // Сценарии использования сообщают об отказах не только исключениями std::exception
+        result.failed = true;
+    }
+    result.time = std::chrono::steady_clock::now() - start;
+    return result;
+}
+
+void Replayer::Apply(const recording::SnapshotCall& call) {
+    if (!game_.GetSessions().empty()) {
+        throw std::logic_error("Recording snapshot must be replayed on an empty game"s);
+    }
+    std::istringstream state{call.state};
+    serialization::StateSerializer{game_, app_}.Deserialize(state);
+    game_.GetLootGenerator().SetTimeWithoutLoot(std::chrono::milliseconds{call.time_without_loot});
+    app_.ReservePlayerIds(static_cast<int>(call.next_player_id));
+    for (const auto& player : app_.GetPlayers().GetPlayers()) {
+        tokens_.push_back(*app_.GetTokens().FindTokenByPlayer(player.get()));
+    }
+}
+
+void Replayer::Apply(const recording::JoinCall& call) {
+    // Записываются только успешные подключения, поэтому номер занимается и при отказе - иначе сдвинутся следующие
+    tokens_.emplace_back();
+    tokens_.back() = app_.JoinGame(call.name, call.map_id).GetTokenAsString();
+}
+
+void Replayer::Apply(const recording::ActionCall& call) {
+    app_.ExecutePlayerAction(GetToken(call.player), app::PlayerAction{call.move});
+}
+
+void Replayer::Apply(const recording::TickCall& call) {
+    std::srand(call.seed);
+    app_.ExecuteTick(app::Tick{model::TimeType{call.dt}});
+}
+
+void Replayer::Apply(const recording::StateCall& call) {
+    std::optional<app::AreaOfInterest> area;
+    if (call.radius) {
+        area = app::AreaOfInterest{*call.radius};
+    }
+    app_.GetState(GetToken(call.player), area);
+}
+
+void Replayer::Apply(const recording::PlayersCall& call) {
+    app_.GetPlayers(GetToken(call.player));
+}
+
+void Replayer::Apply(const recording::EndCall& call) {
+    recorded_hash_ = call.state_hash;
+}
+
+const std::string& Replayer::GetToken(recording::PlayerIndex player) const {
+    if (player >= tokens_.size()) {
+        throw std::logic_error("Recording refers to unknown player "s + std::to_string(player));
+    }
+    return tokens_[player];
+}
+
+}  // namespace sim
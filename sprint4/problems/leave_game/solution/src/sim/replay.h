@@ -0,0 +1,53 @@
+#pragma once
+
+#include "app.h"
+#include "input_recording.h"
+
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace sim {
+
+// Выполнение записанных вызовов (см. input_recording.h) на новом экземпляре игры.
+// Игроки получают новые токены, поэтому номера подключений из записи сопоставляются с ними
+class Replayer {
+public:
+    struct Result {
+        std::chrono::steady_clock::duration time{};
+        // Сценарий отклонил вызов - так же, как при записи
+        bool failed = false;
+    };
+
+    Replayer(model::Game& game, app::Application& app)
+        : game_{game}
+        , app_{app} {
+    }
+
+    Result Execute(const recording::Call& call);
+
+    // Хеш итогового состояния, сохранённый в конце записи
+    std::optional<std::uint64_t> GetRecordedHash() const noexcept {
+        return recorded_hash_;
+    }
+
+private:
+    void Apply(const recording::SnapshotCall& call);
+    void Apply(const recording::JoinCall& call);
+    void Apply(const recording::ActionCall& call);
+    void Apply(const recording::TickCall& call);
+    void Apply(const recording::StateCall& call);
+    void Apply(const recording::PlayersCall& call);
+    void Apply(const recording::EndCall& call);
+
+    const std::string& GetToken(recording::PlayerIndex player) const;
+
+    model::Game& game_;
+    app::Application& app_;
+    std::vector<std::string> tokens_;
+    std::optional<std::uint64_t> recorded_hash_;
+};
+
+}  // namespace sim
@@ -0,0 +1,120 @@
+#include "simulation.h"
+
+#include <array>
+#include <stdexcept>
+
+namespace sim {
+
+using namespace std::literals;
+
+namespace {
+
+constexpr std::array<char, 4> DIRECTIONS = {'L', 'R', 'U', 'D'};
+
+char Opposite(char direction) noexcept {
+    switch (direction) {
+        case 'L': return 'R';
+        case 'R': return 'L';
+        case 'U': return 'D';
+        default: return 'U';
+    }
+}
+
+}  // namespace
+
+std::optional<MovePolicy> ParseMovePolicy(std::string_view name) {
+    if (name == "random"sv) {
+        return MovePolicy::Random;
+    }
+    if (name == "patrol"sv) {
+        return MovePolicy::Patrol;
+    }
+    if (name == "idle"sv) {
+        return MovePolicy::Idle;
+    }
+    if (name == "mixed"sv) {
+        return MovePolicy::Mixed;
+    }
+    return std::nullopt;
+}
+
+std::string_view MovePolicyToString(MovePolicy policy) {
+    switch (policy) {
+        case MovePolicy::Random: return "random"sv;
+        case MovePolicy::Patrol: return "patrol"sv;
+        case MovePolicy::Idle: return "idle"sv;
+        case MovePolicy::Mixed: return "mixed"sv;
+    }
+    return {};
+}
+
+Bots::Bots(app::Application& app, const model::Game& game, BotsConfig config)
+    : app_{app}
+    , game_{game}
+    , config_{config}
+    , random_{config.seed} {
+    if (game_.GetMaps().empty()) {
+        throw std::invalid_argument("Game has no maps for bots"s);
+    }
+    constexpr std::array<MovePolicy, 3> MIXED = {MovePolicy::Random, MovePolicy::Patrol, MovePolicy::Idle};
+    bots_.reserve(config_.count);
+    for (size_t i = 0; i < config_.count; ++i) {
+        const MovePolicy policy = config_.policy == MovePolicy::Mixed ? MIXED[i % MIXED.size()] : config_.policy;
+        bots_.push_back({"bot"s + std::to_string(i), policy});
+        name_to_bot_.emplace(bots_.back().name, i);
+    }
+}
+
+void Bots::JoinAll() {
+    for (auto& bot : bots_) {
+        Join(bot);
+    }
+}
+
+void Bots::Act(RetiredPlayers& retired) {
+    for (const auto& name : retired.TakeRetired()) {
+        if (auto it = name_to_bot_.find(name); it != name_to_bot_.end()) {
+            Join(bots_[it->second]);
+            ++rejoins_;
+        }
+    }
+
+    ++tick_;
+    for (auto& bot : bots_) {
+        if (bot.policy == MovePolicy::Idle || bot.next_turn > tick_) {
+            continue;
+        }
+        if (bot.policy == MovePolicy::Random) {
+            Move(bot, RandomDirection());
+            bot.next_turn = tick_ + NextTurnDelay();
+        } else {
+            bot.direction = Opposite(bot.direction);
+            Move(bot, bot.direction);
+            bot.next_turn = tick_ + config_.turn_period;
+        }
+    }
+}
+
+void Bots::Join(Bot& bot) {
+    // Боты распределяются по картам по порядку
+    const auto& maps = game_.GetMaps();
+    const auto& map = maps[name_to_bot_.at(bot.name) % maps.size()];
+    bot.token = app_.JoinGame(bot.name, *map.GetId()).GetTokenAsString();
+    bot.next_turn = tick_;
+    bot.direction = RandomDirection();
+}
+
+void Bots::Move(Bot& bot, char direction) {
+    app_.ExecutePlayerAction(bot.token, app::PlayerAction{std::string(1, direction)});
+    ++actions_;
+}
+
+char Bots::RandomDirection() {
+    return DIRECTIONS[std::uniform_int_distribution<size_t>{0, DIRECTIONS.size() - 1}(random_)];
+}
+
+size_t Bots::NextTurnDelay() {
+    return std::uniform_int_distribution<size_t>{1, 2 * size_t{config_.turn_period}}(random_);
+}
+
+}  // namespace sim
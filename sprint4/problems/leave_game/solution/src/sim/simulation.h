@@ -0,0 +1,108 @@
+#pragma once
+
+#include "app.h"
+
+#include <cstdint>
+#include <optional>
+#include <random>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Игра без HTTP и БД: собаками управляют боты через те же сценарии использования, что и игроки
+namespace sim {
+
+// Как бот управляет своей собакой
+enum class MovePolicy {
+    // Время от времени поворачивает в случайную сторону
+    Random,
+    // Ходит туда и обратно вдоль одной оси
+    Patrol,
+    // Стоит на месте и со временем уходит на покой
+    Idle,
+    // Политики назначаются ботам по очереди
+    Mixed
+};
+
+std::optional<MovePolicy> ParseMovePolicy(std::string_view name);
+std::string_view MovePolicyToString(MovePolicy policy);
+
+// Хранилище рекордов для симуляции: запоминает имена ушедших на покой, чтобы боты подключились заново
+class RetiredPlayers : public app::PlayerRepository {
+public:
+    void Save(const app::PlayerRecordInfo& player) override {
+        retired_.push_back(player.name);
+        ++total_;
+    }
+    std::vector<app::PlayerStatInfo> GetRecords(size_t /*start*/, size_t /*limit*/) override {
+        return {};
+    }
+
+    // Имена игроков, ушедших на покой после предыдущего вызова
+    std::vector<std::string> TakeRetired() {
+        return std::exchange(retired_, {});
+    }
+    size_t GetTotal() const noexcept {
+        return total_;
+    }
+
+private:
+    std::vector<std::string> retired_;
+    size_t total_ = 0;
+};
+
+struct BotsConfig {
+    size_t count = 100;
+    MovePolicy policy = MovePolicy::Mixed;
+    // Среднее число тиков между поворотами
+    unsigned turn_period = 20;
+    std::uint32_t seed = 0;
+};
+
+// Боты, подключённые к картам игры по очереди
+class Bots {
+public:
+    Bots(app::Application& app, const model::Game& game, BotsConfig config);
+
+    // Подключает всех ботов
+    void JoinAll();
+    // Отправляет действия ботов перед очередным тиком. Ушедшие на покой боты подключаются заново
+    void Act(RetiredPlayers& retired);
+
+    size_t GetActions() const noexcept {
+        return actions_;
+    }
+    size_t GetRejoins() const noexcept {
+        return rejoins_;
+    }
+
+private:
+    struct Bot {
+        std::string name;
+        MovePolicy policy;
+        std::string token;
+        // Тик, на котором бот повернёт в следующий раз
+        size_t next_turn = 0;
+        // Направление патруля
+        char direction = 'L';
+    };
+
+    void Join(Bot& bot);
+    void Move(Bot& bot, char direction);
+    char RandomDirection();
+    size_t NextTurnDelay();
+
+    app::Application& app_;
+    const model::Game& game_;
+    BotsConfig config_;
+    std::mt19937 random_;
+    std::vector<Bot> bots_;
+    std::unordered_map<std::string, size_t> name_to_bot_;
+    size_t tick_ = 0;
+    size_t actions_ = 0;
+    size_t rejoins_ = 0;
+};
+
+}  // namespace sim
@@ -0,0 +1,223 @@
+#include "collision_batch.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define COLLISION_BATCH_X86 1
+#endif
+
+namespace collision_detector {
+
+namespace {
+
+// Параметры отрезка пути собирателя, общие для всех предметов
+struct GathererPath {
+    double a_x, a_y;    // начало пути
+    double v_x, v_y;    // вектор перемещения
+    double v_len2;      // квадрат длины перемещения
+    double width;
+};
+
+GathererPath MakeGathererPath(const Gatherer& gatherer) {
+    const double v_x = gatherer.end_pos.x - gatherer.start_pos.x;
+    const double v_y = gatherer.end_pos.y - gatherer.start_pos.y;
+    return {gatherer.start_pos.x, gatherer.start_pos.y, v_x, v_y, v_x * v_x + v_y * v_y, gatherer.width};
+}
+
+// Проверка одного предмета. Порядок операций тот же, что и в TryCollectPoint,
+// поэтому результат совпадает побитово
+void CollectOne(const GathererPath& path, size_t gatherer_id, const ItemsLayout& items, size_t i,
+                std::vector<GatheringEvent>& events) {
+    const double u_x = items.Xs()[i] - path.a_x;
+    const double u_y = items.Ys()[i] - path.a_y;
+    const double u_dot_v = u_x * path.v_x + u_y * path.v_y;
+    const double u_len2 = u_x * u_x + u_y * u_y;
+    const double proj_ratio = u_dot_v / path.v_len2;
+    const double sq_distance = u_len2 - (u_dot_v * u_dot_v) / path.v_len2;
+    const double radius = path.width + items.Widths()[i];
+
+    if (proj_ratio >= 0 && proj_ratio <= 1 && sq_distance <= radius * radius) {
+        events.push_back({.item_id = i, .gatherer_id = gatherer_id, .sq_distance = sq_distance, .time = proj_ratio});
+    }
+}
+
+// Каждое ядро обрабатывает целые пакеты предметов и возвращает количество обработанных.
+// Оставшийся "хвост" досчитывается скалярно
+size_t CollectScalar(const GathererPath&, size_t, const ItemsLayout&, std::vector<GatheringEvent>&) {
+    return 0;
+}
+
+#ifdef COLLISION_BATCH_X86
+
+size_t CollectSse2(const GathererPath& path, size_t gatherer_id, const ItemsLayout& items,
+                   std::vector<GatheringEvent>& events) {
+    constexpr size_t LANES = 2;
+    const size_t count = items.Size() / LANES * LANES;
+
+    const __m128d a_x = _mm_set1_pd(path.a_x);
+    const __m128d a_y = _mm_set1_pd(path.a_y);
+    const __m128d v_x = _mm_set1_pd(path.v_x);
+    const __m128d v_y = _mm_set1_pd(path.v_y);
+    const __m128d v_len2 = _mm_set1_pd(path.v_len2);
+    const __m128d width = _mm_set1_pd(path.width);
+    const __m128d zero = _mm_setzero_pd();
+    const __m128d one = _mm_set1_pd(1.0);
+
+    alignas(16) double proj[LANES];
+    alignas(16) double sq_dist[LANES];
+
+    for (size_t i = 0; i < count; i += LANES) {
+        const __m128d u_x = _mm_sub_pd(_mm_loadu_pd(items.Xs() + i), a_x);
+        const __m128d u_y = _mm_sub_pd(_mm_loadu_pd(items.Ys() + i), a_y);
+        const __m128d u_dot_v = _mm_add_pd(_mm_mul_pd(u_x, v_x), _mm_mul_pd(u_y, v_y));
+        const __m128d u_len2 = _mm_add_pd(_mm_mul_pd(u_x, u_x), _mm_mul_pd(u_y, u_y));
+        const __m128d proj_ratio = _mm_div_pd(u_dot_v, v_len2);
+        const __m128d sq_distance = _mm_sub_pd(u_len2, _mm_div_pd(_mm_mul_pd(u_dot_v, u_dot_v), v_len2));
+        const __m128d radius = _mm_add_pd(width, _mm_loadu_pd(items.Widths() + i));
+
+        const __m128d collected = _mm_and_pd(
+            _mm_and_pd(_mm_cmpge_pd(proj_ratio, zero), _mm_cmple_pd(proj_ratio, one)),
+            _mm_cmple_pd(sq_distance, _mm_mul_pd(radius, radius)));
+
+        int mask = _mm_movemask_pd(collected);
+        if (mask == 0) {
+            continue;
+        }
+        _mm_store_pd(proj, proj_ratio);
+        _mm_store_pd(sq_dist, sq_distance);
+        for (size_t lane = 0; mask != 0; ++lane, mask >>= 1) {
+            if (mask & 1) {
+                events.push_back({.item_id = i + lane, .gatherer_id = gatherer_id,
+                                  .sq_distance = sq_dist[lane], .time = proj[lane]});
+            }
+        }
+    }
+    return count;
+}
+
+// Ядро компилируется под AVX2 отдельно от остального кода и вызывается,
+// только если процессор его поддерживает. FMA намеренно не включается:
+// слитое умножение-сложение дало бы результат, отличный от скалярного
+__attribute__((target("avx2")))
+size_t CollectAvx2(const GathererPath& path, size_t gatherer_id, const ItemsLayout& items,
+                   std::vector<GatheringEvent>& events) {
+    constexpr size_t LANES = 4;
+    const size_t count = items.Size() / LANES * LANES;
+
+    const __m256d a_x = _mm256_set1_pd(path.a_x);
+    const __m256d a_y = _mm256_set1_pd(path.a_y);
+    const __m256d v_x = _mm256_set1_pd(path.v_x);
+    const __m256d v_y = _mm256_set1_pd(path.v_y);
+    const __m256d v_len2 = _mm256_set1_pd(path.v_len2);
+    const __m256d width = _mm256_set1_pd(path.width);
+    const __m256d zero = _mm256_setzero_pd();
+    const __m256d one = _mm256_set1_pd(1.0);
+
+    alignas(32) double proj[LANES];
+    alignas(32) double sq_dist[LANES];
+
+    for (size_t i = 0; i < count; i += LANES) {
+        const __m256d u_x = _mm256_sub_pd(_mm256_loadu_pd(items.Xs() + i), a_x);
+        const __m256d u_y = _mm256_sub_pd(_mm256_loadu_pd(items.Ys() + i), a_y);
+        const __m256d u_dot_v = _mm256_add_pd(_mm256_mul_pd(u_x, v_x), _mm256_mul_pd(u_y, v_y));
+        const __m256d u_len2 = _mm256_add_pd(_mm256_mul_pd(u_x, u_x), _mm256_mul_pd(u_y, u_y));
+        const __m256d proj_ratio = _mm256_div_pd(u_dot_v, v_len2);
+        const __m256d sq_distance
+            = _mm256_sub_pd(u_len2, _mm256_div_pd(_mm256_mul_pd(u_dot_v, u_dot_v), v_len2));
+        const __m256d radius = _mm256_add_pd(width, _mm256_loadu_pd(items.Widths() + i));
+
+        const __m256d collected = _mm256_and_pd(
+            _mm256_and_pd(_mm256_cmp_pd(proj_ratio, zero, _CMP_GE_OQ), _mm256_cmp_pd(proj_ratio, one, _CMP_LE_OQ)),
+            _mm256_cmp_pd(sq_distance, _mm256_mul_pd(radius, radius), _CMP_LE_OQ));
+
+        int mask = _mm256_movemask_pd(collected);
+        if (mask == 0) {
+            continue;
+        }
+        _mm256_store_pd(proj, proj_ratio);
+        _mm256_store_pd(sq_dist, sq_distance);
+        for (size_t lane = 0; mask != 0; ++lane, mask >>= 1) {
+            if (mask & 1) {
+                events.push_back({.item_id = i + lane, .gatherer_id = gatherer_id,
+                                  .sq_distance = sq_dist[lane], .time = proj[lane]});
+            }
+        }
+    }
+    return count;
+}
+
+#endif  // COLLISION_BATCH_X86
+
+using BatchKernel = size_t (*)(const GathererPath&, size_t, const ItemsLayout&, std::vector<GatheringEvent>&);
+
+BatchKernel GetKernel(BatchIsa isa) noexcept {
+#ifdef COLLISION_BATCH_X86
+    switch (isa) {
+        case BatchIsa::AVX2:
+            return IsBatchIsaSupported(BatchIsa::AVX2) ? CollectAvx2 : CollectSse2;
+        case BatchIsa::SSE2:
+            return CollectSse2;
+        case BatchIsa::SCALAR:
+            break;
+    }
+#endif
+    return CollectScalar;
+}
+
+}  // namespace
+
+bool IsBatchIsaSupported(BatchIsa isa) noexcept {
+    switch (isa) {
+        case BatchIsa::SCALAR:
+            return true;
+#ifdef COLLISION_BATCH_X86
+        case BatchIsa::SSE2:
+            return true;    // SSE2 есть на любом x86-64
+        case BatchIsa::AVX2:
+            return __builtin_cpu_supports("avx2");
+#endif
+        default:
+            return false;
+    }
+}
+
+BatchIsa GetBestBatchIsa() noexcept {
+    static const BatchIsa best_isa = [] {
+        if (IsBatchIsaSupported(BatchIsa::AVX2)) {
+            return BatchIsa::AVX2;
+        }
+        if (IsBatchIsaSupported(BatchIsa::SSE2)) {
+            return BatchIsa::SSE2;
+        }
+        return BatchIsa::SCALAR;
+    }();
+    return best_isa;
+}
+
+void CollectItems(const Gatherer& gatherer, size_t gatherer_id, const ItemsLayout& items,
+                  std::vector<GatheringEvent>& events, BatchIsa isa) {
+    const GathererPath path = MakeGathererPath(gatherer);
+    size_t processed = GetKernel(isa)(path, gatherer_id, items, events);
+    for (size_t i = processed; i < items.Size(); ++i) {
+        CollectOne(path, gatherer_id, items, i, events);
+    }
+}
+
+std::vector<GatheringEvent> FindGatherEvents(const ItemsLayout& items, std::span<const Gatherer> gatherers,
+                                             BatchIsa isa) {
+    std::vector<GatheringEvent> detected_events;
+
+    for (size_t g = 0; g < gatherers.size(); ++g) {
+        const Gatherer& gatherer = gatherers[g];
+        // Пропускаем собирателей, которые не сдвинулись с места
+        if (gatherer.start_pos == gatherer.end_pos) {
+            continue;
+        }
+        CollectItems(gatherer, g, items, detected_events, isa);
+    }
+
+    SortGatheringEvents(detected_events);
+
+    return detected_events;
+}
+
+}  // namespace collision_detector
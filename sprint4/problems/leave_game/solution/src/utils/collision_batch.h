@@ -0,0 +1,84 @@
+#pragma once
+
+#include "collision_detector.h"
+
+#include <span>
+#include <vector>
+
+namespace collision_detector {
+
+// Предметы в виде структуры массивов: координаты и ширины лежат подряд,
+// что позволяет обрабатывать сразу несколько предметов одной векторной инструкцией
+class ItemsLayout {
+public:
+    void Clear() noexcept {
+        ids_.clear();
+        xs_.clear();
+        ys_.clear();
+        widths_.clear();
+    }
+
+    void Reserve(size_t count) {
+        ids_.reserve(count);
+        xs_.reserve(count);
+        ys_.reserve(count);
+        widths_.reserve(count);
+    }
+
+    void Add(const Item& item) {
+        ids_.push_back(item.id);
+        xs_.push_back(item.position.x);
+        ys_.push_back(item.position.y);
+        widths_.push_back(item.width);
+    }
+
+    size_t Size() const noexcept {
+        return ids_.size();
+    }
+
+    unsigned int GetId(size_t idx) const noexcept {
+        return ids_[idx];
+    }
+
+    const double* Xs() const noexcept {
+        return xs_.data();
+    }
+
+    const double* Ys() const noexcept {
+        return ys_.data();
+    }
+
+    const double* Widths() const noexcept {
+        return widths_.data();
+    }
+
+private:
+    std::vector<unsigned int> ids_;
+    std::vector<double> xs_;
+    std::vector<double> ys_;
+    std::vector<double> widths_;
+};
+
+// Набор инструкций, которым выполняется пакетная проверка предметов
+enum class BatchIsa {
+    SCALAR,
+    SSE2,   // 2 предмета за инструкцию
+    AVX2    // 4 предмета за инструкцию
+};
+
+// Лучший набор инструкций, доступный на текущем процессоре (определяется один раз при запуске)
+BatchIsa GetBestBatchIsa() noexcept;
+// Поддерживается ли набор инструкций текущим процессором
+bool IsBatchIsaSupported(BatchIsa isa) noexcept;
+
+// Проверяет все предметы для собирателя с номером gatherer_id и дописывает
+// найденные события сбора в events (без сортировки).
+// Результат побитово совпадает с TryCollectPoint + CollectionResult::IsCollected
+void CollectItems(const Gatherer& gatherer, size_t gatherer_id, const ItemsLayout& items,
+                  std::vector<GatheringEvent>& events, BatchIsa isa = GetBestBatchIsa());
+
+// Аналог FindGatherEvents для предметов, представленных структурой массивов
+std::vector<GatheringEvent> FindGatherEvents(const ItemsLayout& items, std::span<const Gatherer> gatherers,
+                                             BatchIsa isa = GetBestBatchIsa());
+
+}  // namespace collision_detector
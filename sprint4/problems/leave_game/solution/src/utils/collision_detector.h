@@ -3,11 +3,15 @@
 #include "geom.h"
 
 #include <algorithm>
+#include <array>
 #include <cmath>
+#include <concepts>
 #include <limits>
+#include <tuple>
+#include <utility>
 #include <vector>
 #include <optional>
-#include <variant>
+#include <span>
 
 namespace collision_detector {
 
@@ -22,8 +26,25 @@ struct CollectionResult {
     double proj_ratio;
 };
 
-// Движемся из точки a в точку b и пытаемся подобрать точку c
-CollectionResult TryCollectPoint(geom::Point2D a, geom::Point2D b, geom::Point2D c);
+// Движемся из точки a в точку b и пытаемся подобрать точку c.
+// Функция определена в заголовке, чтобы встраиваться во внутренний цикл поиска событий
+inline CollectionResult TryCollectPoint(geom::Point2D a, geom::Point2D b, geom::Point2D c) {
+    // Проверим, что перемещение ненулевое.
+    // Тут приходится использовать строгое равенство, а не приближённое,
+    // пскольку при сборе заказов придётся учитывать перемещение даже на небольшое
+    // расстояние.
+    const double u_x = c.x - a.x;
+    const double u_y = c.y - a.y;
+    const double v_x = b.x - a.x;
+    const double v_y = b.y - a.y;
+    const double u_dot_v = u_x * v_x + u_y * v_y;
+    const double u_len2 = u_x * u_x + u_y * u_y;
+    const double v_len2 = v_x * v_x + v_y * v_y;
+    const double proj_ratio = u_dot_v / v_len2;
+    const double sq_distance = u_len2 - (u_dot_v * u_dot_v) / v_len2;
+
+    return CollectionResult(sq_distance, proj_ratio);
+}
 
 struct Item {
     unsigned int id;
@@ -55,16 +76,99 @@ struct GatheringEvent {
     double time;
 };
 
+// Требования к источнику предметов и собирателей.
+// Им удовлетворяет как виртуальный ItemGathererProvider, так и невиртуальные
+// поставщики вроде SpanItemGathererProvider, для которых поиск событий
+// инстанцируется без виртуальных вызовов и проверок границ
+template <typename Provider>
+concept ItemGathererSource = requires(const Provider& provider, size_t idx) {
+    { provider.ItemsCount() } -> std::convertible_to<size_t>;
+    { provider.GetItem(idx) } -> std::convertible_to<Item>;
+    { provider.GatherersCount() } -> std::convertible_to<size_t>;
+    { provider.GetGatherer(idx) } -> std::convertible_to<Gatherer>;
+};
+
+// Сортирует события сбора по времени.
+// При равном времени порядок определяется номерами собирателя и предмета,
+// чтобы результат не зависел от реализации сортировки
+inline void SortGatheringEvents(std::vector<GatheringEvent>& events) {
+    std::sort(events.begin(), events.end(),
+              [](const GatheringEvent& e_l, const GatheringEvent& e_r) {
+                  return std::tie(e_l.time, e_l.gatherer_id, e_l.item_id)
+                       < std::tie(e_r.time, e_r.gatherer_id, e_r.item_id);
+              });
+}
+
+template <ItemGathererSource Provider>
+std::vector<GatheringEvent> FindGatherEvents(const Provider& provider) {
+    std::vector<GatheringEvent> detected_events;
+
+    const size_t gatherers_count = provider.GatherersCount();
+    const size_t items_count = provider.ItemsCount();
+
+    for (size_t g = 0; g < gatherers_count; ++g) {
+        const Gatherer& gatherer = provider.GetGatherer(g);
+        // Пропускаем собирателей, которые не сдвинулись с места
+        if (gatherer.start_pos == gatherer.end_pos) {
+            continue;
+        }
+        for (size_t i = 0; i < items_count; ++i) {
+            const Item& item = provider.GetItem(i);
+            auto collect_result
+                = TryCollectPoint(gatherer.start_pos, gatherer.end_pos, item.position);
+
+            if (collect_result.IsCollected(gatherer.width + item.width)) {
+                detected_events.push_back({.item_id = i,
+                                           .gatherer_id = g,
+                                           .sq_distance = collect_result.sq_distance,
+                                           .time = collect_result.proj_ratio});
+            }
+        }
+    }
+
+    SortGatheringEvents(detected_events);
+
+    return detected_events;
+}
+
+// Поиск событий через виртуальный интерфейс
 std::vector<GatheringEvent> FindGatherEvents(const ItemGathererProvider& provider);
 
-class VectorItemGathererProvider : public ItemGathererProvider {
+// Невиртуальный поставщик, который только ссылается на уже существующие массивы
+class SpanItemGathererProvider {
 public:
-    VectorItemGathererProvider(std::vector<Item> items,
-                               std::vector<Gatherer> gatherers)
+    SpanItemGathererProvider(std::span<const Item> items,
+                             std::span<const Gatherer> gatherers) noexcept
         : items_(items)
         , gatherers_(gatherers) {
     }
 
+    size_t ItemsCount() const noexcept {
+        return items_.size();
+    }
+    const Item& GetItem(size_t idx) const noexcept {
+        return items_[idx];
+    }
+    size_t GatherersCount() const noexcept {
+        return gatherers_.size();
+    }
+    const Gatherer& GetGatherer(size_t idx) const noexcept {
+        return gatherers_[idx];
+    }
+
+private:
+    std::span<const Item> items_;
+    std::span<const Gatherer> gatherers_;
+};
+
+class VectorItemGathererProvider final : public ItemGathererProvider {
+public:
+    VectorItemGathererProvider(std::vector<Item> items,
+                               std::vector<Gatherer> gatherers)
+        : items_(std::move(items))
+        , gatherers_(std::move(gatherers)) {
+    }
+
     
     size_t ItemsCount() const override {
         return items_.size();
@@ -123,20 +227,44 @@ struct Rect {
         h = std::fabs(end.y - start.y) + width*2;
     }
 
-    std::vector<geom::Point2D> GetVertices() const {
-        std::vector<geom::Point2D> res;
-        res.push_back({x, y});
-        res.push_back({x + w, y});
-        res.push_back({x + w, y + h});
-        res.push_back({x, y + h});
-        return res;
+    std::array<geom::Point2D, 4> GetVertices() const {
+        return {geom::Point2D{x, y}, {x + w, y}, {x + w, y + h}, {x, y + h}};
     }
 };
 
-std::optional<LineSegment> Intersect(LineSegment s1, LineSegment s2);
-LineSegment ProjectX(Rect r);
-LineSegment ProjectY(Rect r);
-std::optional<Rect> Intersect(Rect r1, Rect r2);
+// Вычисляем пересечение отрезков
+inline std::optional<LineSegment> Intersect(LineSegment s1, LineSegment s2) {
+    double left = std::max(s1.x1, s2.x1);
+    double right = std::min(s1.x2, s2.x2);
+
+    if (right < left) {
+        return std::nullopt;
+    }
+
+    return LineSegment{.x1 = left, .x2 = right};
+}
+
+// Вычисляем проекции на оси
+inline LineSegment ProjectX(Rect r) {
+    return LineSegment{.x1 = r.x, .x2 = r.x + r.w};
+}
+
+inline LineSegment ProjectY(Rect r) {
+    return LineSegment{.x1 = r.y, .x2 = r.y + r.h};
+}
+
+inline std::optional<Rect> Intersect(Rect r1, Rect r2) {
+    auto px = Intersect(ProjectX(r1), ProjectX(r2));
+    auto py = Intersect(ProjectY(r1), ProjectY(r2));
+
+    if (!px || !py) {
+        return std::nullopt;
+    }
+
+    // Составляем из проекций прямоугольник
+    return Rect(px->x1, py->x1, 
+                px->x2 - px->x1, py->x2 - py->x1);
+}
 
 class OfficeSaveProvider {
 protected:
@@ -156,16 +284,115 @@ struct OfficeSaveEvent {
     double time;
 };
 
-std::vector<OfficeSaveEvent> FindOfficeSaveEvents(const OfficeSaveProvider& provider) ;
+// Требования к источнику офисов и собирателей (аналогично ItemGathererSource)
+template <typename Provider>
+concept OfficeSaveSource = requires(const Provider& provider, size_t idx) {
+    { provider.RectsCount() } -> std::convertible_to<size_t>;
+    { provider.GetRect(idx) } -> std::convertible_to<Rect>;
+    { provider.GatherersCount() } -> std::convertible_to<size_t>;
+    { provider.GetGatherer(idx) } -> std::convertible_to<Gatherer>;
+};
+
+// Время (доля пройденного пути), за которое собиратель достигает офиса.
+// intersection - пересечение прямоугольника пути собирателя с прямоугольником офиса.
+// Для определения минимального времени в пути до офиса ищем минимальный путь
+// до вершины прямоугольника-пересечения
+inline double GetOfficeSaveTime(const Gatherer& gatherer, const Rect& intersection) {
+    double min_ratio = 1.01;
+    for (auto vertex : intersection.GetVertices()) {
+        auto collect_result = TryCollectPoint(gatherer.start_pos, gatherer.end_pos, vertex);
+
+        if (collect_result.IsCollected(gatherer.width) && collect_result.proj_ratio < min_ratio) {
+            min_ratio = collect_result.proj_ratio;
+        }
+    }
+    return min_ratio;
+}
+
+inline void SortOfficeSaveEvents(std::vector<OfficeSaveEvent>& events) {
+    std::sort(events.begin(), events.end(),
+              [](const OfficeSaveEvent& e_l, const OfficeSaveEvent& e_r) {
+                  return std::tie(e_l.time, e_l.gatherer_id, e_l.office_id)
+                       < std::tie(e_r.time, e_r.gatherer_id, e_r.office_id);
+              });
+}
+
+template <OfficeSaveSource Provider>
+std::vector<OfficeSaveEvent> FindOfficeSaveEvents(const Provider& provider) {
+    std::vector<OfficeSaveEvent> detected_events;
+
+    const size_t gatherers_count = provider.GatherersCount();
+    const size_t rects_count = provider.RectsCount();
+
+    // По всем "собирателям"
+    for (size_t g = 0; g < gatherers_count; ++g) {
+        const Gatherer& gatherer = provider.GetGatherer(g);
+        // Пропускаем ситуацию, когда позиция не поменялась
+        if (gatherer.start_pos == gatherer.end_pos) {
+            continue;
+        }
 
-class VectorOfficeSaveProvider : public OfficeSaveProvider {
+        // Прямогульник, который "накрывает" пройденный собирателем путь
+        const Rect gatherer_path(gatherer.start_pos, gatherer.end_pos, gatherer.width);
+
+        // По всем "базам" (они же офисы в виде прямоугольников)
+        for (size_t i = 0; i < rects_count; ++i) {
+            // Находим пересечение прямоугольника пути с прямоугольником офиса
+            auto intersect_result = Intersect(gatherer_path, provider.GetRect(i));
+
+            if (!intersect_result) {    // Если пересечения нет, то и контакта нет
+                continue;
+            }
+
+            detected_events.push_back({.office_id = i,
+                                       .gatherer_id = g,
+                                       .time = GetOfficeSaveTime(gatherer, *intersect_result)});
+        }
+    }
+
+    SortOfficeSaveEvents(detected_events);
+
+    return detected_events;
+}
+
+// Поиск событий через виртуальный интерфейс
+std::vector<OfficeSaveEvent> FindOfficeSaveEvents(const OfficeSaveProvider& provider);
+
+// Невиртуальный поставщик, который только ссылается на уже существующие массивы
+class SpanOfficeSaveProvider {
 public:
-    VectorOfficeSaveProvider(std::vector<Rect> rects,
-                               std::vector<Gatherer> gatherers)
+    SpanOfficeSaveProvider(std::span<const Rect> rects,
+                           std::span<const Gatherer> gatherers) noexcept
         : rects_(rects)
         , gatherers_(gatherers) {
     }
 
+    size_t RectsCount() const noexcept {
+        return rects_.size();
+    }
+    const Rect& GetRect(size_t idx) const noexcept {
+        return rects_[idx];
+    }
+    size_t GatherersCount() const noexcept {
+        return gatherers_.size();
+    }
+    const Gatherer& GetGatherer(size_t idx) const noexcept {
+        return gatherers_[idx];
+    }
+
+private:
+    std::span<const Rect> rects_;
+    std::span<const Gatherer> gatherers_;
+};
+
+class VectorOfficeSaveProvider final : public OfficeSaveProvider {
+public:
+    VectorOfficeSaveProvider(std::vector<Rect> rects,
+                               std::vector<Gatherer> gatherers)
+        : rects_(std::move(rects))
+        , gatherers_(std::move(gatherers)) {
+    }
+
     
     size_t RectsCount() const override {
         return rects_.size();
@@ -185,8 +412,92 @@ private:
     std::vector<Gatherer> gatherers_;
 };
 
-using AllIvents = std::variant<OfficeSaveEvent, GatheringEvent>;
+// Статический индекс прямоугольников (офисов) для быстрого поиска пересечений.
+// Прямоугольники хранятся в массиве, отсортированном по левой границе. Запрос
+// бинарным поиском находит первый прямоугольник, который ещё может дотянуться
+// до запрашиваемой области (с учётом максимальной ширины), и просматривает только
+// прямоугольники, левая граница которых не правее области запроса.
+// Предназначен для объектов, которые не меняются после загрузки карты
+class RectIndex {
+public:
+    // Добавляет прямоугольник с номером id, сохраняя упорядоченность массива
+    void Add(const Rect& rect, size_t id) {
+        Entry entry{rect, id};
+        auto pos = std::upper_bound(entries_.begin(), entries_.end(), rect.x,
+                                    [](double x, const Entry& e) { return x < e.rect.x; });
+        entries_.insert(pos, entry);
+        max_width_ = std::max(max_width_, rect.w);
+    }
+
+    size_t Size() const noexcept {
+        return entries_.size();
+    }
+
+    // Вызывает fn(id, пересечение) для каждого прямоугольника, пересекающегося с area
+    template <typename Fn>
+    void ForEachIntersection(const Rect& area, Fn&& fn) const {
+        const double min_x = area.x - max_width_;
+        const double max_x = area.x + area.w;
+        auto it = std::lower_bound(entries_.begin(), entries_.end(), min_x,
+                                   [](const Entry& e, double x) { return e.rect.x < x; });
+        for (; it != entries_.end() && it->rect.x <= max_x; ++it) {
+            if (auto intersection = Intersect(area, it->rect)) {
+                fn(it->id, *intersection);
+            }
+        }
+    }
+
+private:
+    struct Entry {
+        Rect rect;
+        size_t id;
+    };
+
+    std::vector<Entry> entries_;
+    double max_width_ = 0.0;
+};
 
-bool operator<(const AllIvents& a, const AllIvents& b);
+// Поиск событий доставки в офисы, заданные индексом
+std::vector<OfficeSaveEvent> FindOfficeSaveEvents(const RectIndex& offices, std::span<const Gatherer> gatherers);
+
+// Поток событий сбора и доставки, упорядоченный по времени.
+// Списки событий должны быть уже отсортированы по времени (так их возвращают
+// FindGatherEvents и FindOfficeSaveEvents), поэтому поток обходит их слиянием
+// за линейное время и не выделяет память.
+// При равном времени сначала идут события сбора, затем события доставки:
+// предмет, подобранный у самого офиса, сразу же сдаётся.
+class EventStream {
+public:
+    EventStream(std::span<const GatheringEvent> gather_events,
+                std::span<const OfficeSaveEvent> office_events) noexcept
+        : gather_events_{gather_events}
+        , office_events_{office_events} {
+    }
+
+    size_t Size() const noexcept {
+        return gather_events_.size() + office_events_.size();
+    }
+
+    // Вызывает visitor для каждого события в порядке времени.
+    // visitor должен принимать как GatheringEvent, так и OfficeSaveEvent
+    template <typename Visitor>
+    void ForEach(Visitor&& visitor) const {
+        auto gather_it = gather_events_.begin();
+        auto office_it = office_events_.begin();
+
+        while (gather_it != gather_events_.end() || office_it != office_events_.end()) {
+            if (office_it == office_events_.end()
+                || (gather_it != gather_events_.end() && gather_it->time <= office_it->time)) {
+                visitor(*gather_it++);
+            } else {
+                visitor(*office_it++);
+            }
+        }
+    }
+
+private:
+    std::span<const GatheringEvent> gather_events_;
+    std::span<const OfficeSaveEvent> office_events_;
+};
 
 }  // namespace collision_detector
\ No newline at end of file
@@ -63,6 +63,15 @@ namespace json_field {
     constexpr static char RESPONSE_TIME[]         = "response_time";
     constexpr static char RESPONSE_CODE[]         = "code";
     constexpr static char RESPONSE_CONTENT_TYPE[] = "content_type";
+    // Connections
+    constexpr static char CONNECTIONS_OPEN[]     = "open";
+    constexpr static char CONNECTIONS_IDLE[]     = "idle";
+    constexpr static char CONNECTIONS_REAPED[]   = "reaped";
+    constexpr static char CONNECTIONS_REJECTED[] = "rejected";
+    // Hot restart
+    constexpr static char HOT_RESTART_STATE_SIZE[] = "stateSize";
+    constexpr static char HOT_RESTART_SOCKETS[]    = "sockets";
+    constexpr static char HOT_RESTART_TIME_US[]    = "timeUs";
     // API
     constexpr static char API_CODE_BAD_REQUEST[]      = "badRequest";
     constexpr static char API_CODE_INVALID_ARGUMENT[] = "invalidArgument";
@@ -70,6 +79,27 @@ namespace json_field {
     constexpr static char API_CODE_INVALID_TOKEN[]    = "invalidToken";
     constexpr static char API_CODE_UNKNOWN_TOKEN[]    = "unknownToken";
     constexpr static char API_CODE_MAP_NOT_FOUND[]    = "mapNotFound";
+    constexpr static char API_CODE_SERVICE_UNAVAILABLE[] = "serviceUnavailable";
+    constexpr static char API_CODE_TOO_MANY_REQUESTS[]   = "tooManyRequests";
+    // Metrics
+    constexpr static char METRICS_QUEUE_DEPTH[]      = "queueDepth";
+    constexpr static char METRICS_PEAK_QUEUE_DEPTH[] = "peakQueueDepth";
+    constexpr static char METRICS_MAX_QUEUE_DEPTH[]  = "maxQueueDepth";
+    constexpr static char METRICS_SHED_QUEUE_DEPTH[] = "shedQueueDepth";
+    constexpr static char METRICS_TICK_LAG[]         = "tickLag";
+    constexpr static char METRICS_MAX_TICK_LAG[]     = "maxTickLag";
+    constexpr static char METRICS_ADMITTED[]         = "admitted";
+    constexpr static char METRICS_SHED[]             = "shed";
+    constexpr static char METRICS_REJECTED[]         = "rejected";
+    constexpr static char METRICS_RATE_LIMITED[]     = "rateLimited";
+    constexpr static char METRICS_FULL_TICKS[]       = "fullSessionTicks";
+    constexpr static char METRICS_IDLE_TICKS[]       = "idleSessionTicks";
+    constexpr static char METRICS_CONNECTIONS[]      = "connections";
+    // Profile
+    constexpr static char PROFILE_RUNNING[]   = "running";
+    constexpr static char PROFILE_FREQUENCY[] = "frequency";
+    constexpr static char PROFILE_SAMPLES[]   = "samples";
+    constexpr static char PROFILE_DROPPED[]   = "dropped";
     // JoinParams
     constexpr static char JOIN_NAME[]   = "userName";
     constexpr static char JOIN_MAP_ID[] = "mapId";
@@ -83,6 +113,8 @@ namespace json_field {
     constexpr static char GET_STATE_LOOT[]     = "lostObjects";
     // PlayerActionParams
     constexpr static char PLAYER_ACTION_MOVE_DIRECTION[]  = "move";
+    // PlayerBatchParams
+    constexpr static char PLAYER_BATCH_ACTIONS[]  = "actions";
     // TickParams
     constexpr static char TICK_DT[]  = "timeDelta";
     // RecordsResult
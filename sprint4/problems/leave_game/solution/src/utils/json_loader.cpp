@@ -10,10 +10,12 @@
 #include <boost/property_tree/json_parser.hpp>
 
 #include <iostream>
+#include <limits>
 #include <stdexcept>
 #include <string_view>
 
 #include "json_fields.h"
+#include "json_scanner.h"
 #include "loot_generator.h"
 #include "tick_use_case.h"
 
@@ -194,14 +196,24 @@ void tag_invoke(json::value_from_tag, json::value& jv, Item const& item)
     };
 }
 
-void tag_invoke(json::value_from_tag, json::value& jv, std::shared_ptr<Item> const& item)
+void tag_invoke(json::value_from_tag, json::value& jv, BagItem const& item)
 {
     jv = {
-        {json_field::ITEM_ID, json::value_from(*item->GetId())},
-        {json_field::ITEM_TYPE, json::value_from(item->GetType())}
+        {json_field::ITEM_ID, json::value_from(*item.id)},
+        {json_field::ITEM_TYPE, json::value_from(item.type)}
     };
 }
 
+void tag_invoke(json::value_from_tag, json::value& jv, Dog::Bag const& bag)
+{
+    json::array arr;
+    arr.reserve(bag.Size());
+    for (const auto& item : bag) {
+        arr.push_back(json::value_from(item));
+    }
+    jv = std::move(arr);
+}
+
 
 void tag_invoke(json::value_from_tag, json::value& jv, ItemInBag<Item> const& item)
 {
@@ -255,6 +267,100 @@ void tag_invoke(json::value_from_tag, json::value& jv, std::vector<Map> const& m
     jv = form_array(maps);
 }
 
+void WriteJson(json_writer::JsonWriter& writer, Office const& office) {
+    auto pos = office.GetPosition();
+    auto offset = office.GetOffset();
+    writer.BeginObject()
+        .Key(json_field::OFFICE_ID).Value(*office.GetId())
+        .Key(json_field::OFFICE_POS_X).Value(pos.x)
+        .Key(json_field::OFFICE_POS_Y).Value(pos.y)
+        .Key(json_field::OFFICE_OFFSET_DX).Value(offset.dx)
+        .Key(json_field::OFFICE_OFFSET_DY).Value(offset.dy)
+        .EndObject();
+}
+
+void WriteJson(json_writer::JsonWriter& writer, Building const& building) {
+    auto bounds = building.GetBounds();
+    writer.BeginObject()
+        .Key(json_field::BUILDING_POS_X).Value(bounds.position.x)
+        .Key(json_field::BUILDING_POS_Y).Value(bounds.position.y)
+        .Key(json_field::BUILDING_SIZE_W).Value(bounds.size.width)
+        .Key(json_field::BUILDING_SIZE_H).Value(bounds.size.height)
+        .EndObject();
+}
+
+void WriteJson(json_writer::JsonWriter& writer, Road const& road) {
+    auto start = road.GetStart();
+    auto end = road.GetEnd();
+    writer.BeginObject()
+        .Key(json_field::ROAD_START_X).Value(start.x)
+        .Key(json_field::ROAD_START_Y).Value(start.y);
+    if (end.x == start.x) { // VERTICAL
+        writer.Key(json_field::ROAD_END_Y).Value(end.y);
+    } else {    // HORIZONTAL
+        writer.Key(json_field::ROAD_END_X).Value(end.x);
+    }
+    writer.EndObject();
+}
+
+// Потерянный предмет в состоянии игры
+void WriteJson(json_writer::JsonWriter& writer, Item const& item) {
+    const auto& pos = item.GetPosition();
+    writer.BeginObject()
+        .Key(json_field::ITEM_TYPE).Value(item.GetType())
+        .Key(json_field::ITEM_POSITION).Pair(pos.x, pos.y)
+        .EndObject();
+}
+
+// Предметы в рюкзаке пса
+void WriteJson(json_writer::JsonWriter& writer, Dog::Bag const& bag) {
+    writer.BeginArray();
+    for (const auto& item : bag) {
+        writer.BeginObject()
+            .Key(json_field::ITEM_ID).Value(*item.id)
+            .Key(json_field::ITEM_TYPE).Value(item.type)
+            .EndObject();
+    }
+    writer.EndArray();
+}
+
+// Поля карты без lootTypes, общие для Map и ExtendedMap
+static void WriteMapFields(json_writer::JsonWriter& writer, Map const& map) {
+    auto write_array = [&writer](const auto& container) {
+        writer.BeginArray();
+        for (const auto& item : container) {
+            WriteJson(writer, item);
+        }
+        writer.EndArray();
+    };
+
+    writer.Key(json_field::MAP_ID).Value(*map.GetId())
+        .Key(json_field::MAP_NAME).Value(map.GetName());
+    writer.Key(json_field::MAP_ROADS);
+    write_array(map.GetRoads());
+    writer.Key(json_field::MAP_BUILDINGS);
+    write_array(map.GetBuildings());
+    writer.Key(json_field::MAP_OFFICES);
+    write_array(map.GetOffices());
+}
+
+void WriteJson(json_writer::JsonWriter& writer, Map const& map) {
+    writer.BeginObject();
+    WriteMapFields(writer, map);
+    writer.EndObject();
+}
+
+void WriteJson(json_writer::JsonWriter& writer, std::vector<Map> const& maps) {
+    writer.BeginArray();
+    for (const auto& map : maps) {
+        writer.BeginObject()
+            .Key(json_field::MAP_ID).Value(*map.GetId())
+            .Key(json_field::MAP_NAME).Value(map.GetName())
+            .EndObject();
+    }
+    writer.EndArray();
+}
+
 } // namespace model
 
 namespace extra_data {
@@ -308,6 +414,14 @@ void tag_invoke(json::value_from_tag, json::value& jv, ExtendedMap const& map)
     jv.emplace_object() = object;
 }
 
+void WriteJson(json_writer::JsonWriter& writer, ExtendedMap const& map) {
+    writer.BeginObject();
+    WriteMapFields(writer, map.GetMap());
+    // Типы трофеев - произвольный JSON из конфигурации, он уже хранится в виде дерева
+    writer.Key(json_field::MAP_LOOT_TYPES).RawValue(json::serialize(map.GetLootTypes()));
+    writer.EndObject();
+}
+
 }   // namespace extra_data
 
 namespace loot_gen {
@@ -419,6 +533,60 @@ void tag_invoke(boost::json::value_from_tag, boost::json::value& jv, RecordsResu
     jv = records;
 }
 
+void WriteJson(json_writer::JsonWriter& writer, ListPlayersResult const& players_result) {
+    writer.BeginObject();
+    for (const auto& player_info : players_result) {
+        writer.Key(player_info.GetIdAsString())
+            .BeginObject()
+            .Key(json_field::LIST_PLAYERS_NAME).Value(player_info.GetNameAsString())
+            .EndObject();
+    }
+    writer.EndObject();
+}
+
+void WriteJson(json_writer::JsonWriter& writer, GetStateResult const& state_result) {
+    writer.BeginObject();
+
+    writer.Key(json_field::GET_STATE_PLAYERS).BeginObject();
+    for (const auto& player_info : state_result.players_) {
+        const auto& dog = player_info.GetDog();
+        const auto& pos = dog.GetPosition();
+        const auto& speed = dog.GetSpeed();
+        const char direction[] = {static_cast<char>(dog.GetDirection())};
+        writer.Key(player_info.GetIdAsString())
+            .BeginObject()
+            .Key(json_field::DOG_POSITION).Pair(pos.x, pos.y)
+            .Key(json_field::DOG_SPEED).Pair(speed.ux, speed.uy)
+            .Key(json_field::DOG_DIRECTION).Value(std::string_view(direction, 1));
+        writer.Key(json_field::PLAYER_BAG);
+        WriteJson(writer, dog.GetBag());
+        writer.Key(json_field::PLAYER_SCORE).Value(dog.GetScore())
+            .EndObject();
+    }
+    writer.EndObject();
+
+    writer.Key(json_field::GET_STATE_LOOT).BeginObject();
+    for (const auto& item_info : state_result.items_) {
+        writer.Key(item_info.GetIdAsString());
+        WriteJson(writer, item_info);
+    }
+    writer.EndObject();
+
+    writer.EndObject();
+}
+
+void WriteJson(json_writer::JsonWriter& writer, RecordsResult const& records_result) {
+    writer.BeginArray();
+    for (const auto& record : records_result.records) {
+        writer.BeginObject()
+            .Key(json_field::RECORD_NAME).Value(record.name)
+            .Key(json_field::RECORD_SCORE).Value(record.score)
+            .Key(json_field::RECORD_TIME).Value(record.play_time)
+            .EndObject();
+    }
+    writer.EndArray();
+}
+
 } // namespace app
 
 
@@ -482,41 +650,108 @@ std::pair<Game, extra_data::MapsLootTypes> LoadGame(const std::filesystem::path&
     return {std::move(game), std::move(lootTypes)};
 }
 
-bool ReadJoinParamsFromString(http_handler::JoinParams& params, std::string str) {
-    // Распарсить строку как JSON, используя boost::json::parse
-    // Получаем json-объект из строки (тип value)
-    auto parsed_config_json = json::parse(str);
-    auto obj = parsed_config_json.as_object();
+namespace {
 
-    params.name   = value_to<std::string>(obj.at(std::string(json_field::JOIN_NAME)));
-    params.map_id = value_to<std::string>(obj.at(std::string(json_field::JOIN_MAP_ID)));
+// Разбирает объект тела запроса. on_field(key) читает значение поля (ненужные пропускает)
+// и возвращает результат чтения
+template <typename OnField>
+void ReadRequestObject(json_scanner::Scanner& scanner, OnField&& on_field) {
+    if (!scanner.ReadObject(on_field) || !scanner.AtEnd()) {
+        throw std::invalid_argument("Request body parse error");
+    }
+}
 
-    return true;
+void RequireField(bool found, std::string_view field) {
+    if (!found) {
+        throw std::invalid_argument("Request field is missing: "s.append(field));
+    }
 }
 
-bool ReadPlayerActionParamsFromString(http_handler::PlayerActionParams& params, std::string str) {
-    // Распарсить строку как JSON, используя boost::json::parse
-    // Получаем json-объект из строки (тип value)
-    auto parsed_config_json = json::parse(str);
-    auto obj = parsed_config_json.as_object();
+}  // namespace
 
-    params.direction = value_to<std::string>(obj.at(std::string(json_field::PLAYER_ACTION_MOVE_DIRECTION)));
+// Параметры запросов разбираются без построения дерева json::value: нужные поля копируются
+// прямо из тела запроса, короткие строки при этом помещаются в std::string без выделения памяти.
+// Если поле повторяется, используется последнее значение - как и при разборе boost::json
+bool ReadJoinParamsFromString(http_handler::JoinParams& params, std::string_view str) {
+    json_scanner::Scanner scanner(str);
+    bool has_name = false;
+    bool has_map_id = false;
+    ReadRequestObject(scanner, [&](std::string_view key) {
+        if (key == json_field::JOIN_NAME) {
+            has_name = scanner.ReadString(params.name);
+            return has_name;
+        }
+        if (key == json_field::JOIN_MAP_ID) {
+            has_map_id = scanner.ReadString(params.map_id);
+            return has_map_id;
+        }
+        return scanner.SkipValue();
+    });
+    RequireField(has_name, json_field::JOIN_NAME);
+    RequireField(has_map_id, json_field::JOIN_MAP_ID);
 
     return true;
 }
 
-bool ReadTickParamsFromString(http_handler::TickParams& params, std::string str) {
-    // Распарсить строку как JSON, используя boost::json::parse
-    // Получаем json-объект из строки (тип value)
-    auto parsed_config_json = json::parse(str);
-    auto obj = parsed_config_json.as_object();
+bool ReadPlayerActionParamsFromString(http_handler::PlayerActionParams& params, std::string_view str) {
+    json_scanner::Scanner scanner(str);
+    bool has_move = false;
+    ReadRequestObject(scanner, [&](std::string_view key) {
+        if (key == json_field::PLAYER_ACTION_MOVE_DIRECTION) {
+            has_move = scanner.ReadString(params.direction);
+            return has_move;
+        }
+        return scanner.SkipValue();
+    });
+    RequireField(has_move, json_field::PLAYER_ACTION_MOVE_DIRECTION);
 
-    auto val = obj.at(std::string(json_field::TICK_DT));
-    if ( !val.is_int64() ) {
-        throw std::runtime_error("Time delta must be int64");
-    }
+    return true;
+}
 
-    params.dt = TimeType(value_to<unsigned>(val));
+bool ReadPlayerBatchParamsFromString(http_handler::PlayerBatchParams& params, std::string_view str) {
+    json_scanner::Scanner scanner(str);
+    bool has_actions = false;
+    params.actions.clear();
+    ReadRequestObject(scanner, [&](std::string_view key) {
+        if (key != json_field::PLAYER_BATCH_ACTIONS) {
+            return scanner.SkipValue();
+        }
+        params.actions.clear();
+        has_actions = scanner.ReadArray([&] {
+            auto& action_params = params.actions.emplace_back();
+            bool has_move = false;
+            const bool parsed = scanner.ReadObject([&](std::string_view action_key) {
+                if (action_key == json_field::PLAYER_ACTION_MOVE_DIRECTION) {
+                    has_move = scanner.ReadString(action_params.direction);
+                    return has_move;
+                }
+                return scanner.SkipValue();
+            });
+            return parsed && has_move;
+        });
+        return has_actions;
+    });
+    RequireField(has_actions, json_field::PLAYER_BATCH_ACTIONS);
+
+    return true;
+}
+
+bool ReadTickParamsFromString(http_handler::TickParams& params, std::string_view str) {
+    json_scanner::Scanner scanner(str);
+    bool has_dt = false;
+    ReadRequestObject(scanner, [&](std::string_view key) {
+        if (key != json_field::TICK_DT) {
+            return scanner.SkipValue();
+        }
+        // Время должно быть целым неотрицательным числом миллисекунд
+        std::int64_t dt = 0;
+        has_dt = scanner.ReadInteger(dt) && dt >= 0 && dt <= std::numeric_limits<unsigned>::max();
+        if (has_dt) {
+            params.dt = TimeType(dt);
+        }
+        return has_dt;
+    });
+    RequireField(has_dt, json_field::TICK_DT);
 
     return true;
 }
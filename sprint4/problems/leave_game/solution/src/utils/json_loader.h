@@ -1,6 +1,7 @@
 #pragma once
 
 #include <filesystem>
+#include <string_view>
 
 #include "game.h"
 #include "http_handler_types.h"
@@ -11,6 +12,7 @@
 #include "tick_use_case.h"
 #include "records_use_case.h"
 #include "extra_data.h"
+#include "json_writer.h"
 
 namespace model {
     void tag_invoke(boost::json::value_from_tag, boost::json::value& jv, Office const& office);
@@ -20,14 +22,25 @@ namespace model {
     void tag_invoke(boost::json::value_from_tag, boost::json::value& jv, Speed const& speed);
     void tag_invoke(boost::json::value_from_tag, boost::json::value& jv, Dog const& dog);
     void tag_invoke(boost::json::value_from_tag, boost::json::value& jv, Item const& item);
-    void tag_invoke(boost::json::value_from_tag, boost::json::value& jv, std::shared_ptr<Item> const& item);
+    void tag_invoke(boost::json::value_from_tag, boost::json::value& jv, BagItem const& item);
+    void tag_invoke(boost::json::value_from_tag, boost::json::value& jv, Dog::Bag const& bag);
     void tag_invoke(boost::json::value_from_tag, boost::json::value& jv, ItemInBag<Item> const& item);
     void tag_invoke(boost::json::value_from_tag, boost::json::value& jv, Map const& map);
     void tag_invoke(boost::json::value_from_tag, boost::json::value& jv, std::vector<Map> const& maps);
+
+    // Потоковая запись в JSON, совпадающая по выводу с tag_invoke
+    void WriteJson(json_writer::JsonWriter& writer, Office const& office);
+    void WriteJson(json_writer::JsonWriter& writer, Building const& building);
+    void WriteJson(json_writer::JsonWriter& writer, Road const& road);
+    void WriteJson(json_writer::JsonWriter& writer, Item const& item);
+    void WriteJson(json_writer::JsonWriter& writer, Dog::Bag const& bag);
+    void WriteJson(json_writer::JsonWriter& writer, Map const& map);
+    void WriteJson(json_writer::JsonWriter& writer, std::vector<Map> const& maps);
 } // namespace model
 
 namespace extra_data {
     void tag_invoke(boost::json::value_from_tag, boost::json::value& jv, ExtendedMap const& maps_loot_types);
+    void WriteJson(json_writer::JsonWriter& writer, ExtendedMap const& map);
 }
 
 namespace loot_gen {
@@ -42,11 +55,16 @@ namespace app {
     void tag_invoke(boost::json::value_from_tag, boost::json::value& jv, PlayerActionResult const& action_result);
     void tag_invoke(boost::json::value_from_tag, boost::json::value& jv, TickResult const& action_result);
     void tag_invoke(boost::json::value_from_tag, boost::json::value& jv, RecordsResult const& action_result);
+
+    void WriteJson(json_writer::JsonWriter& writer, ListPlayersResult const& players_result);
+    void WriteJson(json_writer::JsonWriter& writer, GetStateResult const& state_result);
+    void WriteJson(json_writer::JsonWriter& writer, RecordsResult const& records_result);
 } // namespace app
 
 namespace json_loader {
     std::pair<model::Game, extra_data::MapsLootTypes> LoadGame(const std::filesystem::path& json_path);
-    bool ReadJoinParamsFromString(http_handler::JoinParams& params, std::string str);
-    bool ReadPlayerActionParamsFromString(http_handler::PlayerActionParams& params, std::string str);
-    bool ReadTickParamsFromString(http_handler::TickParams& params, std::string str);
+    bool ReadJoinParamsFromString(http_handler::JoinParams& params, std::string_view str);
+    bool ReadPlayerActionParamsFromString(http_handler::PlayerActionParams& params, std::string_view str);
+    bool ReadPlayerBatchParamsFromString(http_handler::PlayerBatchParams& params, std::string_view str);
+    bool ReadTickParamsFromString(http_handler::TickParams& params, std::string_view str);
 }  // namespace json_loader
@@ -0,0 +1,346 @@
+#include "json_scanner.h"
+
+#include <limits>
+
+namespace json_scanner {
+
+namespace {
+
+bool IsDigit(char ch) noexcept {
+    return ch >= '0' && ch <= '9';
+}
+
+int HexValue(char ch) noexcept {
+    if (ch >= '0' && ch <= '9') {
+        return ch - '0';
+    }
+    if (ch >= 'a' && ch <= 'f') {
+        return ch - 'a' + 10;
+    }
+    if (ch >= 'A' && ch <= 'F') {
+        return ch - 'A' + 10;
+    }
+    return -1;
+}
+
+// Читает четыре шестнадцатеричные цифры после \u. -1 - ошибка
+long ParseHex4(std::string_view str, size_t pos) noexcept {
+    if (str.size() < pos + 4) {
+        return -1;
+    }
+    long code = 0;
+    for (size_t i = pos; i < pos + 4; ++i) {
+        const int digit = HexValue(str[i]);
+        if (digit < 0) {
+            return -1;
+        }
+        code = code * 16 + digit;
+    }
+    return code;
+}
+
+bool IsHighSurrogate(long code) noexcept {
+    return code >= 0xD800 && code <= 0xDBFF;
+}
+
+bool IsLowSurrogate(long code) noexcept {
+    return code >= 0xDC00 && code <= 0xDFFF;
+}
+
+// Длина корректной последовательности UTF-8, начинающейся в позиции pos. 0 - последовательность некорректна
+size_t Utf8SequenceLength(std::string_view str, size_t pos) noexcept {
+    const auto byte = [&](size_t i) {
+        return i < str.size() ? static_cast<unsigned char>(str[i]) : 0u;
+    };
+    const auto in_range = [](unsigned ch, unsigned low, unsigned high) {
+        return ch >= low && ch <= high;
+    };
+
+    const unsigned lead = byte(pos);
+    if (lead < 0x80) {
+        return 1;
+    }
+    if (in_range(lead, 0xC2, 0xDF)) {
+        return in_range(byte(pos + 1), 0x80, 0xBF) ? 2 : 0;
+    }
+    if (in_range(lead, 0xE0, 0xEF)) {
+        // E0 и ED отсекают избыточные кодировки и суррогаты
+        const unsigned low = lead == 0xE0 ? 0xA0 : 0x80;
+        const unsigned high = lead == 0xED ? 0x9F : 0xBF;
+        return in_range(byte(pos + 1), low, high) && in_range(byte(pos + 2), 0x80, 0xBF) ? 3 : 0;
+    }
+    if (in_range(lead, 0xF0, 0xF4)) {
+        const unsigned low = lead == 0xF0 ? 0x90 : 0x80;
+        const unsigned high = lead == 0xF4 ? 0x8F : 0xBF;
+        return in_range(byte(pos + 1), low, high) && in_range(byte(pos + 2), 0x80, 0xBF)
+            && in_range(byte(pos + 3), 0x80, 0xBF) ? 4 : 0;
+    }
+    return 0;
+}
+
+void AppendUtf8(std::string& out, unsigned long code) {
+    if (code < 0x80) {
+        out.push_back(static_cast<char>(code));
+    } else if (code < 0x800) {
+        out.push_back(static_cast<char>(0xC0 | (code >> 6)));
+        out.push_back(static_cast<char>(0x80 | (code & 0x3F)));
+    } else if (code < 0x10000) {
+        out.push_back(static_cast<char>(0xE0 | (code >> 12)));
+        out.push_back(static_cast<char>(0x80 | ((code >> 6) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | (code & 0x3F)));
+    } else {
+        out.push_back(static_cast<char>(0xF0 | (code >> 18)));
+        out.push_back(static_cast<char>(0x80 | ((code >> 12) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | ((code >> 6) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | (code & 0x3F)));
+    }
+}
+
+// Раскодирует содержимое строки, уже проверенное ScanString
+void Unescape(std::string_view raw, std::string& out) {
+    out.clear();
+    size_t run_start = 0;
+    size_t pos = 0;
+    while ((pos = raw.find('\\', pos)) != raw.npos) {
+        out.append(raw.substr(run_start, pos - run_start));
+        const char ch = raw[pos + 1];
+        pos += 2;
+        switch (ch) {
+            case 'b': out.push_back('\b'); break;
+            case 'f': out.push_back('\f'); break;
+            case 'n': out.push_back('\n'); break;
+            case 'r': out.push_back('\r'); break;
+            case 't': out.push_back('\t'); break;
+            case 'u': {
+                unsigned long code = ParseHex4(raw, pos);
+                pos += 4;
+                if (IsHighSurrogate(code)) {
+                    const unsigned long low = ParseHex4(raw, pos + 2);
+                    pos += 6;
+                    code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+                }
+                AppendUtf8(out, code);
+                break;
+            }
+            default: out.push_back(ch);    // ", \ и /
+        }
+        run_start = pos;
+    }
+    out.append(raw.substr(run_start));
+}
+
+}  // namespace
+
+bool Scanner::ReadString(std::string& out) {
+    std::string_view raw;
+    bool escaped = false;
+    if (!ScanString(raw, escaped)) {
+        return false;
+    }
+    if (escaped) {
+        Unescape(raw, out);
+    } else {
+        out.assign(raw);
+    }
+    return true;
+}
+
+bool Scanner::ReadKey(std::string_view& key) {
+    bool escaped = false;
+    if (!ScanString(key, escaped)) {
+        return false;
+    }
+    if (escaped) {
+        Unescape(key, key_buffer_);
+        key = key_buffer_;
+    }
+    return true;
+}
+
+bool Scanner::ReadInteger(std::int64_t& value) {
+    SkipWhitespace();
+    const size_t start = pos_;
+    if (!ScanNumber()) {
+        return false;
+    }
+
+    std::string_view number = json_.substr(start, pos_ - start);
+    const bool negative = number.front() == '-';
+    if (negative) {
+        number.remove_prefix(1);
+    }
+    // Модуль накапливается в беззнаковом виде: у INT64_MIN он на единицу больше INT64_MAX
+    const std::uint64_t limit = negative ? std::uint64_t(std::numeric_limits<std::int64_t>::max()) + 1
+                                         : std::uint64_t(std::numeric_limits<std::int64_t>::max());
+    std::uint64_t magnitude = 0;
+    for (char ch : number) {
+        if (!IsDigit(ch)) {
+            return false;   // дробная часть или показатель
+        }
+        const unsigned digit = ch - '0';
+        if (magnitude > (limit - digit) / 10) {
+            return false;
+        }
+        magnitude = magnitude * 10 + digit;
+    }
+    value = negative ? static_cast<std::int64_t>(0 - magnitude) : static_cast<std::int64_t>(magnitude);
+    return true;
+}
+
+bool Scanner::SkipValue() {
+    SkipWhitespace();
+    if (pos_ >= json_.size()) {
+        return false;
+    }
+    switch (json_[pos_]) {
+        case '{':
+            return ReadObject([this](std::string_view) {
+                return SkipValue();
+            });
+        case '[':
+            return ReadArray([this] {
+                return SkipValue();
+            });
+        case '"': {
+            std::string_view raw;
+            bool escaped = false;
+            return ScanString(raw, escaped);
+        }
+        case 't':
+            return ScanLiteral("true");
+        case 'f':
+            return ScanLiteral("false");
+        case 'n':
+            return ScanLiteral("null");
+        default:
+            return ScanNumber();
+    }
+}
+
+bool Scanner::AtEnd() noexcept {
+    SkipWhitespace();
+    return pos_ == json_.size();
+}
+
+void Scanner::SkipWhitespace() noexcept {
+    while (pos_ < json_.size()) {
+        const char ch = json_[pos_];
+        if (ch != ' ' && ch != '\t' && ch != '\n' && ch != '\r') {
+            break;
+        }
+        ++pos_;
+    }
+}
+
+bool Scanner::Consume(char ch) noexcept {
+    SkipWhitespace();
+    if (pos_ < json_.size() && json_[pos_] == ch) {
+        ++pos_;
+        return true;
+    }
+    return false;
+}
+
+bool Scanner::Enter() noexcept {
+    return ++depth_ <= MAX_DEPTH;
+}
+
+bool Scanner::ScanString(std::string_view& raw, bool& escaped) noexcept {
+    if (!Consume('"')) {
+        return false;
+    }
+    const size_t start = pos_;
+    escaped = false;
+    while (pos_ < json_.size()) {
+        const auto ch = static_cast<unsigned char>(json_[pos_]);
+        if (ch == '"') {
+            raw = json_.substr(start, pos_ - start);
+            ++pos_;
+            return true;
+        }
+        if (ch < 0x20) {
+            return false;
+        }
+        if (ch == '\\') {
+            escaped = true;
+            if (pos_ + 1 >= json_.size()) {
+                return false;
+            }
+            switch (json_[pos_ + 1]) {
+                case '"': case '\\': case '/': case 'b': case 'f': case 'n': case 'r': case 't':
+                    pos_ += 2;
+                    break;
+                case 'u': {
+                    const long code = ParseHex4(json_, pos_ + 2);
+                    if (code < 0 || IsLowSurrogate(code)) {
+                        return false;
+                    }
+                    pos_ += 6;
+                    if (IsHighSurrogate(code)) {
+                        // За старшей половиной суррогатной пары обязана следовать младшая
+                        if (json_.substr(pos_, 2) != "\\u" || !IsLowSurrogate(ParseHex4(json_, pos_ + 2))) {
+                            return false;
+                        }
+                        pos_ += 6;
+                    }
+                    break;
+                }
+                default:
+                    return false;
+            }
+            continue;
+        }
+        const size_t length = Utf8SequenceLength(json_, pos_);
+        if (length == 0) {
+            return false;
+        }
+        pos_ += length;
+    }
+    return false;
+}
+
+bool Scanner::ScanNumber() noexcept {
+    const auto digits = [this] {
+        const size_t start = pos_;
+        while (pos_ < json_.size() && IsDigit(json_[pos_])) {
+            ++pos_;
+        }
+        return pos_ > start;
+    };
+    const auto next_is = [this](char ch) {
+        if (pos_ < json_.size() && json_[pos_] == ch) {
+            ++pos_;
+            return true;
+        }
+        return false;
+    };
+
+    SkipWhitespace();
+    next_is('-');
+    // Ведущие нули запрещены
+    if (!next_is('0') && !digits()) {
+        return false;
+    }
+    if (next_is('.') && !digits()) {
+        return false;
+    }
+    if (next_is('e') || next_is('E')) {
+        if (!next_is('+')) {
+            next_is('-');
+        }
+        if (!digits()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool Scanner::ScanLiteral(std::string_view literal) noexcept {
+    if (json_.substr(pos_, literal.size()) != literal) {
+        return false;
+    }
+    pos_ += literal.size();
+    return true;
+}
+
+}  // namespace json_scanner
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace json_scanner {
+
+// Однопроходный разбор небольших JSON-документов прямо из тела запроса, без построения дерева
+// boost::json::value. Нужные поля читаются по мере прохода, остальные значения проверяются и пропускаются.
+// Правила разбора те же, что у boost::json::parse по умолчанию: без комментариев и завершающих
+// запятых, строки - корректный UTF-8, вложенность не глубже MAX_DEPTH.
+// Все методы возвращают false, если документ некорректен, после этого разбор продолжать нельзя
+class Scanner {
+public:
+    static constexpr unsigned MAX_DEPTH = 32;
+
+    explicit Scanner(std::string_view json) noexcept
+        : json_(json) {
+    }
+
+    Scanner(const Scanner&) = delete;
+    Scanner& operator=(const Scanner&) = delete;
+
+    // Разбирает объект. Для каждого поля вызывается on_field(key), который должен прочитать
+    // значение поля одним из методов сканера и вернуть результат чтения.
+    // key действителен только до чтения значения
+    template <typename OnField>
+    bool ReadObject(OnField&& on_field);
+
+    // Разбирает массив. Для каждого элемента вызывается on_element(), который должен прочитать элемент
+    template <typename OnElement>
+    bool ReadArray(OnElement&& on_element);
+
+    // Читает строку. Строки без escape-последовательностей копируются в out целиком
+    bool ReadString(std::string& out);
+    // Читает целое число, представимое в int64_t. Дробные числа и числа с показателем не подходят
+    bool ReadInteger(std::int64_t& value);
+    // Проверяет и пропускает любое значение
+    bool SkipValue();
+    // true, если после разобранного значения остались только пробельные символы
+    bool AtEnd() noexcept;
+
+private:
+    void SkipWhitespace() noexcept;
+    bool Consume(char ch) noexcept;
+    bool Enter() noexcept;
+    void Leave() noexcept {
+        --depth_;
+    }
+    bool ReadKey(std::string_view& key);
+    // Проверяет строку и возвращает её содержимое без кавычек
+    bool ScanString(std::string_view& raw, bool& escaped) noexcept;
+    bool ScanNumber() noexcept;
+    bool ScanLiteral(std::string_view literal) noexcept;
+
+    std::string_view json_;
+    size_t pos_ = 0;
+    unsigned depth_ = 0;
+    // Ключ с escape-последовательностями раскодируется сюда
+    std::string key_buffer_;
+};
+
+template <typename OnField>
+bool Scanner::ReadObject(OnField&& on_field) {
+    if (!Consume('{') || !Enter()) {
+        return false;
+    }
+    if (!Consume('}')) {
+        do {
+            std::string_view key;
+            if (!ReadKey(key) || !Consume(':') || !on_field(key)) {
+                return false;
+            }
+        } while (Consume(','));
+        if (!Consume('}')) {
+            return false;
+        }
+    }
+    Leave();
+    return true;
+}
+
+template <typename OnElement>
+bool Scanner::ReadArray(OnElement&& on_element) {
+    if (!Consume('[') || !Enter()) {
+        return false;
+    }
+    if (!Consume(']')) {
+        do {
+            if (!on_element()) {
+                return false;
+            }
+        } while (Consume(','));
+        if (!Consume(']')) {
+            return false;
+        }
+    }
+    Leave();
+    return true;
+}
+
+}  // namespace json_scanner
@@ -0,0 +1,159 @@
+#include "json_writer.h"
+
+#include <charconv>
+#include <cmath>
+#include <system_error>
+
+namespace json_writer {
+
+using namespace std::literals;
+
+JsonWriter& JsonWriter::BeginObject() {
+    Separate();
+    out_.push_back('{');
+    need_comma_ = false;
+    return *this;
+}
+
+JsonWriter& JsonWriter::EndObject() {
+    out_.push_back('}');
+    need_comma_ = true;
+    return *this;
+}
+
+JsonWriter& JsonWriter::BeginArray() {
+    Separate();
+    out_.push_back('[');
+    need_comma_ = false;
+    return *this;
+}
+
+JsonWriter& JsonWriter::EndArray() {
+    out_.push_back(']');
+    need_comma_ = true;
+    return *this;
+}
+
+JsonWriter& JsonWriter::Key(std::string_view key) {
+    Separate();
+    WriteString(key);
+    out_.push_back(':');
+    need_comma_ = false;
+    return *this;
+}
+
+JsonWriter& JsonWriter::Value(std::string_view value) {
+    Separate();
+    WriteString(value);
+    need_comma_ = true;
+    return *this;
+}
+
+JsonWriter& JsonWriter::Value(double value) {
+    Separate();
+    need_comma_ = true;
+
+    // Бесконечность и NaN boost::json по умолчанию записывает так же
+    if (std::isnan(value)) {
+        out_.append("null"sv);
+        return *this;
+    }
+    if (std::isinf(value)) {
+        out_.append(value < 0 ? "-1e99999"sv : "1e99999"sv);
+        return *this;
+    }
+
+    // boost::json печатает кратчайшее представление (алгоритм Ryu) в экспоненциальной форме:
+    // мантисса, 'E', показатель без знака '+' и ведущих нулей. std::to_chars даёт те же цифры
+    // в виде "2.5e-01", остаётся поправить запись показателя
+    char buffer[32];
+    const auto [end, ec] = std::to_chars(buffer, buffer + sizeof(buffer), value, std::chars_format::scientific);
+    const std::string_view str(buffer, end - buffer);
+    const auto e_pos = str.find('e');
+
+    out_.append(str.substr(0, e_pos));
+    out_.push_back('E');
+    auto exponent = str.substr(e_pos + 1);
+    if (exponent.front() == '-') {
+        out_.push_back('-');
+    }
+    exponent.remove_prefix(1);    // знак
+    while (exponent.size() > 1 && exponent.front() == '0') {
+        exponent.remove_prefix(1);
+    }
+    out_.append(exponent);
+    return *this;
+}
+
+JsonWriter& JsonWriter::Value(bool value) {
+    Separate();
+    out_.append(value ? "true"sv : "false"sv);
+    need_comma_ = true;
+    return *this;
+}
+
+JsonWriter& JsonWriter::Null() {
+    Separate();
+    out_.append("null"sv);
+    need_comma_ = true;
+    return *this;
+}
+
+JsonWriter& JsonWriter::RawValue(std::string_view json) {
+    Separate();
+    out_.append(json);
+    need_comma_ = true;
+    return *this;
+}
+
+JsonWriter& JsonWriter::WriteInt(std::int64_t value) {
+    Separate();
+    char buffer[24];
+    const auto [end, ec] = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    out_.append(buffer, end);
+    need_comma_ = true;
+    return *this;
+}
+
+JsonWriter& JsonWriter::WriteUInt(std::uint64_t value) {
+    Separate();
+    char buffer[24];
+    const auto [end, ec] = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    out_.append(buffer, end);
+    need_comma_ = true;
+    return *this;
+}
+
+void JsonWriter::WriteString(std::string_view str) {
+    static constexpr char HEX_DIGITS[] = "0123456789abcdef";
+
+    out_.push_back('"');
+    // Участки без спецсимволов копируются целиком
+    size_t run_start = 0;
+    for (size_t i = 0; i < str.size(); ++i) {
+        const auto ch = static_cast<unsigned char>(str[i]);
+        if (ch >= 0x20 && ch != '"' && ch != '\\') {
+            continue;
+        }
+        out_.append(str.substr(run_start, i - run_start));
+        run_start = i + 1;
+        out_.push_back('\\');
+        switch (ch) {
+            case '"': out_.push_back('"'); break;
+            case '\\': out_.push_back('\\'); break;
+            case '\b': out_.push_back('b'); break;
+            case '\f': out_.push_back('f'); break;
+            case '\n': out_.push_back('n'); break;
+            case '\r': out_.push_back('r'); break;
+            case '\t': out_.push_back('t'); break;
+            default:
+                out_.append("u00"sv);
+                out_.push_back(HEX_DIGITS[ch >> 4]);
+                out_.push_back(HEX_DIGITS[ch & 0xF]);
+        }
+    }
+    out_.append(str.substr(run_start));
+    out_.push_back('"');
+}
+
+}  // namespace json_writer
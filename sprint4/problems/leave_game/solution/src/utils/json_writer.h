@@ -0,0 +1,78 @@
+#pragma once
+
+#include <concepts>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+namespace json_writer {
+
+// Потоковая запись JSON прямо в строку-буфер, без построения дерева boost::json::value.
+// Формат вывода совпадает с boost::json::serialize байт в байт: без пробелов,
+// те же правила экранирования строк и та же запись чисел с плавающей точкой (1E0, 2.5E-1).
+// Запятые между элементами расставляются автоматически.
+// Буфер не очищается: запись дописывается в конец, поэтому его можно заранее зарезервировать
+class JsonWriter {
+public:
+    explicit JsonWriter(std::string& out) noexcept
+        : out_(out) {
+    }
+
+    JsonWriter(const JsonWriter&) = delete;
+    JsonWriter& operator=(const JsonWriter&) = delete;
+
+    JsonWriter& BeginObject();
+    JsonWriter& EndObject();
+    JsonWriter& BeginArray();
+    JsonWriter& EndArray();
+    // Ключ следующего значения объекта
+    JsonWriter& Key(std::string_view key);
+
+    JsonWriter& Value(std::string_view value);
+    JsonWriter& Value(const char* value) {
+        return Value(std::string_view(value));
+    }
+    JsonWriter& Value(double value);
+    JsonWriter& Value(bool value);
+    template <std::integral T>
+    JsonWriter& Value(T value) {
+        if constexpr (std::is_signed_v<T>) {
+            return WriteInt(static_cast<std::int64_t>(value));
+        } else {
+            return WriteUInt(static_cast<std::uint64_t>(value));
+        }
+    }
+    JsonWriter& Null();
+    // Уже сериализованное значение
+    JsonWriter& RawValue(std::string_view json);
+
+    // Пара [x, y] - так записываются позиции и скорости
+    JsonWriter& Pair(double first, double second) {
+        return BeginArray().Value(first).Value(second).EndArray();
+    }
+
+private:
+    void Separate() {
+        if (need_comma_) {
+            out_.push_back(',');
+        }
+    }
+    JsonWriter& WriteInt(std::int64_t value);
+    JsonWriter& WriteUInt(std::uint64_t value);
+    void WriteString(std::string_view str);
+
+    std::string& out_;
+    // Следующему элементу нужна запятая: на этом уровне уже записано значение
+    bool need_comma_ = false;
+};
+
+// Формирует JSON значения value в строке out. Для типа T должна быть объявлена функция
+// WriteJson(JsonWriter&, const T&) в пространстве имён T (см. json_loader.h)
+template <typename T>
+void Serialize(const T& value, std::string& out) {
+    JsonWriter writer(out);
+    WriteJson(writer, value);
+}
+
+}  // namespace json_writer
@@ -60,6 +60,22 @@ public:
      */
     unsigned Generate(TimeInterval time_delta, unsigned loot_count, unsigned looter_count);
 
+    /*
+     * Учитывает время, за которое трофеи не могли появиться (трофеев не меньше, чем мародёров).
+     * Равносильно вызову Generate, вернувшему 0, но без обращения к генератору случайных чисел
+     */
+    void AddTimeWithoutLoot(TimeInterval time_delta) noexcept {
+        time_without_loot_ += time_delta;
+    }
+
+    // Время, прошедшее без появления трофеев. Нужно, чтобы воспроизвести генерацию с того же момента
+    TimeInterval GetTimeWithoutLoot() const noexcept {
+        return time_without_loot_;
+    }
+    void SetTimeWithoutLoot(TimeInterval time) noexcept {
+        time_without_loot_ = time;
+    }
+
 private:
     static double DefaultGenerator() noexcept {
         return 1.0;
@@ -0,0 +1,419 @@
+#include "sampling_profiler.h"
+
+#include <cxxabi.h>
+#include <dlfcn.h>
+#include <pthread.h>
+#include <signal.h>
+#include <sys/time.h>
+#include <ucontext.h>
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace profiler {
+
+namespace detail {
+
+std::atomic_bool zones_enabled{false};
+constinit thread_local ZoneStack zone_stack{};
+
+}  // namespace detail
+
+namespace {
+
+using namespace std::literals;
+
+// Ёмкость буфера сэмплов. Фоновый поток опустошает его раньше, чем буфер заполнится даже на MAX_FREQUENCY
+constexpr size_t SLOT_COUNT = 4096;
+constexpr auto DRAIN_PERIOD = 50ms;
+
+enum SlotState : int {
+    FREE,
+    WRITING,
+    READY
+};
+
+struct Sample {
+    std::atomic<int> state{FREE};
+    unsigned stack_depth = 0;
+    unsigned zone_depth = 0;
+    std::array<std::uintptr_t, MAX_STACK_DEPTH> stack;
+    std::array<const char*, MAX_ZONE_DEPTH> zones;
+};
+
+using Stack = std::vector<std::uintptr_t>;
+using Zones = std::vector<const char*>;
+
+// Буфер заполняется из обработчика сигнала, поэтому выделяется один раз и больше не освобождается
+struct SampleBuffer {
+    std::array<Sample, SLOT_COUNT> slots;
+    std::atomic<std::uint64_t> next_slot{0};
+    std::atomic<std::uint64_t> dropped{0};
+};
+
+SampleBuffer* buffer = nullptr;
+std::atomic_bool is_sampling{false};
+
+// Границы стека потока [low, high). high == 0 - границы неизвестны
+struct StackBounds {
+    std::uintptr_t low;
+    std::uintptr_t high;
+};
+
+// Обработчик сигнала читает границы в том же потоке, как и стек зон
+constinit thread_local StackBounds stack_bounds{};
+
+bool SetTimer(unsigned frequency) {
+    itimerval timer{};
+    if (frequency != 0) {
+        timer.it_interval.tv_usec = 1'000'000 / frequency;
+        timer.it_value = timer.it_interval;
+    }
+    return setitimer(ITIMER_PROF, &timer, nullptr) == 0;
+}
+
+// Состояние профилировщика вне обработчика сигнала
+struct State {
+    std::mutex mutex;
+    bool is_running = false;
+    bool is_handler_installed = false;
+    unsigned frequency = 0;
+    std::uint64_t samples = 0;
+    std::map<Stack, std::uint64_t> stacks;
+    std::map<Zones, std::uint64_t> zones;
+
+    std::thread drain_thread;
+    std::condition_variable drain_cv;
+    bool stop_drain = false;
+
+    // Профилировщик, не остановленный до завершения программы, останавливается при разрушении
+    // состояния: присоединяемый std::thread в деструкторе завершил бы процесс через std::terminate
+    ~State() {
+        if (drain_thread.joinable()) {
+            SetTimer(0);
+            is_sampling = false;
+            detail::zones_enabled = false;
+            JoinDrain();
+        }
+    }
+
+    // Останавливает фоновый поток. Вызывается без блокировки mutex
+    void JoinDrain() {
+        {
+            std::lock_guard lock{mutex};
+            stop_drain = true;
+        }
+        drain_cv.notify_one();
+        drain_thread.join();
+    }
+};
+
+State& GetState() {
+    static State state;
+    return state;
+}
+
+// Раскручивает стек прерванного потока по цепочке сохранённых указателей кадров.
+// Кадр - пара (предыдущий указатель кадра, адрес возврата). Каждый кадр должен целиком лежать
+// в стеке потока между вершиной (sp) и его началом, быть выровнен, а следующий - лежать выше предыдущего.
+// Так раскрутка не читает чужую память, если функция без указателя кадра испортила регистр
+unsigned Unwind(const ucontext_t& context, const StackBounds& bounds,
+                std::array<std::uintptr_t, MAX_STACK_DEPTH>& stack) noexcept {
+#if defined(__x86_64__)
+    const auto pc = static_cast<std::uintptr_t>(context.uc_mcontext.gregs[REG_RIP]);
+    auto fp = static_cast<std::uintptr_t>(context.uc_mcontext.gregs[REG_RBP]);
+    const auto sp = static_cast<std::uintptr_t>(context.uc_mcontext.gregs[REG_RSP]);
+#elif defined(__aarch64__)
+    const auto pc = static_cast<std::uintptr_t>(context.uc_mcontext.pc);
+    auto fp = static_cast<std::uintptr_t>(context.uc_mcontext.regs[29]);
+    const auto sp = static_cast<std::uintptr_t>(context.uc_mcontext.sp);
+#else
+    return 0;
+#endif
+    unsigned depth = 0;
+    stack[depth++] = pc;
+    // Вершина вне известного стека (границы не записаны или поток работает на другом стеке) - раскрутки нет
+    if (sp < bounds.low || sp >= bounds.high) {
+        return depth;
+    }
+    constexpr std::uintptr_t FRAME_SIZE = 2 * sizeof(std::uintptr_t);
+    while (depth < MAX_STACK_DEPTH && fp % alignof(std::uintptr_t) == 0
+           && fp >= sp && fp < bounds.high && bounds.high - fp >= FRAME_SIZE) {
+        const auto* frame = reinterpret_cast<const std::uintptr_t*>(fp);
+        const auto next_fp = frame[0];
+        const auto return_address = frame[1];
+        if (return_address == 0) {
+            break;
+        }
+        // Адрес возврата указывает на инструкцию после вызова. Для поиска символа берётся сам вызов
+        stack[depth++] = return_address - 1;
+        // Стек растёт вниз: кадры вызывающих функций лежат выше
+        if (next_fp <= fp) {
+            break;
+        }
+        fp = next_fp;
+    }
+    return depth;
+}
+
+// В обработчике сигнала можно только то, что безопасно для асинхронных сигналов:
+// без выделения памяти и блокировок. Занятый слот буфера не ждём - сэмпл отбрасывается
+void HandleSignal(int, siginfo_t*, void* context) {
+    if (!is_sampling.load(std::memory_order_relaxed)) {
+        return;
+    }
+    const int saved_errno = errno;
+    auto& sample = buffer->slots[buffer->next_slot.fetch_add(1, std::memory_order_relaxed) % SLOT_COUNT];
+    int expected = FREE;
+    if (sample.state.compare_exchange_strong(expected, WRITING, std::memory_order_acquire)) {
+        // Границы читаются в порядке, обратном записи в RegisterThread
+        StackBounds bounds;
+        bounds.high = stack_bounds.high;
+        std::atomic_signal_fence(std::memory_order_acquire);
+        bounds.low = stack_bounds.low;
+        sample.stack_depth = Unwind(*static_cast<const ucontext_t*>(context), bounds, sample.stack);
+
+        const auto& zone_stack = detail::zone_stack;
+        const auto zone_depth = zone_stack.depth.load(std::memory_order_relaxed);
+        std::atomic_signal_fence(std::memory_order_acquire);
+        sample.zone_depth = std::min<unsigned>(zone_depth, MAX_ZONE_DEPTH);
+        std::copy_n(zone_stack.names, sample.zone_depth, sample.zones.begin());
+
+        sample.state.store(READY, std::memory_order_release);
+    } else {
+        buffer->dropped.fetch_add(1, std::memory_order_relaxed);
+    }
+    errno = saved_errno;
+}
+
+// Переносит готовые сэмплы из буфера в агрегированные стеки. Вызывается под state.mutex
+void Drain(State& state) {
+    Stack stack;
+    Zones zones;
+    for (auto& sample : buffer->slots) {
+        if (sample.state.load(std::memory_order_acquire) != READY) {
+            continue;
+        }
+        stack.assign(sample.stack.begin(), sample.stack.begin() + sample.stack_depth);
+        zones.assign(sample.zones.begin(), sample.zones.begin() + sample.zone_depth);
+        sample.state.store(FREE, std::memory_order_release);
+
+        ++state.stacks[stack];
+        ++state.zones[zones];
+        ++state.samples;
+    }
+}
+
+void RunDrain(State& state) {
+    std::unique_lock lock{state.mutex};
+    while (!state.drain_cv.wait_for(lock, DRAIN_PERIOD, [&state] { return state.stop_drain; })) {
+        Drain(state);
+    }
+}
+
+void InstallHandler(State& state) {
+    if (state.is_handler_installed) {
+        return;
+    }
+    buffer = new SampleBuffer;
+    struct sigaction action{};
+    action.sa_sigaction = HandleSignal;
+    action.sa_flags = SA_SIGINFO | SA_RESTART;
+    sigemptyset(&action.sa_mask);
+    if (sigaction(SIGPROF, &action, nullptr) != 0) {
+        throw std::runtime_error("Failed to install SIGPROF handler");
+    }
+    // Обработчик не снимается: сигнал, пришедший после остановки таймера, по умолчанию завершил бы процесс
+    state.is_handler_installed = true;
+}
+
+std::string_view Basename(std::string_view path) {
+    const auto pos = path.rfind('/');
+    return pos == path.npos ? path : path.substr(pos + 1);
+}
+
+// Имя функции по адресу. Без экспортированного символа - модуль и смещение в нём
+std::string Symbolize(std::uintptr_t address) {
+    Dl_info info{};
+    if (dladdr(reinterpret_cast<void*>(address), &info) == 0) {
+        char buf[32];
+        std::snprintf(buf, sizeof(buf), "0x%zx", static_cast<size_t>(address));
+        return buf;
+    }
+    std::string name;
+    if (info.dli_sname) {
+        int status = 0;
+        std::unique_ptr<char, decltype(&std::free)> demangled{
+            abi::__cxa_demangle(info.dli_sname, nullptr, nullptr, &status), &std::free};
+        name = status == 0 ? demangled.get() : info.dli_sname;
+    } else {
+        char buf[32];
+        std::snprintf(buf, sizeof(buf), "+0x%zx", static_cast<size_t>(address - reinterpret_cast<std::uintptr_t>(info.dli_fbase)));
+        name = std::string(Basename(info.dli_fname ? info.dli_fname : "?")).append(buf);
+    }
+    // ';' и перевод строки - разделители формата, пробел допустим только перед счётчиком
+    std::replace(name.begin(), name.end(), ';', ':');
+    std::replace(name.begin(), name.end(), '\n', ' ');
+    return name;
+}
+
+template <typename Key, typename Format>
+std::string Fold(const std::map<Key, std::uint64_t>& samples, Format&& format) {
+    // Одинаковые после символизации стеки (разные адреса внутри одной функции) сливаются в одну строку
+    std::map<std::string, std::uint64_t> folded;
+    for (const auto& [key, count] : samples) {
+        folded[format(key)] += count;
+    }
+    std::string result;
+    for (const auto& [path, count] : folded) {
+        result.append(path).append(" "sv).append(std::to_string(count)).push_back('\n');
+    }
+    return result;
+}
+
+}  // namespace
+
+void RegisterThread() noexcept {
+    if (stack_bounds.high != 0) {
+        return;
+    }
+    pthread_attr_t attr;
+    if (pthread_getattr_np(pthread_self(), &attr) != 0) {
+        return;
+    }
+    void* addr = nullptr;
+    size_t size = 0;
+    if (pthread_attr_getstack(&attr, &addr, &size) == 0) {
+        stack_bounds.low = reinterpret_cast<std::uintptr_t>(addr);
+        // Обработчик сигнала считает границы записанными, когда видит high
+        std::atomic_signal_fence(std::memory_order_release);
+        stack_bounds.high = stack_bounds.low + size;
+    }
+    pthread_attr_destroy(&attr);
+}
+
+bool Start(unsigned frequency) {
+    if (frequency == 0 || frequency > MAX_FREQUENCY) {
+        throw std::invalid_argument("Invalid sampling frequency");
+    }
+    RegisterThread();
+    auto& state = GetState();
+    std::unique_lock lock{state.mutex};
+    if (state.is_running) {
+        return false;
+    }
+    InstallHandler(state);
+    for (auto& sample : buffer->slots) {
+        sample.state.store(FREE, std::memory_order_relaxed);
+    }
+    buffer->dropped = 0;
+    state.samples = 0;
+    state.stacks.clear();
+    state.zones.clear();
+    state.frequency = frequency;
+    state.stop_drain = false;
+    state.drain_thread = std::thread{RunDrain, std::ref(state)};
+
+    detail::zones_enabled = true;
+    is_sampling = true;
+    if (!SetTimer(frequency)) {
+        is_sampling = false;
+        detail::zones_enabled = false;
+        lock.unlock();
+        state.JoinDrain();
+        throw std::runtime_error("Failed to start profiling timer");
+    }
+    state.is_running = true;
+    return true;
+}
+
+bool Stop() {
+    auto& state = GetState();
+    std::unique_lock lock{state.mutex};
+    if (!state.is_running) {
+        return false;
+    }
+    SetTimer(0);
+    is_sampling = false;
+    detail::zones_enabled = false;
+    state.is_running = false;
+    lock.unlock();
+    state.JoinDrain();
+
+    lock.lock();
+    Drain(state);
+    return true;
+}
+
+Stats GetStats() {
+    auto& state = GetState();
+    std::lock_guard lock{state.mutex};
+    if (buffer) {
+        Drain(state);
+    }
+    return {state.is_running, state.frequency, state.samples, buffer ? buffer->dropped.load() : 0};
+}
+
+std::string GetFoldedStacks() {
+    auto& state = GetState();
+    std::lock_guard lock{state.mutex};
+    if (!buffer) {
+        return {};
+    }
+    Drain(state);
+
+    std::unordered_map<std::uintptr_t, std::string> symbols;
+    return Fold(state.stacks, [&symbols](const Stack& stack) {
+        std::string path;
+        // Стек записан от вершины, а свёрнутый формат начинается с корня
+        for (auto it = stack.rbegin(); it != stack.rend(); ++it) {
+            auto symbol = symbols.find(*it);
+            if (symbol == symbols.end()) {
+                symbol = symbols.emplace(*it, Symbolize(*it)).first;
+            }
+            if (!path.empty()) {
+                path.push_back(';');
+            }
+            path.append(symbol->second);
+        }
+        return path;
+    });
+}
+
+std::string GetFoldedZones() {
+    auto& state = GetState();
+    std::lock_guard lock{state.mutex};
+    if (!buffer) {
+        return {};
+    }
+    Drain(state);
+
+    return Fold(state.zones, [](const Zones& zones) {
+        if (zones.empty()) {
+            return "[other]"s;
+        }
+        std::string path;
+        for (const char* zone : zones) {
+            if (!path.empty()) {
+                path.push_back(';');
+            }
+            path.append(zone);
+        }
+        return path;
+    });
+}
+
+}  // namespace profiler
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Встроенный профилировщик: сэмплы стека по сигналу SIGPROF (таймер ITIMER_PROF считает процессорное время)
+// и раскрутка стека по указателям кадров. Результат выдаётся сразу в формате свёрнутых стеков
+// ("main;Run;Tick 42"), который принимают flamegraph.pl, speedscope и inferno - без perf и прав root.
+// Символы находятся через dladdr, поэтому исполняемый файл собирается с -rdynamic и -fno-omit-frame-pointer
+namespace profiler {
+
+// Наибольшая глубина сохраняемого стека и вложенность зон
+constexpr size_t MAX_STACK_DEPTH = 64;
+constexpr size_t MAX_ZONE_DEPTH = 8;
+
+// Частота сэмплирования по умолчанию. Не кратна 10 мс, чтобы не попадать в такт периодическим задачам
+constexpr unsigned DEFAULT_FREQUENCY = 99;
+constexpr unsigned MAX_FREQUENCY = 1000;
+
+namespace detail {
+
+// Стек зон текущего потока. Обработчик сигнала читает его в том же потоке, поэтому достаточно барьера компилятора
+struct ZoneStack {
+    const char* names[MAX_ZONE_DEPTH];
+    std::atomic<unsigned> depth;
+};
+
+extern std::atomic_bool zones_enabled;
+extern constinit thread_local ZoneStack zone_stack;
+
+}  // namespace detail
+
+// Отмечает зону - участок кода, время в котором показывается отдельно от стеков вызовов.
+// Пока профилировщик выключен, зона стоит одну проверку флага.
+// name должен жить всё время работы программы (строковый литерал)
+class ZoneScope {
+public:
+    explicit ZoneScope(const char* name) noexcept
+        : is_active_{detail::zones_enabled.load(std::memory_order_relaxed)} {
+        if (is_active_) {
+            auto& stack = detail::zone_stack;
+            const auto depth = stack.depth.load(std::memory_order_relaxed);
+            if (depth < MAX_ZONE_DEPTH) {
+                stack.names[depth] = name;
+            }
+            // Имя должно быть записано раньше, чем его увидит обработчик сигнала
+            std::atomic_signal_fence(std::memory_order_release);
+            stack.depth.store(depth + 1, std::memory_order_relaxed);
+        }
+    }
+
+    ZoneScope(const ZoneScope&) = delete;
+    ZoneScope& operator=(const ZoneScope&) = delete;
+
+    ~ZoneScope() {
+        if (is_active_) {
+            auto& depth = detail::zone_stack.depth;
+            depth.store(depth.load(std::memory_order_relaxed) - 1, std::memory_order_relaxed);
+        }
+    }
+
+private:
+    bool is_active_;
+};
+
+struct Stats {
+    bool is_running = false;
+    unsigned frequency = 0;
+    std::uint64_t samples = 0;
+    // Сэмплы, для которых не нашлось свободного места в буфере
+    std::uint64_t dropped = 0;
+};
+
+// Запоминает границы стека текущего потока. Раскрутка не выходит за них, а в потоке с неизвестными
+// границами сэмпл содержит только прерванную функцию. Границы узнаются через pthread_getattr_np,
+// которую нельзя вызывать из обработчика сигнала, поэтому потоки, стеки которых нужны в профиле,
+// вызывают RegisterThread сами. Start вызывает её для своего потока. Повторный вызов ничего не делает
+void RegisterThread() noexcept;
+
+// Начинает сбор сэмплов с частотой frequency (1..MAX_FREQUENCY) раз в секунду процессорного времени.
+// Собранные ранее сэмплы сбрасываются. Возвращает false, если профилировщик уже запущен
+bool Start(unsigned frequency = DEFAULT_FREQUENCY);
+// Останавливает сбор. Собранные сэмплы остаются доступны до следующего запуска
+bool Stop();
+
+Stats GetStats();
+
+// Свёрнутые стеки вызовов: функции от корня стека через ';', затем число сэмплов
+std::string GetFoldedStacks();
+// То же для вложенных зон. Сэмплы вне зон учитываются в строке "[other]"
+std::string GetFoldedZones();
+
+}  // namespace profiler
@@ -6,6 +6,8 @@
 #include <boost/archive/text_iarchive.hpp>
 #include <cstdio>
 #include <fstream>
+#include <fcntl.h>
+#include <unistd.h>
 
 #include <boost/serialization/vector.hpp>
 #include <vector>
@@ -15,6 +17,8 @@
 #include "players.h"
 #include "game.h"
 #include "app_serialization.h"
+#include "write_ahead_log.h"
+#include "sampling_profiler.h"
 
 namespace serialization {
 
@@ -25,15 +29,31 @@ public:
     , app_(&app)
     {}
 
-    void Serialize(const std::filesystem::path& path) {
+    // lsn - номер последней записи журнала упреждающей записи, вошедшей в снимок
+    void Serialize(const std::filesystem::path& path, wal::Lsn lsn = 0) {
         auto tmp_file = std::string(path) + ".tmp";
         std::ofstream out{tmp_file, std::ios_base::binary};
+        Serialize(out, lsn);
+        // Снимок должен оказаться на диске раньше, чем будет очищен журнал
+        out.flush();
+        SyncFile(tmp_file);
+
+        std::rename(tmp_file.c_str(), path.c_str());
+        // Переименование тоже должно пережить сбой
+        SyncFile(path.has_parent_path() ? path.parent_path() : std::filesystem::path{"."});
+    }
+
+    // Снимок в поток. Используется и для передачи состояния новому процессу при горячем перезапуске
+    void Serialize(std::ostream& out, wal::Lsn lsn = 0) {
+        profiler::ZoneScope zone{"StateSerializer::Serialize"};
         //boost::archive::binary_oarchive ar{out};
         boost::archive::text_oarchive ar{out};
 
         // сохраняем игру
         ar << game_->GetSessions().size();  // Надо сохранить количество сессий
         for ( const auto& session : game_->GetSessions() ) {
+            // Таймеры собак простаивающей сессии могут отставать
+            session->SyncDogTimers();
             ar << GameSessionRepr(*session);
         }
 
@@ -48,11 +68,16 @@ public:
             ar << PlayerRepr(*player);
         }
 
-        std::rename(tmp_file.c_str(), path.c_str());
+        ar << lsn;
     }
 
-    void Deserialize(const std::filesystem::path& path) {
+    // Возвращает номер последней записи журнала, вошедшей в снимок
+    wal::Lsn Deserialize(const std::filesystem::path& path) {
         std::ifstream in{std::string(path), std::ios_base::binary};
+        return Deserialize(in);
+    }
+
+    wal::Lsn Deserialize(std::istream& in) {
         //boost::archive::binary_oarchive ar{out};
         boost::archive::text_iarchive ar{in};
 
@@ -63,13 +88,14 @@ public:
             // Создаём заготовку под представление сессии
             GameSessionRepr session_repr;
             ar >> session_repr;
-            auto session = game_->CreateSession(session_repr.GetMapId());
+            auto session = game_->CreateSession(session_repr.GetMapId(), session_repr.GetId());
             for ( const auto& dog_repr : session_repr.GetDogs() ) {
                 session->AddDog(dog_repr.Restore());
             }
             for ( const auto& item_repr : session_repr.GetItems() ) {
                 session->AddItem(item_repr.Restore());
             }
+            session->ReserveIds(session_repr.GetNextDogId(), session_repr.GetNextItemId());
         }
 
         // Загружаем токены авторизации игроков
@@ -86,6 +112,23 @@ public:
             ar >> player_repr;
             app_->AddPlayer(player_repr, tokens_table[player_repr.GetId()]);
         }
+
+        // Снимки, сохранённые до появления журнала, заканчиваются на данных игроков
+        wal::Lsn lsn = 0;
+        try {
+            ar >> lsn;
+        } catch (const boost::archive::archive_exception&) {
+            lsn = 0;
+        }
+        return lsn;
+    }
+
+private:
+    static void SyncFile(const std::filesystem::path& path) {
+        if (int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC); fd >= 0) {
+            ::fsync(fd);
+            ::close(fd);
+        }
     }
 
 public:
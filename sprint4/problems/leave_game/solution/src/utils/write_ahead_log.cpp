@@ -0,0 +1,337 @@
+#include "write_ahead_log.h"
+
+#include <boost/crc.hpp>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <stdexcept>
+#include <system_error>
+#include <utility>
+
+namespace wal {
+
+using namespace std::literals;
+
+namespace {
+
+enum class RecordType : std::uint8_t {
+    Join = 1,
+    Action = 2,
+    Tick = 3,
+    Leave = 4
+};
+
+constexpr size_t HEADER_SIZE = sizeof(std::uint32_t) * 2;
+// Ограничение на размер одной записи: защищает от огромных аллокаций при чтении повреждённого журнала
+constexpr std::uint32_t MAX_PAYLOAD_SIZE = 1 << 20;
+
+template <typename T>
+void Put(std::string& out, T value) {
+    char bytes[sizeof(T)];
+    std::memcpy(bytes, &value, sizeof(T));
+    out.append(bytes, sizeof(T));
+}
+
+void PutString(std::string& out, std::string_view str) {
+    Put(out, static_cast<std::uint32_t>(str.size()));
+    out.append(str);
+}
+
+// Последовательное чтение данных записи с проверкой границ
+class PayloadReader {
+public:
+    explicit PayloadReader(std::string_view data) noexcept
+        : data_(data) {
+    }
+
+    template <typename T>
+    bool Get(T& value) noexcept {
+        if (data_.size() < sizeof(T)) {
+            return false;
+        }
+        std::memcpy(&value, data_.data(), sizeof(T));
+        data_.remove_prefix(sizeof(T));
+        return true;
+    }
+
+    bool GetString(std::string& str) {
+        std::uint32_t size;
+        if (!Get(size) || data_.size() < size) {
+            return false;
+        }
+        str.assign(data_.substr(0, size));
+        data_.remove_prefix(size);
+        return true;
+    }
+
+    bool AtEnd() const noexcept {
+        return data_.empty();
+    }
+
+private:
+    std::string_view data_;
+};
+
+struct RecordEncoder {
+    std::string& out;
+
+    RecordType operator()(const JoinRecord& record) const {
+        PutString(out, record.name);
+        PutString(out, record.map_id);
+        PutString(out, record.token);
+        return RecordType::Join;
+    }
+    RecordType operator()(const ActionRecord& record) const {
+        PutString(out, record.token);
+        PutString(out, record.move);
+        return RecordType::Action;
+    }
+    RecordType operator()(const TickRecord& record) const {
+        Put(out, record.dt);
+        Put(out, record.seed);
+        return RecordType::Tick;
+    }
+    RecordType operator()(const LeaveRecord& record) const {
+        PutString(out, record.token);
+        return RecordType::Leave;
+    }
+};
+
+bool DecodeRecord(RecordType type, PayloadReader& reader, Record& record) {
+    switch (type) {
+        case RecordType::Join: {
+            JoinRecord join;
+            if (!reader.GetString(join.name) || !reader.GetString(join.map_id) || !reader.GetString(join.token)) {
+                return false;
+            }
+            record = std::move(join);
+            break;
+        }
+        case RecordType::Action: {
+            ActionRecord action;
+            if (!reader.GetString(action.token) || !reader.GetString(action.move)) {
+                return false;
+            }
+            record = std::move(action);
+            break;
+        }
+        case RecordType::Tick: {
+            TickRecord tick;
+            if (!reader.Get(tick.dt) || !reader.Get(tick.seed)) {
+                return false;
+            }
+            record = tick;
+            break;
+        }
+        case RecordType::Leave: {
+            LeaveRecord leave;
+            if (!reader.GetString(leave.token)) {
+                return false;
+            }
+            record = std::move(leave);
+            break;
+        }
+        default:
+            return false;
+    }
+    return reader.AtEnd();
+}
+
+std::uint32_t Checksum(std::string_view data) noexcept {
+    boost::crc_32_type crc;
+    crc.process_bytes(data.data(), data.size());
+    return crc.checksum();
+}
+
+}  // namespace
+
+void EncodeRecord(Lsn lsn, const Record& record, std::string& out) {
+    // Заголовок заполняется после того, как станет известен размер данных
+    const size_t header_pos = out.size();
+    out.append(HEADER_SIZE, '\0');
+    const size_t body_pos = out.size();
+
+    Put(out, lsn);
+    const size_t type_pos = out.size();
+    out.push_back('\0');
+    const RecordType type = std::visit(RecordEncoder{out}, record);
+    out[type_pos] = static_cast<char>(type);
+
+    const std::string_view body = std::string_view(out).substr(body_pos);
+    const auto payload_size = static_cast<std::uint32_t>(body.size() - sizeof(Lsn) - sizeof(RecordType));
+    const std::uint32_t crc = Checksum(body);
+    std::memcpy(out.data() + header_pos, &payload_size, sizeof(payload_size));
+    std::memcpy(out.data() + header_pos + sizeof(payload_size), &crc, sizeof(crc));
+}
+
+ReadResult ReadLog(const fs::path& path, const std::function<void(Lsn, const Record&)>& on_record) {
+    std::ifstream in{path, std::ios_base::binary};
+    if (!in) {
+        throw std::runtime_error("Failed to open write-ahead log "s + path.string());
+    }
+    const std::string data{std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>()};
+
+    ReadResult result;
+    std::string_view rest = data;
+    Record record;
+    while (rest.size() >= HEADER_SIZE) {
+        std::uint32_t payload_size;
+        std::uint32_t crc;
+        std::memcpy(&payload_size, rest.data(), sizeof(payload_size));
+        std::memcpy(&crc, rest.data() + sizeof(payload_size), sizeof(crc));
+        const size_t body_size = sizeof(Lsn) + sizeof(RecordType) + payload_size;
+        if (payload_size > MAX_PAYLOAD_SIZE || rest.size() - HEADER_SIZE < body_size) {
+            break;
+        }
+        const std::string_view body = rest.substr(HEADER_SIZE, body_size);
+        if (Checksum(body) != crc) {
+            break;
+        }
+
+        Lsn lsn;
+        std::memcpy(&lsn, body.data(), sizeof(lsn));
+        const auto type = static_cast<RecordType>(body[sizeof(Lsn)]);
+        PayloadReader reader(body.substr(sizeof(Lsn) + sizeof(RecordType)));
+        if (!DecodeRecord(type, reader, record)) {
+            break;
+        }
+
+        on_record(lsn, record);
+        ++result.records;
+        result.last_lsn = lsn;
+        rest.remove_prefix(HEADER_SIZE + body_size);
+        result.valid_size = data.size() - rest.size();
+    }
+    return result;
+}
+
+LogWriter::LogWriter(const fs::path& path, std::chrono::milliseconds sync_period, Lsn last_lsn)
+    : sync_period_{sync_period}
+    , last_lsn_{last_lsn}
+    , synced_lsn_{last_lsn} {
+    fd_ = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_APPEND | O_CLOEXEC, 0644);
+    if (fd_ < 0) {
+        throw std::system_error(errno, std::generic_category(), "Failed to open write-ahead log "s + path.string());
+    }
+    thread_ = std::jthread([this](std::stop_token stop) {
+        Run(stop);
+    });
+}
+
+LogWriter::~LogWriter() {
+    // Фоновый поток перед выходом дописывает оставшиеся записи
+    thread_.request_stop();
+    thread_.join();
+    ::close(fd_);
+}
+
+Lsn LogWriter::Append(const Record& record) {
+    std::lock_guard lock{mutex_};
+    const Lsn lsn = ++last_lsn_;
+    EncodeRecord(lsn, record, pending_);
+    if (pending_.size() >= FLUSH_THRESHOLD && !sync_requested_) {
+        sync_requested_ = true;
+        wake_cv_.notify_one();
+    }
+    return lsn;
+}
+
+bool LogWriter::Flush() {
+    std::unique_lock lock{mutex_};
+    const Lsn lsn = last_lsn_;
+    const size_t errors = errors_;
+    sync_requested_ = true;
+    wake_cv_.notify_one();
+    synced_cv_.wait(lock, [this, lsn, errors] {
+        return synced_lsn_ >= lsn || errors_ != errors;
+    });
+    return synced_lsn_ >= lsn;
+}
+
+void LogWriter::Truncate() {
+    std::lock_guard lock{mutex_};
+    // Ещё не записанные записи тоже вошли в снимок
+    pending_.clear();
+    truncate_requested_ = true;
+    synced_lsn_ = last_lsn_;
+    synced_cv_.notify_all();
+    wake_cv_.notify_one();
+}
+
+Lsn LogWriter::GetLastLsn() const {
+    std::lock_guard lock{mutex_};
+    return last_lsn_;
+}
+
+LogWriter::Stats LogWriter::GetStats() const {
+    std::lock_guard lock{mutex_};
+    return {last_lsn_, synced_lsn_, syncs_, errors_};
+}
+
+void LogWriter::Run(std::stop_token stop) {
+    std::string batch;
+    std::unique_lock lock{mutex_};
+    while (true) {
+        wake_cv_.wait_for(lock, stop, sync_period_, [this] {
+            return sync_requested_ || truncate_requested_;
+        });
+        const bool stopping = stop.stop_requested();
+
+        const bool truncate = std::exchange(truncate_requested_, false);
+        batch.swap(pending_);
+        const Lsn batch_lsn = last_lsn_;
+        sync_requested_ = false;
+        lock.unlock();
+
+        // Файл и диск - без блокировки, чтобы Append из strand API не ждал ввода-вывода
+        bool ok = true;
+        if (truncate) {
+            ok = ::ftruncate(fd_, 0) == 0;
+        }
+        if (ok && !batch.empty()) {
+            ok = WriteAll(batch) && ::fdatasync(fd_) == 0;
+        }
+        if (!ok) {
+            std::cerr << "Write-ahead log error: " << std::strerror(errno) << std::endl;
+        }
+        const bool synced = truncate || !batch.empty();
+        batch.clear();
+
+        lock.lock();
+        if (ok) {
+            synced_lsn_ = std::max(synced_lsn_, batch_lsn);
+        } else {
+            ++errors_;
+        }
+        if (synced) {
+            ++syncs_;
+        }
+        synced_cv_.notify_all();
+        if (stopping) {
+            break;
+        }
+    }
+}
+
+bool LogWriter::WriteAll(std::string_view data) noexcept {
+    while (!data.empty()) {
+        const ssize_t written = ::write(fd_, data.data(), data.size());
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        data.remove_prefix(written);
+    }
+    return true;
+}
+
+}  // namespace wal
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <variant>
+
+namespace wal {
+
+namespace fs = std::filesystem;
+
+// Порядковый номер записи журнала. Снимок состояния хранит номер последней вошедшей в него записи
+using Lsn = std::uint64_t;
+
+// Игрок подключился к игре. Токен записывается, чтобы после восстановления он остался прежним
+struct JoinRecord {
+    std::string name;
+    std::string map_id;
+    std::string token;
+};
+
+// Игрок изменил направление движения
+struct ActionRecord {
+    std::string token;
+    std::string move;
+};
+
+// Шаг игрового времени. seed - начальное значение std::rand, от которого зависят типы новых трофеев
+struct TickRecord {
+    std::int64_t dt;    // в миллисекундах
+    std::uint32_t seed;
+};
+
+// Игрок ушёл на покой, его результат уже сохранён в БД
+struct LeaveRecord {
+    std::string token;
+};
+
+using Record = std::variant<JoinRecord, ActionRecord, TickRecord, LeaveRecord>;
+
+// Дописывает в out запись в формате журнала:
+// размер данных (4 байта), CRC32 (4 байта), LSN (8 байт), тип записи (1 байт), данные.
+// Числа хранятся в порядке байтов текущей платформы - журнал читает тот же сервер
+void EncodeRecord(Lsn lsn, const Record& record, std::string& out);
+
+struct ReadResult {
+    size_t records = 0;
+    Lsn last_lsn = 0;
+    // Размер корректной части журнала. Хвост за ней - запись, оборванная аварийным завершением
+    size_t valid_size = 0;
+};
+
+// Читает журнал и вызывает on_record для каждой записи по порядку.
+// Чтение останавливается на первой неполной или повреждённой записи
+ReadResult ReadLog(const fs::path& path, const std::function<void(Lsn, const Record&)>& on_record);
+
+// Журнал упреждающей записи. Записи копятся в памяти, фоновый поток раз в sync_period
+// дописывает их в файл одним вызовом write и синхронизирует файл с диском (групповая фиксация).
+// Append не ждёт диска, поэтому при сбое теряется не больше sync_period последних действий
+class LogWriter {
+public:
+    struct Stats {
+        Lsn last_lsn = 0;
+        Lsn synced_lsn = 0;
+        size_t syncs = 0;
+        size_t errors = 0;
+    };
+
+    // Открывает журнал, отбрасывая его прежнее содержимое. Номера записей продолжаются после last_lsn
+    LogWriter(const fs::path& path, std::chrono::milliseconds sync_period, Lsn last_lsn = 0);
+    // Дописывает и синхронизирует накопленные записи
+    ~LogWriter();
+
+    LogWriter(const LogWriter&) = delete;
+    LogWriter& operator=(const LogWriter&) = delete;
+
+    // Добавляет запись и возвращает её номер
+    Lsn Append(const Record& record);
+    // Ждёт, пока все добавленные записи окажутся на диске. false - запись в файл не удалась
+    bool Flush();
+    // Очищает журнал: все добавленные записи вошли в снимок состояния
+    void Truncate();
+
+    Lsn GetLastLsn() const;
+    Stats GetStats() const;
+
+private:
+    // Буфер, при достижении которого запись не дожидается периода синхронизации
+    static constexpr size_t FLUSH_THRESHOLD = 1 << 20;
+
+    void Run(std::stop_token stop);
+    bool WriteAll(std::string_view data) noexcept;
+
+    int fd_ = -1;
+    std::chrono::milliseconds sync_period_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable_any wake_cv_;
+    std::condition_variable synced_cv_;
+    // Записи, ещё не переданные фоновому потоку
+    std::string pending_;
+    Lsn last_lsn_;
+    Lsn synced_lsn_;
+    bool sync_requested_ = false;
+    bool truncate_requested_ = false;
+    size_t syncs_ = 0;
+    size_t errors_ = 0;
+
+    // Поток групповой фиксации
+    std::jthread thread_;
+};
+
+}  // namespace wal
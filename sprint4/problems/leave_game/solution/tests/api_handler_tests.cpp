@@ -0,0 +1,147 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <algorithm>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "../src/http/api_handler.h"
+#include "test_game.h"
+
+using namespace std::literals;
+using namespace http_handler;
+
+namespace {
+
+// Запрос к API от имени игрока с токеном token
+StringRequest MakeRequest(http::verb method, std::string target, const std::string& token, std::string body = {}) {
+    StringRequest req{method, target, 11};
+    req.set(http::field::authorization, "Bearer " + token);
+    req.set(http::field::content_type, "application/json");
+    req.body() = std::move(body);
+    req.prepare_payload();
+    return req;
+}
+
+}  // namespace
+
+SCENARIO("Player batch") {
+    net::io_context ioc;
+    test_game::TestApp<> test_app({.with_vertical_road = true});
+    auto& app = test_app.app;
+    extra_data::MapsLootTypes extra_data;
+    ApiHandler handler(net::make_strand(ioc), app, extra_data);
+
+    const auto token = app.JoinGame("Sharik", "map1").GetTokenAsString();
+    const auto get_dog = [&] {
+        return app.GetState(token).players_.front().GetDog();
+    };
+    const auto target = "/api/v1/game/player/batch"s;
+
+    SECTION("Actions are applied in order") {
+        const auto response = handler.HandleApiRequest(
+            MakeRequest(http::verb::post, target, token, R"({"actions": [{"move": "R"}, {"move": "L"}]})"));
+        CHECK(response.result() == http::status::ok);
+        // В ответе - состояние игры после выполнения пакета
+        CHECK(response.body().find(R"("players")") != std::string::npos);
+        CHECK(get_dog().GetDirection() == model::Direction::WEST);
+    }
+
+    SECTION("Batch with an invalid action is not applied at all") {
+        const auto response = handler.HandleApiRequest(
+            MakeRequest(http::verb::post, target, token, R"({"actions": [{"move": "R"}, {"move": "X"}]})"));
+        CHECK(response.result() == http::status::bad_request);
+        CHECK(get_dog().GetDirection() == model::Direction::NORTH);
+        CHECK(get_dog().GetSpeed() == model::Speed{0.0, 0.0});
+    }
+
+    SECTION("Malformed batch is rejected") {
+        CHECK(handler.HandleApiRequest(MakeRequest(http::verb::post, target, token, R"({"moves": []})")).result()
+              == http::status::bad_request);
+        CHECK(handler.HandleApiRequest(MakeRequest(http::verb::post, target, token, R"({"actions": [{"move": 1}]})")).result()
+              == http::status::bad_request);
+    }
+
+    SECTION("Unknown token and wrong method") {
+        const auto unknown = handler.HandleApiRequest(
+            MakeRequest(http::verb::post, target, std::string(32, 'a'), R"({"actions": []})"));
+        CHECK(unknown.result() == http::status::unauthorized);
+
+        const auto response = handler.HandleApiRequest(MakeRequest(http::verb::get, target, token, R"({"actions": []})"));
+        CHECK(response.result() == http::status::method_not_allowed);
+        CHECK(response[http::field::allow] == "POST");
+    }
+}
+
+SCENARIO("Area of interest") {
+    net::io_context ioc;
+    test_game::TestApp<> test_app({.with_vertical_road = true});
+    auto& app = test_app.app;
+    extra_data::MapsLootTypes extra_data;
+    ApiHandler handler(net::make_strand(ioc), app, extra_data);
+
+    // Собаки игроков стоят на горизонтальной дороге в 0, 3 и 10 от начала, предметы - в 2 и 20
+    const auto token = app.JoinGame("Sharik", "map1").GetTokenAsString();
+    app.JoinGame("Tuzik", "map1");
+    app.JoinGame("Bobik", "map1");
+    auto session = test_app.game.GetSessions().front();
+    const auto& dogs = session->GetDogs();
+    REQUIRE(dogs.size() == 3);
+    dogs[0]->SetPosition({0.0, 0.0});
+    dogs[1]->SetPosition({3.0, 0.0});
+    dogs[2]->SetPosition({10.0, 0.0});
+    model::Item::Type item_type = 0;
+    session->AddItem({2.0, 0.0}, item_type);
+    session->AddItem({20.0, 0.0}, item_type);
+
+    const auto get_dog_positions = [&](std::optional<app::AreaOfInterest> area) {
+        std::vector<double> positions;
+        for (const auto& player : app.GetState(token, area).players_) {
+            positions.push_back(player.GetDog().GetPosition().x);
+        }
+        std::sort(positions.begin(), positions.end());
+        return positions;
+    };
+
+    SECTION("Without radius the whole session is returned") {
+        CHECK(get_dog_positions(std::nullopt) == std::vector{0.0, 3.0, 10.0});
+        CHECK(app.GetState(token).items_.size() == 2);
+    }
+
+    SECTION("Dogs and items outside the radius are excluded") {
+        CHECK(get_dog_positions(app::AreaOfInterest{5.0}) == std::vector{0.0, 3.0});
+        const auto items = app.GetState(token, app::AreaOfInterest{5.0}).items_;
+        REQUIRE(items.size() == 1);
+        CHECK(items.front().GetPosition().x == 2.0);
+
+        // Граница области в неё входит
+        CHECK(get_dog_positions(app::AreaOfInterest{3.0}) == std::vector{0.0, 3.0});
+        CHECK(get_dog_positions(app::AreaOfInterest{100.0}) == std::vector{0.0, 3.0, 10.0});
+    }
+
+    SECTION("Player's own dog is always included") {
+        CHECK(get_dog_positions(app::AreaOfInterest{0.0}) == std::vector{0.0});
+        CHECK(app.GetState(token, app::AreaOfInterest{0.0}).items_.empty());
+    }
+
+    SECTION("Radius is read from the query") {
+        const auto get_state = [&](std::string target) {
+            return handler.HandleApiRequest(MakeRequest(http::verb::get, std::move(target), token));
+        };
+        CHECK(get_state("/api/v1/game/state"s).result() == http::status::ok);
+        CHECK(get_state("/api/v1/game/state?radius=5"s).result() == http::status::ok);
+        CHECK(get_state("/api/v1/game/state?radius=0.5&foo=bar"s).result() == http::status::ok);
+        // Посторонние параметры пропускаются
+        CHECK(get_state("/api/v1/game/state?foo=bar"s).result() == http::status::ok);
+
+        for (const auto target : {"/api/v1/game/state?radius=abc"s, "/api/v1/game/state?radius=-1"s,
+                                  "/api/v1/game/state?radius="s, "/api/v1/game/state?radius"s,
+                                  "/api/v1/game/state?radius=5m"s, "/api/v1/game/state?radius=inf"s,
+                                  "/api/v1/game/state?radius=nan"s}) {
+            INFO(target);
+            const auto response = get_state(target);
+            CHECK(response.result() == http::status::bad_request);
+            CHECK(response.body().find("invalidArgument") != std::string::npos);
+        }
+    }
+}
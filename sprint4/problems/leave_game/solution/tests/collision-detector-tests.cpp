@@ -2,12 +2,14 @@
 
 #include <cmath>
 #include <functional>
+#include <random>
 #include <sstream>
 
 #include <catch2/catch_test_macros.hpp>
 #include <catch2/matchers/catch_matchers_templated.hpp>
 
 #include "../src/utils/collision_detector.h"
+#include "../src/utils/collision_batch.h"
 
 namespace Catch {
 template<>
@@ -134,4 +136,181 @@ SCENARIO("Collision detection") {
             CHECK(events.empty());
         }
     }
+}
+
+SCENARIO("Event stream merge") {
+    using collision_detector::GatheringEvent;
+    using collision_detector::OfficeSaveEvent;
+
+    // Порядок событий записываем строкой вида "g<собиратель>:<предмет>" / "o<собиратель>:<офис>"
+    auto collect_order = [](const collision_detector::EventStream& stream) {
+        std::vector<std::string> order;
+        stream.ForEach([&order](const auto& evt) {
+            using T = std::decay_t<decltype(evt)>;
+            if constexpr (std::is_same_v<T, GatheringEvent>) {
+                order.push_back("g" + std::to_string(evt.gatherer_id) + ":" + std::to_string(evt.item_id));
+            } else {
+                order.push_back("o" + std::to_string(evt.gatherer_id) + ":" + std::to_string(evt.office_id));
+            }
+        });
+        return order;
+    };
+
+    WHEN("both streams are empty") {
+        std::vector<GatheringEvent> gather_events;
+        std::vector<OfficeSaveEvent> office_events;
+        collision_detector::EventStream stream(gather_events, office_events);
+        THEN("No events") {
+            CHECK(stream.Size() == 0);
+            CHECK(collect_order(stream).empty());
+        }
+    }
+    WHEN("events of different kinds are interleaved") {
+        std::vector<GatheringEvent> gather_events{{0, 0, 0., 0.1}, {1, 0, 0., 0.5}, {2, 1, 0., 0.9}};
+        std::vector<OfficeSaveEvent> office_events{{0, 1, 0., 0.3}, {0, 0, 0., 0.7}};
+        collision_detector::EventStream stream(gather_events, office_events);
+        THEN("Events are ordered by time") {
+            CHECK(stream.Size() == 5);
+            CHECK(collect_order(stream) == std::vector<std::string>{"g0:0", "o1:0", "g0:1", "o0:0", "g1:2"});
+        }
+    }
+    WHEN("events of different kinds happen at the same time") {
+        std::vector<GatheringEvent> gather_events{{3, 0, 0., 0.5}, {4, 1, 0., 0.5}};
+        std::vector<OfficeSaveEvent> office_events{{0, 0, 0., 0.5}, {1, 1, 0., 0.5}};
+        collision_detector::EventStream stream(gather_events, office_events);
+        THEN("No event is lost and gathering goes first") {
+            CHECK(collect_order(stream) == std::vector<std::string>{"g0:3", "g1:4", "o0:0", "o1:1"});
+        }
+    }
+    WHEN("several items are gathered at the same time") {
+        collision_detector::VectorItemGathererProvider provider{{
+                {0, {5, 0.5}, 0.},
+                {1, {5, -0.5}, 0.},
+            }, {
+                {{0, -0.5}, {10, -0.5}, 1.},
+                {{0, 0.5}, {10, 0.5}, 1.},
+            }
+        };
+        THEN("Events are ordered by gatherer and item") {
+            auto events = collision_detector::FindGatherEvents(provider);
+            REQUIRE(events.size() == 4);
+            CHECK((events[0].gatherer_id == 0 && events[0].item_id == 0));
+            CHECK((events[1].gatherer_id == 0 && events[1].item_id == 1));
+            CHECK((events[2].gatherer_id == 1 && events[2].item_id == 0));
+            CHECK((events[3].gatherer_id == 1 && events[3].item_id == 1));
+        }
+    }
+}
+
+SCENARIO("Batched collision detection") {
+    using collision_detector::BatchIsa;
+
+    // Результаты пакетной обработки должны побитово совпадать со скалярными
+    auto check_batched = [](const std::vector<collision_detector::Item>& items,
+                            const std::vector<collision_detector::Gatherer>& gatherers) {
+        auto expected = collision_detector::FindGatherEvents(
+            collision_detector::SpanItemGathererProvider{items, gatherers});
+
+        collision_detector::ItemsLayout layout;
+        for (const auto& item : items) {
+            layout.Add(item);
+        }
+
+        for (auto isa : {BatchIsa::SCALAR, BatchIsa::SSE2, BatchIsa::AVX2}) {
+            if (!collision_detector::IsBatchIsaSupported(isa)) {
+                continue;
+            }
+            INFO("isa: " << static_cast<int>(isa));
+            auto events = collision_detector::FindGatherEvents(layout, gatherers, isa);
+            REQUIRE(events.size() == expected.size());
+            for (size_t i = 0; i < events.size(); ++i) {
+                CHECK(events[i].item_id == expected[i].item_id);
+                CHECK(events[i].gatherer_id == expected[i].gatherer_id);
+                CHECK(events[i].sq_distance == expected[i].sq_distance);
+                CHECK(events[i].time == expected[i].time);
+            }
+        }
+    };
+
+    WHEN("multiple items on a way of gatherer") {
+        check_batched({
+            {0, {9, 0.27}, .1},
+            {1, {8, 0.24}, .1},
+            {2, {7, 0.21}, .1},
+            {3, {6, 0.18}, .1},
+            {4, {5, 0.15}, .1},
+            {5, {4, 0.12}, .1},
+            {6, {3, 0.09}, .1},
+            {7, {2, 0.06}, .1},
+            {8, {1, 0.03}, .1},
+            {9, {0, 0.0}, .1},
+            {10, {-1, 0}, .1},
+        }, {
+            {{0, 0}, {10, 0}, 0.1},
+        });
+    }
+    WHEN("multiple gatherers and one item") {
+        check_batched({
+            {0, {0, 0}, 0.},
+        }, {
+            {{-5, 0}, {5, 0}, 1.},
+            {{0, 1}, {0, -1}, 1.},
+            {{-10, 10}, {101, -100}, 0.5},
+            {{-100, 100}, {10, -10}, 0.5},
+            {{-5, 0}, {-5, 0}, 1.},
+        });
+    }
+    WHEN("many random items and gatherers") {
+        std::mt19937 generator(42);
+        std::uniform_real_distribution<double> coord(-20., 20.);
+        std::uniform_real_distribution<double> width(0., 1.);
+
+        std::vector<collision_detector::Item> items;
+        for (unsigned i = 0; i < 103; ++i) {
+            items.push_back({i, {coord(generator), coord(generator)}, width(generator)});
+        }
+        std::vector<collision_detector::Gatherer> gatherers;
+        for (unsigned i = 0; i < 17; ++i) {
+            gatherers.push_back({{coord(generator), coord(generator)}, {coord(generator), coord(generator)}, width(generator) * 5});
+        }
+        check_batched(items, gatherers);
+    }
+}
+
+SCENARIO("Office index") {
+    using collision_detector::Rect;
+
+    WHEN("gatherers move among offices") {
+        std::mt19937 generator(7);
+        std::uniform_real_distribution<double> coord(-50., 50.);
+        std::uniform_real_distribution<double> size(0., 5.);
+
+        std::vector<Rect> offices;
+        collision_detector::RectIndex index;
+        for (size_t i = 0; i < 40; ++i) {
+            offices.emplace_back(coord(generator), coord(generator), size(generator), size(generator));
+            index.Add(offices.back(), i);
+        }
+        std::vector<collision_detector::Gatherer> gatherers;
+        for (size_t i = 0; i < 60; ++i) {
+            geom::Point2D start{coord(generator), coord(generator)};
+            gatherers.push_back({start, {start.x + size(generator) * 4, start.y - size(generator) * 4}, 0.6});
+        }
+        gatherers.push_back({{0, 0}, {0, 0}, 0.6});
+
+        THEN("Index finds the same events as full search") {
+            auto expected = collision_detector::FindOfficeSaveEvents(
+                collision_detector::SpanOfficeSaveProvider{offices, gatherers});
+            auto events = collision_detector::FindOfficeSaveEvents(index, gatherers);
+
+            CHECK(index.Size() == offices.size());
+            REQUIRE(!expected.empty());
+            REQUIRE(events.size() == expected.size());
+            for (size_t i = 0; i < events.size(); ++i) {
+                CHECK(events[i].office_id == expected[i].office_id);
+                CHECK(events[i].gatherer_id == expected[i].gatherer_id);
+                CHECK(events[i].time == expected[i].time);
+            }
+        }
+    }
 }
\ No newline at end of file
@@ -0,0 +1,306 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <future>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../src/http/hot_restart.h"
+#include "../src/http/request_handler.h"
+#include "../src/http/state_handover.h"
+#include "test_game.h"
+
+using namespace std::literals;
+namespace fs = std::filesystem;
+namespace net = boost::asio;
+namespace http = boost::beast::http;
+using Clock = std::chrono::steady_clock;
+
+namespace {
+
+const std::string STATE = "game state snapshot"s;
+
+// Отвечает на одно соединение строкой reply
+void Serve(int listen_fd, std::string_view reply) {
+    const int connection = ::accept(listen_fd, nullptr, nullptr);
+    if (connection < 0) {
+        return;
+    }
+    char request[64];
+    if (::recv(connection, request, sizeof(request), 0) > 0) {
+        ::send(connection, reply.data(), reply.size(), MSG_NOSIGNAL);
+    }
+    ::close(connection);
+}
+
+// Новый процесс сервера: забирает слушающий сокет и обслуживает соединения, пока клиент не затихнет
+int RunNewServer(const fs::path& control_path) {
+    // Дать старому серверу поработать под нагрузкой
+    std::this_thread::sleep_for(200ms);
+    const auto handoff = hot_restart::RequestHandoff(control_path, 5s);
+    if (!handoff || handoff->state != STATE || handoff->listen_fds.size() != 1) {
+        return 1;
+    }
+    pollfd fds{handoff->listen_fds[0], POLLIN, 0};
+    size_t served = 0;
+    while (::poll(&fds, 1, 1000) > 0) {
+        Serve(fds.fd, "new"sv);
+        ++served;
+    }
+    return served > 0 ? 0 : 2;
+}
+
+// Клиент, непрерывно открывающий соединения к серверу
+struct ClientStats {
+    size_t from_old = 0;
+    size_t from_new = 0;
+    size_t failed = 0;
+    Clock::duration max_latency{};
+};
+
+ClientStats RunClient(uint16_t port, const std::atomic<bool>& stop) {
+    ClientStats stats;
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    while (!stop) {
+        const auto start = Clock::now();
+        const int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+        char reply[8] = {};
+        ssize_t received = -1;
+        if (::connect(fd, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) == 0
+            && ::send(fd, "ping", 4, MSG_NOSIGNAL) == 4) {
+            received = ::recv(fd, reply, sizeof(reply), MSG_WAITALL);
+        }
+        ::close(fd);
+
+        const std::string_view answer(reply, std::max<ssize_t>(received, 0));
+        if (answer == "old"sv) {
+            ++stats.from_old;
+        } else if (answer == "new"sv) {
+            ++stats.from_new;
+        } else {
+            ++stats.failed;
+        }
+        stats.max_latency = std::max(stats.max_latency, Clock::now() - start);
+    }
+    return stats;
+}
+
+}  // namespace
+
+SCENARIO("Hot restart hands the listening socket over to a new process") {
+    // Слушающий сокет старого сервера на свободном порту
+    const int listen_fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    REQUIRE(listen_fd >= 0);
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t addr_len = sizeof(addr);
+    REQUIRE(::bind(listen_fd, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) == 0);
+    REQUIRE(::listen(listen_fd, SOMAXCONN) == 0);
+    REQUIRE(::getsockname(listen_fd, reinterpret_cast<sockaddr*>(&addr), &addr_len) == 0);
+
+    const fs::path control_path = fs::temp_directory_path() / ("game_server_hot_restart_"s + std::to_string(::getpid()));
+    hot_restart::ControlSocket control(control_path);
+
+    // Новый процесс получает сокет только через управляющий сокет, унаследованные копии закрываются
+    const pid_t child = ::fork();
+    REQUIRE(child >= 0);
+    if (child == 0) {
+        ::close(listen_fd);
+        ::close(control.GetFd());
+        ::_exit(RunNewServer(control_path));
+    }
+
+    std::atomic<bool> stop_client = false;
+    ClientStats stats;
+    std::thread client([&] {
+        stats = RunClient(ntohs(addr.sin_port), stop_client);
+    });
+
+    // Старый сервер обслуживает соединения, пока не подключится новый процесс
+    Clock::duration handoff_time{};
+    while (true) {
+        pollfd fds[] = {{listen_fd, POLLIN, 0}, {control.GetFd(), POLLIN, 0}};
+        if (::poll(fds, 2, 5000) <= 0) {
+            FAIL("New process did not connect to the control socket");
+        }
+        if (fds[1].revents & POLLIN) {
+            if (auto connection = control.Accept()) {
+                const auto start = Clock::now();
+                hot_restart::SendHandoff(*connection, {listen_fd}, STATE);
+                ::close(listen_fd);
+                handoff_time = Clock::now() - start;
+                break;
+            }
+        }
+        if (fds[0].revents & POLLIN) {
+            Serve(listen_fd, "old"sv);
+        }
+    }
+
+    std::this_thread::sleep_for(300ms);
+    stop_client = true;
+    client.join();
+
+    int status = 0;
+    REQUIRE(::waitpid(child, &status, 0) == child);
+    CHECK(WIFEXITED(status));
+    CHECK(WEXITSTATUS(status) == 0);
+
+    using std::chrono::duration_cast;
+    using std::chrono::microseconds;
+    WARN("handoff: " << duration_cast<microseconds>(handoff_time).count() << " us, "
+         << "max client latency (downtime): " << duration_cast<microseconds>(stats.max_latency).count() << " us, "
+         << "responses: " << stats.from_old << " old / " << stats.from_new << " new");
+    CHECK(stats.failed == 0);
+    CHECK(stats.from_old > 0);
+    CHECK(stats.from_new > 0);
+    CHECK(stats.max_latency < 1s);
+}
+
+SCENARIO("Draining process hands the game state over") {
+    const fs::path wal_path = fs::temp_directory_path() / ("game_server_handover_wal_"s + std::to_string(::getpid()));
+    test_game::TestApp<> running;
+    auto& app = running.app;
+    serialization::StateSerializer serializer(running.game, app);
+    http_handler::AdmissionControl admission{http_handler::AdmissionConfig{}};
+    std::optional<wal::LogWriter> wal_writer{std::in_place, wal_path, 1s};
+    app.SetWriteAheadLog(&*wal_writer);
+    const auto token = app.JoinGame("Reks"s, "map1"s).GetTokenAsString();
+
+    hot_restart::StateHandover handover(app, serializer, admission);
+    const int listen_fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    REQUIRE(listen_fd >= 0);
+
+    // Обработчик запросов работающего процесса. Пока ioc не запущен, запросы к API ждут в очереди strand
+    net::io_context ioc;
+    auto api_strand = net::make_strand(ioc);
+    extra_data::MapsLootTypes extra_data;
+    http_handler::RateLimiter rate_limiter{http_handler::RateLimitConfig{}};
+    auto connections = std::make_shared<http_server::ConnectionManager>(ioc, 10s, 0);
+    auto handler = std::make_shared<http_handler::RequestHandler>(api_strand, app, fs::temp_directory_path(), extra_data,
+                                                                  admission, rate_limiter, *connections);
+
+    // Ответ на запрос. nullopt - соединение закрыто без ответа
+    using Result = std::optional<http_handler::StringResponse>;
+    std::vector<std::optional<Result>> results;
+    const auto join = [&](std::string name) {
+        http_handler::StringRequest req{http::verb::post, "/api/v1/game/join"s, 11};
+        req.set(http::field::content_type, "application/json");
+        req.keep_alive(true);
+        req.body() = R"({"userName": ")"s + name + R"(", "mapId": "map1"})"s;
+        req.prepare_payload();
+        auto& result = results.emplace_back();
+        (*handler)(std::move(req), [&result](auto&& response) {
+            if constexpr (std::is_same_v<std::decay_t<decltype(response)>, http_server::CloseConnection>) {
+                result.emplace(std::nullopt);
+            } else if constexpr (std::is_same_v<std::decay_t<decltype(response)>, http_handler::StringResponse>) {
+                result.emplace(std::move(response));
+            }
+        }, net::ip::tcp::endpoint{net::ip::make_address("127.0.0.1"), 12345});
+    };
+    results.reserve(4);
+    join("Bobik"s);
+    join("Tuzik"s);
+    join("Barbos"s);
+
+    // Новые запросы к API не допускаются, а снимок делается вслед за запросами, уже стоящими в очереди
+    admission.StartDraining();
+    net::post(api_strand, [&handover] {
+        handover.Begin();
+    });
+    join("Polkan"s);
+    ioc.run();
+
+    // Стоявшие в очереди запросы выполнены как обычно, но соединение после них закрывается
+    for (size_t i = 0; i < 3; ++i) {
+        REQUIRE(results[i]);
+        REQUIRE(*results[i]);
+        CHECK((*results[i])->result() == http::status::ok);
+        CHECK_FALSE((*results[i])->keep_alive());
+    }
+    // Запрос, пришедший после начала передачи, не получает 503: соединение закрывается, и клиент повторит его
+    REQUIRE(results[3]);
+    CHECK_FALSE(*results[3]);
+
+    CHECK(handover.IsHandedOff());
+    CHECK(admission.IsHandedOff());
+    CHECK_FALSE(admission.TryAdmit(http_handler::RequestPriority::Essential));
+    // После снимка действия в журнал не пишутся
+    const auto last_lsn = wal_writer->GetLastLsn();
+    app.JoinGame("Sharik"s, "map1"s);
+    CHECK(wal_writer->GetLastLsn() == last_lsn);
+
+    SECTION("Successor receives the snapshot and the sockets") {
+        const fs::path control_path = fs::temp_directory_path() / ("game_server_handover_"s + std::to_string(::getpid()));
+        hot_restart::ControlSocket control(control_path);
+        auto successor = std::async(std::launch::async, [&control_path] {
+            return hot_restart::RequestHandoff(control_path, 5s);
+        });
+        pollfd fds{control.GetFd(), POLLIN, 0};
+        REQUIRE(::poll(&fds, 1, 5000) == 1);
+        const auto connection = control.Accept();
+        REQUIRE(connection);
+
+        std::promise<std::exception_ptr> sent;
+        handover.Send(*connection, {listen_fd}, [&sent](std::exception_ptr error) {
+            sent.set_value(error);
+        });
+        auto handoff = successor.get();
+        CHECK(sent.get_future().get() == nullptr);
+        // Журнал дописан до передачи
+        CHECK(wal_writer->GetStats().synced_lsn == last_lsn);
+
+        REQUIRE(handoff);
+        CHECK(handoff->listen_fds.size() == 1);
+        for (const int fd : handoff->listen_fds) {
+            ::close(fd);
+        }
+        CHECK(handoff->state == handover.GetState());
+
+        // Новый процесс восстанавливает игроков, подключившихся до снимка, и продолжает журнал с его номера
+        test_game::TestApp<> successor_app;
+        serialization::StateSerializer new_serializer(successor_app.game, successor_app.app);
+        std::istringstream state{handoff->state};
+        CHECK(new_serializer.Deserialize(state) == last_lsn);
+        CHECK(successor_app.app.GetPlayers(token).size() == 4);
+    }
+
+    SECTION("Failed handover resumes serving") {
+        std::promise<std::exception_ptr> sent;
+        handover.Send(-1, {listen_fd}, [&sent](std::exception_ptr error) {
+            sent.set_value(error);
+        });
+        CHECK(sent.get_future().get() != nullptr);
+
+        handover.Abort();
+        CHECK_FALSE(handover.IsHandedOff());
+        CHECK_FALSE(admission.IsDraining());
+        CHECK_FALSE(admission.IsHandedOff());
+        CHECK(admission.TryAdmit(http_handler::RequestPriority::Essential));
+        // Действия снова пишутся в журнал
+        app.JoinGame("Druzhok"s, "map1"s);
+        CHECK(wal_writer->GetLastLsn() > last_lsn);
+    }
+
+    ::close(listen_fd);
+    wal_writer.reset();
+    fs::remove(wal_path);
+}
@@ -0,0 +1,133 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <filesystem>
+#include <string>
+#include <unistd.h>
+
+#include "../src/app/input_recording.h"
+#include "../src/sim/replay.h"
+#include "../src/sim/simulation.h"
+#include "test_game.h"
+
+using namespace std::literals;
+namespace fs = std::filesystem;
+
+namespace {
+
+// Трофеи появляются часто, собаки уходят на покой после 2 секунд бездействия
+const test_game::GameParams GAME_PARAMS{
+    .with_vertical_road = true, .dog_speed = 2.0, .loot_period = 0.5, .loot_types = 3, .retirement_time = 2.0};
+
+// Приложение, которое вместо сохранения рекордов считает ушедших на покой игроков
+using RecordedApp = test_game::TestApp<sim::RetiredPlayers>;
+
+// Игра, в которой игроки подключаются, двигаются и уходят на покой
+void Play(app::Application& app, int steps) {
+    std::vector<std::string> tokens;
+    for (int step = 0; step < steps; ++step) {
+        if (step % 10 == 0) {
+            tokens.push_back(app.JoinGame("dog"s + std::to_string(tokens.size()), "map1"s).GetTokenAsString());
+        }
+        const auto& token = tokens[step % tokens.size()];
+        try {
+            app.ExecutePlayerAction(token, app::PlayerAction{std::string(1, "LRUD"[step % 4])});
+            app.GetState(token, step % 2 ? std::optional{app::AreaOfInterest{10.0}} : std::nullopt);
+            app.GetPlayers(token);
+        } catch (...) {
+            // Игрок ушёл на покой
+        }
+        app.ExecuteTick(app::Tick{model::TimeType{100}});
+    }
+}
+
+struct ReplayResult {
+    size_t calls = 0;
+    size_t failed = 0;
+    std::uint64_t hash = 0;
+    std::optional<std::uint64_t> recorded_hash;
+};
+
+ReplayResult Replay(const fs::path& path) {
+    RecordedApp test_app(GAME_PARAMS);
+    auto& [game, retired, app] = test_app;
+    sim::Replayer replayer(game, app);
+
+    ReplayResult result;
+    result.calls = recording::ReadRecording(path, [&](std::chrono::microseconds, const recording::Call& call) {
+        result.failed += replayer.Execute(call).failed;
+    });
+    result.hash = recording::HashGameState(game, app.GetPlayers());
+    result.recorded_hash = replayer.GetRecordedHash();
+    return result;
+}
+
+}  // namespace
+
+SCENARIO("Input recording replays to the same state") {
+    const fs::path path = fs::temp_directory_path() / ("game_server_recording_"s + std::to_string(::getpid()));
+
+    SECTION("Recording from an empty game") {
+        RecordedApp test_app(GAME_PARAMS);
+        auto& [game, retired, app] = test_app;
+        size_t recorded_calls = 0;
+        std::uint64_t hash = 0;
+        {
+            recording::Recorder recorder(path);
+            app.SetRecorder(&recorder);
+            Play(app, 200);
+            hash = recording::HashGameState(game, app.GetPlayers());
+            recorder.Finish(hash);
+            recorded_calls = recorder.GetCalls();
+        }
+        REQUIRE(retired.GetTotal() > 0);
+
+        const auto result = Replay(path);
+        CHECK(result.calls == recorded_calls);
+        CHECK(result.recorded_hash == hash);
+        CHECK(result.hash == hash);
+        // Отклонённые при записи действия не записываются, а остальные вызовы выполняются так же
+        CHECK(result.failed == 0);
+    }
+
+    SECTION("Recording starts from a restored state") {
+        RecordedApp test_app(GAME_PARAMS);
+        auto& [game, retired, app] = test_app;
+        Play(app, 55);
+
+        std::uint64_t hash = 0;
+        {
+            recording::Recorder recorder(path);
+            recorder.Snapshot(game, app);
+            app.SetRecorder(&recorder);
+            // Двигаются и игроки из снимка
+            for (const auto& player : app.GetPlayers().GetPlayers()) {
+                app.ExecutePlayerAction(*app.GetTokens().FindTokenByPlayer(player.get()), app::PlayerAction{"R"s});
+            }
+            Play(app, 100);
+            hash = recording::HashGameState(game, app.GetPlayers());
+            recorder.Finish(hash);
+        }
+
+        const auto result = Replay(path);
+        CHECK(result.hash == hash);
+        CHECK(result.recorded_hash == hash);
+    }
+
+    SECTION("Recording cut short by a crash") {
+        RecordedApp test_app(GAME_PARAMS);
+        auto& [game, retired, app] = test_app;
+        {
+            recording::Recorder recorder(path);
+            app.SetRecorder(&recorder);
+            Play(app, 50);
+        }
+        // Последний кадр записан не полностью
+        fs::resize_file(path, fs::file_size(path) - 1);
+
+        const auto result = Replay(path);
+        CHECK(result.calls > 0);
+        CHECK_FALSE(result.recorded_hash);
+    }
+
+    fs::remove(path);
+}
@@ -0,0 +1,166 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <boost/json.hpp>
+
+#include <optional>
+#include <random>
+
+#include "../src/utils/json_fields.h"
+#include "../src/utils/json_loader.h"
+#include "../src/utils/json_scanner.h"
+
+using namespace std::literals;
+namespace json = boost::json;
+
+namespace {
+
+// Эталонный разбор через дерево boost::json - так параметры запросов читались раньше
+std::optional<http_handler::JoinParams> ReferenceJoin(std::string_view body) {
+    try {
+        const auto obj = json::parse(body).as_object();
+        return http_handler::JoinParams{json::value_to<std::string>(obj.at(json_field::JOIN_NAME)),
+                                        json::value_to<std::string>(obj.at(json_field::JOIN_MAP_ID))};
+    } catch (const std::exception&) {
+        return std::nullopt;
+    }
+}
+
+std::optional<int64_t> ReferenceTick(std::string_view body) {
+    try {
+        const auto obj = json::parse(body).as_object();
+        const auto& val = obj.at(json_field::TICK_DT);
+        if (!val.is_int64()) {
+            return std::nullopt;
+        }
+        return json::value_to<unsigned>(val);
+    } catch (const std::exception&) {
+        return std::nullopt;
+    }
+}
+
+std::optional<http_handler::JoinParams> ScanJoin(std::string_view body) {
+    try {
+        http_handler::JoinParams params;
+        json_loader::ReadJoinParamsFromString(params, body);
+        return params;
+    } catch (const std::invalid_argument&) {
+        return std::nullopt;
+    }
+}
+
+std::optional<int64_t> ScanTick(std::string_view body) {
+    try {
+        http_handler::TickParams params;
+        json_loader::ReadTickParamsFromString(params, body);
+        return params.dt.count();
+    } catch (const std::invalid_argument&) {
+        return std::nullopt;
+    }
+}
+
+bool IsValidJson(std::string_view str) {
+    json::error_code ec;
+    json::parse(str, ec);
+    return !ec;
+}
+
+bool ScannerAccepts(std::string_view str) {
+    json_scanner::Scanner scanner(str);
+    return scanner.SkipValue() && scanner.AtEnd();
+}
+
+// Случайно портит документ: удаляет и вставляет символы, вклеивает куски других документов
+std::string Mutate(std::string str, std::mt19937& random, const std::vector<std::string>& seeds) {
+    static constexpr std::string_view ALPHABET = "{}[]\",:\\/0123456789.-+eEtrufalsn ud8\t\n\x01\xd0\xa8\xff"sv;
+    const int mutations = std::uniform_int_distribution<int>{1, 4}(random);
+    for (int i = 0; i < mutations; ++i) {
+        const size_t pos = std::uniform_int_distribution<size_t>{0, str.size()}(random);
+        switch (random() % 3) {
+            case 0:
+                if (!str.empty()) {
+                    str.erase(std::min(pos, str.size() - 1), 1);
+                }
+                break;
+            case 1:
+                str.insert(pos, 1, ALPHABET[random() % ALPHABET.size()]);
+                break;
+            default:
+                str.insert(pos, seeds[random() % seeds.size()]);
+        }
+    }
+    return str;
+}
+
+const std::vector<std::string> SEEDS = {
+    R"({"userName":"Scooby Doo","mapId":"map1"})",
+    R"({"mapId":"map1", "userName":"Шарик", "extra":[1,{"a":null}]})",
+    R"({"timeDelta":100})",
+    R"({"timeDelta":-1})",
+    R"({"move":"L"})",
+    R"({"actions":[{"move":"U"},{"move":""}]})",
+    R"([1,-0.5e+3,true,false,null,"😀\n"])",
+    "{\"userName\":\"Шарик\",\"mapId\":\"town\"}",
+};
+
+}  // namespace
+
+SCENARIO("Request scanner extracts parameters") {
+    SECTION("Join") {
+        const auto params = ScanJoin(R"( {"userName" : "Sco\"oby!", "skip":{"a":[1,2]}, "mapId":"map1"} )");
+        REQUIRE(params);
+        CHECK(params->name == "Sco\"oby!"s);
+        CHECK(params->map_id == "map1"s);
+
+        CHECK_FALSE(ScanJoin(R"({"userName":"a"})"));
+        CHECK_FALSE(ScanJoin(R"({"userName":1,"mapId":"map1"})"));
+        CHECK_FALSE(ScanJoin(R"({"userName":"a","mapId":"map1"} x)"));
+    }
+
+    SECTION("Action") {
+        http_handler::PlayerActionParams params;
+        json_loader::ReadPlayerActionParamsFromString(params, R"({"move":"R"})");
+        CHECK(params.direction == "R"s);
+        CHECK_THROWS_AS(json_loader::ReadPlayerActionParamsFromString(params, R"({"move":null})"), std::invalid_argument);
+    }
+
+    SECTION("Batch") {
+        http_handler::PlayerBatchParams params;
+        json_loader::ReadPlayerBatchParamsFromString(params, R"({"actions":[{"move":"U"},{"x":1,"move":""}]})");
+        REQUIRE(params.actions.size() == 2);
+        CHECK(params.actions[0].direction == "U"s);
+        CHECK(params.actions[1].direction.empty());
+        CHECK_THROWS_AS(json_loader::ReadPlayerBatchParamsFromString(params, R"({"actions":[{}]})"), std::invalid_argument);
+    }
+
+    SECTION("Tick") {
+        CHECK(ScanTick(R"({"timeDelta":0})") == 0);
+        CHECK(ScanTick(R"({"timeDelta":4294967295})") == 4294967295);
+        CHECK_FALSE(ScanTick(R"({"timeDelta":4294967296})"));
+        CHECK_FALSE(ScanTick(R"({"timeDelta":-1})"));
+        CHECK_FALSE(ScanTick(R"({"timeDelta":1.0})"));
+        CHECK_FALSE(ScanTick(R"({"timeDelta":"1"})"));
+    }
+}
+
+SCENARIO("Request scanner agrees with boost::json on malformed bodies") {
+    std::mt19937 random{2024};
+    for (int i = 0; i < 100000; ++i) {
+        const std::string body = Mutate(SEEDS[random() % SEEDS.size()], random, SEEDS);
+        INFO(body);
+        REQUIRE(ScannerAccepts(body) == IsValidJson(body));
+
+        const auto join = ScanJoin(body);
+        const auto reference_join = ReferenceJoin(body);
+        REQUIRE(join.has_value() == reference_join.has_value());
+        if (join) {
+            REQUIRE(join->name == reference_join->name);
+            REQUIRE(join->map_id == reference_join->map_id);
+        }
+        REQUIRE(ScanTick(body) == ReferenceTick(body));
+    }
+
+    SECTION("Nesting depth") {
+        CHECK(ScannerAccepts(std::string(32, '[') + std::string(32, ']')));
+        CHECK_FALSE(ScannerAccepts(std::string(33, '[') + std::string(33, ']')));
+    }
+}
@@ -0,0 +1,134 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+
+#include <boost/json.hpp>
+
+#include <limits>
+#include <random>
+
+#include "../src/utils/json_writer.h"
+#include "../src/utils/json_loader.h"
+
+using namespace std::literals;
+namespace json = boost::json;
+
+namespace {
+
+std::string WriteDouble(double value) {
+    std::string out;
+    json_writer::JsonWriter writer(out);
+    writer.Value(value);
+    return out;
+}
+
+std::string WriteString(std::string_view value) {
+    std::string out;
+    json_writer::JsonWriter writer(out);
+    writer.Value(value);
+    return out;
+}
+
+// Состояние игры с заданным числом собак, у каждой несколько предметов в рюкзаке
+app::GetStateResult MakeState(size_t dogs_count) {
+    std::mt19937_64 random{42};
+    std::uniform_real_distribution<double> coord{0.0, 100.0};
+    std::uniform_real_distribution<double> speed{-3.0, 3.0};
+    constexpr model::Direction DIRECTIONS[] = {model::Direction::NORTH, model::Direction::SOUTH,
+                                               model::Direction::WEST, model::Direction::EAST};
+
+    app::GetStateResult state;
+    state.players_.reserve(dogs_count);
+    for (size_t i = 0; i < dogs_count; ++i) {
+        model::Dog dog{model::Dog::Id{static_cast<uint32_t>(i)}, model::Dog::Name{"dog"s + std::to_string(i)},
+                       model::Position{coord(random), coord(random)}, model::Speed{speed(random), speed(random)},
+                       DIRECTIONS[i % 4]};
+        for (uint32_t j = 0; j < i % 3; ++j) {
+            dog.TakeItem(model::Item{model::Item::Id{static_cast<uint32_t>(i * 3 + j)}, static_cast<int>(j),
+                                     model::Position{0.0, 0.0}});
+        }
+        dog.AddScore(static_cast<int>(i * 10));
+        state.players_.emplace_back(app::Player::Id{static_cast<int>(i)}, dog);
+    }
+    for (uint32_t i = 0; i < dogs_count / 4; ++i) {
+        state.items_.emplace_back(model::Item::Id{i}, static_cast<int>(i % 5),
+                                  model::Position{coord(random), coord(random)});
+    }
+    return state;
+}
+
+}  // namespace
+
+SCENARIO("JsonWriter writes numbers like boost::json") {
+    SECTION("Special doubles") {
+        for (double value : {0.0, -0.0, 1.0, -1.0, 0.25, 100.0, 1e-7, 1e21, 123456.789, 0.1,
+                             std::numeric_limits<double>::min(), std::numeric_limits<double>::max(),
+                             std::numeric_limits<double>::denorm_min(), std::numeric_limits<double>::infinity(),
+                             -std::numeric_limits<double>::infinity()}) {
+            INFO(value);
+            CHECK(WriteDouble(value) == json::serialize(json::value(value)));
+        }
+        CHECK(WriteDouble(std::numeric_limits<double>::quiet_NaN()) == "null"s);
+    }
+
+    SECTION("Random doubles") {
+        std::mt19937_64 random{1};
+        std::uniform_real_distribution<double> dist{-1000.0, 1000.0};
+        for (int i = 0; i < 10000; ++i) {
+            const double value = dist(random);
+            INFO(value);
+            REQUIRE(WriteDouble(value) == json::serialize(json::value(value)));
+        }
+    }
+
+    SECTION("Integers") {
+        std::string out;
+        json_writer::JsonWriter writer(out);
+        writer.BeginArray()
+            .Value(0)
+            .Value(-1)
+            .Value(std::numeric_limits<int64_t>::min())
+            .Value(std::numeric_limits<uint64_t>::max())
+            .EndArray();
+        CHECK(out == json::serialize(json::array{0, -1, std::numeric_limits<int64_t>::min(),
+                                                 std::numeric_limits<uint64_t>::max()}));
+    }
+}
+
+SCENARIO("JsonWriter escapes strings like boost::json") {
+    for (std::string_view str : {""sv, "plain"sv, "quote\"back\\slash"sv, "\b\f\n\r\t"sv, "\x01\x1f"sv,
+                                 "Шарик"sv, "tail\x7f"sv}) {
+        INFO(str);
+        CHECK(WriteString(str) == json::serialize(json::value(str)));
+    }
+}
+
+SCENARIO("JsonWriter builds objects and arrays") {
+    std::string out;
+    json_writer::JsonWriter writer(out);
+    writer.BeginObject()
+        .Key("a").BeginArray().EndArray()
+        .Key("b").BeginObject().Key("c").Value(true).Key("d").Null().EndObject()
+        .Key("e").Pair(1.0, 2.5)
+        .EndObject();
+    CHECK(out == R"({"a":[],"b":{"c":true,"d":null},"e":[1E0,2.5E0]})"s);
+}
+
+SCENARIO("Game state serialization") {
+    const auto state = MakeState(1000);
+    const std::string expected = json::serialize(json::value_from(state));
+
+    std::string actual;
+    json_writer::Serialize(state, actual);
+    CHECK(actual == expected);
+
+    BENCHMARK("boost::json, 1k dogs") {
+        return json::serialize(json::value_from(state));
+    };
+
+    BENCHMARK("json_writer, 1k dogs") {
+        std::string out;
+        out.reserve(expected.size());
+        json_writer::Serialize(state, out);
+        return out;
+    };
+}
@@ -0,0 +1,99 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include "../src/app/memory_records.h"
+#include "../src/load/load_client.h"
+
+using namespace std::literals;
+using load::LatencyHistogram;
+
+SCENARIO("Latency histogram") {
+    LatencyHistogram histogram;
+    CHECK(histogram.GetValueAtPercentile(99.0) == 0us);
+
+    WHEN("values are small") {
+        for (int i = 1; i <= 100; ++i) {
+            histogram.Record(std::chrono::microseconds{i});
+        }
+        THEN("percentiles are exact") {
+            CHECK(histogram.GetCount() == 100);
+            CHECK(histogram.GetMin() == 1us);
+            CHECK(histogram.GetMax() == 100us);
+            CHECK(histogram.GetMean() == 50us);
+            CHECK(histogram.GetValueAtPercentile(50.0) == 50us);
+            CHECK(histogram.GetValueAtPercentile(99.0) == 99us);
+            CHECK(histogram.GetValueAtPercentile(100.0) == 100us);
+        }
+    }
+
+    WHEN("values are large") {
+        for (int i = 1; i <= 1000; ++i) {
+            histogram.Record(std::chrono::microseconds{i * 1000});
+        }
+        THEN("relative error is below one percent") {
+            const auto p50 = histogram.GetValueAtPercentile(50.0);
+            CHECK(p50 >= 500ms);
+            CHECK(p50 <= 505ms);
+            CHECK(histogram.GetValueAtPercentile(100.0) == 1s);
+        }
+    }
+
+    WHEN("histograms are merged") {
+        LatencyHistogram other;
+        histogram.Record(10ms);
+        other.Record(20ms);
+        other.Record(LatencyHistogram::Microseconds{LatencyHistogram::MAX_VALUE + 1});
+        histogram.Merge(other);
+        THEN("counts and extremes are combined") {
+            CHECK(histogram.GetCount() == 3);
+            CHECK(histogram.GetMin() == 10ms);
+            CHECK(histogram.GetMax().count() == LatencyHistogram::MAX_VALUE);
+        }
+    }
+}
+
+SCENARIO("Load generator helpers") {
+    SECTION("Open loop schedules requests at a constant rate") {
+        const auto start = load::Clock::now();
+        load::Pacer pacer{100.0, start};
+        CHECK(pacer.Next(start) == start);
+        CHECK(pacer.Next(start) == start + 10ms);
+        CHECK(pacer.Next(start + 1s) == start + 20ms);
+    }
+
+    SECTION("Closed loop waits for the think time") {
+        load::Pacer pacer{5ms};
+        const auto now = load::Clock::now();
+        CHECK(pacer.Next(now) == now + 5ms);
+    }
+
+    SECTION("Join token is read from the response") {
+        CHECK(load::ParseJoinToken(R"({"authToken":"6516861d89ebfff147bf2eb2b5153ae1","playerId":0})"sv)
+              == "6516861d89ebfff147bf2eb2b5153ae1"s);
+        CHECK_FALSE(load::ParseJoinToken(R"({"playerId":0})"sv));
+        CHECK_FALSE(load::ParseJoinToken(R"({"authToken":"abc")"sv));
+    }
+}
+
+SCENARIO("Records kept in memory") {
+    app::MemoryPlayerRepository records;
+    const auto save = [&records](std::string name, int score, double play_time) {
+        records.Save({app::PlayerId::New(), std::move(name), score, play_time});
+    };
+    save("slow", 10, 50.0);
+    save("fast", 10, 20.0);
+    save("best", 30, 100.0);
+    save("zero", 0, 1.0);
+
+    const auto all = records.GetRecords(0, 100);
+    REQUIRE(all.size() == 4);
+    CHECK(all[0].name == "best"s);
+    CHECK(all[1].name == "fast"s);
+    CHECK(all[2].name == "slow"s);
+    CHECK(all[3].name == "zero"s);
+
+    const auto page = records.GetRecords(1, 2);
+    REQUIRE(page.size() == 2);
+    CHECK(page[0].name == "fast"s);
+    CHECK(page[1].name == "slow"s);
+    CHECK(records.GetRecords(10, 2).empty());
+}
@@ -2,6 +2,7 @@
 //#include <catch2/matchers/catch_matchers_templated.hpp>
 
 #include "../src/model/dog.h"
+#include "../src/model/game.h"
 
 using namespace model;
 
@@ -41,4 +42,188 @@ SCENARIO("Dog") {
         Dog dog{Dog::Id{0}, Dog::Name{"Sharik"}, Position{0.0, 0.0}, Speed{0.0, 0.0}, direction};
         REQUIRE(dog.GetDirection() == direction);
     }
-}
\ No newline at end of file
+
+    // Рюкзак хранит предметы по значению и растёт за пределы встроенной вместимости
+    SECTION("Bag") {
+        Dog dog{Dog::Id{0}, Dog::Name{"Sharik"}};
+        const size_t count = Bag::INLINE_CAPACITY + 2;
+        for (size_t i = 0; i < count; ++i) {
+            dog.TakeItem(Item{Item::Id{static_cast<uint32_t>(i)}, static_cast<int>(i % 2), Position{1.0, 1.0}, 5});
+        }
+        REQUIRE(dog.GetBagSize() == count);
+
+        Dog copy = dog;
+        dog.SaveBag();
+        CHECK(dog.GetBagSize() == 0);
+        CHECK(dog.GetScore() == static_cast<int>(count) * 5);
+
+        REQUIRE(copy.GetBagSize() == count);
+        uint32_t expected_id = 0;
+        for (const auto& item : copy.GetBag()) {
+            CHECK(*item.id == expected_id);
+            CHECK(item.type == static_cast<int>(expected_id % 2));
+            ++expected_id;
+        }
+    }
+
+    // Перемещение рюкзака, хранящего предметы в куче, оставляет исходный рюкзак пустым и пригодным к работе
+    SECTION("Bag move") {
+        Bag bag;
+        const size_t count = Bag::INLINE_CAPACITY + 2;
+        for (size_t i = 0; i < count; ++i) {
+            bag.Add({Item::Id{static_cast<uint32_t>(i)}, 0, 1});
+        }
+
+        Bag moved = std::move(bag);
+        CHECK(moved.Size() == count);
+        CHECK(bag.Size() == 0);
+        CHECK(bag.GetCapacity() == Bag::INLINE_CAPACITY);
+        CHECK(bag.begin() == bag.end());
+
+        // Исходный рюкзак снова растёт за пределы встроенного хранилища
+        for (size_t i = 0; i < count; ++i) {
+            bag.Add({Item::Id{static_cast<uint32_t>(count + i)}, 1, 2});
+        }
+        CHECK(bag.Size() == count);
+
+        Bag assigned;
+        assigned.Add({Item::Id{100u}, 0, 1});
+        assigned = std::move(moved);
+        REQUIRE(assigned.Size() == count);
+        CHECK(moved.Size() == 0);
+        uint32_t expected_id = 0;
+        for (const auto& item : assigned) {
+            CHECK(*item.id == expected_id++);
+        }
+
+        // Рюкзак во встроенном хранилище переносит свои предметы копированием
+        Bag small;
+        small.Add({Item::Id{7u}, 2, 3});
+        Bag small_moved = std::move(small);
+        REQUIRE(small_moved.Size() == 1);
+        CHECK(*small_moved.begin()->id == 7u);
+        CHECK(small.Size() == 0);
+    }
+}
+
+// Несколько сессий на одной карте
+SCENARIO("Game sessions") {
+    Game game(loot_gen::LootGeneratorInfo{5.0, 0.5});
+    Map map(Map::Id{"map1"}, "Map 1");
+    map.AddRoad(Road(Road::HORIZONTAL, {0, 0}, 10));
+    game.AddMap(map);
+    const Map::Id map_id{"map1"};
+
+    SECTION("Without capacity all players join one session") {
+        auto session = game.FindSession(map_id);
+        for (int i = 0; i < 10; ++i) {
+            REQUIRE(game.FindSession(map_id) == session);
+            session->AddDog({0.0, 0.0}, Dog::Name{"dog" + std::to_string(i)});
+        }
+        CHECK(game.GetSessions().size() == 1);
+    }
+
+    SECTION("Full sessions are split and empty ones are reclaimed") {
+        game.SetSessionCapacity(2);
+        std::vector<GameSession*> sessions;
+        for (int i = 0; i < 5; ++i) {
+            auto session = game.FindSession(map_id);
+            session->AddDog({0.0, 0.0}, Dog::Name{"dog" + std::to_string(i)});
+            sessions.push_back(session);
+        }
+        REQUIRE(game.GetSessions().size() == 3);
+        CHECK(sessions[0] == sessions[1]);
+        CHECK(sessions[2] == sessions[3]);
+        CHECK(sessions[4] != sessions[2]);
+
+        // Новый игрок попадает в наименее загруженную сессию
+        sessions[0]->RemoveDog(sessions[0]->GetDogs().front()->GetId());
+        CHECK(game.FindSession(map_id) == sessions[0]);
+
+        const auto last_id = sessions[4]->GetId();
+        sessions[4]->RemoveDog(sessions[4]->GetDogs().front()->GetId());
+        game.RemoveEmptySessions();
+        CHECK(game.GetSessions().size() == 2);
+        CHECK(game.FindSessionById(last_id) == nullptr);
+
+        // Последняя сессия карты сохраняется, даже если пуста
+        for (auto session : std::vector<GameSession*>(game.GetSessions())) {
+            while (!session->GetDogs().empty()) {
+                session->RemoveDog(session->GetDogs().front()->GetId());
+            }
+        }
+        game.RemoveEmptySessions();
+        CHECK(game.GetSessions().size() == 1);
+    }
+}
+
+// Собака, восстановленная из сохранённого состояния
+SCENARIO("Restored dog") {
+    Game game(loot_gen::LootGeneratorInfo{5.0, 0.5});
+    Map map(Map::Id{"map1"}, "Map 1");
+    map.AddRoad(Road(Road::HORIZONTAL, {0, 0}, 10));
+    map.SetBagCapacity(static_cast<int>(Bag::INLINE_CAPACITY) + 5);
+    game.AddMap(map);
+    auto session = game.FindSession(Map::Id{"map1"});
+
+    Dog saved{Dog::Id{7}, Dog::Name{"Sharik"}, Position{1.0, 0.0}};
+    saved.TakeItem(Item{Item::Id{1u}, 0, Position{1.0, 0.0}});
+    session->AddDog(saved);
+
+    // Рюкзак восстановленной собаки, как и новой, вмещает предметы по вместимости карты
+    REQUIRE(session->GetDogs().size() == 1);
+    const auto& dog = *session->GetDogs().front();
+    CHECK(dog.GetBagSize() == 1);
+    CHECK(dog.GetBag().GetCapacity() == Bag::INLINE_CAPACITY + 5);
+}
+
+// Простаивающая сессия
+SCENARIO("Idle game session") {
+    Game game(loot_gen::LootGeneratorInfo{5.0, 0.5});
+    Map map(Map::Id{"map1"}, "Map 1");
+    map.AddRoad(Road(Road::HORIZONTAL, {0, 0}, 10));
+    game.AddMap(map);
+    auto session = game.FindSession(Map::Id{"map1"});
+    constexpr TimeType DT{500};
+
+    SECTION("Empty session is idle") {
+        CHECK(session->IsIdle());
+    }
+
+    SECTION("Dog timers are applied on sync") {
+        auto dog = session->AddDog({0.0, 0.0}, Dog::Name{"Sharik"});
+        auto item_type = 0;
+        session->AddItem({5.0, 0.0}, item_type);
+        REQUIRE(session->IsIdle());
+
+        for (int i = 0; i < 4; ++i) {
+            session->AdvanceIdle(DT);
+        }
+        CHECK(dog->GetSleepTime() == 0.0);
+        CHECK(session->GetMaxSleepTime() == 2.0);
+
+        session->SyncDogTimers();
+        CHECK(dog->GetSleepTime() == 2.0);
+        CHECK(dog->GetPlayTime() == 2.0);
+        CHECK(session->GetMaxSleepTime() == 2.0);
+
+        // Время простоя не достаётся собаке, подключившейся позже
+        session->AdvanceIdle(DT);
+        auto late_dog = session->AddDog({0.0, 0.0}, Dog::Name{"Tuzik"});
+        CHECK(dog->GetSleepTime() == 2.5);
+        CHECK(late_dog->GetSleepTime() == 0.0);
+    }
+
+    SECTION("Moving dog makes session active") {
+        auto dog = session->AddDog({0.0, 0.0}, Dog::Name{"Sharik"});
+        auto item_type = 0;
+        session->AddItem({5.0, 0.0}, item_type);
+        dog->SetSpeed(1.0, Direction::EAST);
+        session->MarkActive();
+        CHECK_FALSE(session->IsIdle());
+
+        session->Tick(DT);
+        CHECK_FALSE(session->IsIdle());
+        CHECK(dog->GetSleepTime() == 0.0);
+    }
+}
@@ -0,0 +1,121 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <string>
+#include <thread>
+
+#include "../src/utils/sampling_profiler.h"
+
+using namespace std::literals;
+
+// Нагрузка на процессор: таймер ITIMER_PROF считает только процессорное время.
+// Функция не в анонимном пространстве имён, чтобы её имя попало в таблицу символов для dladdr
+[[gnu::noinline]] double Burn(std::chrono::milliseconds duration) {
+    profiler::ZoneScope zone{"Burn"};
+    volatile double sum = 0.0;
+    const auto end = std::chrono::steady_clock::now() + duration;
+    while (std::chrono::steady_clock::now() < end) {
+        for (int i = 1; i < 1000; ++i) {
+            sum = sum + std::sqrt(static_cast<double>(i));
+        }
+    }
+    return sum;
+}
+
+namespace {
+
+// Число сэмплов в строке свёрнутого стека, начинающейся с path. 0, если строки нет
+std::uint64_t GetCount(const std::string& folded, const std::string& path) {
+    const auto pos = folded.find(path + " "s);
+    if (pos == std::string::npos || (pos != 0 && folded[pos - 1] != '\n')) {
+        return 0;
+    }
+    return std::stoull(folded.substr(pos + path.size() + 1));
+}
+
+}  // namespace
+
+SCENARIO("Sampling profiler") {
+    GIVEN("a stopped profiler") {
+        THEN("zones are not tracked") {
+            profiler::ZoneScope zone{"Idle"};
+            CHECK(profiler::detail::zone_stack.depth == 0);
+            CHECK_FALSE(profiler::Stop());
+        }
+    }
+
+    WHEN("CPU work is sampled inside a zone") {
+        REQUIRE(profiler::Start(profiler::MAX_FREQUENCY));
+        CHECK_FALSE(profiler::Start());
+        {
+            profiler::ZoneScope outer{"Outer"};
+            Burn(300ms);
+        }
+        REQUIRE(profiler::Stop());
+
+        const auto stats = profiler::GetStats();
+        const auto zones = profiler::GetFoldedZones();
+        const auto stacks = profiler::GetFoldedStacks();
+
+        THEN("samples are attributed to the nested zone") {
+            CHECK_FALSE(stats.is_running);
+            CHECK(stats.samples > 50);
+            CHECK(GetCount(zones, "Outer;Burn"s) > stats.samples / 2);
+            CHECK(profiler::detail::zone_stack.depth == 0);
+        }
+        THEN("stacks are folded from the root and contain the sampled function") {
+            CHECK(stacks.find("Burn"s) != std::string::npos);
+            CHECK(stacks.back() == '\n');
+            // Start запомнил границы стека этого потока, поэтому раскрутка дошла до вызывающих функций
+            CHECK(stacks.find(";Burn"s) != std::string::npos);
+        }
+        THEN("samples are kept until the next start") {
+            CHECK(profiler::GetStats().samples == stats.samples);
+            REQUIRE(profiler::Start());
+            CHECK(profiler::GetStats().samples < stats.samples);
+            CHECK(profiler::Stop());
+        }
+    }
+
+    WHEN("a thread without known stack bounds is sampled") {
+        REQUIRE(profiler::Start(profiler::MAX_FREQUENCY));
+        std::thread{[] {
+            Burn(300ms);
+        }}.join();
+        REQUIRE(profiler::Stop());
+
+        THEN("samples contain only the interrupted function") {
+            const auto stacks = profiler::GetFoldedStacks();
+            CHECK(profiler::GetStats().samples > 50);
+            CHECK(stacks.find(';') == std::string::npos);
+        }
+    }
+
+    WHEN("the program exits while sampling") {
+        // Сэмплы и фоновый поток остаются работать до разрушения статических объектов
+        const pid_t child = ::fork();
+        REQUIRE(child >= 0);
+        if (child == 0) {
+            profiler::Start();
+            Burn(50ms);
+            std::exit(EXIT_SUCCESS);
+        }
+        int status = 0;
+        REQUIRE(::waitpid(child, &status, 0) == child);
+
+        THEN("the profiler is stopped without aborting") {
+            CHECK(WIFEXITED(status));
+            CHECK(WEXITSTATUS(status) == EXIT_SUCCESS);
+        }
+    }
+
+    THEN("invalid frequency is rejected") {
+        CHECK_THROWS_AS(profiler::Start(0), std::invalid_argument);
+        CHECK_THROWS_AS(profiler::Start(profiler::MAX_FREQUENCY + 1), std::invalid_argument);
+    }
+}
@@ -0,0 +1,127 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../src/http/rate_limiter.h"
+
+using namespace std::literals;
+using namespace http_handler;
+
+namespace {
+
+// Токены правильного формата: корзины заводятся только для них
+constexpr auto TOKEN = "6516861d89ebfff147bf2eb2b5153ae1"sv;
+constexpr auto FIRST_TOKEN = "00000000000000000000000000000001"sv;
+constexpr auto SECOND_TOKEN = "00000000000000000000000000000002"sv;
+constexpr auto THIRD_TOKEN = "00000000000000000000000000000003"sv;
+
+// Сколько из count запросов допущено в момент now
+int CountAllowed(RateLimiter& limiter, ApiRoute route, std::string_view token, const boost::asio::ip::address& ip,
+                 RateLimiter::Clock::time_point now, int count) {
+    int allowed = 0;
+    for (int i = 0; i < count; ++i) {
+        allowed += limiter.Allow(route, token, ip, now) ? 1 : 0;
+    }
+    return allowed;
+}
+
+}  // namespace
+
+SCENARIO("Route budget") {
+    SECTION("Token and IP rates") {
+        const auto budget = ParseRouteBudget("state=5/8"sv);
+        REQUIRE(budget);
+        CHECK(budget->first == ApiRoute::State);
+        CHECK(budget->second.token_rate == 5);
+        CHECK(budget->second.ip_rate == 8);
+    }
+
+    SECTION("IP rate may be omitted") {
+        const auto budget = ParseRouteBudget("action=3"sv);
+        REQUIRE(budget);
+        CHECK(budget->first == ApiRoute::PlayerAction);
+        CHECK(budget->second.token_rate == 3);
+        CHECK(budget->second.ip_rate == 0);
+        CHECK(ParseRouteBudget("batch=1/2"sv)->first == ApiRoute::PlayerBatch);
+    }
+
+    SECTION("Invalid specs are rejected") {
+        for (const auto spec : {"state"sv, "foo=1"sv, "=1"sv, "state="sv, "state=x"sv, "state=-1"sv, "state=5/"sv,
+                                "state=5/x"sv, "state=5/8/9"sv, "state=1.5"sv, "state=99999999999"sv}) {
+            INFO(spec);
+            CHECK_FALSE(ParseRouteBudget(spec));
+        }
+    }
+}
+
+SCENARIO("Rate limiter") {
+    RateLimitConfig config;
+    config[ApiRoute::State] = {5, 8};
+    RateLimiter limiter(config, 1024);
+    const auto ip = boost::asio::ip::make_address("10.0.0.1");
+    const auto now = RateLimiter::Clock::now();
+
+    SECTION("Burst is allowed, then denied, then refilled") {
+        CHECK(CountAllowed(limiter, ApiRoute::State, TOKEN, ip, now, 10) == 5);
+        CHECK_FALSE(limiter.Allow(ApiRoute::State, TOKEN, ip, now));
+
+        // За 200 мс корзина на 5 запросов в секунду пополняется на один запрос
+        CHECK(CountAllowed(limiter, ApiRoute::State, TOKEN, ip, now + 200ms, 10) == 1);
+        // За секунду - целиком, но не больше своего объёма
+        CHECK(CountAllowed(limiter, ApiRoute::State, TOKEN, ip, now + 10s, 10) == 5);
+
+        CHECK(limiter.GetStats().allowed == 11);
+        CHECK(limiter.GetStats().rejected == 20);
+    }
+
+    SECTION("Keys are independent") {
+        const auto other_ip = boost::asio::ip::make_address("::1");
+        CHECK(CountAllowed(limiter, ApiRoute::State, FIRST_TOKEN, ip, now, 10) == 5);
+        // Другой токен с другого адреса не затронут
+        CHECK(CountAllowed(limiter, ApiRoute::State, SECOND_TOKEN, other_ip, now, 10) == 5);
+        // У третьего токена своя корзина, но адрес общий с первым: на него осталось 3 запроса из 8
+        CHECK(CountAllowed(limiter, ApiRoute::State, THIRD_TOKEN, ip, now, 10) == 3);
+        // Запросы без токена ограничиваются только по адресу
+        CHECK(CountAllowed(limiter, ApiRoute::State, ""sv, other_ip, now, 10) == 3);
+        // У маршрута без бюджета ограничений нет
+        CHECK(CountAllowed(limiter, ApiRoute::Maps, FIRST_TOKEN, ip, now, 100) == 100);
+    }
+
+    SECTION("Tokens of a wrong format get no bucket") {
+        // Каждый такой запрос ограничивается только по адресу: 8 запросов, а не по 5 на токен
+        int allowed = 0;
+        for (int i = 0; i < 10; ++i) {
+            allowed += limiter.Allow(ApiRoute::State, "token" + std::to_string(i), ip, now) ? 1 : 0;
+        }
+        CHECK(allowed == 8);
+    }
+
+    SECTION("Many keys fit in a fixed table") {
+        // Старые корзины вытесняются новыми, ограничитель продолжает работать
+        for (int i = 0; i < 10000; ++i) {
+            std::string token(32, '0');
+            token.replace(token.size() - 5, 5, std::to_string(10000 + i));
+            limiter.Allow(ApiRoute::State, token, boost::asio::ip::make_address_v4(i), now);
+        }
+        // Вытеснившая корзина адреса начинает пустой, так что перебор ключей не даёт нового бюджета.
+        // Через секунду она наполняется целиком
+        CHECK(CountAllowed(limiter, ApiRoute::State, ""sv, ip, now, 10) == 0);
+        CHECK(CountAllowed(limiter, ApiRoute::State, ""sv, ip, now + 1s, 10) == 8);
+    }
+
+    SECTION("Statistics from several threads are summed") {
+        std::vector<std::jthread> threads;
+        for (int i = 0; i < 4; ++i) {
+            threads.emplace_back([&] {
+                CountAllowed(limiter, ApiRoute::Maps, ""sv, ip, now, 100);
+                CountAllowed(limiter, ApiRoute::State, ""sv, ip, now, 100);
+            });
+        }
+        threads.clear();
+        // У маршрута без бюджета запросы не считаются, а корзина адреса общая на все потоки
+        CHECK(limiter.GetStats().allowed == 8);
+        CHECK(limiter.GetStats().rejected == 392);
+    }
+}
@@ -0,0 +1,230 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <filesystem>
+#include <optional>
+#include <string>
+
+#include "../src/http/request_handler.h"
+#include "../src/utils/sampling_profiler.h"
+#include "test_game.h"
+
+using namespace std::literals;
+using namespace http_handler;
+
+namespace {
+
+// Обработчик запросов игры со всем, что ему нужно
+struct Server {
+    explicit Server(bool is_metrics_enabled, bool is_profiler_enabled = false)
+        : handler{std::make_shared<RequestHandler>(net::make_strand(ioc), test_app.app, std::filesystem::temp_directory_path(),
+                                                   extra_data, admission, rate_limiter, *connections,
+                                                   is_metrics_enabled, is_profiler_enabled)} {
+    }
+
+    // Выполняет запрос. Запросы к API выполняются в strand, поэтому ответ получен, когда ioc выполнит
+    // все обработчики. nullopt - вместо ответа соединение закрыто
+    std::optional<StringResponse> Send(StringRequest req) {
+        std::optional<StringResponse> response;
+        bool is_closed = false;
+        (*handler)(std::move(req), [&response, &is_closed](auto&& result) {
+            if constexpr (std::is_same_v<std::decay_t<decltype(result)>, StringResponse>) {
+                response = std::move(result);
+            } else if constexpr (std::is_same_v<std::decay_t<decltype(result)>, http_server::CloseConnection>) {
+                is_closed = true;
+            }
+        }, endpoint);
+        ioc.restart();
+        ioc.run();
+        REQUIRE(response.has_value() != is_closed);
+        return response;
+    }
+
+    StringResponse Handle(StringRequest req) {
+        auto response = Send(std::move(req));
+        REQUIRE(response);
+        return std::move(*response);
+    }
+
+    net::io_context ioc;
+    test_game::TestApp<> test_app;
+    extra_data::MapsLootTypes extra_data;
+    AdmissionControl admission{AdmissionConfig{}};
+    RateLimiter rate_limiter{RateLimitConfig{}};
+    std::shared_ptr<http_server::ConnectionManager> connections =
+        std::make_shared<http_server::ConnectionManager>(ioc, 10s, 0);
+    const net::ip::tcp::endpoint endpoint{net::ip::make_address("127.0.0.1"), 12345};
+    std::shared_ptr<RequestHandler> handler;
+};
+
+StringRequest MakeRequest(http::verb method, std::string target) {
+    StringRequest req{method, target, 11};
+    req.keep_alive(true);
+    return req;
+}
+
+}  // namespace
+
+SCENARIO("Server metrics") {
+    Server server{true};
+    const auto target = "/api/v1/metrics"s;
+
+    SECTION("Connection counters are reported") {
+        auto open = server.connections->TryOpen();
+        auto idle = server.connections->TryOpen();
+        idle->SetIdle(true);
+        server.connections->OnRejected();
+
+        const auto response = server.Handle(MakeRequest(http::verb::get, target));
+        CHECK(response.result() == http::status::ok);
+        CHECK(response.body().find(R"("connections":{"open":2,"idle":1,"reaped":0,"rejected":1})")
+              != std::string::npos);
+    }
+
+    SECTION("Only GET and HEAD are allowed") {
+        const auto response = server.Handle(MakeRequest(http::verb::post, target));
+        CHECK(response.result() == http::status::method_not_allowed);
+        CHECK(response[http::field::allow] == "GET, HEAD");
+    }
+
+    SECTION("Metrics are disabled by default") {
+        Server default_server{false};
+        const auto response = default_server.Handle(MakeRequest(http::verb::get, target));
+        CHECK(response.result() == http::status::bad_request);
+        CHECK(response.body().find("queueDepth") == std::string::npos);
+    }
+}
+
+SCENARIO("Profiler endpoint") {
+    Server server{false, true};
+
+    SECTION("Invalid sampling frequency is rejected") {
+        for (const auto target : {"/api/v1/profile/start?frequency=0"s, "/api/v1/profile/start?frequency=abc"s,
+                                  "/api/v1/profile/start?frequency"s, "/api/v1/profile/start?frequency=-5"s,
+                                  "/api/v1/profile/start?frequency="s + std::to_string(profiler::MAX_FREQUENCY + 1)}) {
+            INFO(target);
+            const auto response = server.Handle(MakeRequest(http::verb::post, target));
+            CHECK(response.result() == http::status::bad_request);
+            CHECK(response.body().find("invalidArgument") != std::string::npos);
+        }
+        CHECK_FALSE(profiler::GetStats().is_running);
+    }
+
+    SECTION("Sampling is started and stopped") {
+        auto response = server.Handle(MakeRequest(http::verb::post, "/api/v1/profile/start?frequency=500"s));
+        CHECK(response.result() == http::status::ok);
+        CHECK(response.body().find(R"("running":true,"frequency":500)") != std::string::npos);
+
+        response = server.Handle(MakeRequest(http::verb::post, "/api/v1/profile/stop"s));
+        CHECK(response.result() == http::status::ok);
+        CHECK(response.body().find(R"("running":false)") != std::string::npos);
+    }
+
+    SECTION("Control actions accept only POST") {
+        const auto response = server.Handle(MakeRequest(http::verb::get, "/api/v1/profile/start"s));
+        CHECK(response.result() == http::status::method_not_allowed);
+        CHECK(std::string(response[http::field::allow]) == AllowedMethods::PROFILE_CONTROL);
+        CHECK_FALSE(profiler::GetStats().is_running);
+    }
+
+    SECTION("Views accept only GET and HEAD") {
+        const auto response = server.Handle(MakeRequest(http::verb::post, "/api/v1/profile/stacks"s));
+        CHECK(response.result() == http::status::method_not_allowed);
+        CHECK(std::string(response[http::field::allow]) == AllowedMethods::PROFILE_VIEW);
+
+        CHECK(server.Handle(MakeRequest(http::verb::get, "/api/v1/profile/zones"s)).result() == http::status::ok);
+        CHECK(server.Handle(MakeRequest(http::verb::post, "/api/v1/profile/flame"s)).result() == http::status::bad_request);
+    }
+
+    SECTION("Profiler is disabled by default") {
+        Server default_server{false};
+        const auto response = default_server.Handle(MakeRequest(http::verb::post, "/api/v1/profile/start"s));
+        CHECK(response.result() == http::status::bad_request);
+        CHECK_FALSE(profiler::GetStats().is_running);
+    }
+
+    profiler::Stop();
+}
+
+SCENARIO("Admission control") {
+    SECTION("Non-essential requests are shed first") {
+        AdmissionControl admission{{4, 2, std::chrono::milliseconds(50), std::chrono::seconds(1)}};
+        CHECK(admission.TryAdmit(RequestPriority::NonEssential));
+        CHECK(admission.TryAdmit(RequestPriority::Essential));
+        // Очередь дошла до порога сброса: второстепенные запросы отклоняются, важные ещё допускаются
+        CHECK_FALSE(admission.TryAdmit(RequestPriority::NonEssential));
+        CHECK(admission.TryAdmit(RequestPriority::Essential));
+        CHECK(admission.TryAdmit(RequestPriority::Essential));
+        // Очередь заполнена: отклоняются все
+        CHECK_FALSE(admission.TryAdmit(RequestPriority::Essential));
+
+        auto metrics = admission.GetMetrics();
+        CHECK(metrics.queue_depth == 4);
+        CHECK(metrics.peak_queue_depth == 4);
+        CHECK(metrics.admitted == 4);
+        CHECK(metrics.shed == 1);
+        CHECK(metrics.rejected == 1);
+
+        // Очередь разобрана
+        for (int i = 0; i < 4; ++i) {
+            admission.OnDequeued();
+        }
+        CHECK(admission.TryAdmit(RequestPriority::NonEssential));
+        admission.OnDequeued();
+
+        // Игровой цикл не успевает за тикером - второстепенные запросы отклоняются и при пустой очереди
+        admission.ReportTickLag(std::chrono::milliseconds(60));
+        CHECK_FALSE(admission.TryAdmit(RequestPriority::NonEssential));
+        CHECK(admission.TryAdmit(RequestPriority::Essential));
+        admission.OnDequeued();
+        admission.ReportTickLag(std::chrono::milliseconds(0));
+        CHECK(admission.TryAdmit(RequestPriority::NonEssential));
+        admission.OnDequeued();
+
+        metrics = admission.GetMetrics();
+        CHECK(metrics.queue_depth == 0);
+        CHECK(metrics.shed == 2);
+    }
+
+    SECTION("Draining rejects new requests") {
+        AdmissionControl admission{AdmissionConfig{}};
+        admission.StartDraining();
+        CHECK(admission.IsDraining());
+        CHECK_FALSE(admission.TryAdmit(RequestPriority::Essential));
+        CHECK_FALSE(admission.TryAdmit(RequestPriority::NonEssential));
+        CHECK(admission.GetMetrics().rejected == 2);
+        CHECK(admission.GetMetrics().queue_depth == 0);
+
+        // Передача состояния не удалась - запросы снова допускаются
+        admission.StopDraining();
+        CHECK(admission.TryAdmit(RequestPriority::Essential));
+    }
+
+    SECTION("Overloaded server answers 503 with Retry-After") {
+        Server server{false};
+        // Очередь strand заполнена
+        const auto max_queue_depth = server.admission.GetConfig().max_queue_depth;
+        for (size_t i = 0; i < max_queue_depth; ++i) {
+            REQUIRE(server.admission.TryAdmit(RequestPriority::Essential));
+        }
+        const auto response = server.Handle(MakeRequest(http::verb::get, "/api/v1/maps"s));
+        CHECK(response.result() == http::status::service_unavailable);
+        CHECK(response[http::field::retry_after] == "1");
+        CHECK(response.keep_alive());
+        CHECK(response.body().find("Server is overloaded") != std::string::npos);
+        // Тело ответа сериализуется один раз и одинаково для всех отказов
+        CHECK(server.Handle(MakeRequest(http::verb::get, "/api/v1/maps"s)).body() == response.body());
+        for (size_t i = 0; i < max_queue_depth; ++i) {
+            server.admission.OnDequeued();
+        }
+    }
+
+    SECTION("Draining server closes the connection instead of answering") {
+        Server server{false};
+        // Передача состояния новому процессу: клиент повторит запрос на новом соединении уже к нему
+        server.admission.StartDraining();
+        CHECK_FALSE(server.Send(MakeRequest(http::verb::get, "/api/v1/maps"s)));
+        // Передача не удалась - запросы снова выполняются
+        server.admission.StopDraining();
+        CHECK(server.Send(MakeRequest(http::verb::get, "/api/v1/maps"s)));
+    }
+}
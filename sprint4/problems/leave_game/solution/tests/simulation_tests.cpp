@@ -0,0 +1,54 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include "../src/sim/simulation.h"
+#include "test_game.h"
+
+using namespace std::literals;
+
+SCENARIO("Headless simulation") {
+    // Две карты, собаки уходят на покой после 1 секунды бездействия
+    test_game::TestApp<sim::RetiredPlayers> test_app(
+        {.map_ids = {"map1", "map2"}, .with_vertical_road = true, .loot_types = 3, .retirement_time = 1.0});
+    auto& [game, retired, app] = test_app;
+    model::TickProfile profile;
+    app.SetTickProfile(&profile);
+    const app::Tick tick{model::TimeType{100}};
+
+    SECTION("Bots join maps in turn") {
+        sim::Bots bots(app, game, {10, sim::MovePolicy::Random, 5, 42});
+        bots.JoinAll();
+        REQUIRE(app.GetPlayers().GetPlayers().size() == 10);
+        REQUIRE(game.GetSessions().size() == 2);
+        for (const auto session : game.GetSessions()) {
+            CHECK(session->GetDogs().size() == 5);
+        }
+
+        for (int i = 0; i < 50; ++i) {
+            bots.Act(retired);
+            app.ExecuteTick(tick);
+        }
+        CHECK(bots.GetActions() > 0);
+        CHECK(profile.move.count() > 0);
+        CHECK(retired.GetTotal() == 0);
+    }
+
+    SECTION("Retired bots join again") {
+        sim::Bots bots(app, game, {4, sim::MovePolicy::Idle, 5, 42});
+        bots.JoinAll();
+        for (int i = 0; i < 25; ++i) {
+            bots.Act(retired);
+            app.ExecuteTick(tick);
+        }
+        bots.Act(retired);
+
+        CHECK(bots.GetActions() == 0);
+        CHECK(retired.GetTotal() >= 4);
+        CHECK(bots.GetRejoins() == retired.GetTotal());
+        CHECK(app.GetPlayers().GetPlayers().size() == 4);
+    }
+
+    SECTION("Unknown policy is rejected") {
+        CHECK(sim::ParseMovePolicy("patrol"sv) == sim::MovePolicy::Patrol);
+        CHECK_FALSE(sim::ParseMovePolicy("teleport"sv));
+    }
+}
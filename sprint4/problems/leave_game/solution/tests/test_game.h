@@ -0,0 +1,61 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "../src/app/app.h"
+#include "../src/app/memory_records.h"
+
+// Общие для тестов игра и приложение поверх неё
+namespace test_game {
+
+// Параметры тестовой игры. По умолчанию - одна карта map1 с горизонтальной дорогой длиной 40
+struct GameParams {
+    // Карты с одинаковыми дорогами
+    std::vector<std::string> map_ids{"map1"};
+    // Вертикальная дорога длиной 40 из начала горизонтальной
+    bool with_vertical_road = false;
+    double dog_speed = 1.0;
+    // Период появления трофеев (секунды) и вероятность
+    double loot_period = 5.0;
+    double loot_probability = 0.5;
+    // Число типов трофеев на картах. 0 - трофеев нет
+    unsigned loot_types = 0;
+    // Время бездействия, после которого собака уходит на покой (секунды)
+    double retirement_time = 15.0;
+};
+
+inline model::Game MakeGame(const GameParams& params = {}) {
+    model::Game game(loot_gen::LootGeneratorInfo{params.loot_period, params.loot_probability}, 1.0, 3,
+                     params.retirement_time);
+    for (size_t i = 0; i < params.map_ids.size(); ++i) {
+        model::Map map(model::Map::Id{params.map_ids[i]}, "Map " + std::to_string(i + 1));
+        map.AddRoad(model::Road(model::Road::HORIZONTAL, {0, 0}, 40));
+        if (params.with_vertical_road) {
+            map.AddRoad(model::Road(model::Road::VERTICAL, {0, 0}, 40));
+        }
+        map.SetDogSpeed(params.dog_speed);
+        if (params.loot_types > 0) {
+            map.SetNLootTypes(params.loot_types);
+        }
+        game.AddMap(map);
+    }
+    return game;
+}
+
+// Игра, хранилище рекордов и приложение. Records - хранилище ушедших на покой игроков
+template <typename Records = app::MemoryPlayerRepository>
+struct TestApp {
+    explicit TestApp(const GameParams& params = {})
+        : game(MakeGame(params)) {
+    }
+
+    TestApp(const TestApp&) = delete;
+    TestApp& operator=(const TestApp&) = delete;
+
+    model::Game game;
+    Records records;
+    app::Application app{game, records};
+};
+
+}  // namespace test_game
@@ -0,0 +1,118 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+#include "../src/utils/write_ahead_log.h"
+
+using namespace std::literals;
+namespace fs = std::filesystem;
+
+namespace {
+
+struct LoggedRecord {
+    wal::Lsn lsn;
+    wal::Record record;
+};
+
+std::vector<LoggedRecord> ReadAll(const fs::path& path, wal::ReadResult* result = nullptr) {
+    std::vector<LoggedRecord> records;
+    auto res = wal::ReadLog(path, [&records](wal::Lsn lsn, const wal::Record& record) {
+        records.push_back({lsn, record});
+    });
+    if (result) {
+        *result = res;
+    }
+    return records;
+}
+
+// Временный файл журнала, удаляемый после теста
+struct TempLog {
+    fs::path path = fs::temp_directory_path() / "game_server_wal_test.log";
+
+    ~TempLog() {
+        fs::remove(path);
+    }
+};
+
+}  // namespace
+
+SCENARIO("Write-ahead log") {
+    TempLog log;
+
+    SECTION("Records are read back in order") {
+        {
+            wal::LogWriter writer(log.path, 1ms);
+            CHECK(writer.Append(wal::JoinRecord{"Шарик"s, "map1"s, "0123456789abcdef0123456789abcdef"s}) == 1);
+            CHECK(writer.Append(wal::ActionRecord{"0123456789abcdef0123456789abcdef"s, "L"s}) == 2);
+            CHECK(writer.Append(wal::TickRecord{100, 42}) == 3);
+            CHECK(writer.Append(wal::LeaveRecord{"token"s}) == 4);
+            REQUIRE(writer.Flush());
+            CHECK(writer.GetStats().synced_lsn == 4);
+        }
+
+        const auto records = ReadAll(log.path);
+        REQUIRE(records.size() == 4);
+        for (size_t i = 0; i < records.size(); ++i) {
+            CHECK(records[i].lsn == i + 1);
+        }
+        const auto& join = std::get<wal::JoinRecord>(records[0].record);
+        CHECK(join.name == "Шарик"s);
+        CHECK(join.map_id == "map1"s);
+        CHECK(std::get<wal::ActionRecord>(records[1].record).move == "L"s);
+        CHECK(std::get<wal::TickRecord>(records[2].record).dt == 100);
+        CHECK(std::get<wal::TickRecord>(records[2].record).seed == 42);
+        CHECK(std::get<wal::LeaveRecord>(records[3].record).token == "token"s);
+    }
+
+    SECTION("Records stay on disk after destruction without explicit flush") {
+        {
+            wal::LogWriter writer(log.path, 1h);
+            for (int i = 0; i < 1000; ++i) {
+                writer.Append(wal::TickRecord{i, 0});
+            }
+        }
+        CHECK(ReadAll(log.path).size() == 1000);
+    }
+
+    SECTION("Truncation drops records included in snapshot") {
+        wal::LogWriter writer(log.path, 1ms, 10);
+        writer.Append(wal::TickRecord{1, 0});
+        writer.Append(wal::TickRecord{2, 0});
+        REQUIRE(writer.Flush());
+        writer.Truncate();
+        CHECK(writer.Append(wal::TickRecord{3, 0}) == 13);
+        REQUIRE(writer.Flush());
+
+        const auto records = ReadAll(log.path);
+        REQUIRE(records.size() == 1);
+        CHECK(records[0].lsn == 13);
+        CHECK(std::get<wal::TickRecord>(records[0].record).dt == 3);
+    }
+
+    SECTION("Reading stops at torn or corrupted record") {
+        {
+            wal::LogWriter writer(log.path, 1ms);
+            writer.Append(wal::ActionRecord{"token"s, "U"s});
+            writer.Append(wal::ActionRecord{"token"s, "D"s});
+        }
+        const auto full_size = fs::file_size(log.path);
+
+        // Последняя запись оборвана
+        fs::resize_file(log.path, full_size - 3);
+        wal::ReadResult result;
+        CHECK(ReadAll(log.path, &result).size() == 1);
+        CHECK(result.last_lsn == 1);
+        const auto first_size = result.valid_size;
+
+        // Испорчен байт данных первой записи
+        {
+            std::fstream file(log.path, std::ios::in | std::ios::out | std::ios::binary);
+            file.seekp(first_size - 1);
+            file.put('X');
+        }
+        CHECK(ReadAll(log.path, &result).empty());
+        CHECK(result.valid_size == 0);
+    }
+}